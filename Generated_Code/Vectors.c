@@ -151,9 +151,9 @@ const tIsrFunc _InterruptVectorTable[103] @0x00000000 = { /* Interrupt vector ta
   hwCpu_Interrupt,                     /* 0x49  0x00000124   -   -   ivVtpm2ovf    unused by PE */
   hwCpu_Interrupt,                     /* 0x4A  0x00000128   -   -   ivVspi2       unused by PE */
   hwCpu_Interrupt,                     /* 0x4B  0x0000012C   -   -   ivVspi1       unused by PE */
-  hwCpu_Interrupt,                     /* 0x4C  0x00000130   -   -   ivVsci1err    unused by PE */
-  hwCpu_Interrupt,                     /* 0x4D  0x00000134   -   -   ivVsci1rx     unused by PE */
-  hwCpu_Interrupt,                     /* 0x4E  0x00000138   -   -   ivVsci1tx     unused by PE */
+  hwExpOut_InterruptError,             /* 0x4C  0x00000130   2   5   ivVsci1err    used by PE */
+  hwExpOut_InterruptRx,                /* 0x4D  0x00000134   2   4   ivVsci1rx     used by PE */
+  hwExpOut_InterruptTx,                /* 0x4E  0x00000138   2   3   ivVsci1tx     used by PE */
   hwCpu_Interrupt,                     /* 0x4F  0x0000013C   -   -   ivViicx       unused by PE */
   drvCtsISR,                           /* 0x50  0x00000140   3   6   ivVkeyboard   used by PE */
   hwCpu_Interrupt,                     /* 0x51  0x00000144   -   -   ivVadc        unused by PE */
@@ -20,7 +20,7 @@
 **         Serial channel              : SCI1
 **
 **         Protocol
-**             Init baud rate          : 9600baud
+**             Init baud rate          : 115200baud
 **             Width                   : 8 bits
 **             Stop bits               : 1
 **             Parity                  : none
@@ -34,7 +34,13 @@
 **             Baud setting reg.       : SCI1BD    [0xFFFF8020]
 **             Special register        : SCI1S1    [0xFFFF8024]
 **
+**         Input interrupt
+**             Vector name             : Vsci1rx
+**             Priority                : 240
 **
+**         Output interrupt
+**             Vector name             : Vsci1tx
+**             Priority                : 240
 **
 **         Used pins:
 **         ----------------------------------------------------------
@@ -53,6 +59,8 @@
 **         SendChar        - byte hwExpOut_SendChar(hwExpOut_TComData Chr);
 **         GetCharsInRxBuf - word hwExpOut_GetCharsInRxBuf(void);
 **         GetCharsInTxBuf - word hwExpOut_GetCharsInTxBuf(void);
+**         GetRxIdle       - bool hwExpOut_GetRxIdle(void);
+**         GetTxComplete   - bool hwExpOut_GetTxComplete(void);
 **
 **     (c) Copyright UNIS, spol. s r.o. 1997-2008
 **     UNIS, spol. s r.o.
@@ -67,21 +75,27 @@
 /* MODULE hwExpOut. */
 
 #include "hwExpOut.h"
+#include "Events.h"
 
 
 
 
 #define OVERRUN_ERR      0x01          /* Overrun error flag bit   */
 #define COMMON_ERR       0x02          /* Common error of RX       */
-#define FULL_TX          0x04          /* Full transmit buffer     */
+#define CHAR_IN_RX       0x04          /* Char is in RX buffer     */
+#define FULL_TX          0x08          /* Full transmit buffer     */
+#define IDLE_ERR         0x10          /* Idle character flag bit  */
 
 
 static byte SerFlag;                   /* Flags for serial communication */
                                        /* Bit 0 - Overrun error */
                                        /* Bit 1 - Common error of RX */
-                                       /* Bit 2 - Full TX buffer */
+                                       /* Bit 2 - Char in RX buffer */
+                                       /* Bit 3 - Full TX buffer */
+                                       /* Bit 4 - Idle detected */
 static bool EnUser;                    /* Enable/Disable SCI */
 static bool EnMode;                    /* Enable/Disable SCI in speed mode */
+static hwExpOut_TComData BufferRead;   /* Input char for SCI commmunication */
 static hwExpOut_TComData BufferWrite;  /* Output char for SCI commmunication */
 
 /*
@@ -97,23 +111,28 @@ static hwExpOut_TComData BufferWrite;  /* Output char for SCI commmunication */
 */
 static void HWEnDi(void)
 {
+  EnterCritical();                     /* Save the PS register */
   if(EnMode && EnUser) {               /* Enable device? */
     SCI1BDH = 0x00;                    /* Set high divisor register (enable device) */
-    SCI1BDL = 0xA4;                    /* Set low divisor register (enable device) */
-    SCI1C2_TE = 0x01;                   /* Enable transmitter */
-    SCI1C2_RE = 0x01;                   /* Enable receiver */
+    SCI1BDL = 0x0E;                    /* Set low divisor register (enable device) */
+      /* SCI1C3: ORIE=1,NEIE=1,FEIE=1,PEIE=1 */
+    SCI1C3 |= 0x0F;                    /* Enable error interrupts */
+    SCI1C2 |= ( SCI1C2_TE_MASK | SCI1C2_RE_MASK | SCI1C2_RIE_MASK | SCI1C2_ILIE_MASK); /*  Enable transmitter, Enable receiver, Enable receiver interrupt, Enable idle interrupt */
     if(SerFlag & FULL_TX) {            /* Is any char in the transmit buffer? */
+      (void)SCI1S1;                    /* Reset interrupt request flag */
       while(!SCI1S1_TDRE) {}           /* Wait for transmitter empty */
       SCI1D = (byte)BufferWrite;       /* Store char to the transmitter register */
-      SerFlag &= ~FULL_TX;             /* Clear the FULL_TX flag */
+      SCI1C2_TIE = 1;                  /* Enable transmit interrupt */
     }
   }
   else {
-    SCI1C2_RE = 0x00;                   /* Disable receiver */
-    SCI1C2_TE = 0x00;                   /* Disable transmitter */
+    /* SCI1C3: ORIE=0,NEIE=0,FEIE=0,PEIE=0 */
+    SCI1C3 &= ~0x0F;                   /* Disable error interrupts */
+    SCI1C2 &= ( (~SCI1C2_RE_MASK) & (~SCI1C2_TE_MASK) & (~SCI1C2_TIE_MASK) & (~SCI1C2_RIE_MASK) & (~SCI1C2_ILIE_MASK)); /*  Disable receiver, Disable transmitter, Disable transmit interrupt, Disable receiver interrupt, Disable idle interrupt */
     SCI1BDH = 0x00;                    /* Set high divisor register to zero (disable device) */
     SCI1BDL = 0x00;                    /* Set low divisor register to zero (disable device) */
   }
+  ExitCritical();                      /* Restore the PS register */
 }
 
 /*
@@ -208,18 +227,18 @@ byte hwExpOut_Disable(void)
 byte hwExpOut_RecvChar(hwExpOut_TComData *Chr)
 {
   byte Result = ERR_OK;                /* Return error code */
-  byte StatReg = SCI1S1;               /* Read status register */
 
   if(!EnMode) {                        /* Is the device disabled in the actual speed CPU mode? */
     return ERR_SPEED;                  /* If yes then error */
   }
-  if (StatReg & (SCI1S1_OR_MASK|SCI1S1_NF_MASK|SCI1S1_FE_MASK|SCI1S1_PF_MASK)) { /* Is any error set? */
-    Result = ERR_COMMON;               /* If yes then set common error value */
-  } else if (!(StatReg & SCI1S1_RDRF_MASK)) { /* Is the reciver empty and no error is set? */
-    return ERR_RXEMPTY;                /* If yes then error */
-  } else {                             /* Intentionally left empty due to compatibility with MISRA rule 60*/
+  if(!(SerFlag & CHAR_IN_RX)) {        /* Is any char in RX buffer? */
+    return ERR_RXEMPTY;                /* If no then error */
   }
-  *Chr = SCI1D;                        /* Read data from the receiver */
+  EnterCritical();                     /* Save the PS register */
+  *Chr = BufferRead;                   /* Received char */
+  Result = (byte)((SerFlag & (OVERRUN_ERR|COMMON_ERR))?ERR_COMMON:ERR_OK);
+  SerFlag &= ~(OVERRUN_ERR|COMMON_ERR|CHAR_IN_RX); /* Clear all errors in the status variable */
+  ExitCritical();                      /* Restore the PS register */
   return Result;                       /* Return error code */
 }
 
@@ -251,15 +270,20 @@ byte hwExpOut_SendChar(hwExpOut_TComData Chr)
   if(!EnMode) {                        /* Is the device disabled in the actual speed CPU mode? */
     return ERR_SPEED;                  /* If yes then error */
   }
-  if ((!SCI1S1_TDRE)||(SerFlag & FULL_TX)) { /* Is the transmitter empty? */
-    return ERR_TXFULL;                 /* If no then error */
+  if(SerFlag & FULL_TX) {              /* Is any char in TX buffer? */
+    return ERR_TXFULL;                 /* If yes then error */
   }
+  EnterCritical();                     /* Save the PS register */
   if(EnUser) {                         /* Is the device enabled by user? */
+    (void)SCI1S1;                      /* Reset interrupt request flag */
     SCI1D = (byte)Chr;                 /* Store char to the transmitter register */
-  } else {
-    BufferWrite = Chr;
-    SerFlag |= FULL_TX;                /* Set the flag "full TX buffer" */
+    SCI1C2_TIE = 1;                    /* Enable transmit interrupt */
   }
+  else {
+    BufferWrite = Chr;                 /* Store char to temporary variable */
+  }
+  SerFlag |= FULL_TX;                  /* Set the flag "full TX buffer" */
+  ExitCritical();                      /* Restore the PS register */
   return ERR_OK;                       /* OK */
 }
 
@@ -277,11 +301,10 @@ byte hwExpOut_SendChar(hwExpOut_TComData Chr)
 **                           buffer.
 ** ===================================================================
 */
-/*
 word hwExpOut_GetCharsInRxBuf(void)
-
-**      This method is implemented as a macro. See header module. **
-*/
+{
+  return (word)((SerFlag & CHAR_IN_RX) != 0); /* Return number of chars in receive buffer */
+}
 
 /*
 ** ===================================================================
@@ -299,7 +322,98 @@ word hwExpOut_GetCharsInRxBuf(void)
 */
 word hwExpOut_GetCharsInTxBuf(void)
 {
-  return (word)((EnUser) ? (!SCI1S1_TDRE) : ((SerFlag & FULL_TX) != 0)); /* Return number of chars in the transmitter buffer */
+  return (word)((SerFlag & FULL_TX) != 0); /* Return number of chars in the transmitter buffer */
+}
+
+/*
+** ===================================================================
+**     Method      :  hwExpOut_InterruptRx (bean AsynchroSerial)
+**
+**     Description :
+**         The method services the receive interrupt of the selected 
+**         peripheral(s) and eventually invokes the bean's event(s).
+**         This method is internal. It is used by Processor Expert only.
+** ===================================================================
+*/
+#define ON_ERROR      1
+#define ON_FULL_RX    2
+#define ON_RX_CHAR    4
+#define ON_IDLE_CHAR  8
+ISR(hwExpOut_InterruptRx)
+{
+  byte StatReg = SCI1S1;               /* Temporary variable for status flags */
+  hwExpOut_TComData Data;              /* Temporary variable for data */
+  byte OnFlags = 0;                    /* Temporary variable for flags */
+
+  if (StatReg & SCI1S1_RDRF_MASK) {    /* Has a character been received? */
+    Data = SCI1D;                      /* Read data from the receiver */
+    if(SerFlag & CHAR_IN_RX) {         /* Is any char already present in the receive buffer? */
+      SerFlag |= OVERRUN_ERR;          /* If yes then set flag OVERRUN_ERR */
+    }
+    if(!(SerFlag & OVERRUN_ERR )) {    /* Is an overrun detected? */
+      BufferRead = Data;
+      SerFlag |= CHAR_IN_RX;           /* Set flag "char in RX buffer" */
+      OnFlags |= ON_RX_CHAR;           /* Set flag "OnRxChar" */
+    }
+  }
+  if (StatReg & SCI1S1_IDLE_MASK) {    /* If IDLE character received */
+    if (!(StatReg & SCI1S1_RDRF_MASK)) { /* If no data received, clear the flag */
+      (void)SCI1D;                     /* Dummy read of data register - clear idle flag */
+    }
+    SerFlag |= IDLE_ERR;
+  }
+  if(OnFlags & ON_RX_CHAR) {           /* Is OnRxChar flag set? */
+    hwExpOut_OnRxChar();               /* If yes then invoke user event */
+  }
+}
+
+/*
+** ===================================================================
+**     Method      :  hwExpOut_InterruptTx (bean AsynchroSerial)
+**
+**     Description :
+**         The method services the receive interrupt of the selected 
+**         peripheral(s) and eventually invokes the bean's event(s).
+**         This method is internal. It is used by Processor Expert only.
+** ===================================================================
+*/
+#define ON_FREE_TX  1
+#define ON_TX_CHAR  2
+ISR(hwExpOut_InterruptTx)
+{
+  byte OnFlags = 0;                    /* Temporary variable for flags */
+
+  if(SerFlag & FULL_TX) {              /* Is a char already present in the transmit buffer? */
+    OnFlags |= ON_TX_CHAR;             /* Set flag "OnTxChar" */
+  }
+  SerFlag &= ~FULL_TX;                 /* Reset flag "full TX buffer" */
+  SCI1C2_TIE = 0;                      /* Disable transmit interrupt */
+  if(OnFlags & ON_TX_CHAR) {           /* Is flag "OnTxChar" set? */
+    hwExpOut_OnTxChar();               /* If yes then invoke user event */
+  }
+}
+
+/*
+** ===================================================================
+**     Method      :  hwExpOut_InterruptError (bean AsynchroSerial)
+**
+**     Description :
+**         The method services the error interrupt of the selected 
+**         peripheral(s) and eventually invokes the bean's event(s).
+**         This method is internal. It is used by Processor Expert only.
+** ===================================================================
+*/
+ISR(hwExpOut_InterruptError)
+{
+  byte StatReg = getReg(SCI1S1);
+
+  (void)SCI1D;                         /* Dummy read of data register - clear error bits */
+  if(StatReg & SCI1S1_IDLE_MASK) {     /* if IDLE character received */
+    SerFlag |= IDLE_ERR;
+  }
+  if(StatReg & (SCI1S1_OR_MASK|SCI1S1_NF_MASK|SCI1S1_FE_MASK|SCI1S1_PF_MASK)) { /* Is an error detected? */
+    SerFlag |= COMMON_ERR;             /* If yes then set an internal flag */
+  }
 }
 
 /*
@@ -362,6 +476,50 @@ void hwExpOut_SetSlow(void)
   HWEnDi();                            /* Enable/disable device according to status flags */
 }
 
+/*
+** ===================================================================
+**     Method      :  hwExpOut_GetRxIdle (bean AsynchroSerial)
+**
+**     Description :
+**         Returns the state of the receiver idle flag. This method
+**         is available only if event <OnIdle> is disabled.
+**     Parameters  : None
+**     Returns     :
+**         ---             - The state of the receiver idle flag.
+** ===================================================================
+*/
+bool hwExpOut_GetRxIdle(void)
+{
+  bool Result;
+
+  EnterCritical();                     /* Save the PS register */
+  Result = (bool)((SerFlag & IDLE_ERR)?1:0); /* If idle signal has been received? */
+  SerFlag &= ~IDLE_ERR;                /* Reset idle signal flag */
+  ExitCritical();                      /* Restore the PS register */
+  return Result;                       /* OK */
+}
+
+/*
+** ===================================================================
+**     Method      :  hwExpOut_GetTxComplete (bean AsynchroSerial)
+**
+**     Description :
+**         Returns whether the transmitter is finished transmitting
+**         all data, preamble, and break characters and is idle. It
+**         can be used to determine when it is safe to switch a line
+**         driver (e.g. in RS-485 applications). This method is
+**         available only if event <OnTxComplete> is disabled.
+**     Parameters  : None
+**     Returns     :
+**         ---             - Transmission process completeness.
+** ===================================================================
+*/
+/*
+void hwExpOut_GetTxComplete(void)
+
+**      This method is implemented as a macro. See header module. **
+*/
+
 
 
 /* END hwExpOut. */
@@ -20,7 +20,7 @@
 **         Serial channel              : SCI1
 **
 **         Protocol
-**             Init baud rate          : 9600baud
+**             Init baud rate          : 115200baud
 **             Width                   : 8 bits
 **             Stop bits               : 1
 **             Parity                  : none
@@ -34,7 +34,13 @@
 **             Baud setting reg.       : SCI1BD    [0xFFFF8020]
 **             Special register        : SCI1S1    [0xFFFF8024]
 **
+**         Input interrupt
+**             Vector name             : Vsci1rx
+**             Priority                : 240
 **
+**         Output interrupt
+**             Vector name             : Vsci1tx
+**             Priority                : 240
 **
 **         Used pins:
 **         ----------------------------------------------------------
@@ -53,6 +59,8 @@
 **         SendChar        - byte hwExpOut_SendChar(hwExpOut_TComData Chr);
 **         GetCharsInRxBuf - word hwExpOut_GetCharsInRxBuf(void);
 **         GetCharsInTxBuf - word hwExpOut_GetCharsInTxBuf(void);
+**         GetRxIdle       - bool hwExpOut_GetRxIdle(void);
+**         GetTxComplete   - bool hwExpOut_GetTxComplete(void);
 **
 **     (c) Copyright UNIS, spol. s r.o. 1997-2008
 **     UNIS, spol. s r.o.
@@ -193,8 +201,7 @@ byte hwExpOut_SendChar(hwExpOut_TComData Chr);
 ** ===================================================================
 */
 
-#define hwExpOut_GetCharsInRxBuf() \
-((word) SCI1S1_RDRF)                   /* Return number of chars in receive buffer */
+word hwExpOut_GetCharsInRxBuf(void);
 /*
 ** ===================================================================
 **     Method      :  hwExpOut_GetCharsInRxBuf (bean AsynchroSerial)
@@ -226,6 +233,43 @@ word hwExpOut_GetCharsInTxBuf(void);
 ** ===================================================================
 */
 
+__interrupt void hwExpOut_InterruptRx(void);
+/*
+** ===================================================================
+**     Method      :  hwExpOut_InterruptRx (bean AsynchroSerial)
+**
+**     Description :
+**         The method services the receive interrupt of the selected 
+**         peripheral(s) and eventually invokes the bean's event(s).
+**         This method is internal. It is used by Processor Expert only.
+** ===================================================================
+*/
+
+__interrupt void hwExpOut_InterruptTx(void);
+/*
+** ===================================================================
+**     Method      :  hwExpOut_InterruptTx (bean AsynchroSerial)
+**
+**     Description :
+**         The method services the receive interrupt of the selected 
+**         peripheral(s) and eventually invokes the bean's event(s).
+**         This method is internal. It is used by Processor Expert only.
+** ===================================================================
+*/
+
+__interrupt void hwExpOut_InterruptError(void);
+/*
+** ===================================================================
+**     Method      :  hwExpOut_InterruptError (bean AsynchroSerial)
+**
+**     Description :
+**         The method services the error interrupt of the selected 
+**         peripheral(s) and eventually invokes the bean's event(s).
+**         This method is internal. It is used by Processor Expert only.
+** ===================================================================
+*/
+
+
 void hwExpOut_Init(void);
 /*
 ** ===================================================================
@@ -265,6 +309,38 @@ void hwExpOut_SetSlow(void);
 ** ===================================================================
 */
 
+#define hwExpOut_GetTxComplete()\
+  (bool) getRegBit(SCI1S1, TC)
+/*
+** ===================================================================
+**     Method      :  hwExpOut_GetTxComplete (bean AsynchroSerial)
+**
+**     Description :
+**         Returns whether the transmitter is finished transmitting
+**         all data, preamble, and break characters and is idle. It
+**         can be used to determine when it is safe to switch a line
+**         driver (e.g. in RS-485 applications). This method is
+**         available only if event <OnTxComplete> is disabled.
+**     Parameters  : None
+**     Returns     :
+**         ---             - Transmission process completeness.
+** ===================================================================
+*/
+
+bool hwExpOut_GetRxIdle(void);
+/*
+** ===================================================================
+**     Method      :  hwExpOut_GetRxIdle (bean AsynchroSerial)
+**
+**     Description :
+**         Returns the state of the receiver idle flag. This method
+**         is available only if event <OnIdle> is disabled.
+**     Parameters  : None
+**     Returns     :
+**         ---             - The state of the receiver idle flag.
+** ===================================================================
+*/
+
 
 /* END hwExpOut. */
 
@@ -0,0 +1,108 @@
+###############################################################################
+#                       Copyright (c) 2008, Jabil Circuit
+#
+# This source code and any compilation or derivative thereof is the sole
+# property of Jabil Circuit and is provided pursuant to a Software License
+# Agreement.  This code is the proprietary information of Jabil Circuit and
+# is confidential in nature.  Its use and dissemination by any party other
+# than Jabil Circuit is strictly limited by the confidential information
+# provisions of the Software License Agreement referenced above.
+#
+###############################################################################
+#
+# Project      : WaterOptimizer Irrigation System (WOIS)
+# Organization : WaterOptimizer, LLC
+# Module       : xmapRam.py
+# Description  : This host script summarizes the static RAM used by each
+#                object file, from the CodeWarrior linker map (.xMAP) file.
+#
+# Usage        : python xmapRam.py <file.xMAP> [ramStart ramSize]
+#
+#                The RAM range defaults to the userram region in WOIS-PE.lcf.
+#                Every map entry inside that range is counted, whatever its
+#                section name (.data, .sdata, .bss, .sbss, ...).  Overlapping
+#                entries (section and symbol lines for the same bytes) are
+#                only counted once.  Compare the totals with the BBU "ram"
+#                command, which reports the .data and .bss section sizes.
+#
+###############################################################################
+
+import re
+import sys
+
+RAM_START = 0x00800000                  # userram ORIGIN in WOIS-PE.lcf
+RAM_SIZE = 0x00002000                   # userram LENGTH in WOIS-PE.lcf
+
+# "  00800000 00000004 .bss    symbol	(object.obj)"
+MAP_ENTRY = re.compile(r'^\s+([0-9A-Fa-f]{8})\s+([0-9A-Fa-f]{8})\s+'
+                       r'(\.\w+)\s+(\S+)\s*\((.+)\)\s*$')
+
+
+def spanBytes(spans):
+    """Return the number of bytes covered by a list of (start, end) spans."""
+    total = 0
+    last = None
+    for start, end in sorted(spans):
+        if last is not None and start < last:
+            start = last
+        if end > start:
+            total += end - start
+        if last is None or end > last:
+            last = end
+    return total
+
+
+def main(argv):
+    if len(argv) not in (2, 4):
+        sys.stderr.write('usage: python xmapRam.py <file.xMAP> '
+                         '[ramStart ramSize]\n')
+        return 1
+
+    ramStart = RAM_START
+    ramSize = RAM_SIZE
+    if len(argv) == 4:
+        ramStart = int(argv[2], 0)
+        ramSize = int(argv[3], 0)
+    ramEnd = ramStart + ramSize
+
+    # spans[object][section] = [(start, end), ...]
+    spans = {}
+    with open(argv[1], 'r') as mapFile:
+        for line in mapFile:
+            match = MAP_ENTRY.match(line)
+            if match is None:
+                continue
+            addr = int(match.group(1), 16)
+            size = int(match.group(2), 16)
+            if size == 0 or addr < ramStart or (addr + size) > ramEnd:
+                continue
+            obj = match.group(5).strip()
+            section = match.group(3)
+            spans.setdefault(obj, {}).setdefault(section, []).append(
+                (addr, addr + size))
+
+    sections = sorted(set(s for obj in spans.values() for s in obj))
+    rows = []
+    for obj, objSpans in spans.items():
+        sizes = [spanBytes(objSpans.get(s, [])) for s in sections]
+        rows.append((sum(sizes), obj, sizes))
+    rows.sort(key=lambda row: (-row[0], row[1]))
+
+    width = max([len('object')] + [len(row[1]) for row in rows])
+    print('%-*s %s %7s' % (width, 'object',
+                          ' '.join('%7s' % s for s in sections), 'total'))
+    for total, obj, sizes in rows:
+        print('%-*s %s %7d' % (width, obj,
+                              ' '.join('%7d' % n for n in sizes), total))
+
+    grand = sum(row[0] for row in rows)
+    print('%-*s %s %7d' % (width, 'TOTAL',
+                          ' '.join('%7d' % sum(row[2][i] for row in rows)
+                                   for i in range(len(sections))), grand))
+    print('%d of %d bytes of RAM (%d%%), not counting heap and stack'
+          % (grand, ramSize, (grand * 100) // ramSize))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -28,6 +28,7 @@
 	/* imported data */
 
 extern unsigned long far _SP_INIT, _SDA_BASE;
+extern unsigned long far __SP_END;
 extern unsigned long far _START_BSS, _END_BSS;
 extern unsigned long far _START_SBSS, _END_SBSS;
 extern unsigned long far __DATA_RAM, __DATA_ROM, __DATA_END;
@@ -212,6 +213,16 @@ asm __declspec(register_abi) void _startup(void)
 	/* setup A5 */
     lea           _SDA_BASE,a5
 
+	/* paint the unused stack with a known pattern (see drvSysRamGet) */
+    lea           __SP_END, a0
+    move.l        #0xA5A5A5A5, d0
+__paint_stack__:
+    cmpa.l        a7, a0
+    bcc           __skip_paint__
+    move.l        d0, (a0)+
+    bra           __paint_stack__
+__skip_paint__:
+
 
 	/* zero initialize the .bss section */
 
@@ -36,6 +36,7 @@
 #include "global.h"
 #include "drvKeypad.h"
 #include "drvMoist.h"
+#include "drvExpBus.h"
 #include "drvRadio.h"
 #include "drvRtc.h"
 #include "drvSolenoid.h"
@@ -142,6 +143,45 @@ void  hwExpIn_OnRxChar(void)
   drvRadioOnRxChar();
 }
 
+/*
+** ===================================================================
+**     Event       :  hwExpOut_OnTxChar (module Events)
+**
+**     From bean   :  hwExpOut [AsynchroSerial]
+**     Description :
+**         This event is called after a character is transmitted.
+**     Parameters  : None
+**     Returns     : Nothing
+** ===================================================================
+*/
+void  hwExpOut_OnTxChar(void)
+{
+  /* Write your code here ... */
+  drvExpBusOnTxChar();
+}
+
+/*
+** ===================================================================
+**     Event       :  hwExpOut_OnRxChar (module Events)
+**
+**     From bean   :  hwExpOut [AsynchroSerial]
+**     Description :
+**         This event is called after a correct character is
+**         received.
+**         The event is available only when the <Interrupt
+**         service/event> property is enabled and either the
+**         <Receiver> property is enabled or the <SCI output mode>
+**         property (if supported) is set to Single-wire mode.
+**     Parameters  : None
+**     Returns     : Nothing
+** ===================================================================
+*/
+void  hwExpOut_OnRxChar(void)
+{
+  /* Write your code here ... */
+  drvExpBusOnRxChar();
+}
+
 /* END Events */
 
 /*
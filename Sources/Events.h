@@ -16,6 +16,8 @@
 **         hwRtc_OnInterrupt         - void hwRtc_OnInterrupt(void);
 **         hwExpIn_OnRxChar          - void hwExpIn_OnRxChar(void);
 **         hwExpIn_OnTxChar          - void hwExpIn_OnTxChar(void);
+**         hwExpOut_OnRxChar         - void hwExpOut_OnRxChar(void);
+**         hwExpOut_OnTxChar         - void hwExpOut_OnTxChar(void);
 **
 **     (c) Copyright UNIS, spol. s r.o. 1997-2006
 **     UNIS, spol. s r.o.
@@ -155,6 +157,37 @@ void hwExpIn_OnTxChar(void);
 ** ===================================================================
 */
 
+void hwExpOut_OnRxChar(void);
+/*
+** ===================================================================
+**     Event       :  hwExpOut_OnRxChar (module Events)
+**
+**     From bean   :  hwExpOut [AsynchroSerial]
+**     Description :
+**         This event is called after a correct character is
+**         received.
+**         The event is available only when the <Interrupt
+**         service/event> property is enabled and either the
+**         <Receiver> property is enabled or the <SCI output mode>
+**         property (if supported) is set to Single-wire mode.
+**     Parameters  : None
+**     Returns     : Nothing
+** ===================================================================
+*/
+
+void hwExpOut_OnTxChar(void);
+/*
+** ===================================================================
+**     Event       :  hwExpOut_OnTxChar (module Events)
+**
+**     From bean   :  hwExpOut [AsynchroSerial]
+**     Description :
+**         This event is called after a character is transmitted.
+**     Parameters  : None
+**     Returns     : Nothing
+** ===================================================================
+*/
+
 
 /* END Events */
 #endif /* __Events_H*/
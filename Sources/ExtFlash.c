@@ -100,7 +100,8 @@ bool_t extFlashBufferRead(uint32_t offset, void *pBuf, uint32_t len)
  * extFlashFWErase
  *
  * PURPOSE
- *      This routine erases 2 sectors of the flash for a new FW version
+ *      This routine erases the FW_NEW_SECTORS sectors of the flash used
+ *      for a new FW version (info sector and code)
  *
  * PARAMETERS
  *      offset  IN  offset of sector want to start sector erase
@@ -113,7 +114,7 @@ bool_t extFlashFWErase(uint32_t offset)
 {
     uint8_t i;
     
-    for(i=0; i<4; i++)
+    for(i=0; i<FW_NEW_SECTORS; i++)
     {
       while(drvExtFlashBusy())
       {
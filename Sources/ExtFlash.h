@@ -38,6 +38,12 @@
 #define FW_NEW_CODE_SPI_ADDR          0x10000    // spi flash address for a firmware version
 #define FW_FACTORY_INFO_SPI_ADDR      0x40000    // spi flash address for factory info
 #define FW_FACTORY_CODE_SPI_ADDR      0x50000    // spi flash address for factory version
+#define EVENT_JOURNAL_SPI_ADDR        0x70000    // spi flash address for system event journal
+#define EVENT_JOURNAL_B_SPI_ADDR      0x30000    // spi flash address for second event journal sector
+
+//sectors erased for a new firmware version (info + code, ends below EVENT_JOURNAL_B_SPI_ADDR)
+#define FW_NEW_SECTORS  ((FW_NEW_CODE_SPI_ADDR - FW_NEW_INFO_SPI_ADDR + MAX_FW_IMAGE_SIZE + \
+                          EXT_FLASH_SEC_SIZE - 1) / EXT_FLASH_SEC_SIZE)
 
 /*
  * Application Interface
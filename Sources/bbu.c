@@ -36,6 +36,7 @@
 #include "crc.h"
 #include "drvAlarm.h"
 #include "drvEeprom.h"
+#include "drvExpBus.h"
 #include "drvExtFlash.h"
 #include "drvKeypad.h"
 #include "drvLcd.h"
@@ -44,8 +45,8 @@
 #include "drvSolenoid.h"
 #include "drvSys.h"
 #include "hwCpu.h"
-#include "hwExpOut.h"
 #include "hwI2c.h"
+#include "radio.h"
 
 #include "bbu.h"
 
@@ -78,6 +79,9 @@ static int bbuCmdMemoryFill(void);
 static int bbuCmdMemoryRead(void);
 static int bbuCmdMemoryWrite(void);
 static int bbuCmdPowerStatus(void);
+static int bbuCmdRam(void);
+static int bbuCmdReplay(void);
+static int bbuCmdRadioStat(void);
 static int bbuCmdSensorDump(void);
 static int bbuCmdSensorPower(void);
 static int bbuCmdSensorRead(void);
@@ -287,6 +291,36 @@ static const bbuCmdEnt_t bbuCmds[] =
         "Display power status (12VDC and 24VAC).",
         ""
     },
+    {
+        "ram",
+        bbuCmdRam,
+        "",
+        "Display RAM usage.",
+        "Reports static data, heap and stack sizes and the deepest stack use\n"
+        "since reset (stack high-water mark)."
+    },
+    {
+        "rply",
+        bbuCmdReplay,
+        "model|'all' [count ['base']]",
+        "Run the radio packet replay benchmark.",
+        "Generated radio frames are fed through the radio receive path and\n"
+        "handled; responses are discarded.  Valid 'model' values are:\n"
+        "  noop, exstat, getlcd, cfgget, txstat, mix\n"
+        "'count' is the number of frames to replay (default 200).\n"
+        "'base' saves the results as the baseline that later runs are\n"
+        "compared against.  Run on a quiet radio network."
+    },
+    {
+        "rsta",
+        bbuCmdRadioStat,
+        "['reset']",
+        "Display radio protocol statistics.",
+        "For each WOIS command and transfer data type received since reset:\n"
+        "messages received, acked, nacked (rejected) and duplicated, acks\n"
+        "that failed to transmit, and average and longest processing time\n"
+        "in ms.  'reset' clears the statistics after they are displayed."
+    },
     {
         "send",
         bbuCmdSensorDump,
@@ -361,6 +395,7 @@ static const bbuCmdEnt_t bbuCmds[] =
 static char bbuCmdBuf[82];
 static char bbuCmdLast[82];
 static char bbuOutBuf[160];             /* also used for LCD test */
+static uint32_t bbuReplayBase[RADIO_REPLAY_N];  /* baseline us/frame, 0=none */
 
 static bool bbuExit = FALSE;
 static uint8_t bbuSensorZone = 0;
@@ -878,12 +913,12 @@ static int bbuCmdKeypad(void)
     do
     {
         uint8_t key = drvKeypadGet();
-        hwExpOut_TComData ch;
+        uint8_t ch;
 
         switch (key & DRV_KEYPAD_TYPE_MASK)
         {
             case DRV_KEYPAD_TYPE_NONE:
-                if (hwExpOut_RecvChar(&ch) == ERR_OK)
+                if (drvExpBusConsoleGetc(&ch))
                 {
                     isDone = TRUE;
                 }
@@ -1534,6 +1569,186 @@ static int bbuCmdPowerStatus(void)
 }
 
 
+static int bbuCmdRam(void)
+{
+    drvSysRam_t ram;
+
+    drvSysRamGet(&ram);
+    sprintf(bbuOutBuf,
+            "data   = %u\nbss    = %u\nheap   = %u\nstack  = %u (used %u, free %u)\n",
+            ram.data,
+            ram.bss,
+            ram.heap,
+            ram.stack,
+            ram.stackUsed,
+            ram.stack - ram.stackUsed);
+    bbuPuts(bbuOutBuf);
+
+    return 0;
+}
+
+
+static int bbuCmdReplay(void)
+{
+    char *pToken;
+    char *pEnd;
+    int first;
+    int last;
+    int model;
+    long count = 200;
+    bool_t setBase = FALSE;
+    uint32_t usPerFrame;
+    radioReplayResult_t result;
+
+    /* get traffic model name, or 'all' */
+    pToken = strtok(NULL, " \t");
+    if (pToken == NULL)
+    {
+        return 1;
+    }
+    if (strcmp(pToken, "all") == 0)
+    {
+        first = 0;
+        last = RADIO_REPLAY_N - 1;
+    }
+    else
+    {
+        for (first = 0; first < RADIO_REPLAY_N; first++)
+        {
+            if (strcmp(pToken, radioReplayName[first]) == 0)
+            {
+                break;
+            }
+        }
+        if (first >= RADIO_REPLAY_N)
+        {
+            return 1;
+        }
+        last = first;
+    }
+
+    /* get optional frame count and baseline flag */
+    pToken = strtok(NULL, " \t");
+    if (pToken != NULL)
+    {
+        count = strtol(pToken, &pEnd, 0);
+        if (*pEnd != '\0' || count < 1 || count > 0xFFFF)
+        {
+            return 1;
+        }
+        pToken = strtok(NULL, " \t");
+        if (pToken != NULL)
+        {
+            if (strcmp(pToken, "base") != 0)
+            {
+                return 1;
+            }
+            setBase = TRUE;
+        }
+    }
+
+    for (model = first; model <= last; model++)
+    {
+        if (!radioReplayRun((uint8_t)model, (uint16_t)count, &result))
+        {
+            sprintf(bbuOutBuf, "%-7s FAILED\n", radioReplayName[model]);
+            bbuPuts(bbuOutBuf);
+            continue;
+        }
+        usPerFrame = (result.handled != 0) ?
+                     (result.ms * 1000) / result.handled : 0;
+        sprintf(bbuOutBuf,
+                "%-7s frames=%u handled=%u tx=%u ms=%lu us/frame=%lu",
+                radioReplayName[model],
+                result.frames,
+                result.handled,
+                result.txFrames,
+                (unsigned long)result.ms,
+                (unsigned long)usPerFrame);
+        bbuPuts(bbuOutBuf);
+
+        if (setBase)
+        {
+            bbuReplayBase[model] = usPerFrame;
+        }
+        else if (bbuReplayBase[model] != 0)
+        {
+            sprintf(bbuOutBuf, " base=%lu (%+d%%)%s",
+                    (unsigned long)bbuReplayBase[model],
+                    (((int)usPerFrame - (int)bbuReplayBase[model]) * 100) /
+                        (int)bbuReplayBase[model],
+                    (usPerFrame > bbuReplayBase[model] +
+                                  bbuReplayBase[model] / 10) ?
+                        " REGRESSION" : "");
+            bbuPuts(bbuOutBuf);
+        }
+        bbuPuts("\n");
+    }
+
+    return 0;
+}
+
+
+static int bbuCmdRadioStat(void)
+{
+    char *pToken;
+    bool_t reset = FALSE;
+    radioProtoStat_t *pStat;
+    uint16_t nDone;
+    int i;
+
+    pToken = strtok(NULL, " \t");
+    if (pToken != NULL)
+    {
+        if (strcmp(pToken, "reset") != 0)
+        {
+            return 1;
+        }
+        reset = TRUE;
+    }
+
+    bbuPuts("msg       rx   ack  nack   dup txfail avgms maxms\n");
+    for (i = 0; i < RADIO_PSTAT_N; i++)
+    {
+        pStat = &radioProtoStat[i];
+        if (pStat->type == RADIO_PSTAT_FREE)
+        {
+            break;
+        }
+        nDone = pStat->ack + pStat->nack;
+        if (pStat->type == RADIO_PSTAT_CMD)
+        {
+            sprintf(bbuOutBuf, "cmd  %02X", pStat->code);
+        }
+        else if (pStat->type == RADIO_PSTAT_XFER)
+        {
+            sprintf(bbuOutBuf, "xfer %02X", pStat->code);
+        }
+        else
+        {
+            sprintf(bbuOutBuf, "other  ");
+        }
+        bbuPuts(bbuOutBuf);
+        sprintf(bbuOutBuf, " %5u %5u %5u %5u %6u %5u %5u\n",
+                pStat->rx,
+                pStat->ack,
+                pStat->nack,
+                pStat->dup,
+                pStat->txFail,
+                (nDone == 0) ? 0 : (unsigned int)(pStat->totalMs / nDone),
+                pStat->maxMs);
+        bbuPuts(bbuOutBuf);
+    }
+
+    if (reset)
+    {
+        radioProtoStatReset();
+    }
+
+    return 0;
+}
+
+
 static int bbuCmdSensorDump(void)
 {
     for (int zone = 1; zone <= SYS_N_UNIT_ZONES; zone++)
@@ -1798,7 +2013,7 @@ static char *bbuGets(void)
     {
         char ch;
 
-        while (hwExpOut_RecvChar((hwExpOut_TComData *)&ch) != ERR_OK)
+        while (!drvExpBusConsoleGetc((uint8_t *)&ch))
         {
             drvSysWatchDogClear();
         }
@@ -1845,11 +2060,16 @@ static char *bbuGets(void)
 
 static void bbuPutc(char ch)
 {
+    /* The port carries expansion bus frames while the bus is enabled. */
+    if (drvExpBusIsEnabled())
+    {
+        return;
+    }
     if (ch == '\n')
     {
         bbuPutc('\r');
     }
-    while (hwExpOut_SendChar(ch) != ERR_OK)
+    while (!drvExpBusConsolePutc((uint8_t)ch))
     {
         drvSysWatchDogClear();
     }
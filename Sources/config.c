@@ -40,6 +40,26 @@
 #define CONFIG_EVENT_EVT_SAVED  SYS_EVENT_CONFIG + 3    /* Event trace saved */
 #define CONFIG_EVENT_DL_APPLY   SYS_EVENT_CONFIG + 4    /* Cfg Dld applied */
 #define CONFIG_EVENT_DL_APP_F   SYS_EVENT_CONFIG + 5    /* Cfg Dld apply fail*/
+#define CONFIG_EVENT_COMMIT     SYS_EVENT_CONFIG + 6    /* Cfg image committed */
+
+/* EEPROM offset of config image 1 or 2 */
+#define CONFIG_SLOT_OFFSET(s)   (((s) == 1) ? CONFIG_IMAGE1 : CONFIG_IMAGE2)
+
+/*
+**  Config Image Field Range Limit
+**
+**  Shared by configImageContentValidate() and the download streaming
+**  validator (configStreamByte), so each field range is defined once.
+**  Multi-byte fields are in network (big-endian) byte order.
+*/
+typedef struct
+{
+    uint16_t offset;        /* field offset within its structure */
+    uint8_t size;           /* element size in bytes (1 or 2) */
+    uint8_t count;          /* number of elements (array fields) */
+    uint16_t min;           /* minimum valid value */
+    uint16_t max;           /* maximum valid value */
+} configFieldLimit_t;
 
 
 
@@ -66,10 +86,70 @@ configImage_t config;                           /* Config Image in RAM */
 */
 static uint32_t configDirtyTime;                /* dirty-detect tick count */
 static uint32_t configNextWriteOffset;          /* next EEPROM write offset */
+static uint32_t configVerifyOffset;             /* next EEPROM verify offset */
+static uint16_t configVerifyCrc;                /* background verify CRC */
 static uint8_t configImageStatus1;              /* Config Image 1 Status */
 static uint8_t configImageStatus2;              /* Config Image 2 Status */
+static uint8_t configActiveSlot = 1;            /* committed image (1 or 2) */
+static uint32_t configCommitSeq;                /* last commit sequence no. */
+static bool_t configCommitNow = FALSE;          /* commit without lazy delay */
 uint8_t configState = CONFIG_STATE_RESTART;     /* Config Manager State */
 static bool_t configRzwwsChanged;               /* RZWWS changed flag */
+static bool_t configSnapshotIsValid = FALSE;    /* snapshot matches checksum */
+static uint16_t configSnapshotCheckSum;         /* checksum of snapshot */
+
+/*
+**  Download Buffer Streaming Validation State
+*/
+static bool_t configStreamIsValid = FALSE;      /* stream written in order */
+static uint32_t configStreamOffset;             /* next expected offset */
+static uint16_t configStreamCrc;                /* CRC accumulator */
+static uint16_t configStreamCheckSum;           /* checksum from header */
+static int16_t configStreamError = -1;          /* first bad field offset */
+static uint8_t configStreamPrev;                /* previous byte */
+static uint8_t configStreamNumZones;            /* numZones from image */
+static uint8_t configStreamMinMoist;            /* current zone minMoist */
+static uint8_t configStreamMaxMoist;            /* current zone maxMoist */
+static int8_t configStreamGroup[SYS_N_ZONES];   /* zone groups from image */
+
+static void configStreamByte(uint32_t offset, uint8_t value);
+
+/*
+**  System and Zone Configuration Field Range Limits
+**
+**  Fields with cross-field or special-value rules (version, number of zones,
+**  PAN ID, pad bytes, moisture limits, plant type, sensor group) are checked
+**  by the validators themselves.
+*/
+static const configFieldLimit_t configSysLimits[] =
+{
+    { woffsetof(configSys_t, opMode), 1, 1, 0, CONFIG_OPMODE_LIMIT - 1 },
+    { woffsetof(configSys_t, pulseMode), 1, 1, 0, CONFIG_PULSEMODE_LIMIT - 1 },
+    { woffsetof(configSys_t, timeFmt), 1, 1, 0, CONFIG_TIMEFMT_LIMIT - 1 },
+};
+
+static const configFieldLimit_t configZoneLimits[] =
+{
+    { woffsetof(configZone_t, runTime), 1, SYS_N_PROGRAMS, 0, CONFIG_RUNTIME_MAX },
+    { woffsetof(configZone_t, appRate), 2, 1, CONFIG_APPRATE_MIN, CONFIG_APPRATE_MAX },
+    { woffsetof(configZone_t, soilType), 1, 1, 0, CONFIG_SOILTYPE_LIMIT - 1 },
+    { woffsetof(configZone_t, slope), 1, 1, 0, CONFIG_SLOPE_LIMIT - 1 },
+    { woffsetof(configZone_t, minMoist), 1, 1, CONFIG_MOIST_MIN, CONFIG_MOIST_MAX - 1 },
+    { woffsetof(configZone_t, climate), 1, 1, 0, CONFIG_CLIMATE_LIMIT - 1 },
+    { woffsetof(configZone_t, appEff), 1, 1, CONFIG_APPEFF_MIN, CONFIG_APPEFF_MAX },
+    { woffsetof(configZone_t, rzwws), 2, 1, CONFIG_RZWWS_MIN, CONFIG_RZWWS_MAX },
+};
+
+#define CONFIG_SYS_N_LIMITS     (sizeof(configSysLimits) / sizeof(configSysLimits[0]))
+#define CONFIG_ZONE_N_LIMITS    (sizeof(configZoneLimits) / sizeof(configZoneLimits[0]))
+
+static int16_t configFieldsValidate(const configFieldLimit_t *pTable,
+                                    uint8_t nLimits,
+                                    const uint8_t *pData);
+static const configFieldLimit_t *configFieldLimitFind(const configFieldLimit_t *pTable,
+                                                      uint8_t nLimits,
+                                                      uint16_t last,
+                                                      uint16_t *pStart);
 
 /*
 **  Default RZWWS values based on the plant type
@@ -103,9 +183,16 @@ static const uint16_t configPlantTypeRzwws[] =
  * NOTES
  *      This routine must be called at system initialization.
  *
+ *      To keep start-up fast, only the committed image is read here; it is
+ *      checked while being loaded into RAM.  The other image is verified
+ *      later by configPoll, a block at a time, in the background.
+ *
  *****************************************************************************/
 void configInit(void)
 {
+    uint8_t *pActive;                   /* active image status */
+    uint8_t *pInactive;                 /* inactive image status */
+
     /* Verify manufacturing data and load the WOIS serial number. */
     if (!configManufInit())
     {
@@ -113,28 +200,47 @@ void configInit(void)
         sysFaultSet(SYS_FAULT_MANUFDATA);
     }
 
-    /* Verify configuration image copies stored in EEPROM. */
-    configImageVerify();
+    /* Find which configuration image was last committed. */
+    configCommitInit();
+
+    pActive = (configActiveSlot == 1) ? &configImageStatus1 : &configImageStatus2;
+    pInactive = (configActiveSlot == 1) ? &configImageStatus2 : &configImageStatus1;
 
     /* Load configuration image working copy into RAM. */
-    if (configImageStatus1 != CONFIG_IMAGE_CORRUPT)
-    {
-        /* Load configuration image 1 into memory */
-        drvEepromRead(CONFIG_IMAGE1, &config, CONFIG_IMAGE_SIZE);
-    }
-    else if (configImageStatus2 != CONFIG_IMAGE_CORRUPT)
+    if (configImageLoad(CONFIG_SLOT_OFFSET(configActiveSlot)))
     {
-        /* Load configuration image 2 into memory */
-        drvEepromRead(CONFIG_IMAGE2, &config, CONFIG_IMAGE_SIZE);
+        /* Committed image loaded; verify the other one in the background. */
+        *pActive = CONFIG_IMAGE_VALID;
+        *pInactive = CONFIG_IMAGE_UNKNOWN;
+        configVerifyOffset = 0;
+        configState = CONFIG_STATE_VERIFYING;
     }
     else
     {
-        /* Load factory default configuration image into RAM. */
-        configDefaultLoad();
-    }
+        *pActive = CONFIG_IMAGE_CORRUPT;
 
-    /* Set configuration state to Clean. */
-    configState = CONFIG_STATE_CLEAN;
+        /* Trace corrupt image detected event. */
+        sysEvent(CONFIG_EVENT_CORRUPT, configActiveSlot);
+
+        if (configImageLoad(CONFIG_SLOT_OFFSET((configActiveSlot == 1) ? 2 : 1)))
+        {
+            /* Fall back to the other image (it is committed by configPoll). */
+            *pInactive = CONFIG_IMAGE_VALID;
+        }
+        else
+        {
+            *pInactive = CONFIG_IMAGE_CORRUPT;
+
+            /* Trace corrupt image detected event. */
+            sysEvent(CONFIG_EVENT_CORRUPT, (configActiveSlot == 1) ? 2 : 1);
+
+            /* Load factory default configuration image into RAM. */
+            configDefaultLoad();
+        }
+
+        /* Set configuration state to Clean. */
+        configState = CONFIG_STATE_CLEAN;
+    }
 
     /* Clear plant type changed flag. */
     configRzwwsChanged = FALSE;
@@ -163,6 +269,14 @@ void configInit(void)
  *      This routine keeps the two copies of non-volatile configuration image
  *      in the EEPROM up-to-date and in sync with each other.
  *
+ *      Changes are only ever written to the inactive image.  Once it has
+ *      been completely written it is made the active image by a single
+ *      commit record write (see configCommitWrite), and then the other
+ *      image is brought up-to-date as a backup.  A power failure part way
+ *      through a write therefore always leaves the last committed image
+ *      intact, and a new configuration can be sent to expansion units as
+ *      soon as one image has been committed.
+ *
  *      The Configuration Manager uses a finite state machine to control
  *      the sequence of configuration data store management operations.
  *
@@ -186,6 +300,9 @@ void configPoll(void)
 {
     bool_t isModified = FALSE;
     uint16_t newChecksum;
+    uint8_t inactive;                   /* inactive image (1 or 2) */
+    uint8_t *pActive;                   /* active image status */
+    uint8_t *pInactive;                 /* inactive image status */
 
     /* set navigation zones based on unit type */
     if(config.sys.unitType == UNIT_TYPE_MASTER)
@@ -206,6 +323,9 @@ void configPoll(void)
 
         /* Schedule re-write of both EEPROM configuration images. */
         configImageSyncNeeded();
+
+        /* Settings shown on the LCD may have changed. */
+        uiNotify(UI_DEP_CONFIG);
         
 
     }
@@ -223,6 +343,10 @@ void configPoll(void)
         }
     }
 
+    inactive = (configActiveSlot == 1) ? 2 : 1;
+    pActive = (configActiveSlot == 1) ? &configImageStatus1 : &configImageStatus2;
+    pInactive = (configActiveSlot == 1) ? &configImageStatus2 : &configImageStatus1;
+
     switch (configState)
     {
         case CONFIG_STATE_RESTART:
@@ -231,6 +355,15 @@ void configPoll(void)
             configState = CONFIG_STATE_CLEAN;
             break;
 
+        case CONFIG_STATE_VERIFYING:
+            /* Verify the image not loaded at start-up, a block at a time. */
+            configVerifyNextBlock();
+            if (configVerifyOffset >= CONFIG_IMAGE_SIZE)
+            {
+                configState = CONFIG_STATE_CLEAN;
+            }
+            break;
+
         case CONFIG_STATE_CLEAN:
             /* Check for corrupt images needing rewrite. */
             if ((configImageStatus1 != CONFIG_IMAGE_VALID) ||
@@ -242,62 +375,35 @@ void configPoll(void)
             break;
 
         case CONFIG_STATE_DIRTY:
-            /* First priority is fixing any corrupt configuration images. */
-            if (configImageStatus1 == CONFIG_IMAGE_CORRUPT)
+            if ((*pActive == CONFIG_IMAGE_VALID) &&
+                (*pInactive == CONFIG_IMAGE_VALID))
             {
-                /* Begin corruption-fix re-sync for image 1. */
-                configState = CONFIG_STATE_WRITING1;
-                configNextWriteOffset = 0;
+                /* All images are in-sync, set state to Clean. */
+                configState = CONFIG_STATE_CLEAN;
             }
-            else if (configImageStatus2 == CONFIG_IMAGE_CORRUPT)
+            else if ((*pActive != CONFIG_IMAGE_VALID) &&
+                     (*pInactive == CONFIG_IMAGE_VALID))
             {
-                /* Begin corruption-fix re-sync for image 2. */
-                configState = CONFIG_STATE_WRITING2;
-                configNextWriteOffset = 0;
+                /* Inactive image holds the working copy, so commit it. */
+                configCommitWrite(inactive);
             }
-            else if (dtElapsedSeconds(configDirtyTime) > CONFIG_LAZY_WRITE_SECS)
+            else if ((configImageStatus1 == CONFIG_IMAGE_CORRUPT) ||
+                     (configImageStatus2 == CONFIG_IMAGE_CORRUPT) ||
+                     configCommitNow ||
+                     (dtElapsedSeconds(configDirtyTime) > CONFIG_LAZY_WRITE_SECS))
             {
-                /* Begin lazy write re-sync, starting with image 1. */
-                configState = CONFIG_STATE_WRITING1;
+                /*
+                **  Corrupt images are fixed and downloaded configurations
+                **  are committed at once, other changes are lazy written.
+                **  Either way, the inactive image is the one rewritten.
+                */
+                configState = (inactive == 1) ? CONFIG_STATE_WRITING1 :
+                                                CONFIG_STATE_WRITING2;
                 configNextWriteOffset = 0;
             }
             break;
 
         case CONFIG_STATE_WRITING1:
-            if (isModified)
-            {
-                /* Another change was made, so start over. */
-                configNextWriteOffset = 0;
-            }
-            if (configNextWriteOffset < CONFIG_IMAGE_SIZE)
-            {
-                configWriteNextBlock(CONFIG_IMAGE1);
-            }
-            else
-            {
-                /* Mark image 1 as now being in-sync. */
-                configImageStatus1 = CONFIG_IMAGE_VALID;
-                /* Check if image 2 needs updating. */
-                if (configImageStatus2 == CONFIG_IMAGE_VALID)
-                {
-                    /* All images are in-sync, set state to Clean. */
-                    configState = CONFIG_STATE_CLEAN;
-                    
-                    /* if master then send new config to expansion units */
-                    if(config.sys.unitType == UNIT_TYPE_MASTER) 
-                    {
-                       expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, RADIO_EXP_SEND_ALL);     
-                    }
-                }
-                else
-                {
-                    /* Update image 2. */
-                    configState = CONFIG_STATE_WRITING2;
-                    configNextWriteOffset = 0;
-                }
-            }
-            break;
-
         case CONFIG_STATE_WRITING2:
             if (isModified)
             {
@@ -306,30 +412,19 @@ void configPoll(void)
             }
             if (configNextWriteOffset < CONFIG_IMAGE_SIZE)
             {
-                configWriteNextBlock(CONFIG_IMAGE2);
+                configWriteNextBlock(CONFIG_SLOT_OFFSET(inactive));
             }
             else
             {
-                /* Mark image 2 as now being in-sync. */
-                configImageStatus2 = CONFIG_IMAGE_VALID;
-                /* Check if image 1 needs updating. */
-                if (configImageStatus1 == CONFIG_IMAGE_VALID)
+                /* Mark inactive image as now being in-sync. */
+                *pInactive = CONFIG_IMAGE_VALID;
+                /* Commit it if the active image is out-of-date. */
+                if (*pActive != CONFIG_IMAGE_VALID)
                 {
-                    /* All images are in-sync, set state to Clean. */
-                    configState = CONFIG_STATE_CLEAN;
-                    
-                    /* if master then send new config to expansion units */
-                    if(config.sys.unitType == UNIT_TYPE_MASTER) 
-                    {
-                       expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, RADIO_EXP_SEND_ALL);     
-                    }
-                }
-                else
-                {
-                    /* Update image 1. */
-                    configState = CONFIG_STATE_WRITING1;
-                    configNextWriteOffset = 0;
+                    configCommitWrite(inactive);
                 }
+                /* Update the other image, if needed. */
+                configState = CONFIG_STATE_DIRTY;
             }
             break;
 
@@ -451,6 +546,8 @@ void configDefaultLoad(void)
 #endif
 
     config.sys.unitType = UNIT_TYPE_MASTER;
+    config.sys.expBusWired = 0;
+    config.sys.solInrush = 0;
     config.sys.numUnits = 0;
     config.sys.masterMac = 0x0013A20000000000;
     config.sys.expMac1 = 0x0013A20000000000;
@@ -840,6 +937,229 @@ bool_t configImageChecksumIsValid(uint32_t imageOffset, uint16_t *checksum)
 }
 
 
+/******************************************************************************
+ *
+ * configImageLoad
+ *
+ * PURPOSE
+ *      This routine loads a config image from EEPROM into the RAM working
+ *      copy, verifying its integrity in the same pass.
+ *
+ * PARAMETERS
+ *      imageOffset IN  offset to start of config image in EEPROM
+ *
+ * RETURN VALUE
+ *      This routine returns TRUE if the configuration image has the correct
+ *      config version and a valid checksum.
+ *
+ * NOTES
+ *      The image is read a block at a time directly into the working copy
+ *      and the CRC is accumulated over each block as it arrives, so the
+ *      EEPROM is only read once.  If FALSE is returned, the working copy
+ *      holds an invalid image and must be reloaded by the caller.
+ *
+ *****************************************************************************/
+bool_t configImageLoad(uint32_t imageOffset)
+{
+    uint8_t *pData = (uint8_t *)&config;
+    uint16_t crc = CRC_INIT_VALUE;      /* CRC accumulator */
+    uint32_t nextIndex;                 /* next offset within image to read */
+    uint32_t nBytes;                    /* next number of bytes to read */
+    uint32_t i;                         /* index */
+
+    for (nextIndex = 0; nextIndex < CONFIG_IMAGE_SIZE; nextIndex += nBytes)
+    {
+        nBytes = CONFIG_IMAGE_SIZE - nextIndex;
+        if (nBytes > CONFIG_BLOCK_SIZE)
+        {
+            nBytes = CONFIG_BLOCK_SIZE;
+        }
+
+        drvEepromRead(imageOffset + nextIndex, &pData[nextIndex], nBytes);
+
+        /* The CRC does not cover the 4-byte version and checksum header. */
+        for (i = (nextIndex == 0) ? 4 : 0; i < nBytes; i++)
+        {
+            crcByte(pData[nextIndex + i], &crc);
+        }
+
+        /* Make sure watchdog doesn't timeout during this long operation. */
+        sysExecutionExtend();
+    }
+
+    return (ntohs(config.sys.version) == CONFIG_VERSION) &&
+           (ntohs(config.sys.checkSum) == crc);
+}
+
+
+/******************************************************************************
+ *
+ * configVerifyNextBlock
+ *
+ * PURPOSE
+ *      This routine verifies the next block of the inactive config image in
+ *      EEPROM, as a background task following a fast start-up.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      configVerifyOffset must be set to 0 before the first call.  When the
+ *      last block has been checked, the inactive image status is set to
+ *      valid, out-of-date or corrupt, just as configImageVerify would.
+ *
+ *****************************************************************************/
+void configVerifyNextBlock(void)
+{
+    uint32_t imageOffset = CONFIG_SLOT_OFFSET((configActiveSlot == 1) ? 2 : 1);
+    uint8_t *pStatus = (configActiveSlot == 1) ? &configImageStatus2 : &configImageStatus1;
+    uint8_t data[CONFIG_BLOCK_SIZE];    /* read buffer */
+    uint16_t header[2];                 /* image version and checksum */
+    uint32_t nBytes;
+    uint32_t i;
+
+    if (configVerifyOffset == 0)
+    {
+        configVerifyCrc = CRC_INIT_VALUE;
+        configVerifyOffset = 4;
+    }
+
+    nBytes = CONFIG_IMAGE_SIZE - configVerifyOffset;
+    if (nBytes > CONFIG_BLOCK_SIZE)
+    {
+        nBytes = CONFIG_BLOCK_SIZE;
+    }
+
+    drvEepromRead(imageOffset + configVerifyOffset, data, nBytes);
+    for (i = 0; i < nBytes; i++)
+    {
+        crcByte(data[i], &configVerifyCrc);
+    }
+    configVerifyOffset += nBytes;
+
+    if (configVerifyOffset >= CONFIG_IMAGE_SIZE)
+    {
+        drvEepromRead(imageOffset, header, sizeof(header));
+        if ((ntohs(header[0]) != CONFIG_VERSION) ||
+            (ntohs(header[1]) != configVerifyCrc))
+        {
+            *pStatus = CONFIG_IMAGE_CORRUPT;
+
+            /* Trace corrupt image detected event. */
+            sysEvent(CONFIG_EVENT_CORRUPT, (configActiveSlot == 1) ? 2 : 1);
+        }
+        else if (configVerifyCrc == ntohs(config.sys.checkSum))
+        {
+            /* Configuration is valid and matches the copy in RAM. */
+            *pStatus = CONFIG_IMAGE_VALID;
+        }
+        else
+        {
+            /* Configuration is valid but out of date. */
+            *pStatus = CONFIG_IMAGE_OLD;
+        }
+    }
+}
+
+
+/******************************************************************************
+ *
+ * configFieldsValidate
+ *
+ * PURPOSE
+ *      This routine checks the fields of a system or zone configuration
+ *      structure against a field range limit table.
+ *
+ * PARAMETERS
+ *      pTable      IN  field range limit table
+ *      nLimits     IN  number of entries in the table
+ *      pData       IN  structure data, as stored in the config image
+ *
+ * RETURN VALUE
+ *      This routine returns -1 if all fields are within their limits;
+ *      otherwise, the offset of the first invalid field element within the
+ *      structure is returned.
+ *
+ *****************************************************************************/
+static int16_t configFieldsValidate(const configFieldLimit_t *pTable,
+                                    uint8_t nLimits,
+                                    const uint8_t *pData)
+{
+    const uint8_t *pField;
+    uint16_t value;
+    uint8_t i;
+    uint8_t n;
+
+    for (i = 0; i < nLimits; i++)
+    {
+        for (n = 0; n < pTable[i].count; n++)
+        {
+            pField = pData + pTable[i].offset + (n * pTable[i].size);
+            value = (pTable[i].size == 2) ? U8TOU16(pField[0], pField[1]) : pField[0];
+            if ((value < pTable[i].min) || (value > pTable[i].max))
+            {
+                return (int16_t)(pField - pData);
+            }
+        }
+    }
+
+    return -1;
+}
+
+
+/******************************************************************************
+ *
+ * configFieldLimitFind
+ *
+ * PURPOSE
+ *      This routine finds the field range limit for the field element that
+ *      ends at a given structure offset.
+ *
+ * PARAMETERS
+ *      pTable      IN  field range limit table
+ *      nLimits     IN  number of entries in the table
+ *      last        IN  offset of the byte within the structure
+ *      pStart      OUT offset of the field element start within the structure
+ *
+ * RETURN VALUE
+ *      This routine returns the field range limit, or NULL if no checked
+ *      field element ends at the given offset.
+ *
+ * NOTES
+ *      This is used by the streaming validator, which checks a field when
+ *      its last byte arrives.
+ *
+ *****************************************************************************/
+static const configFieldLimit_t *configFieldLimitFind(const configFieldLimit_t *pTable,
+                                                      uint8_t nLimits,
+                                                      uint16_t last,
+                                                      uint16_t *pStart)
+{
+    uint16_t f;
+    uint8_t i;
+
+    for (i = 0; i < nLimits; i++)
+    {
+        if (last < pTable[i].offset)
+        {
+            continue;
+        }
+        f = last - pTable[i].offset;
+        if ((f < (pTable[i].size * pTable[i].count)) &&
+            ((f % pTable[i].size) == (pTable[i].size - 1)))
+        {
+            *pStart = last - (pTable[i].size - 1);
+            return &pTable[i];
+        }
+    }
+
+    return NULL;
+}
+
+
 /******************************************************************************
  *
  * configImageContentValidate
@@ -889,6 +1209,7 @@ int16_t configImageContentValidate(uint32_t imageOffset)
     int8_t group[SYS_N_ZONES];  /* zone group array */
     uint32_t nextIndex = 0;     /* next offset within image to read */
     size_t offset;              /* error offset if invalid field is found */
+    int16_t fieldError;         /* field table error offset (-1=none) */
     uint16_t checksum;          /* configuration image checksum */
     char debugBuf[8];           /* DEBUG BUFFER */
     union                       /* buffer for EEPROM config data reads */
@@ -919,22 +1240,12 @@ int16_t configImageContentValidate(uint32_t imageOffset)
         offset = woffsetof(configImage_t, sys.numZones);
         goto error_exit;
     }
-    /* Verify operating mode. */
-    if (data.sys.opMode >= CONFIG_OPMODE_LIMIT)
-    {
-        offset = woffsetof(configImage_t, sys.opMode);
-        goto error_exit;
-    }
-    /* Verify pulse mode. */
-    if (data.sys.pulseMode >= CONFIG_PULSEMODE_LIMIT)
-    {
-        offset = woffsetof(configImage_t, sys.pulseMode);
-        goto error_exit;
-    }
-    /* Verify time format. */
-    if (data.sys.timeFmt >= CONFIG_TIMEFMT_LIMIT)
+    /* Verify operating mode, pulse mode and time format. */
+    fieldError = configFieldsValidate(configSysLimits, CONFIG_SYS_N_LIMITS,
+                                      (const uint8_t *)&data.sys);
+    if (fieldError != -1)
     {
-        offset = woffsetof(configImage_t, sys.timeFmt);
+        offset = woffsetof(configImage_t, sys) + fieldError;
         goto error_exit;
     }
 #ifdef RADIO_ZB
@@ -951,7 +1262,7 @@ int16_t configImageContentValidate(uint32_t imageOffset)
         goto error_exit;
     }
     /* Verify pad bytes are zeros. */
-    for (i = 0; i < 6; i++)
+    for (i = 0; i < sizeof(data.sys.pad); i++)
     {
         if (data.sys.pad[i] != 0)
         {
@@ -972,39 +1283,13 @@ int16_t configImageContentValidate(uint32_t imageOffset)
         drvEepromRead(imageOffset + nextIndex, &data, sizeof(configZone_t));
         /* Increment next byte index past end of current zone. */
         nextIndex += sizeof(configZone_t);
-        /* Verify zone run time. */
-        for (i = 0; i < SYS_N_PROGRAMS; i++)
-        {
-            if (data.zone.runTime[i] > CONFIG_RUNTIME_MAX)
-            {
-                offset = woffsetof(configImage_t, zone[zi].runTime[i]);
-                goto error_exit;
-            }
-        }
-        /* Verify zone application rate. */
-        if ((ntohs(data.zone.appRate) == 0) ||
-            (ntohs(data.zone.appRate) > CONFIG_APPRATE_MAX))
-        {
-            offset = woffsetof(configImage_t, zone[zi].appRate);
-            goto error_exit;
-        }
-        /* Verify zone soil type. */
-        if (data.zone.soilType >= CONFIG_SOILTYPE_LIMIT)
-        {
-            offset = woffsetof(configImage_t, zone[zi].soilType);
-            goto error_exit;
-        }
-        /* Verify zone slope. */
-        if (data.zone.slope >= CONFIG_SLOPE_LIMIT)
-        {
-            offset = woffsetof(configImage_t, zone[zi].slope);
-            goto error_exit;
-        }
-        /* Verify zone minimum moisture. */
-        if ((data.zone.minMoist < CONFIG_MOIST_MIN) ||
-            (data.zone.minMoist > (CONFIG_MOIST_MAX - 1)))
+        /* Verify zone run times, application rate and efficiency, soil
+           type, slope, minimum moisture, climate and RZWWS. */
+        fieldError = configFieldsValidate(configZoneLimits, CONFIG_ZONE_N_LIMITS,
+                                          (const uint8_t *)&data.zone);
+        if (fieldError != -1)
         {
-            offset = woffsetof(configImage_t, zone[zi].minMoist);
+            offset = woffsetof(configImage_t, zone[zi]) + fieldError;
             goto error_exit;
         }
         /* Verify zone maximum moisture. */
@@ -1020,12 +1305,6 @@ int16_t configImageContentValidate(uint32_t imageOffset)
             offset = woffsetof(configImage_t, zone[zi].minMoist);
             goto error_exit;
         }
-        /* Verify zone climate. */
-        if (data.zone.climate >= CONFIG_CLIMATE_LIMIT)
-        {
-            offset = woffsetof(configImage_t, zone[zi].climate);
-            goto error_exit;
-        }
         /* Verify zone plant type. */
         if (CONFIG_PT_SPECIES(data.zone.plantType) >= CONFIG_PLANTTYPE_LIMIT)
         {
@@ -1052,22 +1331,6 @@ int16_t configImageContentValidate(uint32_t imageOffset)
         /* Save zone group setting for final group consistency check. */
         group[zi] = data.zone.group;
 
-        /* Verify zone application rate efficiency. */
-        if ((data.zone.appEff < CONFIG_APPEFF_MIN) ||
-            (data.zone.appEff > CONFIG_APPEFF_MAX))
-        {
-            offset = woffsetof(configImage_t, zone[zi].appEff);
-            goto error_exit;
-        }
-
-        /* Verify zone RZWWS. */
-        if ((ntohs(data.zone.rzwws) < CONFIG_RZWWS_MIN) ||
-            (ntohs(data.zone.rzwws) > CONFIG_RZWWS_MAX))
-        {
-            offset = woffsetof(configImage_t, zone[zi].rzwws);
-            goto error_exit;
-        }
-
         /*
         **  Call sysExecutionExtend at the end of each loop to prevent
         **  watchdog reset during this relatively long operation.
@@ -1191,39 +1454,139 @@ void configImageVerify(void)
     }
 }
 
-
 /******************************************************************************
  *
- * configZonePlantTypeGet
+ * configCommitInit
  *
  * PURPOSE
- *      This routine returns 3 bytes of plant type information for a zone.
- *      The plant type, density, and drought tolerance are stored in a single
- *      byte within the configuration data store, and this routine splits up
- *      the bit-fields into separate bytes for ease of use.
+ *      This routine finds which configuration image was last committed.
  *
  * PARAMETERS
- *      zi          IN      zone index (0-47)
- *      pType       OUT     plant type (i.e., the plant species type)
- *      pDensity    OUT     plant density
- *      pDt         OUT     plant drought tolerance
+ *      None.
  *
  * RETURN VALUE
  *      None.
  *
+ * NOTES
+ *      Commit records are written alternately to CONFIG_COMMIT_RECORDS
+ *      EEPROM blocks, so a power failure while writing one leaves the
+ *      previous record intact.  The valid record with the highest sequence
+ *      number is the current one.  If there are no valid records (e.g.,
+ *      first start after a firmware update) image 1 is taken as active.
+ *
  *****************************************************************************/
-void configZonePlantTypeGet(uint8_t zi,
-                            uint8_t *pType,
-                            uint8_t *pDensity,
-                            uint8_t *pDt)
+void configCommitInit(void)
 {
-    if (zi < SYS_N_ZONES)
-    {
-        *pType = CONFIG_PT_SPECIES(config.zone[zi].plantType);
-        *pDensity = CONFIG_PT_DENSITY(config.zone[zi].plantType);
-        *pDt = CONFIG_PT_DT(config.zone[zi].plantType);
-    }
-}
+    configCommit_t rec;
+    bool_t isFound = FALSE;
+    uint8_t i;
+
+    configActiveSlot = 1;
+    configCommitSeq = 0;
+    for (i = 0; i < CONFIG_COMMIT_RECORDS; i++)
+    {
+        drvEepromRead(CONFIG_COMMIT + i * CONFIG_BLOCK_SIZE, &rec, sizeof(rec));
+        if ((rec.crc != crc16(&rec, woffsetof(configCommit_t, crc))) ||
+            ((rec.slot != 1) && (rec.slot != 2)))
+        {
+            /* Not a valid commit record. */
+            continue;
+        }
+        if (!isFound || (rec.seq > configCommitSeq))
+        {
+            configCommitSeq = rec.seq;
+            configActiveSlot = rec.slot;
+            isFound = TRUE;
+        }
+    }
+}
+
+
+/******************************************************************************
+ *
+ * configCommitWrite
+ *
+ * PURPOSE
+ *      This routine commits a configuration image, making it the active
+ *      image loaded at the next system start.
+ *
+ * PARAMETERS
+ *      slot    IN  image to commit (1 or 2)
+ *
+ * RETURN VALUE
+ *      This routine returns TRUE if the commit record was written.
+ *
+ * NOTES
+ *      The image must already be completely written and in-sync with the
+ *      working copy in RAM.  The commit is a single commit record write,
+ *      so it either happens completely or not at all.  Once committed, the
+ *      master sends the new configuration on to its expansion units.
+ *
+ *****************************************************************************/
+bool_t configCommitWrite(uint8_t slot)
+{
+    configCommit_t rec;
+    uint32_t seq = configCommitSeq + 1;
+
+    rec.seq = seq;
+    rec.slot = slot;
+    rec.pad = 0;
+    rec.crc = crc16(&rec, woffsetof(configCommit_t, crc));
+    if (!drvEepromWrite(&rec,
+                        CONFIG_COMMIT + (seq % CONFIG_COMMIT_RECORDS) * CONFIG_BLOCK_SIZE,
+                        sizeof(rec)))
+    {
+        /* Leave the previous image active - retried on next poll. */
+        return FALSE;
+    }
+    configCommitSeq = seq;
+    configActiveSlot = slot;
+    configCommitNow = FALSE;
+
+    /* Trace configuration committed event. */
+    sysEvent(CONFIG_EVENT_COMMIT, slot);
+
+    /* if master then send new config to expansion units */
+    if (config.sys.unitType == UNIT_TYPE_MASTER)
+    {
+        expansionCfgDistribute();
+    }
+    return TRUE;
+}
+
+
+/******************************************************************************
+ *
+ * configZonePlantTypeGet
+ *
+ * PURPOSE
+ *      This routine returns 3 bytes of plant type information for a zone.
+ *      The plant type, density, and drought tolerance are stored in a single
+ *      byte within the configuration data store, and this routine splits up
+ *      the bit-fields into separate bytes for ease of use.
+ *
+ * PARAMETERS
+ *      zi          IN      zone index (0-47)
+ *      pType       OUT     plant type (i.e., the plant species type)
+ *      pDensity    OUT     plant density
+ *      pDt         OUT     plant drought tolerance
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ *****************************************************************************/
+void configZonePlantTypeGet(uint8_t zi,
+                            uint8_t *pType,
+                            uint8_t *pDensity,
+                            uint8_t *pDt)
+{
+    if (zi < SYS_N_ZONES)
+    {
+        *pType = CONFIG_PT_SPECIES(config.zone[zi].plantType);
+        *pDensity = CONFIG_PT_DENSITY(config.zone[zi].plantType);
+        *pDt = CONFIG_PT_DT(config.zone[zi].plantType);
+    }
+}
 
 
 /******************************************************************************
@@ -1325,6 +1688,8 @@ void configFactoryDefaultInit(void)
  *      returns.  This operation can take up to 150 ms to complete.
  *      The system is regularly notified during this long process to prevent
  *      watchdog reset and manage any power failures.
+ *      The copy is skipped if the configuration checksum is unchanged since
+ *      the last snapshot was saved, since the snapshot is then up to date.
  *
  *****************************************************************************/
 void configSnapshotSave(void)
@@ -1345,6 +1710,13 @@ void configSnapshotSave(void)
         config.sys.checkSum = htons(newCheckSum);
     }
 
+    /* Nothing to do if the snapshot already holds this configuration. */
+    if (configSnapshotIsValid && (newCheckSum == configSnapshotCheckSum))
+    {
+        config.sys.checkSum = oldCheckSum;
+        return;
+    }
+
     i = 0;
     while (i < CONFIG_IMAGE_SIZE)
     {
@@ -1361,6 +1733,9 @@ void configSnapshotSave(void)
 
     /* Restore original RAM checksum. */
     config.sys.checkSum = oldCheckSum;
+
+    configSnapshotCheckSum = newCheckSum;
+    configSnapshotIsValid = TRUE;
 }
 
 
@@ -1387,6 +1762,241 @@ void configSnapshotRead(uint32_t offset, void *pBuf, uint32_t len)
 }
 
 
+/******************************************************************************
+ *
+ * configSnapshotBlockCrc
+ *
+ * PURPOSE
+ *      This routine computes the CRC of one block of the configuration
+ *      snapshot image in EEPROM.
+ *
+ * PARAMETERS
+ *      block   IN  block index (block size is CONFIG_BLOCK_SIZE)
+ *
+ * RETURN VALUE
+ *      CRC-16 of the block data; CRC_INIT_VALUE if block is out of range.
+ *
+ * NOTES
+ *      The block CRCs form a manifest the NOC compares against its cached
+ *      copy of the image, so that only changed blocks need to be uploaded.
+ *
+ *****************************************************************************/
+uint16_t configSnapshotBlockCrc(uint16_t block)
+{
+    uint8_t data[CONFIG_BLOCK_SIZE];
+    uint32_t offset = (uint32_t)block * CONFIG_BLOCK_SIZE;
+    uint32_t nBytes;
+
+    if (offset >= CONFIG_IMAGE_SIZE)
+    {
+        return CRC_INIT_VALUE;
+    }
+    nBytes = CONFIG_IMAGE_SIZE - offset;
+    if (nBytes > CONFIG_BLOCK_SIZE)
+    {
+        nBytes = CONFIG_BLOCK_SIZE;
+    }
+    drvEepromRead(CONFIG_IMAGE_SNAPSHOT + offset, data, nBytes);
+
+    return crc16(data, nBytes);
+}
+
+
+/******************************************************************************
+ *
+ * configSnapshotRleEncode
+ *
+ * PURPOSE
+ *      This routine run-length encodes part of the configuration snapshot
+ *      for a compressed upload segment.
+ *
+ * PARAMETERS
+ *      pOffset IN/OUT  snapshot offset to start encoding from; updated to
+ *                      the offset where the next segment must start
+ *      pOut    OUT     encoded data buffer
+ *      maxOut  IN      size of the encoded data buffer
+ *
+ * RETURN VALUE
+ *      Length of the encoded data (0 when the end of the image is reached).
+ *
+ * NOTES
+ *      The encoding is a sequence of tokens, none of which spans a segment:
+ *          0x00..0x7F  literal - the next (control + 1) bytes are copied
+ *          0x80..0xFF  run - the next byte is repeated (control - 0x7D) times
+ *      So literals are 1..128 bytes and runs are 3..130 bytes.  Each segment
+ *      can therefore be decoded on its own given the image offset at which
+ *      it starts.
+ *
+ *****************************************************************************/
+uint8_t configSnapshotRleEncode(uint32_t *pOffset, uint8_t *pOut, uint8_t maxOut)
+{
+    uint8_t in[CONFIG_BLOCK_SIZE];
+    uint32_t offset = *pOffset;
+    uint32_t nIn;
+    uint32_t pos;
+    uint32_t n;
+    uint8_t outLen = 0;
+    bool_t isFull = FALSE;
+
+    while ((offset < CONFIG_IMAGE_SIZE) && !isFull)
+    {
+        /* Read the next window of the snapshot. */
+        nIn = CONFIG_IMAGE_SIZE - offset;
+        if (nIn > CONFIG_BLOCK_SIZE)
+        {
+            nIn = CONFIG_BLOCK_SIZE;
+        }
+        drvEepromRead(CONFIG_IMAGE_SNAPSHOT + offset, in, nIn);
+
+        pos = 0;
+        while (pos < nIn)
+        {
+            /* Measure the run of repeated bytes at this position. */
+            n = 1;
+            while ((pos + n < nIn) && (in[pos + n] == in[pos]))
+            {
+                n++;
+            }
+
+            if (n >= CONFIG_RLE_MIN_RUN)
+            {
+                if (outLen + 2 > maxOut)
+                {
+                    isFull = TRUE;
+                    break;
+                }
+                pOut[outLen++] = (uint8_t)(0x80 + n - CONFIG_RLE_MIN_RUN);
+                pOut[outLen++] = in[pos];
+            }
+            else
+            {
+                /* Literal up to the start of the next run. */
+                n = 1;
+                while ((pos + n < nIn) &&
+                       !((pos + n + 2 < nIn) &&
+                         (in[pos + n] == in[pos + n + 1]) &&
+                         (in[pos + n] == in[pos + n + 2])))
+                {
+                    n++;
+                }
+                if (outLen + 1 + n > maxOut)
+                {
+                    if (outLen + 2 > maxOut)
+                    {
+                        isFull = TRUE;
+                        break;
+                    }
+                    n = maxOut - outLen - 1;
+                    isFull = TRUE;
+                }
+                pOut[outLen++] = (uint8_t)(n - 1);
+                memcpy(&pOut[outLen], &in[pos], n);
+                outLen += (uint8_t)n;
+            }
+            pos += n;
+            if (isFull)
+            {
+                break;
+            }
+        }
+        offset += pos;
+    }
+
+    *pOffset = offset;
+    return outLen;
+}
+
+
+/******************************************************************************
+ *
+ * configBufferRleWrite
+ *
+ * PURPOSE
+ *      This routine decodes one run-length encoded download segment into the
+ *      configuration download buffer area of EEPROM.
+ *
+ * PARAMETERS
+ *      pIn     IN      encoded segment data
+ *      len     IN      length of encoded segment data
+ *      pOffset IN/OUT  download buffer offset of the decoded segment start;
+ *                      updated to the offset following the segment
+ *
+ * RETURN VALUE
+ *      TRUE on success; FALSE if the segment is malformed or decodes past
+ *      the end of the configuration image, in which case *pOffset is not
+ *      changed.
+ *
+ * NOTES
+ *      See configSnapshotRleEncode() for the encoding.  Decoded data is
+ *      gathered into writes through configBufferWrite() that end on EEPROM
+ *      page boundaries, so each write programs a single page, and the
+ *      watchdog is serviced after each one; one segment may decode to the
+ *      whole configuration image.  The downloaded image is validated by
+ *      configBufferLoad() as for an uncompressed download.
+ *
+ *****************************************************************************/
+bool_t configBufferRleWrite(const uint8_t *pIn, uint8_t len, uint32_t *pOffset)
+{
+    uint8_t out[CONFIG_BLOCK_SIZE];
+    uint32_t offset = *pOffset;
+    uint8_t outLen = 0;
+    uint8_t i = 0;
+    uint8_t n;
+    uint8_t value = 0;
+    bool_t isRun;
+
+    while (i < len)
+    {
+        isRun = (pIn[i] >= 0x80);
+        if (isRun)
+        {
+            n = (uint8_t)(pIn[i] - 0x80 + CONFIG_RLE_MIN_RUN);
+            if (i + 1 >= len)
+            {
+                return FALSE;
+            }
+            value = pIn[i + 1];
+            i += 2;
+        }
+        else
+        {
+            n = (uint8_t)(pIn[i] + 1);
+            if (i + 1 + n > len)
+            {
+                return FALSE;
+            }
+            i++;
+        }
+        if (offset + outLen + n > CONFIG_IMAGE_SIZE)
+        {
+            return FALSE;
+        }
+
+        /* Copy the token output, flushing at each page boundary. */
+        while (n > 0)
+        {
+            out[outLen++] = isRun ? value : pIn[i++];
+            n--;
+            if (((offset + outLen) % CONFIG_BLOCK_SIZE) == 0)
+            {
+                configBufferWrite(out, offset, outLen);
+                offset += outLen;
+                outLen = 0;
+                sysExecutionExtend();
+            }
+        }
+    }
+    if (outLen > 0)
+    {
+        configBufferWrite(out, offset, outLen);
+        offset += outLen;
+    }
+
+    *pOffset = offset;
+    return TRUE;
+}
+
+
 /******************************************************************************
  *
  * configBufferLoad
@@ -1405,6 +2015,8 @@ void configSnapshotRead(uint32_t offset, void *pBuf, uint32_t len)
  *      byte-offset of the first invalid field detected.
  *
  * NOTES
+ *      If the whole image was written in order by configBufferWrite() it
+ *      has already been validated and is not read back for validation.
  *      The stored configuration data images will be automatically updated
  *      to match the new version in RAM.
  *      The user interface is sent back to its "home" Control & Status screen.
@@ -1431,7 +2043,15 @@ int16_t configBufferLoad(void)
                                         * stopping and the next one starting */
     
     /* Verify configuration data values are within acceptable bounds. */
-    result = configImageContentValidate(CONFIG_IMAGE_BUFFER);
+    if (configStreamIsValid && (configStreamOffset == CONFIG_IMAGE_SIZE))
+    {
+        /* Image was already validated as it was downloaded. */
+        result = configStreamError;
+    }
+    else
+    {
+        result = configImageContentValidate(CONFIG_IMAGE_BUFFER);
+    }
 
     if (result == -1)
     {
@@ -1573,6 +2193,8 @@ int16_t configBufferLoad(void)
         
         /* Indicate the need to re-sync EEPROM configuration image copies. */
         configImageSyncNeeded();
+        /* Commit the new configuration without waiting for lazy write. */
+        configCommitNow = TRUE;
         /* Update sensor sample frequency for new configuration. */
         irrMoistConfigUpdate();
         /* Update the Radio PAN ID if it has changed. */
@@ -1623,6 +2245,9 @@ void configBufferClear(void)
     uint8_t data[CONFIG_BLOCK_SIZE];
     int i;
 
+    /* Buffer no longer holds a streamed image. */
+    configStreamIsValid = FALSE;
+
     /* Set configuration download buffer all 0xFF bytes. */
     memset(data, 0xFF, sizeof(data));
     for (i = CONFIG_IMAGE_BUFFER;
@@ -1636,6 +2261,210 @@ void configBufferClear(void)
 }
 
 
+/******************************************************************************
+ *
+ * configStreamByte
+ *
+ * PURPOSE
+ *      This routine feeds one byte of a config image being downloaded into
+ *      the streaming validator.
+ *
+ * PARAMETERS
+ *      offset  IN  image offset of the byte
+ *      value   IN  byte value
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      Bytes must be supplied in image order.  The checks made here are
+ *      the same as those made by configImageContentValidate(), and field
+ *      ranges come from the same limit tables; multi-byte fields are
+ *      checked when their last byte arrives, and checks that
+ *      depend on later fields are made when those fields arrive.  The first
+ *      error offset found is kept in configStreamError.
+ *
+ *****************************************************************************/
+static void configStreamByte(uint32_t offset, uint8_t value)
+{
+    uint16_t word = (uint16_t)((configStreamPrev << 8) | value);
+    size_t error = 0;
+    bool_t isError = FALSE;
+    const configFieldLimit_t *pLimit;
+    uint16_t start;
+    uint32_t f;
+    uint8_t zi;
+
+    configStreamPrev = value;
+    if (offset >= 4)
+    {
+        crcByte(value, &configStreamCrc);
+    }
+
+    if (offset < sizeof(configSys_t))
+    {
+        if (offset == woffsetof(configSys_t, version) + 1)
+        {
+            if (word != CONFIG_VERSION)
+            {
+                error = woffsetof(configImage_t, sys.version);
+                isError = TRUE;
+            }
+        }
+        else if (offset == woffsetof(configSys_t, checkSum) + 1)
+        {
+            configStreamCheckSum = word;
+        }
+        else if (offset == woffsetof(configSys_t, numZones))
+        {
+            configStreamNumZones = value;
+            if (value > sysMaxZones)
+            {
+                error = woffsetof(configImage_t, sys.numZones);
+                isError = TRUE;
+            }
+        }
+        else if ((pLimit = configFieldLimitFind(configSysLimits, CONFIG_SYS_N_LIMITS,
+                                                (uint16_t)offset, &start)) != NULL)
+        {
+            if ((((pLimit->size == 2) ? word : value) < pLimit->min) ||
+                (((pLimit->size == 2) ? word : value) > pLimit->max))
+            {
+                error = woffsetof(configImage_t, sys) + start;
+                isError = TRUE;
+            }
+        }
+#ifndef RADIO_ZB
+        else if (offset == woffsetof(configSys_t, radioPanId) + 1)
+        {
+            if ((word >= CONFIG_PAN_ID_LIMIT) && (word != CONFIG_PAN_ID_ANY))
+            {
+                error = woffsetof(configImage_t, sys.radioPanId);
+                isError = TRUE;
+            }
+        }
+        else if ((offset >= woffsetof(configSys_t, pad)) &&
+                 (offset < woffsetof(configSys_t, pad) + sizeof(config.sys.pad)))
+        {
+            if (value != 0)
+            {
+                error = offset;
+                isError = TRUE;
+            }
+        }
+#endif
+    }
+    else if (offset < woffsetof(configImage_t, sched))
+    {
+        /* Zone configuration:  zone index and offset within zone. */
+        f = offset - woffsetof(configImage_t, zone);
+        zi = (uint8_t)(f / sizeof(configZone_t));
+        f = f % sizeof(configZone_t);
+        error = woffsetof(configImage_t, zone) + zi * sizeof(configZone_t);
+
+        if ((pLimit = configFieldLimitFind(configZoneLimits, CONFIG_ZONE_N_LIMITS,
+                                           (uint16_t)f, &start)) != NULL)
+        {
+            if ((((pLimit->size == 2) ? word : value) < pLimit->min) ||
+                (((pLimit->size == 2) ? word : value) > pLimit->max))
+            {
+                error += start;
+                isError = TRUE;
+            }
+        }
+
+        if (f == woffsetof(configZone_t, minMoist))
+        {
+            configStreamMinMoist = value;
+        }
+        else if (f == woffsetof(configZone_t, maxMoist))
+        {
+            configStreamMaxMoist = value;
+        }
+        else if (f == woffsetof(configZone_t, plantType))
+        {
+            if ((CONFIG_PT_SPECIES(value) >= CONFIG_PLANTTYPE_LIMIT) ||
+                (CONFIG_PT_DENSITY(value) >= CONFIG_PLANTDENSITY_LIMIT) ||
+                (CONFIG_PT_DT(value) >= CONFIG_PLANTDT_LIMIT))
+            {
+                error += f;
+                isError = TRUE;
+            }
+        }
+        else if (f == woffsetof(configZone_t, group))
+        {
+            configStreamGroup[zi] = (int8_t)value;
+            if (((int8_t)value != CONFIG_GROUP_NONE) &&
+                (((int8_t)value < 0) || ((int8_t)value >= SYS_N_ZONES)))
+            {
+                error += f;
+                isError = TRUE;
+            }
+        }
+        else if (f == woffsetof(configZone_t, sensorType))
+        {
+            /* Moisture limits depend on the sensor type. */
+            if (((value == SNS_WIRED_MOIST) || (value == SNS_WIRELESS_MOIST)) &&
+                ((configStreamMaxMoist < (CONFIG_MOIST_MIN + 1)) ||
+                 (configStreamMaxMoist > CONFIG_MOIST_MAX)))
+            {
+                error += woffsetof(configZone_t, maxMoist);
+                isError = TRUE;
+            }
+            else if (configStreamMinMoist >= configStreamMaxMoist)
+            {
+                error += woffsetof(configZone_t, minMoist);
+                isError = TRUE;
+            }
+        }
+    }
+    else
+    {
+        /* Schedule start times. */
+        f = offset - woffsetof(configImage_t, sched);
+        if (((f & 1) != 0) &&
+            (word != CONFIG_SCHED_START_DISABLED) &&
+            (word >= CONFIG_SCHED_START_LIMIT))
+        {
+            error = offset - 1;
+            isError = TRUE;
+        }
+    }
+
+    if (isError && (configStreamError == -1))
+    {
+        configStreamError = (int16_t)error;
+    }
+
+    /* Whole-image checks once the last byte has arrived. */
+    if (offset == CONFIG_IMAGE_SIZE - 1)
+    {
+        for (zi = 0; zi < configStreamNumZones; zi++)
+        {
+            if ((configStreamGroup[zi] == CONFIG_GROUP_NONE) ||
+                (configStreamGroup[zi] == zi))
+            {
+                continue;
+            }
+            if ((configStreamGroup[zi] < configStreamNumZones) &&
+                (configStreamGroup[configStreamGroup[zi]] == configStreamGroup[zi]))
+            {
+                continue;
+            }
+            if (configStreamError == -1)
+            {
+                configStreamError = (int16_t)woffsetof(configImage_t, zone[zi].group);
+            }
+            break;
+        }
+        if ((configStreamCrc != configStreamCheckSum) && (configStreamError == -1))
+        {
+            configStreamError = (int16_t)woffsetof(configImage_t, sys.checkSum);
+        }
+    }
+}
+
+
 /******************************************************************************
  *
  * configBufferWrite
@@ -1652,10 +2481,91 @@ void configBufferClear(void)
  * RETURN VALUE
  *      None.
  *
+ * NOTES
+ *      A download written in order from offset 0 is validated as it
+ *      arrives (see configStreamByte), so configBufferLoad() does not need
+ *      to re-read the image to validate it, and configBufferError() can
+ *      report a bad field as soon as the segment holding it is written.
+ *      Any other write (out of order, repeated, or a delta patch) makes
+ *      configBufferLoad() fall back to full validation from EEPROM.
+ *
  *****************************************************************************/
 void configBufferWrite(const void *pBuf, uint32_t offset, uint32_t len)
 {
+    const uint8_t *pData = (const uint8_t *)pBuf;
+    uint32_t i;
+
     drvEepromWrite(pBuf, CONFIG_IMAGE_BUFFER + offset, len);
+
+    if (offset == 0)
+    {
+        /* Start of a new download. */
+        configStreamOffset = 0;
+        configStreamCrc = CRC_INIT_VALUE;
+        configStreamError = -1;
+        configStreamNumZones = 0;
+        configStreamIsValid = TRUE;
+    }
+    if (!configStreamIsValid || (offset != configStreamOffset) ||
+        (offset + len > CONFIG_IMAGE_SIZE))
+    {
+        configStreamIsValid = FALSE;
+        return;
+    }
+    for (i = 0; i < len; i++)
+    {
+        configStreamByte(offset + i, pData[i]);
+    }
+    configStreamOffset += len;
+}
+
+
+/******************************************************************************
+ *
+ * configBufferError
+ *
+ * PURPOSE
+ *      This routine reports any error found so far by the streaming
+ *      validation of the configuration image being downloaded.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      -1 if no invalid field has been found, otherwise the byte-offset of
+ *      the first invalid field found.
+ *
+ *****************************************************************************/
+int16_t configBufferError(void)
+{
+    return configStreamIsValid ? configStreamError : -1;
+}
+
+
+/******************************************************************************
+ *
+ * configBufferRead
+ *
+ * PURPOSE
+ *      This routine reads data from the configuration download buffer area
+ *      of EEPROM.
+ *
+ * PARAMETERS
+ *      offset  IN  offset in download buffer to start reading
+ *      pBuf    OUT pointer to read data destination
+ *      len     IN  length of data
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      Expansion units keep the last image received from the master in the
+ *      download buffer so that later changes can be sent as a delta.
+ *
+ *****************************************************************************/
+void configBufferRead(uint32_t offset, void *pBuf, uint32_t len)
+{
+    drvEepromRead(CONFIG_IMAGE_BUFFER + offset, pBuf, len);
 }
 
 
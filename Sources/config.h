@@ -42,14 +42,27 @@
 #define CONFIG_STATE_DIRTY      2       /* Data Store is out-of-sync */
 #define CONFIG_STATE_WRITING1   3       /* Updating EEPROM data copy 1 */
 #define CONFIG_STATE_WRITING2   4       /* Updating EEPROM data copy 2 */
+#define CONFIG_STATE_VERIFYING  5       /* Verifying inactive EEPROM copy */
 extern uint8_t configState;             /* Configuration Manager State */
 
 /* Configuration Image Status */
 #define CONFIG_IMAGE_CORRUPT    0       /* Image is Corrupted */
 #define CONFIG_IMAGE_VALID      1       /* Image is Valid */
 #define CONFIG_IMAGE_OLD        2       /* Image is Valid but Out-of-Sync */
+#define CONFIG_IMAGE_UNKNOWN    3       /* Image not yet verified */
 
 
+/* Configuration Commit Record */
+#define CONFIG_COMMIT_RECORDS   2       /* records, one per EEPROM block */
+
+typedef struct
+{
+    uint32_t seq;                       /* commit sequence number */
+    uint8_t slot;                       /* committed image (1 or 2) */
+    uint8_t pad;                        /* always 0 */
+    uint16_t crc;                       /* CRC of preceding bytes */
+} configCommit_t;
+
 #define CONFIG_LAZY_WRITE_SECS  5       /* Dirty config secs before Write */
 #define CONFIG_MB_FIX_SECS      10      /* Dirty config secs before MB fix */
 
@@ -69,9 +82,12 @@ extern uint8_t configState;             /* Configuration Manager State */
 #define CONFIG_EVENT_LOG        0x2800//0x1400  /* EEPROM offset to saved event log */
 #define FLOW_SNS_DATA           0x2C00          /* EEPROM offset to save 1 days worth of flow sensor data */
 #define LEVEL_SNS_DATA          0x5600          /* EEPROM offset to save 1 days worth of level sensor data */
+#define CONFIG_COMMIT           0x5C00          /* EEPROM offset to config commit records */
+#define IRR_CHECKPOINT_DATA     0x5D00          /* EEPROM offset to irrigation checkpoint */
 
 
 #define CONFIG_BLOCK_SIZE       64      /* EEPROM sector size */
+#define CONFIG_RLE_MIN_RUN      3       /* shortest run in RLE transfers */
 #define CONFIG_EEPROM_SIZE      32768   /* EEPROM size (assuming only 32K) */
 #define FLOW_DATA_SIZE          1440
 #define LEVEL_DATA_SIZE         1440
@@ -141,6 +157,9 @@ typedef struct
     #define SC_SLEEP_TIME_IRR         30
 #endif
 
+#define SC_SLEEP_TIME_MIN       2       /* shortest scheduled sensor concentrator sleep time in seconds */
+#define SC_WAKE_MARGIN_SECS     1       /* seconds to wake after a scheduled valve change */
+
 #define SC_HIBERNATE_TEMP_C	    4	    /* sensor concentrator hiberate temperature is degree C */
 #define SC_HIBERNATE_THRES_TIME	86400 /* sensor concentrator hiberate threshold time in msec (24hours)*/
 #define SC_NUM_CHAN_UNIT        4       /* number of channels per sensor concentrator */
@@ -190,7 +209,11 @@ typedef struct
     snsConConfig_t assocSensorCon[MAX_NUM_SC];     /* array to hold the MAC IDs of sensor    *
                                                     * concentrators that are associated with *
                                                     * unit */                                        
-    uint8_t pad[6];                         /* System Pad Bytes - Reserved */
+    uint8_t expBusWired;                    /* units on the wired expansion */
+                                            /* bus (bit n = unit type n) */
+    uint8_t solInrush;                      /* solenoid turn-on stagger */
+                                            /* (20 ms units, 0 = default) */
+    uint8_t pad[4];                         /* System Pad Bytes - Reserved */
 
 } configSys_t;
 
@@ -419,18 +442,27 @@ void configMemoryChecksumUpdate(void);
 uint16_t configMemoryChecksumCalc(void);
 void configWriteNextBlock(uint32_t imageOffset);
 bool_t configImageChecksumIsValid(uint32_t imageOffset, uint16_t *checksum);
+bool_t configImageLoad(uint32_t imageOffset);
+void configVerifyNextBlock(void);
 int16_t configImageContentValidate(uint32_t imageOffset);
 bool_t configManufInit(void);
 void configManufRead(configManuf_t *pManufImage);
 void configImageVerify(void);
+void configCommitInit(void);
+bool_t configCommitWrite(uint8_t slot);
 void configZonePlantTypeGet(uint8_t zi, uint8_t *pType, uint8_t *pDensity, uint8_t *pDt);
 void configZonePlantTypeSet(uint8_t zi, uint8_t type, uint8_t density, uint8_t dt);
 void configFactoryDefaultInit(void);
 void configSnapshotSave(void);
 void configSnapshotRead(uint32_t offset, void *pBuf, uint32_t len);
+uint16_t configSnapshotBlockCrc(uint16_t block);
+uint8_t configSnapshotRleEncode(uint32_t *pOffset, uint8_t *pOut, uint8_t maxOut);
+bool_t configBufferRleWrite(const uint8_t *pIn, uint8_t len, uint32_t *pOffset);
 int16_t configBufferLoad(void);
 void configBufferClear(void);
 void configBufferWrite(const void *pBuf, uint32_t offset, uint32_t len);
+int16_t configBufferError(void);
+void configBufferRead(uint32_t offset, void *pBuf, uint32_t len);
 void configEventLogSave(void);
 void configEventLogRead(uint32_t offset, void *pBuf, uint32_t len);
 uint16_t configRzwwsDefault(uint8_t plantType);
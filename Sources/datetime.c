@@ -26,6 +26,7 @@
 #include "config.h"
 #include "irrigation.h"
 #include "datetime.h"
+#include "format.h"
 #include "drvRtc.h"
 
 
@@ -473,6 +474,8 @@ void dtIncrement(void)
  *****************************************************************************/
 char *dtFormatHourMin(char *buf, uint8_t hour, uint8_t min)
 {
+    char *p = buf;
+
     switch (config.sys.timeFmt)
     {
         case CONFIG_TIMEFMT_12HR:
@@ -488,20 +491,28 @@ char *dtFormatHourMin(char *buf, uint8_t hour, uint8_t min)
                 {
                     hour = 12;
                 }
-                sprintf(buf, "%2d:%02d%s", hour, min, pSuffix);
+                p = fmtUint(p, hour, 2, ' ');
+                *p++ = ':';
+                p = fmtUint(p, min, 2, '0');
+                p = fmtStr(p, pSuffix, 0);
             }
             break;
 
         case CONFIG_TIMEFMT_24HR_US:
             /* 24-hour US format (e.g. "01:00" and "23:59") */
-            sprintf(buf, "%02d:%02d", hour, min);
+            p = fmtUint(p, hour, 2, '0');
+            *p++ = ':';
+            p = fmtUint(p, min, 2, '0');
             break;
 
         case CONFIG_TIMEFMT_24HR_CA:
             /* 24-hour CANADA format (e.g. "01h00" and "23h59") */
-            sprintf(buf, "%02dh%02d", hour, min);
+            p = fmtUint(p, hour, 2, '0');
+            *p++ = 'h';
+            p = fmtUint(p, min, 2, '0');
             break;
     }
+    *p = '\0';
 
     return buf;
 }
@@ -556,7 +567,12 @@ char *dtFormatRunTime(char *buf, uint16_t minutes)
     uint8_t hour = (uint8_t)(minutes / 60);
     uint8_t min  = (uint8_t)(minutes % 60);
 
-    sprintf(buf, "%2d:%02d", hour, min);
+    char *p = buf;
+
+    p = fmtUint(p, hour, 2, ' ');
+    *p++ = ':';
+    p = fmtUint(p, min, 2, '0');
+    *p = '\0';
 
     return buf;
 }
@@ -586,7 +602,14 @@ char *dtFormatRunTimeSecs(char *buf, uint32_t seconds)
     uint8_t mins  = (uint8_t)((seconds / 60) % 60);
     uint8_t secs = (uint8_t)((seconds % 60) % 60);
 
-    sprintf(buf, "%d:%02d:%02d", hours, mins, secs);
+    char *p = buf;
+
+    p = fmtUint(p, hours, 0, ' ');
+    *p++ = ':';
+    p = fmtUint(p, mins, 2, '0');
+    *p++ = ':';
+    p = fmtUint(p, secs, 2, '0');
+    *p = '\0';
 
     return buf;
 }
@@ -615,15 +638,20 @@ char *dtFormatRunTimeSecs(char *buf, uint32_t seconds)
  *****************************************************************************/
 char *dtFormatCurrentTimeDate(char *buf)
 {
-    char tmpbuf[41];
-    const char *pTimeStr = dtFormatHourMin(tmpbuf, dtHour, dtMin);
-
-    sprintf(buf, "%s %3.3s %3.3s %02d, %04d",
-            pTimeStr,
-            dtDayNames[dtWday],
-            dtMonthNames[dtMon],
-            dtMday,
-            dtYear);
+    char *p;
+
+    dtFormatHourMin(buf, dtHour, dtMin);
+    p = buf + strlen(buf);
+    *p++ = ' ';
+    p = fmtStr(p, dtDayNames[dtWday], 3);
+    *p++ = ' ';
+    p = fmtStr(p, dtMonthNames[dtMon], 3);
+    *p++ = ' ';
+    p = fmtUint(p, dtMday, 2, '0');
+    *p++ = ',';
+    *p++ = ' ';
+    p = fmtUint(p, dtYear, 4, '0');
+    *p = '\0';
 
     return buf;
 }
@@ -652,15 +680,17 @@ char *dtFormatCurrentTimeDate(char *buf)
  *****************************************************************************/
 char *dtFormatCurrentDateTime(char *buf)
 {
-    char tmpbuf[41];
-    const char *pTimeStr = dtFormatHourMin(tmpbuf, dtHour, dtMin);
-
-    sprintf(buf, "%04d-%3.3s-%02d %3.3s %s",
-            dtYear,
-            dtMonthNames[dtMon],
-            dtMday,
-            dtDayNames[dtWday],
-            pTimeStr);
+    char *p = buf;
+
+    p = fmtUint(p, dtYear, 4, '0');
+    *p++ = '-';
+    p = fmtStr(p, dtMonthNames[dtMon], 3);
+    *p++ = '-';
+    p = fmtUint(p, dtMday, 2, '0');
+    *p++ = ' ';
+    p = fmtStr(p, dtDayNames[dtWday], 3);
+    *p++ = ' ';
+    dtFormatHourMin(p, dtHour, dtMin);
 
     return buf;
 }
@@ -688,13 +718,20 @@ char *dtFormatCurrentDateTime(char *buf)
  *****************************************************************************/
 char *dtFormatDebugDateTime(char *buf)
 {
-    sprintf(buf, "%04d-%02d-%02d %02d:%02d:%02d",
-            dtYear,
-            dtMon + 1,
-            dtMday,
-            dtHour,
-            dtMin,
-            dtSec);
+    char *p = buf;
+
+    p = fmtUint(p, dtYear, 4, '0');
+    *p++ = '-';
+    p = fmtUint(p, dtMon + 1, 2, '0');
+    *p++ = '-';
+    p = fmtUint(p, dtMday, 2, '0');
+    *p++ = ' ';
+    p = fmtUint(p, dtHour, 2, '0');
+    *p++ = ':';
+    p = fmtUint(p, dtMin, 2, '0');
+    *p++ = ':';
+    p = fmtUint(p, dtSec, 2, '0');
+    *p = '\0';
 
     return buf;
 }
@@ -722,20 +759,19 @@ char *dtFormatUpTime(char *buf)
     uint8_t mins  = (uint8_t)(((dtTickCount % DT_SECS_24_HOURS) / 60) % 60);
     uint8_t secs = (uint8_t)(((dtTickCount % DT_SECS_24_HOURS) % 60) % 60);
 
-    if (days == 0)
-    {
-        sprintf(buf, "%02d:%02d:%02d", hours, mins, secs);
-    }
-    else
+    char *p = buf;
+
+    if (days != 0)
     {
-        sprintf(buf,
-                "%d day%s %02d:%02d:%02d",
-                days,
-                (days == 1) ? "" : "s",
-                hours,
-                mins,
-                secs);
+        p = fmtUint(p, days, 0, ' ');
+        p = fmtStr(p, (days == 1) ? " day " : " days ", 0);
     }
+    p = fmtUint(p, hours, 2, '0');
+    *p++ = ':';
+    p = fmtUint(p, mins, 2, '0');
+    *p++ = ':';
+    p = fmtUint(p, secs, 2, '0');
+    *p = '\0';
 
     return buf;
 }
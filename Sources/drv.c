@@ -83,4 +83,36 @@ asm uint8_t drvIlmSet(uint8_t level)
 #endif
 
 
+/******************************************************************************
+ *
+ *  drvBitCtz
+ *
+ *  DESCRIPTION:
+ *      This driver utility function returns the number of trailing zero bits
+ *      in a value, i.e. the bit number of its lowest set bit.
+ *
+ *  PARAMETERS:
+ *      value (in) - value to scan (must be non-zero)
+ *
+ *  RETURNS:
+ *      bit number (0..31) of the lowest set bit
+ *
+ *  NOTES:
+ *      This can be invoked from any context.  The lowest set bit is isolated
+ *      and multiplied by a de Bruijn constant, so the top five bits of the
+ *      product index a table; this runs in constant time with no loop.
+ *
+ *****************************************************************************/
+uint8_t drvBitCtz(uint32_t value)
+{
+    static const uint8_t table[32] =
+    {
+         0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+        31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9
+    };
+
+    return table[((value & (0 - value)) * 0x077CB531UL) >> 27];
+}
+
+
 /* END drv */
@@ -29,6 +29,7 @@ extern uint8_t drvLatch2;
 extern uint8_t drvLatch3;
 
 //uint8_t drvIlmSet(uint8_t level);
+uint8_t drvBitCtz(uint32_t value);
 
 
 /* END drv */
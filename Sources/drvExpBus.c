@@ -0,0 +1,752 @@
+/******************************************************************************
+ *                       Copyright (c) 2008, Jabil Circuit
+ *
+ * This source code and any compilation or derivative thereof is the sole
+ * property of Jabil Circuit and is provided pursuant to a Software License
+ * Agreement.  This code is the proprietary information of Jabil Circuit and
+ * is confidential in nature.  Its use and dissemination by any party other
+ * than Jabil Circuit is strictly limited by the confidential information
+ * provisions of the Software License Agreement referenced above.
+ *
+ ******************************************************************************
+ *
+ * Project      : WaterOptimizer Irrigation System (WOIS)
+ * Organization : WaterOptimizer, LLC
+ * Module       : drvExpBus.c
+ * Description  : This file implements the wired expansion bus serial port
+ *                driver, which carries framed messages between co-located
+ *                master and expansion units over the hwExpOut SCI.
+ *
+ *****************************************************************************/
+
+/* MODULE drvExpBus */
+
+#include <string.h>
+
+#include "global.h"
+#include "platform.h"
+#include "crc.h"
+#include "drvRtc.h"
+#include "hwExpOut.h"
+#include "hwExpOutRts.h"
+
+#include "drvExpBus.h"
+
+
+/*
+ * Each frame on the wire is:
+ *   Bytes      Field Description
+ *   ---------  ----------------------------------------------
+ *        1     Start of frame (DRV_EXPBUS_SOF)
+ *        1     Body length (1 to DRV_EXPBUS_MAX_FRAME)
+ *        n     Body
+ *        2     CRC-16 of the body, most significant byte first
+ *
+ * A frame with a bad CRC is dropped and the receiver hunts for the next
+ * start of frame.  A frame that stalls part way through is also dropped.
+ *
+ * Frames are parsed and checked by the receive ISR as the bytes arrive, so
+ * the main loop only has to keep up with whole frames rather than with the
+ * line rate.  Each complete, valid frame is placed in a small frame queue;
+ * a frame that arrives while the queue is full is dropped and counted as
+ * an overrun.
+ *
+ * The RTS line is asserted while a frame is being sent, to enable the
+ * line driver on a shared (half-duplex) bus.
+ *
+ * The hwExpOut bean runs the port interrupt driven at 115200 baud.  While
+ * the expansion bus is disabled the port is the debug console: this driver
+ * turns the SCI interrupts off, sets 9600 baud and polls the SCI registers
+ * directly for console characters.
+ */
+#define DRV_EXPBUS_SOF          0x7E
+#define DRV_EXPBUS_OVERHEAD     4       /* SOF + length + CRC bytes */
+#define DRV_EXPBUS_RX_TIMEOUT   10U     /* ms of silence that aborts a frame */
+
+#define DRV_EXPBUS_SBR_BUS      0x0E    /* SCI baud divisor for 115200 baud */
+#define DRV_EXPBUS_SBR_CONSOLE  0xA4    /* SCI baud divisor for 9600 baud */
+#define DRV_EXPBUS_SCI_ERR_IE   0x0F    /* SCI1C3 ORIE, NEIE, FEIE, PEIE */
+#define DRV_EXPBUS_SCI_ERR_MASK (SCI1S1_OR_MASK | SCI1S1_NF_MASK | \
+                                 SCI1S1_FE_MASK | SCI1S1_PF_MASK)
+
+#define DRV_EXPBUS_RX_FRAMES    3       /* receive frame queue depth */
+#define DRV_EXPBUS_TX_BUF_SIZE  128     /* transmit queue size */
+
+/* Receive frame parser states */
+#define DRV_EXPBUS_RX_HUNT      0       /* waiting for start of frame */
+#define DRV_EXPBUS_RX_LEN       1       /* waiting for length */
+#define DRV_EXPBUS_RX_BODY      2       /* receiving body */
+#define DRV_EXPBUS_RX_CRC_H     3       /* waiting for CRC MSB */
+#define DRV_EXPBUS_RX_CRC_L     4       /* waiting for CRC LSB */
+
+/*
+**  Receive Frame Queue Element Structure
+**  An element is free while its length is zero.  The receive ISR fills the
+**  element at the insert index and sets its length once the frame is
+**  valid; the task level reader clears the length when it is done.
+*/
+typedef struct
+{
+    volatile uint8_t len;               /* frame body length, 0 if free */
+    uint8_t body[DRV_EXPBUS_MAX_FRAME]; /* frame body */
+} drvExpBusRxFrame_t;
+
+static bool_t   drvExpBusEnabled = FALSE;
+
+/* Receive frame queue (filled by the UART receive ISR) */
+static drvExpBusRxFrame_t drvExpBusRxFrames[DRV_EXPBUS_RX_FRAMES];
+static uint8_t  drvExpBusRxInsert = 0;
+static uint8_t  drvExpBusRxRemove = 0;
+
+/* Receive frame parser (runs in the UART receive ISR) */
+static uint8_t  drvExpBusRxState = DRV_EXPBUS_RX_HUNT;
+static uint8_t  drvExpBusRxLen;
+static uint8_t  drvExpBusRxCount;
+static uint16_t drvExpBusRxCrc;
+static uint16_t drvExpBusRxCrcCalc;
+static uint32_t drvExpBusRxTime;
+
+/* Transmit circular buffer (emptied by the UART transmit ISR) */
+static uint8_t  drvExpBusTxBuf[DRV_EXPBUS_TX_BUF_SIZE];
+static volatile uint8_t drvExpBusTxInsert = 0;
+static volatile uint8_t drvExpBusTxRemove = 0;
+static volatile bool_t  drvExpBusTxActive = FALSE;
+static bool_t   drvExpBusRtsOn = FALSE;
+
+/* Statistics */
+uint32_t drvExpBusStatRxFrames   = 0;
+uint32_t drvExpBusStatRxBadCrc   = 0;
+uint32_t drvExpBusStatRxTimeouts = 0;
+uint32_t drvExpBusStatRxOverruns = 0;
+uint32_t drvExpBusStatTxFrames   = 0;
+
+static void    drvExpBusPortSet(bool_t bus);
+static void    drvExpBusRxParse(uint8_t ch);
+static uint8_t drvExpBusTxFree(void);
+static void    drvExpBusTxEnqueue(uint8_t byte);
+
+
+/******************************************************************************
+ *
+ *  drvExpBusEnable
+ *
+ *  DESCRIPTION:
+ *      This driver API function turns the wired expansion bus on or off.
+ *
+ *  PARAMETERS:
+ *      enable (in) - TRUE to carry expansion bus frames on the port
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      The port is shared with the debug console, which is suppressed while
+ *      the expansion bus is enabled.  The port runs interrupt driven at
+ *      115200 baud for the expansion bus, and polled at 9600 baud for the
+ *      console otherwise.  Any queued or partial frames are discarded.
+ *
+ *****************************************************************************/
+void drvExpBusEnable(bool_t enable)
+{
+    uint8_t i;
+
+    if (enable != drvExpBusEnabled)
+    {
+        EnterCritical();                /* save and disable interrupts */
+        drvExpBusEnabled = enable;
+        for (i = 0; i < DRV_EXPBUS_RX_FRAMES; i++)
+        {
+            drvExpBusRxFrames[i].len = 0;
+        }
+        drvExpBusRxInsert = drvExpBusRxRemove = 0;
+        drvExpBusRxState = DRV_EXPBUS_RX_HUNT;
+        drvExpBusTxInsert = drvExpBusTxRemove = 0;
+        drvExpBusTxActive = FALSE;
+        ExitCritical();                 /* restore interrupts */
+
+        /* let the transmit ISR take any character still buffered */
+        while (hwExpOut_GetCharsInTxBuf() != 0)
+        {
+            ;
+        }
+        drvExpBusPortSet(enable);
+    }
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusRestart
+ *
+ *  DESCRIPTION:
+ *      This driver API function restores the port mode after the hwExpOut
+ *      bean has been (re)enabled.
+ *
+ *  PARAMETERS:
+ *      none
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      This must be called after hwExpOut_Enable(), which sets up the port
+ *      for the expansion bus, at system init and when leaving low-power mode.
+ *
+ *****************************************************************************/
+void drvExpBusRestart(void)
+{
+    drvExpBusPortSet(drvExpBusEnabled);
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusIsEnabled
+ *
+ *  DESCRIPTION:
+ *      This driver API function reports whether the wired expansion bus owns
+ *      the port.
+ *
+ *  PARAMETERS:
+ *      none
+ *
+ *  RETURNS:
+ *      TRUE if the expansion bus is enabled
+ *
+ *****************************************************************************/
+bool_t drvExpBusIsEnabled(void)
+{
+    return drvExpBusEnabled;
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusWrite
+ *
+ *  DESCRIPTION:
+ *      This driver API function adds the framing and CRC to a message and
+ *      copies it to the transmit buffer.  If there is insufficient space in
+ *      the transmit buffer, then nothing is enqueued.
+ *
+ *  PARAMETERS:
+ *      pBuf (in)   - frame body
+ *      length (in) - frame body length (1 to DRV_EXPBUS_MAX_FRAME)
+ *
+ *  RETURNS:
+ *      TRUE if the frame was successfully enqueued for transmission
+ *
+ *  NOTES:
+ *      This can only be invoked from task (non-interrupt) level, due to its
+ *      access to the transmit buffer.
+ *
+ *****************************************************************************/
+bool_t drvExpBusWrite(const void *pBuf, uint8_t length)
+{
+    const uint8_t *pData = (const uint8_t *)pBuf;
+    uint16_t crc;
+    uint8_t i;
+
+    if (!drvExpBusEnabled ||
+        (length == 0) ||
+        (length > DRV_EXPBUS_MAX_FRAME) ||
+        (drvExpBusTxFree() < (length + DRV_EXPBUS_OVERHEAD)))
+    {
+        return FALSE;
+    }
+
+    crc = crc16(pData, length);
+
+    drvExpBusTxEnqueue(DRV_EXPBUS_SOF);
+    drvExpBusTxEnqueue(length);
+    for (i = 0; i < length; i++)
+    {
+        drvExpBusTxEnqueue(pData[i]);
+    }
+    drvExpBusTxEnqueue((uint8_t)(crc >> 8));
+    drvExpBusTxEnqueue((uint8_t)crc);
+    drvExpBusStatTxFrames++;
+
+    /* start transmission if the transmitter is idle */
+    if (!drvExpBusTxActive)
+    {
+        /* enable the line driver */
+        hwExpOutRts_SetVal();
+        drvExpBusRtsOn = TRUE;
+        drvExpBusTxActive = TRUE;
+        drvExpBusOnTxChar();
+    }
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusRead
+ *
+ *  DESCRIPTION:
+ *      This driver API function returns the next complete, valid frame (if
+ *      any) received on the wired expansion bus.
+ *
+ *  PARAMETERS:
+ *      pBuf (out)     - caller's buffer for the frame body
+ *      maxLength (in) - size of caller's buffer
+ *
+ *  RETURNS:
+ *      frame body length, or 0 if no complete frame is available
+ *
+ *  NOTES:
+ *      This can only be invoked from task (non-interrupt) level.  Frames
+ *      larger than the caller's buffer are dropped.
+ *
+ *****************************************************************************/
+uint8_t drvExpBusRead(void *pBuf, uint8_t maxLength)
+{
+    drvExpBusRxFrame_t *pFrame;
+    uint8_t length;
+
+    if (!drvExpBusEnabled)
+    {
+        return 0;
+    }
+
+    for (;;)
+    {
+        pFrame = &drvExpBusRxFrames[drvExpBusRxRemove];
+        length = pFrame->len;
+        if (length == 0)
+        {
+            return 0;
+        }
+        if (length <= maxLength)
+        {
+            memcpy(pBuf, pFrame->body, length);
+        }
+
+        /* hand the element back to the receive ISR */
+        pFrame->len = 0;
+        if (++drvExpBusRxRemove >= DRV_EXPBUS_RX_FRAMES)
+        {
+            drvExpBusRxRemove = 0;
+        }
+
+        if (length <= maxLength)
+        {
+            drvExpBusStatRxFrames++;
+            return length;
+        }
+    }
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusPoll
+ *
+ *  DESCRIPTION:
+ *      This driver API function releases the line driver once the last frame
+ *      has been completely sent.
+ *
+ *  PARAMETERS:
+ *      none
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      This should be called from the main polling loop.  RTS is held until
+ *      the last character has left the shift register.
+ *
+ *****************************************************************************/
+void drvExpBusPoll(void)
+{
+    if (drvExpBusRtsOn && !drvExpBusTxActive && hwExpOut_GetTxComplete())
+    {
+        hwExpOutRts_ClrVal();
+        drvExpBusRtsOn = FALSE;
+    }
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusConsoleGetc
+ *
+ *  DESCRIPTION:
+ *      This driver API function reads a debug console character from the
+ *      port, if one has been received.
+ *
+ *  PARAMETERS:
+ *      pCh (out) - received character
+ *
+ *  RETURNS:
+ *      TRUE if a character was received without error
+ *
+ *  NOTES:
+ *      The port is polled; no characters are received while the expansion
+ *      bus is enabled.
+ *
+ *****************************************************************************/
+bool_t drvExpBusConsoleGetc(uint8_t *pCh)
+{
+    uint8_t stat;
+
+    if (drvExpBusEnabled)
+    {
+        return FALSE;
+    }
+
+    stat = SCI1S1;
+    if ((stat & (SCI1S1_RDRF_MASK | DRV_EXPBUS_SCI_ERR_MASK)) == 0)
+    {
+        return FALSE;
+    }
+
+    /* reading the data register also clears the error flags */
+    *pCh = SCI1D;
+    return ((stat & DRV_EXPBUS_SCI_ERR_MASK) == 0);
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusConsolePutc
+ *
+ *  DESCRIPTION:
+ *      This driver API function writes a debug console character to the
+ *      port, if the transmitter is ready for it.
+ *
+ *  PARAMETERS:
+ *      ch (in) - character to send
+ *
+ *  RETURNS:
+ *      TRUE if the character was sent, FALSE if the transmitter is busy or
+ *      the expansion bus is enabled
+ *
+ *****************************************************************************/
+bool_t drvExpBusConsolePutc(uint8_t ch)
+{
+    if (drvExpBusEnabled || !SCI1S1_TDRE)
+    {
+        return FALSE;
+    }
+
+    SCI1D = ch;
+    return TRUE;
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusConsoleTxBusy
+ *
+ *  DESCRIPTION:
+ *      This driver API function reports whether a debug console character
+ *      is waiting to be sent.
+ *
+ *  PARAMETERS:
+ *      none
+ *
+ *  RETURNS:
+ *      TRUE if the transmit data register is full
+ *
+ *****************************************************************************/
+bool_t drvExpBusConsoleTxBusy(void)
+{
+    return (!drvExpBusEnabled && !SCI1S1_TDRE);
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusPortSet
+ *
+ *  DESCRIPTION:
+ *      This function sets up the SCI for the expansion bus or for the debug
+ *      console.
+ *
+ *  PARAMETERS:
+ *      bus (in) - TRUE for interrupt service at 115200 baud, FALSE for
+ *                 polled operation at 9600 baud
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      The register settings for the expansion bus are the same as those
+ *      made by the hwExpOut bean when it is enabled.  The last character is
+ *      allowed to leave the shift register before the baud rate changes.
+ *
+ *****************************************************************************/
+static void drvExpBusPortSet(bool_t bus)
+{
+    while (SCI1C2_TE && !SCI1S1_TC)
+    {
+        ;
+    }
+
+    EnterCritical();                    /* save and disable interrupts */
+    if (bus)
+    {
+        SCI1BDH = 0x00;
+        SCI1BDL = DRV_EXPBUS_SBR_BUS;
+        (void)SCI1S1;                   /* discard any console character */
+        (void)SCI1D;
+        SCI1C3 |= DRV_EXPBUS_SCI_ERR_IE;
+        SCI1C2 |= (SCI1C2_TE_MASK | SCI1C2_RE_MASK |
+                   SCI1C2_RIE_MASK | SCI1C2_ILIE_MASK);
+    }
+    else
+    {
+        SCI1C3 &= ~DRV_EXPBUS_SCI_ERR_IE;
+        SCI1C2 &= ~(SCI1C2_TIE_MASK | SCI1C2_RIE_MASK | SCI1C2_ILIE_MASK);
+        SCI1BDH = 0x00;
+        SCI1BDL = DRV_EXPBUS_SBR_CONSOLE;
+    }
+    ExitCritical();                     /* restore interrupts */
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusOnRxChar
+ *
+ *  DESCRIPTION:
+ *      This function processes a receive character interrupt by passing the
+ *      received bytes from the UART to the receive frame parser.
+ *
+ *  PARAMETERS:
+ *      none
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      This is invoked from the UART receive character ISR, which only runs
+ *      while the expansion bus is enabled.
+ *
+ *****************************************************************************/
+void drvExpBusOnRxChar(void)
+{
+    uint8_t ch;
+
+    if (!drvExpBusEnabled)
+    {
+        return;
+    }
+
+    while (hwExpOut_GetCharsInRxBuf() != 0)
+    {
+        if (hwExpOut_RecvChar(&ch) == ERR_OK)
+        {
+            drvExpBusRxParse(ch);
+        }
+    }
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusRxParse
+ *
+ *  DESCRIPTION:
+ *      This function runs the receive frame parser on one received byte,
+ *      and places a complete, valid frame in the receive frame queue.
+ *
+ *  PARAMETERS:
+ *      ch (in) - received byte
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      This is invoked from the UART receive character ISR.  The CRC is
+ *      accumulated as the body arrives.  A frame is only started when the
+ *      queue element at the insert index is free; otherwise the frame is
+ *      dropped and counted as an overrun.
+ *
+ *****************************************************************************/
+static void drvExpBusRxParse(uint8_t ch)
+{
+    drvExpBusRxFrame_t *pFrame = &drvExpBusRxFrames[drvExpBusRxInsert];
+    uint32_t now = drvMSGet();
+
+    /* abandon a frame that has stalled */
+    if ((drvExpBusRxState != DRV_EXPBUS_RX_HUNT) &&
+        ((now - drvExpBusRxTime) > DRV_EXPBUS_RX_TIMEOUT))
+    {
+        drvExpBusRxState = DRV_EXPBUS_RX_HUNT;
+        drvExpBusStatRxTimeouts++;
+    }
+    drvExpBusRxTime = now;
+
+    switch (drvExpBusRxState)
+    {
+        case DRV_EXPBUS_RX_HUNT:
+            if (ch == DRV_EXPBUS_SOF)
+            {
+                drvExpBusRxState = DRV_EXPBUS_RX_LEN;
+            }
+            break;
+
+        case DRV_EXPBUS_RX_LEN:
+            if ((ch == 0) || (ch > DRV_EXPBUS_MAX_FRAME))
+            {
+                /* not a frame - resynchronize */
+                drvExpBusRxState = (ch == DRV_EXPBUS_SOF) ?
+                                   DRV_EXPBUS_RX_LEN : DRV_EXPBUS_RX_HUNT;
+            }
+            else if (pFrame->len != 0)
+            {
+                /* frame queue full - drop this frame */
+                drvExpBusStatRxOverruns++;
+                drvExpBusRxState = DRV_EXPBUS_RX_HUNT;
+            }
+            else
+            {
+                drvExpBusRxLen = ch;
+                drvExpBusRxCount = 0;
+                drvExpBusRxCrcCalc = CRC_INIT_VALUE;
+                drvExpBusRxState = DRV_EXPBUS_RX_BODY;
+            }
+            break;
+
+        case DRV_EXPBUS_RX_BODY:
+            pFrame->body[drvExpBusRxCount++] = ch;
+            crcByte(ch, &drvExpBusRxCrcCalc);
+            if (drvExpBusRxCount >= drvExpBusRxLen)
+            {
+                drvExpBusRxState = DRV_EXPBUS_RX_CRC_H;
+            }
+            break;
+
+        case DRV_EXPBUS_RX_CRC_H:
+            drvExpBusRxCrc = (uint16_t)ch << 8;
+            drvExpBusRxState = DRV_EXPBUS_RX_CRC_L;
+            break;
+
+        case DRV_EXPBUS_RX_CRC_L:
+        default:
+            drvExpBusRxCrc |= ch;
+            drvExpBusRxState = DRV_EXPBUS_RX_HUNT;
+            if (drvExpBusRxCrc != drvExpBusRxCrcCalc)
+            {
+                drvExpBusStatRxBadCrc++;
+            }
+            else
+            {
+                /* queue the frame for the task level reader */
+                pFrame->len = drvExpBusRxLen;
+                if (++drvExpBusRxInsert >= DRV_EXPBUS_RX_FRAMES)
+                {
+                    drvExpBusRxInsert = 0;
+                }
+            }
+            break;
+    }
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusOnTxChar
+ *
+ *  DESCRIPTION:
+ *      This function processes a transmit character interrupt by moving the
+ *      next transmit byte from the transmit buffer to the UART, if the buffer
+ *      is not empty.
+ *
+ *  PARAMETERS:
+ *      none
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      This is invoked from the UART transmit character ISR.  It is also used
+ *      from drvExpBusWrite to initiate transmission when a frame is added to
+ *      an idle transmitter.
+ *
+ *****************************************************************************/
+void drvExpBusOnTxChar(void)
+{
+    EnterCritical();                    /* save and disable interrupts */
+
+    if (drvExpBusTxActive && (drvExpBusTxRemove != drvExpBusTxInsert))
+    {
+        (void)hwExpOut_SendChar(drvExpBusTxBuf[drvExpBusTxRemove]);
+        if (++drvExpBusTxRemove >= sizeof(drvExpBusTxBuf))
+        {
+            drvExpBusTxRemove = 0;
+        }
+    }
+    else
+    {
+        /* no data available - mark the transmitter as idle */
+        drvExpBusTxActive = FALSE;
+    }
+
+    ExitCritical();                     /* restore interrupts */
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusTxFree
+ *
+ *  DESCRIPTION:
+ *      This function returns the number of bytes that can be added to the
+ *      transmit buffer.
+ *
+ *  PARAMETERS:
+ *      none
+ *
+ *  RETURNS:
+ *      number of free bytes in the transmit buffer
+ *
+ *****************************************************************************/
+static uint8_t drvExpBusTxFree(void)
+{
+    uint8_t insert = drvExpBusTxInsert;
+    uint8_t remove = drvExpBusTxRemove;
+
+    if (insert >= remove)
+    {
+        return (uint8_t)(sizeof(drvExpBusTxBuf) - 1 - (insert - remove));
+    }
+    return (uint8_t)(remove - insert - 1);
+}
+
+
+/******************************************************************************
+ *
+ *  drvExpBusTxEnqueue
+ *
+ *  DESCRIPTION:
+ *      This function adds a byte to the transmit buffer.
+ *
+ *  PARAMETERS:
+ *      byte (in) - data byte to add
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      The caller must have checked that there is room in the buffer.
+ *
+ *****************************************************************************/
+static void drvExpBusTxEnqueue(uint8_t byte)
+{
+    uint8_t insert = drvExpBusTxInsert;
+
+    drvExpBusTxBuf[insert] = byte;
+    if (++insert >= sizeof(drvExpBusTxBuf))
+    {
+        insert = 0;
+    }
+    drvExpBusTxInsert = insert;
+}
+
+
+/* END drvExpBus */
@@ -0,0 +1,59 @@
+/******************************************************************************
+ *                       Copyright (c) 2008, Jabil Circuit
+ *
+ * This source code and any compilation or derivative thereof is the sole
+ * property of Jabil Circuit and is provided pursuant to a Software License
+ * Agreement.  This code is the proprietary information of Jabil Circuit and
+ * is confidential in nature.  Its use and dissemination by any party other
+ * than Jabil Circuit is strictly limited by the confidential information
+ * provisions of the Software License Agreement referenced above.
+ *
+ ******************************************************************************
+ *
+ * Project      : WaterOptimizer Irrigation System (WOIS)
+ * Organization : WaterOptimizer, LLC
+ * Module       : drvExpBus.h
+ * Description  : This file declares the interface to the wired expansion
+ *                bus serial port driver.
+ *
+ *****************************************************************************/
+
+#ifndef __drvExpBus_H
+#define __drvExpBus_H
+
+/* MODULE drvExpBus */
+
+
+/*
+ * Application Interface
+ */
+
+#define DRV_EXPBUS_MAX_FRAME    96      /* max frame body size in bytes */
+
+void    drvExpBusEnable(bool_t enable);
+void    drvExpBusRestart(void);
+bool_t  drvExpBusIsEnabled(void);
+bool_t  drvExpBusWrite(const void *pBuf, uint8_t length);
+uint8_t drvExpBusRead(void *pBuf, uint8_t maxLength);
+void    drvExpBusPoll(void);
+
+/* Debug console (while the expansion bus is disabled) */
+bool_t  drvExpBusConsoleGetc(uint8_t *pCh);
+bool_t  drvExpBusConsolePutc(uint8_t ch);
+bool_t  drvExpBusConsoleTxBusy(void);
+
+/* UART event handlers */
+void    drvExpBusOnRxChar(void);
+void    drvExpBusOnTxChar(void);
+
+/* Statistics */
+extern uint32_t drvExpBusStatRxFrames;
+extern uint32_t drvExpBusStatRxBadCrc;
+extern uint32_t drvExpBusStatRxTimeouts;
+extern uint32_t drvExpBusStatRxOverruns;
+extern uint32_t drvExpBusStatTxFrames;
+
+
+/* END drvExpBus */
+
+#endif
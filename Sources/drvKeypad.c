@@ -28,6 +28,7 @@
 #include "hwNav.h"
 
 #include "drvKeypad.h"
+#include "drvRtc.h"
 
 
 /* non-tuneable parameters for keypad driver (based on hardware) */
@@ -36,7 +37,7 @@
 #define DRV_KEYPAD_N_ALLKEYS    (DRV_KEYPAD_N_FUNCKEYS + DRV_KEYPAD_N_SOFTKEYS)
 
 /* tuneable parameters for keypad driver */
-#define DRV_KEYPAD_QUEUE_SIZE       48U
+#define DRV_KEYPAD_QUEUE_SIZE       16U     /* dial turns coalesce */
 #define DRV_KEYPAD_ALT_FUNC_DELAY   100U    /* 100 ticks = 2000ms */
 #define DRV_KEYPAD_SOFT_RPT_DELAY_S 30U     /* 30 ticks = 600ms */
 #define DRV_KEYPAD_SOFT_RPT_DELAY_F 230U    /* 230 ticks = 4600ms */
@@ -47,6 +48,14 @@
 #define DRV_KEYPAD_NAV_TURN_INC     10
 #define DRV_KEYPAD_NAV_MAX_TURNS    10
 
+/*
+ * Nav-dial acceleration: each same-direction detent arriving within
+ * DRV_KEYPAD_NAV_ACCEL_MS of the previous one raises the dial speed, and
+ * every DRV_KEYPAD_NAV_TURN_INC speed units add one step per detent.
+ */
+#define DRV_KEYPAD_NAV_ACCEL_MS     60U
+#define DRV_KEYPAD_NAV_MAX_SPEED    (3 * DRV_KEYPAD_NAV_TURN_INC)
+
 enum drvKeypadNavStates
 {
     IDLE = 0,
@@ -221,7 +230,7 @@ static const uint8_t drvKeypadNavFsmEdges[NSTATES][NINPUTS] =
     },
 };
 
-static uint8_t drvKeypadQueue[DRV_KEYPAD_QUEUE_SIZE];
+static drvKeypadEvent_t drvKeypadQueue[DRV_KEYPAD_QUEUE_SIZE];
 static uint8_t drvKeypadQueueInsert = 0U;
 static uint8_t drvKeypadQueueRemove = 0U;
 
@@ -232,6 +241,12 @@ static uint8_t  drvKeypadSoftKeyRptCnt[DRV_KEYPAD_N_SOFTKEYS];
 static uint8_t drvKeypadNavState = 0U;
 static uint8_t drvKeypadNavCcwTurns = 0U;
 static uint8_t drvKeypadNavCwTurns = 0U;
+static uint8_t drvKeypadNavSpeed = 0U;
+static uint8_t drvKeypadNavLastKey = DRV_KEYPAD_TYPE_NONE;
+static uint16_t drvKeypadNavLastTime = 0U;
+
+static void drvKeypadEnqueue(uint8_t key, uint8_t steps);
+static uint8_t drvKeypadNavSteps(uint8_t key);
 
 
 /******************************************************************************
@@ -251,24 +266,77 @@ static uint8_t drvKeypadNavCwTurns = 0U;
  *  NOTES:
  *      This can be invoked from any context but it is NOT reentrant.
  *
+ *      A coalesced nav-dial event is returned once per step.
+ *
  *****************************************************************************/
 uint8_t drvKeypadGet(void)
 {
     uint8_t key = DRV_KEYPAD_TYPE_NONE;
 
+    EnterCritical();                    /* save and disable interrupts */
+
     if (drvKeypadQueueRemove != drvKeypadQueueInsert)
     {
-        key = drvKeypadQueue[drvKeypadQueueRemove];
-        if (++drvKeypadQueueRemove >= DRV_KEYPAD_QUEUE_SIZE)
+        drvKeypadEvent_t *pEntry = &drvKeypadQueue[drvKeypadQueueRemove];
+
+        key = pEntry->key;
+        if (pEntry->count > 1)
+        {
+            pEntry->count--;
+        }
+        else if (++drvKeypadQueueRemove >= DRV_KEYPAD_QUEUE_SIZE)
         {
             drvKeypadQueueRemove = 0;
         }
     }
 
+    ExitCritical();                     /* restore interrupts */
+
     return key;
 }
 
 
+/******************************************************************************
+ *
+ *  drvKeypadGetEvent
+ *
+ *  DESCRIPTION:
+ *      This driver API function polls the keypad event queue and returns the
+ *      oldest event (if any) in the queue, including its step count and
+ *      timestamp.
+ *
+ *  PARAMETERS:
+ *      pEvent (out) - event removed from the queue
+ *
+ *  RETURNS:
+ *      TRUE if an event was returned, FALSE if the queue is empty
+ *
+ *  NOTES:
+ *      This can be invoked from any context but it is NOT reentrant.
+ *
+ *****************************************************************************/
+bool_t drvKeypadGetEvent(drvKeypadEvent_t *pEvent)
+{
+    bool_t found = FALSE;
+
+    EnterCritical();                    /* save and disable interrupts */
+
+    if (drvKeypadQueueRemove != drvKeypadQueueInsert)
+    {
+        *pEvent = drvKeypadQueue[drvKeypadQueueRemove];
+        if (++drvKeypadQueueRemove >= DRV_KEYPAD_QUEUE_SIZE)
+        {
+            drvKeypadQueueRemove = 0;
+        }
+        found = TRUE;
+    }
+
+    ExitCritical();                     /* restore interrupts */
+
+    return found;
+}
+
+
 /******************************************************************************
  *
  *  drvKeypadPut
@@ -291,19 +359,107 @@ uint8_t drvKeypadGet(void)
  *****************************************************************************/
 void drvKeypadPut(uint8_t key)
 {
+    drvKeypadEnqueue(key, 1);
+}
+
+
+/******************************************************************************
+ *
+ *  drvKeypadEnqueue
+ *
+ *  DESCRIPTION:
+ *      This driver internal function adds steps of a keypad event to the
+ *      event queue.  A nav-dial event is merged into the newest queued event
+ *      when that is a turn in the same direction.
+ *
+ *  PARAMETERS:
+ *      key (in) - event code to add to the queue
+ *      steps (in) - number of steps the event represents
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      This can be invoked from any context (and it is reentrant).
+ *
+ *****************************************************************************/
+static void drvKeypadEnqueue(uint8_t key, uint8_t steps)
+{
+    uint16_t now = (uint16_t)drvMSGet();
+    drvKeypadEvent_t *pLast;
+
     EnterCritical();                    /* save and disable interrupts */
 
-    /* NOTE: adding to a full queue yields an empty queue */
-    drvKeypadQueue[drvKeypadQueueInsert] = key;
-    if (++drvKeypadQueueInsert >= DRV_KEYPAD_QUEUE_SIZE)
+    pLast = &drvKeypadQueue[(drvKeypadQueueInsert == 0) ?
+                            (DRV_KEYPAD_QUEUE_SIZE - 1) :
+                            (drvKeypadQueueInsert - 1)];
+
+    if ((drvKeypadQueueRemove != drvKeypadQueueInsert) &&
+        ((key & DRV_KEYPAD_TYPE_MASK) == DRV_KEYPAD_TYPE_NAV) &&
+        (pLast->key == key) &&
+        ((uint16_t)pLast->count + steps <= 255U))
+    {
+        /* coalesce with the pending same-direction dial turn */
+        pLast->count += steps;
+        pLast->time = now;
+    }
+    else
     {
-        drvKeypadQueueInsert = 0;
+        /* NOTE: adding to a full queue yields an empty queue */
+        drvKeypadQueue[drvKeypadQueueInsert].key = key;
+        drvKeypadQueue[drvKeypadQueueInsert].count = steps;
+        drvKeypadQueue[drvKeypadQueueInsert].time = now;
+        if (++drvKeypadQueueInsert >= DRV_KEYPAD_QUEUE_SIZE)
+        {
+            drvKeypadQueueInsert = 0;
+        }
     }
 
     ExitCritical();                     /* restore interrupts */
 }
 
 
+/******************************************************************************
+ *
+ *  drvKeypadNavSteps
+ *
+ *  DESCRIPTION:
+ *      This driver internal function applies nav-dial acceleration, returning
+ *      the number of steps a detent in the given direction is worth.
+ *
+ *  PARAMETERS:
+ *      key (in) - nav-dial event code (DRV_KEYPAD_KEY_NAV_CW/CCW)
+ *
+ *  RETURNS:
+ *      number of steps (1 when the dial is turned slowly)
+ *
+ *  NOTES:
+ *      This is called from the nav timer ISR.
+ *
+ *****************************************************************************/
+static uint8_t drvKeypadNavSteps(uint8_t key)
+{
+    uint16_t now = (uint16_t)drvMSGet();
+
+    if ((key == drvKeypadNavLastKey) &&
+        ((uint16_t)(now - drvKeypadNavLastTime) < DRV_KEYPAD_NAV_ACCEL_MS))
+    {
+        if (drvKeypadNavSpeed < DRV_KEYPAD_NAV_MAX_SPEED)
+        {
+            drvKeypadNavSpeed++;
+        }
+    }
+    else
+    {
+        drvKeypadNavSpeed = 0;
+    }
+    drvKeypadNavLastKey = key;
+    drvKeypadNavLastTime = now;
+
+    return (uint8_t)(1 + (drvKeypadNavSpeed / DRV_KEYPAD_NAV_TURN_INC));
+}
+
+
 /******************************************************************************
  *
  *  drvKeypadSwitchIsr
@@ -521,7 +677,8 @@ void drvKeypadNavIsr(void)
         {
             case ENQ_CW:
                 /* add clockwise nav dial turn event to queue */
-                drvKeypadPut(DRV_KEYPAD_KEY_NAV_CW);
+                drvKeypadEnqueue(DRV_KEYPAD_KEY_NAV_CW,
+                                 drvKeypadNavSteps(DRV_KEYPAD_KEY_NAV_CW));
                 /* FALL THROUGH */
             case BIAS_CW:
                 /* Increment the drvKeypadNavTurns variable IF the opposite
@@ -536,7 +693,8 @@ void drvKeypadNavIsr(void)
                 break;
             case ENQ_CCW:
                 /* add counter-clockwise nav dial turn event to queue */
-                drvKeypadPut(DRV_KEYPAD_KEY_NAV_CCW);
+                drvKeypadEnqueue(DRV_KEYPAD_KEY_NAV_CCW,
+                                 drvKeypadNavSteps(DRV_KEYPAD_KEY_NAV_CCW));
                 /* FALL THROUGH */
             case BIAS_CCW:
                 /* Increment the drvKeypadNavTurns variable IF the opposite
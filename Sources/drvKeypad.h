@@ -54,7 +54,16 @@
 #define DRV_KEYPAD_KEY_NAV_CW       (DRV_KEYPAD_TYPE_NAV       | 0x00)
 #define DRV_KEYPAD_KEY_NAV_CCW      (DRV_KEYPAD_TYPE_NAV       | 0x01)
 
+/* Keypad event, as queued (consecutive same-direction dial turns coalesce) */
+typedef struct
+{
+    uint8_t  key;                       /* event code (DRV_KEYPAD_KEY_xxx) */
+    uint8_t  count;                     /* steps (1 for pushbutton events) */
+    uint16_t time;                      /* drvMSGet() of latest step, low 16 */
+} drvKeypadEvent_t;
+
 uint8_t drvKeypadGet(void);
+bool_t  drvKeypadGetEvent(drvKeypadEvent_t *pEvent);
 void    drvKeypadPut(uint8_t key);
 
 
@@ -93,6 +93,7 @@ static uint16_t drvRadioTxRemove = 0;
 /* TX/RX state flags */
 static bool_t drvRadioTxActive = FALSE;
 static bool_t drvRadioRtsState;
+static bool_t drvRadioRxInjectLast = FALSE; /* last Rx bytes were injected */
 
 /* Statistics */
 uint32_t drvRadioStatRxBytes        = 0;
@@ -506,6 +507,7 @@ void drvRadioReadFlush(void)
     EnterCritical();                    /* save and disable interrupts */
     drvRadioRxInsert = 0;
     drvRadioRxRemove = 0;
+    drvRadioRxInjectLast = FALSE;
     drvRadioRts(TRUE);
     ExitCritical();                     /* restore interrupts */
 
@@ -521,7 +523,8 @@ void drvRadioReadFlush(void)
  *      This internal function adds a byte to the end of the receive buffer.
  *      The byte is discarded if the buffer is already full.  The RTS flow
  *      control signal is deasserted to throttle the radio if the buffer has
- *      reached its high-water threshold.
+ *      reached its high-water threshold.  The buffer no longer ends with an
+ *      injected frame.
  *
  *  PARAMETERS:
  *      byte (in) - data byte to enqueue
@@ -538,6 +541,8 @@ static void drvRadioRxEnqueue(uint8_t byte)
 {
     uint16_t newInsert;
 
+    drvRadioRxInjectLast = FALSE;
+
     /* compute updated insert pointer for overflow check */
     newInsert = drvRadioRxInsert + 1;
     if (newInsert >= sizeof(drvRadioRxBuf))
@@ -724,6 +729,60 @@ void drvRadioOnRxChar(void)
 }
 
 
+/******************************************************************************
+ *
+ *  drvRadioRxInject
+ *
+ *  DESCRIPTION:
+ *      This radio serial port driver API function places a radio API frame
+ *      in the receive buffer as if it had been received from the radio.  It
+ *      adds the message framing and checksum bytes.  If the frame cannot be
+ *      placed between whole frames, or there is insufficient space in the
+ *      receive buffer, then nothing is enqueued.
+ *
+ *  PARAMETERS:
+ *      pBuf (in)   - buffer containing the radio API frame to inject
+ *      length (in) - length of the frame (not including framing)
+ *
+ *  RETURNS:
+ *      TRUE if the frame was successfully enqueued
+ *
+ *  NOTES:
+ *      This is used to replay recorded or generated radio traffic through
+ *      the same receive path as the UART.  The receive buffer is shared with
+ *      the UART receive ISR, so a frame is only injected when the buffer is
+ *      empty or ends with a previously injected frame; it is never placed
+ *      inside a partly received radio frame.  The caller must read the
+ *      buffer empty before injecting again once real radio bytes arrive.
+ *      Space is only used up to the RTS flow control threshold.
+ *
+ *****************************************************************************/
+bool_t drvRadioRxInject(const void *pBuf, uint16_t length)
+{
+    const uint8_t *pByte = (const uint8_t *)pBuf;
+    bool_t result = FALSE;
+
+    EnterCritical();                    /* save and disable interrupts */
+    if (((drvRadioRxBufCount() == 0) || drvRadioRxInjectLast) &&
+        ((drvRadioRxBufCount() + 1 + 2 + length + 1) < DRV_RADIO_RX_THRESH_HI))
+    {
+        drvRadioRxEnqueue(0x7E);
+        drvRadioRxEnqueue(0x00);
+        drvRadioRxEnqueue(length & 0xFF);
+        for (int i = 0; i < length; i++)
+        {
+            drvRadioRxEnqueue(pByte[i]);
+        }
+        drvRadioRxEnqueue(drvRadioCalcChecksum(pByte, length));
+        drvRadioRxInjectLast = TRUE;
+        result = TRUE;
+    }
+    ExitCritical();                     /* restore interrupts */
+
+    return result;
+}
+
+
 
 /*====== Radio transmit circular buffer routines ============================*/
 
@@ -39,6 +39,7 @@ bool_t  drvRadioCts(void);
 int16_t drvRadioRead(void *pBuf, uint16_t length);
 bool_t  drvRadioWrite(const void *pBuf, uint16_t length);
 void    drvRadioReadFlush(void);
+bool_t  drvRadioRxInject(const void *pBuf, uint16_t length);
 void    drvRadioWriteFlush(void);
 void drvRadioTxEnqueue(uint8_t byte);
 void drvRadioTxStart(void);
@@ -32,7 +32,10 @@
 
 
 static uint16_t drvSolenoidActual = 0;
-static uint16_t drvSolenoidTarget = 0;
+static volatile uint16_t drvSolenoidTarget = 0;
+static uint8_t  drvSolenoidInrushTicks =
+    (DRV_SOLENOID_INRUSH_MS + DRV_SOLENOID_TICK_MS - 1) / DRV_SOLENOID_TICK_MS;
+static uint8_t  drvSolenoidHoldoff = 0;    /* ticks before next turn-on */
 
 
 /******************************************************************************
@@ -42,10 +45,9 @@ static uint16_t drvSolenoidTarget = 0;
  *  DESCRIPTION:
  *      This driver API function sets/clears the target solenoid state for a
  *      specified zone or master valve solenoid.  Zone solenoids are numbered
- *      1..12.  A value of 0 represents the master valve.  Application logic
- *      should insure that no more than one zone solenoid is activated at any
- *      one time, 
- *      the master valve solenoid is on whenever running an irrigation program
+ *      1..12.  A value of 0 represents the master valve.  Turning a zone on
+ *      turns every other zone off, and the master valve is kept on unless it
+ *      is specifically turned off (which turns everything off).
  *
  *  PARAMETERS:
  *      zone (in)  - Value (0..12, master + 12 solenoids) of solenoid to activate/deactivate.
@@ -56,28 +58,18 @@ static uint16_t drvSolenoidTarget = 0;
  *
  *  NOTES:
  *      This can be invoked from any context, but it is not reentrant.
+ *      Use drvSolenoidSetMask to run more than one zone at a time.
  *
  *****************************************************************************/
 void drvSolenoidSet(uint8_t zone, bool_t state)
 {
-    //everything is already off since;
-    // a. there can only be one solenoid on at a time
-    // b. the master solenoid should be on unless specifically commanded to turn off
-    drvSolenoidTarget = 0x0001;
-
-    if(TRUE == state) 
+    if (state)
     {
-		      drvSolenoidTarget |= (1 << zone);
+        drvSolenoidSetMask(0x0001 | (1 << zone));
     }
     else
     {
-        //everything is already off nothing to do;
-        
-        if(zone == 0)
-		    {
-		      //master off...everything off
-		      drvSolenoidTarget = 0;
-		    }
+        drvSolenoidSetMask((zone == 0) ? 0 : 0x0001);
     }
 }
 
@@ -107,19 +99,103 @@ bool_t drvSolenoidGet(uint8_t zone)
 }
 
 
+/******************************************************************************
+ *
+ *  drvSolenoidSetMask
+ *
+ *  DESCRIPTION:
+ *      This driver API function sets the target state of all solenoids at
+ *      once.  Bit 0 is the master valve and bits 1..12 are zones 1..12.
+ *
+ *  PARAMETERS:
+ *      mask (in) - solenoids to be activated (others are deactivated)
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      This can be invoked from any context.  The outputs follow the target
+ *      state from the solenoid ISR, with turn-ons staggered by the inrush
+ *      delay so that several valves can be run from the 24VAC supply.
+ *
+ *****************************************************************************/
+void drvSolenoidSetMask(uint16_t mask)
+{
+    drvSolenoidTarget = mask & DRV_SOLENOID_MASK_ALL;
+}
+
+
+/******************************************************************************
+ *
+ *  drvSolenoidGetMask
+ *
+ *  DESCRIPTION:
+ *      This driver API function reports the target state of all solenoids.
+ *
+ *  PARAMETERS:
+ *      none
+ *
+ *  RETURNS:
+ *      target solenoid mask (bit 0 = master, bits 1..12 = zones 1..12)
+ *
+ *  NOTES:
+ *      This can be invoked from any context.
+ *
+ *****************************************************************************/
+uint16_t drvSolenoidGetMask(void)
+{
+    return drvSolenoidTarget;
+}
+
+
+/******************************************************************************
+ *
+ *  drvSolenoidInrushSet
+ *
+ *  DESCRIPTION:
+ *      This driver API function sets the minimum time between turning on one
+ *      solenoid and turning on the next, which lets each valve's inrush
+ *      current settle before the next one adds to it.
+ *
+ *  PARAMETERS:
+ *      ms (in) - turn-on stagger in milliseconds (0 = driver default)
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      The delay is rounded up to whole solenoid ISR ticks, with a minimum
+ *      of one tick.
+ *
+ *****************************************************************************/
+void drvSolenoidInrushSet(uint16_t ms)
+{
+    uint16_t ticks;
+
+    if (ms == 0)
+    {
+        ms = DRV_SOLENOID_INRUSH_MS;
+    }
+    ticks = (ms + DRV_SOLENOID_TICK_MS - 1) / DRV_SOLENOID_TICK_MS;
+
+    drvSolenoidInrushTicks = (ticks > 255) ? 255 : (uint8_t)ticks;
+}
+
+
 /******************************************************************************
  *
  *  drvSolenoidIsr
  *
  *  DESCRIPTION:
  *      This internal driver function updates the actual state of the solenoid
- *      outputs to match the application-specified target state.  At most one
- *      solenoid output will be changed on each call.  Turning outputs off is
- *      favored over turning outputs on.  It is called periodically from a
- *      20mS timer interrupt.  This mechanism limits the electrical current
- *      demands due to solenoid switching.  It also allows time for one zone's
- *      TRIAC to turn off (at the next 24VAC zero-crossing) before turning on
- *      another zone's TRIAC.
+ *      outputs to match the application-specified target state.  It is
+ *      called periodically from a 20mS timer interrupt.  All pending
+ *      turn-offs are made together; turning outputs off is favored over
+ *      turning outputs on.  At most one solenoid is turned on per call, and
+ *      only once the inrush delay since the previous turn-on has passed.
+ *      This limits the electrical current demands due to solenoid switching.
+ *      It also allows time for one zone's TRIAC to turn off (at the next
+ *      24VAC zero-crossing) before turning on another zone's TRIAC.
  *
  *  PARAMETERS:
  *      none
@@ -128,62 +204,70 @@ bool_t drvSolenoidGet(uint8_t zone)
  *      none
  *
  *  NOTES:
- *      This is invoked from a timer ISR.
+ *      This is invoked from a timer ISR.  Only the output latches whose
+ *      solenoid bits changed are rewritten.
  *
  *****************************************************************************/
 void drvSolenoidIsr(void)
 {
-    uint16_t off = (drvSolenoidActual ^ drvSolenoidTarget) & ~drvSolenoidTarget;
-    uint16_t on  = (drvSolenoidActual ^ drvSolenoidTarget) & drvSolenoidTarget;
+    uint16_t target = drvSolenoidTarget;
+    uint16_t off = drvSolenoidActual & ~target;
+    uint16_t on  = target & ~drvSolenoidActual;
+    uint16_t changed;
+
+    if (drvSolenoidHoldoff != 0)
+    {
+        drvSolenoidHoldoff--;
+    }
 
-    /* turn-off events take priority over turn-on events */
     if (off != 0)
     {
-        /* at least one solenoid to turn off - select lowest numbered one */
-        for (int i = 0; i < 13; i++)
-        {
-            if ((off & (1 << i)) != 0)
-            {
-                drvSolenoidActual &= ~(1 << i);
-                break;
-            }
-        }
+        /* turn-off events take priority - make them all now */
+        changed = off;
     }
-    else if (on != 0)
+    else if ((on != 0) && (drvSolenoidHoldoff == 0))
     {
-        /* at least one solenoid to turn on - select lowest numbered one */
-        for (int i = 0; i < 13; i++)
-        {
-            if ((on & (1 << i)) != 0)
-            {
-                drvSolenoidActual |= (1 << i);
-                break;
-            }
-        }
+        /* turn on the lowest numbered pending solenoid */
+        changed = (uint16_t)(1 << drvBitCtz(on));
+        drvSolenoidHoldoff = drvSolenoidInrushTicks;
     }
     else
     {
         return;
     }
 
-    /* update solenoid output latches and 24VAC power control */
+    drvSolenoidActual ^= changed;
+
+    /* update changed solenoid output latches and 24VAC power control */
 
     EnterCritical();                    /* save and disable interrupts */
 
-    drvLatch1 = (uint8_t)(drvSolenoidActual >> 1);
-    hwBusData_PutVal(drvLatch1);
-    hwBusLatch1_SetVal();
-    hwBusLatch1_ClrVal();
+    if ((changed & 0x01FE) != 0)
+    {
+        /* zones 1..8 */
+        drvLatch1 = (uint8_t)(drvSolenoidActual >> 1);
+        hwBusData_PutVal(drvLatch1);
+        hwBusLatch1_SetVal();
+        hwBusLatch1_ClrVal();
+    }
 
-    drvLatch2 = (uint8_t)((drvLatch2 & ~0x0F) | ((drvSolenoidActual >> 9) & 0x0F));
-    hwBusData_PutVal(drvLatch2);
-    hwBusLatch2_SetVal();
-    hwBusLatch2_ClrVal();
+    if ((changed & 0x1E00) != 0)
+    {
+        /* zones 9..12 */
+        drvLatch2 = (uint8_t)((drvLatch2 & ~0x0F) | ((drvSolenoidActual >> 9) & 0x0F));
+        hwBusData_PutVal(drvLatch2);
+        hwBusLatch2_SetVal();
+        hwBusLatch2_ClrVal();
+    }
 
-    drvLatch3 = (uint8_t)((drvLatch3 & ~0x01) | (drvSolenoidActual & 0x01));
-    hwBusData_PutVal(drvLatch3);
-    hwBusLatch3_SetVal();
-    hwBusLatch3_ClrVal();
+    if ((changed & 0x0001) != 0)
+    {
+        /* master valve */
+        drvLatch3 = (uint8_t)((drvLatch3 & ~0x01) | (drvSolenoidActual & 0x01));
+        hwBusData_PutVal(drvLatch3);
+        hwBusLatch3_SetVal();
+        hwBusLatch3_ClrVal();
+    }
 
     /* enable 24VAC power if and only if any solenoid is activated */
     hwPower24vacControl_PutVal((drvSolenoidActual != 0) ? 1 : 0);
@@ -27,8 +27,15 @@
  * Application Interface
  */
 
-void   drvSolenoidSet(uint8_t zone, bool_t state);
-bool_t drvSolenoidGet(uint8_t zone);
+#define DRV_SOLENOID_MASK_ALL   0x1FFF  /* master (bit 0) + zones 1..12 */
+#define DRV_SOLENOID_TICK_MS    20      /* solenoid ISR period */
+#define DRV_SOLENOID_INRUSH_MS  100     /* default turn-on stagger */
+
+void     drvSolenoidSet(uint8_t zone, bool_t state);
+bool_t   drvSolenoidGet(uint8_t zone);
+void     drvSolenoidSetMask(uint16_t mask);
+uint16_t drvSolenoidGetMask(void);
+void     drvSolenoidInrushSet(uint16_t ms);
 
 
 /*
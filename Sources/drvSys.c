@@ -27,6 +27,7 @@
 #include "drv.h"
 #include "drvCts.h"
 #include "drvEeprom.h"
+#include "drvExpBus.h"
 #include "drvKeypad.h"
 #include "drvLcd.h"
 #include "drvMoist.h"
@@ -67,6 +68,17 @@
 
 static uint8_t drvSysSaveLed = 0x00;    /* saved state of status LEDs */
 
+/*
+ * RAM section bounds from the linker command file.  The startup code paints
+ * the stack from __SP_END up to the initial SP with DRV_SYS_STACK_PAINT.
+ */
+#define DRV_SYS_STACK_PAINT     0xA5A5A5A5UL    /* must match startcf.c */
+
+extern uint8_t far __DATA_RAM[], __DATA_END[];
+extern uint8_t far __BSS_START[], __BSS_END[];
+extern uint8_t far __HEAP_START[], __HEAP_END[];
+extern uint8_t far __SP_END[], __SP_INIT[];
+
 
 /******************************************************************************
  *
@@ -121,6 +133,49 @@ bool_t drvSys24vacOk(void)
 }
 
 
+/******************************************************************************
+ *
+ *  drvSysRamGet
+ *
+ *  DESCRIPTION:
+ *      This driver API function reports how the 8 KB of RAM is used: the
+ *      static data sections, the heap and stack reserves, and the deepest
+ *      stack use since reset.
+ *
+ *  PARAMETERS:
+ *      pRam (out) - RAM usage report
+ *
+ *  RETURNS:
+ *      none
+ *
+ *  NOTES:
+ *      This can be invoked from any context.  The stack high-water mark is
+ *      found by scanning up from the stack limit for the first word that no
+ *      longer holds the paint pattern written at startup, so it is exact
+ *      unless a stack frame happened to store the pattern itself.
+ *
+ *      Per-module static RAM use is summarized from the linker map (.xMAP)
+ *      file on the host by Project_Settings/Linker_Files/xmapRam.py.
+ *
+ *****************************************************************************/
+void drvSysRamGet(drvSysRam_t *pRam)
+{
+    const uint32_t *pWord = (const uint32_t *)__SP_END;
+
+    while ((pWord < (const uint32_t *)__SP_INIT) &&
+           (*pWord == DRV_SYS_STACK_PAINT))
+    {
+        pWord++;
+    }
+
+    pRam->data = (uint16_t)(__DATA_END - __DATA_RAM);
+    pRam->bss = (uint16_t)(__BSS_END - __BSS_START);
+    pRam->heap = (uint16_t)(__HEAP_END - __HEAP_START);
+    pRam->stack = (uint16_t)(__SP_INIT - __SP_END);
+    pRam->stackUsed = (uint16_t)(__SP_INIT - (const uint8_t *)pWord);
+}
+
+
 /******************************************************************************
  *
  *  drvSysStart
@@ -267,6 +322,7 @@ void drvSysRestart(void)
     hwSpi_Enable();
     hwExpIn_Enable();
     hwExpOut_Enable();
+    drvExpBusRestart();                 /* reapply expansion bus/console mode */
     drvMoistRestart();
 
     /* now we can (re)initialize the radio module */
@@ -43,6 +43,18 @@ void    drvSysWatchDogClear(void);
 
 uint8_t drvSysResetReason(void);
 
+/* RAM usage, in bytes */
+typedef struct
+{
+    uint16_t data;                      /* initialized static data */
+    uint16_t bss;                       /* zero-initialized static data */
+    uint16_t heap;                      /* heap reserve */
+    uint16_t stack;                     /* stack reserve */
+    uint16_t stackUsed;                 /* stack high-water mark */
+} drvSysRam_t;
+
+void    drvSysRamGet(drvSysRam_t *pRam);
+
 void drvProcessorReboot(void);
 /*
  * Internal Driver Interfaces
@@ -0,0 +1,285 @@
+/******************************************************************************
+ *                       Copyright (c) 2008, Jabil Circuit
+ *
+ * This source code and any compilation or derivative thereof is the sole
+ * property of Jabil Circuit and is provided pursuant to a Software License
+ * Agreement.  This code is the proprietary information of Jabil Circuit and
+ * is confidential in nature.  Its use and dissemination by any party other
+ * than Jabil Circuit is strictly limited by the confidential information
+ * provisions of the Software License Agreement referenced above.
+ *
+ ******************************************************************************
+ *
+ * Project      : WaterOptimizer Irrigation System (WOIS)
+ * Organization : WaterOptimizer, LLC
+ * Module       : format.c
+ * Description  : This file implements the integer text formatting utility
+ *
+ *****************************************************************************/
+
+/* Used for building in Windows environment. */
+#include "stdafx.h"
+
+#include "global.h"
+#include "format.h"
+
+
+/******************************************************************************
+ *
+ *  FORMAT IMPLEMENTATION VALUES
+ *
+ *****************************************************************************/
+
+#define FMT_DIGITS_MAX      10          /* digits in largest uint32_t */
+
+static const char fmtHexDigits[] = "0123456789ABCDEF";
+
+
+/******************************************************************************
+ *
+ * FUNCTION NAME
+ *      fmtDigits
+ *
+ * PURPOSE
+ *      This routine converts an unsigned value to decimal digits.
+ *
+ * PARAMETERS
+ *      OUT pDigits     buffer for digits (FMT_DIGITS_MAX chars), stored
+ *                      least significant digit first
+ *      IN  value       value to convert
+ *
+ * RETURN VALUE
+ *      This routine returns the number of digits (at least 1).
+ *
+ *****************************************************************************/
+static uint8_t fmtDigits(char *pDigits, uint32_t value)
+{
+    uint8_t n = 0;
+
+    do
+    {
+        pDigits[n++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    return n;
+}
+
+
+/******************************************************************************
+ *
+ * FUNCTION NAME
+ *      fmtStr
+ *
+ * PURPOSE
+ *      This routine copies a string, like sprintf "%.Ns".
+ *
+ * PARAMETERS
+ *      OUT pBuf        output position
+ *      IN  pStr        string to copy
+ *      IN  maxLen      maximum characters to copy (0 = no limit)
+ *
+ * RETURN VALUE
+ *      This routine returns a pointer past the last character written.
+ *
+ *****************************************************************************/
+char *fmtStr(char *pBuf, const char *pStr, uint8_t maxLen)
+{
+    uint8_t n = 0;
+
+    while ((*pStr != '\0') && ((maxLen == 0) || (n < maxLen)))
+    {
+        *pBuf++ = *pStr++;
+        n++;
+    }
+
+    return pBuf;
+}
+
+
+/******************************************************************************
+ *
+ * FUNCTION NAME
+ *      fmtUint
+ *
+ * PURPOSE
+ *      This routine writes an unsigned decimal value, like sprintf "%Nu"
+ *      (pad ' ') or "%0Nu" (pad '0').
+ *
+ * PARAMETERS
+ *      OUT pBuf        output position
+ *      IN  value       value to write
+ *      IN  width       minimum field width (0 = no padding)
+ *      IN  pad         pad character
+ *
+ * RETURN VALUE
+ *      This routine returns a pointer past the last character written.
+ *
+ *****************************************************************************/
+char *fmtUint(char *pBuf, uint32_t value, uint8_t width, char pad)
+{
+    char digits[FMT_DIGITS_MAX];
+    uint8_t n = fmtDigits(digits, value);
+
+    while (width > n)
+    {
+        *pBuf++ = pad;
+        width--;
+    }
+    while (n > 0)
+    {
+        *pBuf++ = digits[--n];
+    }
+
+    return pBuf;
+}
+
+
+/******************************************************************************
+ *
+ * FUNCTION NAME
+ *      fmtInt
+ *
+ * PURPOSE
+ *      This routine writes a signed decimal value, like sprintf "%Nd"
+ *      (pad ' ') or "%0Nd" (pad '0').
+ *
+ * PARAMETERS
+ *      OUT pBuf        output position
+ *      IN  value       value to write
+ *      IN  width       minimum field width, including any sign
+ *      IN  pad         pad character
+ *
+ * RETURN VALUE
+ *      This routine returns a pointer past the last character written.
+ *
+ *****************************************************************************/
+char *fmtInt(char *pBuf, int32_t value, uint8_t width, char pad)
+{
+    char digits[FMT_DIGITS_MAX];
+    uint32_t mag;
+    uint8_t n;
+
+    if (value >= 0)
+    {
+        return fmtUint(pBuf, (uint32_t)value, width, pad);
+    }
+
+    mag = (uint32_t)(-(value + 1)) + 1;
+    n = fmtDigits(digits, mag) + 1;
+    if (pad == '0')
+    {
+        /* Sign goes before zero padding. */
+        *pBuf++ = '-';
+    }
+    while (width > n)
+    {
+        *pBuf++ = pad;
+        width--;
+    }
+    if (pad != '0')
+    {
+        *pBuf++ = '-';
+    }
+
+    return fmtUint(pBuf, mag, 0, pad);
+}
+
+
+/******************************************************************************
+ *
+ * FUNCTION NAME
+ *      fmtHex
+ *
+ * PURPOSE
+ *      This routine writes a value in upper-case hexadecimal, like sprintf
+ *      "%0NX".
+ *
+ * PARAMETERS
+ *      OUT pBuf        output position
+ *      IN  value       value to write
+ *      IN  width       minimum number of digits (1-8)
+ *
+ * RETURN VALUE
+ *      This routine returns a pointer past the last character written.
+ *
+ *****************************************************************************/
+char *fmtHex(char *pBuf, uint32_t value, uint8_t width)
+{
+    uint8_t n = 1;
+
+    /* Count the significant digits. */
+    while ((n < 8) && ((value >> (n * 4)) != 0))
+    {
+        n++;
+    }
+    if (width > n)
+    {
+        n = width;
+    }
+    while (n > 0)
+    {
+        n--;
+        *pBuf++ = fmtHexDigits[(value >> (n * 4)) & 0x0F];
+    }
+
+    return pBuf;
+}
+
+
+/******************************************************************************
+ *
+ * FUNCTION NAME
+ *      fmtFixed
+ *
+ * PURPOSE
+ *      This routine writes a fixed-point decimal value, e.g. application
+ *      rates in hundredths of an inch per hour, like sprintf "%d.%02d".
+ *
+ * PARAMETERS
+ *      OUT pBuf        output position
+ *      IN  value       value, scaled by 10^decimals
+ *      IN  decimals    number of digits after the decimal point (1-9)
+ *      IN  width       minimum field width, space padded
+ *
+ * RETURN VALUE
+ *      This routine returns a pointer past the last character written.
+ *
+ *****************************************************************************/
+char *fmtFixed(char *pBuf, int32_t value, uint8_t decimals, uint8_t width)
+{
+    char digits[FMT_DIGITS_MAX];
+    uint32_t mag;
+    uint8_t n;
+    uint8_t len;
+
+    mag = (value < 0) ? (uint32_t)(-(value + 1)) + 1 : (uint32_t)value;
+    n = fmtDigits(digits, mag);
+
+    /* Zero-fill so there is at least one digit before the point. */
+    while (n <= decimals)
+    {
+        digits[n++] = '0';
+    }
+
+    len = (uint8_t)(n + 1 + ((value < 0) ? 1 : 0));
+    while (width > len)
+    {
+        *pBuf++ = ' ';
+        width--;
+    }
+    if (value < 0)
+    {
+        *pBuf++ = '-';
+    }
+    while (n > 0)
+    {
+        if (n == decimals)
+        {
+            *pBuf++ = '.';
+        }
+        *pBuf++ = digits[--n];
+    }
+
+    return pBuf;
+}
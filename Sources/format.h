@@ -0,0 +1,57 @@
+/******************************************************************************
+ *                       Copyright (c) 2008, Jabil Circuit
+ *
+ * This source code and any compilation or derivative thereof is the sole
+ * property of Jabil Circuit and is provided pursuant to a Software License
+ * Agreement.  This code is the proprietary information of Jabil Circuit and
+ * is confidential in nature.  Its use and dissemination by any party other
+ * than Jabil Circuit is strictly limited by the confidential information
+ * provisions of the Software License Agreement referenced above.
+ *
+ ******************************************************************************
+ *
+ * Project      : WaterOptimizer Irrigation System (WOIS)
+ * Organization : WaterOptimizer, LLC
+ * Module       : format.h
+ * Description  : This file defines the integer text formatting utility
+ *
+ *****************************************************************************/
+
+#ifndef __format_H
+#define __format_H
+
+/* MODULE format */
+
+#include "global.h"
+
+
+/******************************************************************************
+ *
+ *  FUNCTION PROTOTYPES
+ *
+ *****************************************************************************/
+
+/*
+**  Each routine writes its text at pBuf, without a terminating null, and
+**  returns a pointer to the character following the text written.  This
+**  allows fields to be written directly into LCD buffer positions and
+**  chained.  Null-terminate with "*p = '\0';" where a string is needed.
+*/
+
+/* String copy (maxLen 0 = whole string) */
+char *fmtStr(char *pBuf, const char *pStr, uint8_t maxLen);
+
+/* Decimal integers, padded to width with pad character (' ' or '0') */
+char *fmtUint(char *pBuf, uint32_t value, uint8_t width, char pad);
+char *fmtInt(char *pBuf, int32_t value, uint8_t width, char pad);
+
+/* Upper-case hexadecimal, zero-padded to width */
+char *fmtHex(char *pBuf, uint32_t value, uint8_t width);
+
+/* Fixed-point decimal, e.g. value 125 with 2 decimals is "1.25" */
+char *fmtFixed(char *pBuf, int32_t value, uint8_t decimals, uint8_t width);
+
+
+/* END format */
+
+#endif
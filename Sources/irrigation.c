@@ -30,6 +30,8 @@
 #include "moisture.h"
 #include "drvSolenoid.h"
 #include "drvSys.h"
+#include "drvEeprom.h"
+#include "crc.h"
 #include "radio.h"
 
 /* Irrigation Events */
@@ -41,6 +43,7 @@
 #define IRR_EVENT_ET_DATA       SYS_EVENT_IRR + 6   /* Weather Update +ET */
 #define IRR_EVENT_FORCE_BSY     SYS_EVENT_IRR + 7   /* Force On Busy/Ignore */
 #define IRR_EVENT_RAIN          SYS_EVENT_IRR + 8   /* Weather Update +rain */
+#define IRR_EVENT_IRR_RESUME    SYS_EVENT_IRR + 9   /* Resumed from checkpoint */
 
 
 
@@ -166,6 +169,11 @@ uint16_t slaveFlowDelay = 0;
 uint8_t  findFlow = 0;
 uint8_t slaveFindFlow = 0;
 bool_t TestSkipFlag = FALSE;
+static bool_t irrCheckpointReady = FALSE;  /* checkpoint restore has run */
+static bool_t irrCheckpointActive = TRUE;  /* checkpoint may hold a program */
+static uint32_t irrCheckpointTime;      /* dtTickCount of last checkpoint */
+static uint8_t irrCheckpointZones;      /* zones laid out in EEPROM checkpoint */
+static uint16_t irrCheckpointZoneSaved[SYS_N_ZONES]; /* zone CRCs in EEPROM */
 
 /*
 ** Zone Irrigation State Data
@@ -212,6 +220,10 @@ static void     irrSensorThresholdCheck(void);
 static void     irrStartedDebug(void);
 static bool_t   irrHaveRunnableProgram(void);
 static bool_t   flowMinMax(uint8_t zi); 
+static uint16_t irrCheckpointCrc(const irrCheckpoint_t *pCkpt);
+static uint16_t irrCheckpointZoneCrc(uint8_t zi);
+static bool_t   irrCheckpointWrite(const void *pBuf, uint16_t offset, uint16_t nbytes);
+static void     irrCheckpointRestore(void);
 
 
 /******************************************************************************
@@ -244,6 +256,9 @@ void irrInit(void)
     irrAutoPgmPending = IRR_PGM_NONE;
     /* Set last ET data time to force initial "no weather data" error. */
     irrLastEtDataTime = (uint32_t)0 - DT_SECS_24_HOURS;
+
+    /* Resume any program interrupted by a reset or power loss. */
+    irrCheckpointRestore();
 }
 
 
@@ -268,6 +283,12 @@ void irrPoll(void)
     irrElapsedSecs = dtElapsedSeconds(irrLastPollTime);
     irrLastPollTime = dtTickCount;
 
+    /* Irrigation timers shown on the LCD advance while a program runs. */
+    if ((irrElapsedSecs != 0) && (irrState != IRR_STATE_IDLE))
+    {
+        uiNotify(UI_DEP_IRR);
+    }
+
     /* Check for no weather data received in last 24 hours. */
     if ((config.sys.opMode == CONFIG_OPMODE_WEATHER) &&
         (dtElapsedSeconds(irrLastEtDataTime) > DT_SECS_24_HOURS))
@@ -293,6 +314,7 @@ void irrPoll(void)
     if(irrStateOld != irrState)
     {
         irrStateOld = irrState;
+        uiNotify(UI_DEP_IRR);
         /* if expansion report status back to master */
         if((config.sys.unitType != UNIT_TYPE_MASTER))
         {
@@ -318,6 +340,14 @@ void irrPoll(void)
             /* Invalid state.  Should never happen. */
             break;
     }
+
+    /* Checkpoint a running program's progress periodically. */
+    if (((irrState == IRR_STATE_WATERING) ||
+         (irrState == IRR_STATE_SOAKING)) &&
+        (dtElapsedSeconds(irrCheckpointTime) >= IRR_CHECKPOINT_SECS))
+    {
+        irrCheckpointSave();
+    }
 }
 
 
@@ -750,6 +780,7 @@ static void irrZoneTransition(bool_t forceTransition)
             /* Pause for soak. */
             irrCurZone = 0;
             irrState = IRR_STATE_SOAKING;
+            irrCheckpointSave();
             
             /* if expansion report status back to master */
             if(config.sys.unitType != UNIT_TYPE_MASTER)
@@ -799,6 +830,7 @@ static void irrCycleStart(void)
     /* Set the current zone to the next zone chosen for watering. */
     irrCurZone = irrNextZone;
     irrState = IRR_STATE_WATERING;
+    irrCheckpointSave();
 
     if ((irrOpMode == CONFIG_OPMODE_SENSOR) &&
         (irrIsCurrentGroupLeader(irrCurZone)))
@@ -918,6 +950,8 @@ static void irrProgramFinished(void)
     irrProgram = IRR_PGM_NONE;
     irrState = IRR_STATE_IDLE;
     irrCurZone = 0;
+    /* Nothing left to resume. */
+    irrCheckpointSave();
     /* Set moisture sample frequency to inactive for all sensored zones. */
     irrMoistConfigUpdate();
     /* Request LCD screen refresh. */
@@ -1282,6 +1316,143 @@ uint16_t irrRemainingZonePulses(uint8_t zone)
 }
 
 
+/******************************************************************************
+ *
+ * irrNextTransitionSecs
+ *
+ * PURPOSE
+ *      This routine is called to estimate the number of seconds until the
+ *      irrigation logic next calls irrZoneTransition(), i.e. the next time
+ *      any zone valve in the active program will change state.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      This routine returns the number of seconds until the next zone
+ *      transition, or IRR_SECS_NONE if no timed transition is pending.
+ *
+ * NOTES
+ *      A zone that is neither watering nor soaking can only be started at
+ *      a zone transition, so the value returned here is also the earliest
+ *      time that any other unfinished zone of the program can turn on.
+ *      No timed transition is pending while watering is inhibited or
+ *      paused in the middle of a zone cycle.
+ *
+ *****************************************************************************/
+uint32_t irrNextTransitionSecs(void)
+{
+    uint32_t secs = IRR_SECS_NONE;  /* seconds until next transition */
+    uint32_t pulseSecs;             /* seconds left in current pulse */
+
+    switch (irrState)
+    {
+        case IRR_STATE_SENSING:
+            /* First zone starts as soon as the sensor wait completes. */
+            secs = IRR_SENSING_SECS;
+            break;
+
+        case IRR_STATE_WATERING:
+            secs = (uint32_t)irrRemainingZoneSecs(irrCurZone);
+            if (irrPulseMode == CONFIG_PULSEMODE_ON)
+            {
+                /* Pulse cycle may end before the zone runtime does. */
+                pulseSecs = irrRemainingZonePulseSecs(irrCurZone);
+                if (pulseSecs < secs)
+                {
+                    secs = pulseSecs;
+                }
+            }
+            break;
+
+        case IRR_STATE_SOAKING:
+            /* All zones soaking; next zone starts when a soak completes. */
+            if ((irrCurZone == 0) && !sysIsInhibited && !sysIsPaused)
+            {
+                secs = irrRemainingSoakSecs();
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return secs;
+}
+
+
+/******************************************************************************
+ *
+ * irrScheduleNextStartSecs
+ *
+ * PURPOSE
+ *      This routine is called to find the number of seconds until the next
+ *      scheduled automatic irrigation program start.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      This routine returns the number of seconds until the next scheduled
+ *      program start, zero if a program is already queued for auto-start,
+ *      or IRR_SECS_NONE if no program is scheduled to start today or
+ *      tomorrow.
+ *
+ * NOTES
+ *      Only today's and tomorrow's start times are inspected; callers use
+ *      the result to shorten wake-up intervals that are much less than a
+ *      day long.  Programs are auto-started by dtPoll() at the top of the
+ *      scheduled minute.
+ *
+ *****************************************************************************/
+uint32_t irrScheduleNextStartSecs(void)
+{
+    uint32_t secs = IRR_SECS_NONE;      /* seconds until next start */
+    uint32_t nowSecs;                   /* seconds since 00:00 today */
+    uint32_t startSecs;                 /* program start, secs since 00:00 */
+    uint16_t startTime;                 /* program start, mins since 00:00 */
+    uint8_t day;                        /* irrigation day of week */
+    uint8_t d;                          /* days from today */
+    uint8_t pi;                         /* program index */
+
+    if (irrAutoPgmPending != IRR_PGM_NONE)
+    {
+        /* Program will start on the next irrigation poll. */
+        return 0;
+    }
+
+    if (!sysIsAuto)
+    {
+        /* Scheduled programs do not start when not in Auto. */
+        return IRR_SECS_NONE;
+    }
+
+    nowSecs = (((uint32_t)dtHour * 60) + dtMin) * 60 + dtSec;
+    day = dtIrrWday();
+
+    for (d = 0; d < 2; d++)
+    {
+        for (pi = 0; pi < SYS_N_PROGRAMS; pi++)
+        {
+            startTime = ntohs(config.sched[day][pi].startTime);
+            if (startTime >= CONFIG_SCHED_START_LIMIT)
+            {
+                /* Start time disabled. */
+                continue;
+            }
+            startSecs = (d * DT_SECS_24_HOURS) + ((uint32_t)startTime * 60);
+            if ((startSecs >= nowSecs) && ((startSecs - nowSecs) < secs))
+            {
+                secs = startSecs - nowSecs;
+            }
+        }
+        day = (day + 1) % CONFIG_SCHED_DAY_LIMIT;
+    }
+
+    return secs;
+}
+
+
 /******************************************************************************
  *
  * irrProgramRuntime
@@ -2218,6 +2389,7 @@ static void irrWeatherUpdateZone(uint8_t zi, uint16_t etData, uint16_t rainfall)
     {
         irrMoistureBalance[zi] = IRR_MB_MIN;
     }
+    uiNotify(UI_DEP_IRR);
 }
 
 
@@ -2356,6 +2528,9 @@ static void irrSolenoidControl(uint8_t zone, bool_t state)
     /* Make sure watchdog doesn't timeout on long debug message writes. */
     sysExecutionExtend();
 
+    /* Apply the configured solenoid turn-on stagger. */
+    drvSolenoidInrushSet(config.sys.solInrush * DRV_SOLENOID_TICK_MS);
+
     if (zone == 0)
     {
         sprintf(zoneName, "Master Valve");
@@ -2945,8 +3120,347 @@ void irrMbSet(uint8_t zone, int16_t mbValue)
         {
             irrMoistureBalance[zi] = mbValue;
         }
+        uiNotify(UI_DEP_IRR);
     }
 }
+
+
+/******************************************************************************
+ *
+ * irrCheckpointSave
+ *
+ * PURPOSE
+ *      This routine is called to save the progress of the current irrigation
+ *      program to EEPROM so that it can be resumed after a reset.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      This routine is called at every zone transition, every
+ *      IRR_CHECKPOINT_SECS while a program is watering or soaking, and when
+ *      a main power failure is detected.  Only the range of zones from the
+ *      first to the last zone whose data changed since it was last written
+ *      is written, using the zone CRCs kept in irrCheckpointZoneSaved[], as
+ *      one moisture balance range and one zone state range; all zones are
+ *      written if the number of zones (and so the record layout) changed.
+ *      This costs at most as many EEPROM page writes as writing the whole
+ *      record.  The
+ *      header is written last; a write cut short by loss of power leaves a
+ *      record whose CRC does not match, and it is then ignored at start-up.
+ *      When no program is running, an empty record is written only if the
+ *      checkpoint still describes a program.
+ *      Nothing is written before irrCheckpointRestore() has run, so a power
+ *      failure detected during start-up cannot overwrite the checkpoint.
+ *
+ *****************************************************************************/
+void irrCheckpointSave(void)
+{
+    irrCheckpoint_t ckpt;
+    uint16_t mbBytes;
+    uint16_t zoneCrc;
+    bool_t written;
+    uint8_t zi;
+    uint8_t lo;
+    uint8_t hi = 0;
+
+    if (!irrCheckpointReady)
+    {
+        /* Checkpoint not yet restored. */
+        return;
+    }
+    irrCheckpointTime = dtTickCount;
+
+    if (irrState == IRR_STATE_IDLE)
+    {
+        if (!irrCheckpointActive)
+        {
+            /* Checkpoint already shows no program in progress. */
+            return;
+        }
+        ckpt.numZones = 0;
+    }
+    else
+    {
+        ckpt.numZones = irrNumZones;
+    }
+
+    ckpt.version = IRR_CHECKPOINT_VERSION;
+    ckpt.configCheckSum = config.sys.checkSum;
+    ckpt.sysState = sysState;
+    ckpt.state = irrState;
+    ckpt.program = irrProgram;
+    ckpt.opMode = irrOpMode;
+    ckpt.pulseMode = irrPulseMode;
+    ckpt.curZone = irrCurZone;
+    ckpt.testRunTime = sysTestRunTime;
+    ckpt.crc = irrCheckpointCrc(&ckpt);
+
+    /* Find the range of zones changed since they were last written. */
+    lo = ckpt.numZones;
+    for (zi = 0; zi < ckpt.numZones; zi++)
+    {
+        if ((ckpt.numZones != irrCheckpointZones) ||
+            (irrCheckpointZoneCrc(zi) != irrCheckpointZoneSaved[zi]))
+        {
+            if (zi < lo)
+            {
+                lo = zi;
+            }
+            hi = zi + 1;
+        }
+    }
+
+    if (lo < hi)
+    {
+        mbBytes = ckpt.numZones * sizeof(irrMoistureBalance[0]);
+        written = irrCheckpointWrite(&irrMoistureBalance[lo],
+                                     IRR_CHECKPOINT_DATA + sizeof(ckpt) +
+                                     lo * sizeof(irrMoistureBalance[0]),
+                                     (hi - lo) * sizeof(irrMoistureBalance[0])) &&
+                  irrCheckpointWrite(&irrZone[lo],
+                                     IRR_CHECKPOINT_DATA + sizeof(ckpt) + mbBytes +
+                                     lo * sizeof(irrZoneState_t),
+                                     (hi - lo) * sizeof(irrZoneState_t));
+        for (zi = lo; zi < hi; zi++)
+        {
+            zoneCrc = irrCheckpointZoneCrc(zi);
+            if (written)
+            {
+                irrCheckpointZoneSaved[zi] = zoneCrc;
+            }
+            else
+            {
+                /* Write failed; force it to be written again next time. */
+                irrCheckpointZoneSaved[zi] = (uint16_t)~zoneCrc;
+            }
+        }
+    }
+    if (ckpt.numZones != 0)
+    {
+        irrCheckpointZones = ckpt.numZones;
+    }
+    drvEepromWrite(&ckpt, IRR_CHECKPOINT_DATA, sizeof(ckpt));
+
+    irrCheckpointActive = (ckpt.numZones != 0);
+}
+
+
+/******************************************************************************
+ *
+ * irrCheckpointWrite
+ *
+ * PURPOSE
+ *      This routine writes part of the irrigation checkpoint to EEPROM one
+ *      page at a time, keeping the watchdog tamed between pages.
+ *
+ * PARAMETERS
+ *      pBuf        IN      data to write
+ *      offset      IN      EEPROM offset to write
+ *      nbytes      IN      number of bytes to write
+ *
+ * RETURN VALUE
+ *      This routine returns TRUE on success; FALSE on error.
+ *
+ * NOTES
+ *      The power fail check in sysExecutionExtend() is skipped once main
+ *      power has failed, since the checkpoint is also saved from it.
+ *
+ *****************************************************************************/
+static bool_t irrCheckpointWrite(const void *pBuf, uint16_t offset, uint16_t nbytes)
+{
+    const uint8_t *pData = (const uint8_t *)pBuf;
+    uint16_t pageBytes;
+
+    while (nbytes > 0)
+    {
+        pageBytes = DRV_EEPROM_PAGE_SIZE - (offset & (DRV_EEPROM_PAGE_SIZE - 1));
+        if (pageBytes > nbytes)
+        {
+            pageBytes = nbytes;
+        }
+        if (!drvEepromWrite(pData, offset, pageBytes))
+        {
+            return FALSE;
+        }
+        pData += pageBytes;
+        offset += pageBytes;
+        nbytes -= pageBytes;
+
+        if (drvSys12vdcOk())
+        {
+            sysExecutionExtend();
+        }
+        else
+        {
+            drvSysWatchDogClear();
+        }
+    }
+
+    return TRUE;
+}
+
+
+/******************************************************************************
+ *
+ * irrCheckpointCrc
+ *
+ * PURPOSE
+ *      This routine calculates the CRC of an irrigation checkpoint record,
+ *      using the zone data currently in RAM.
+ *
+ * PARAMETERS
+ *      pCkpt       IN      checkpoint header
+ *
+ * RETURN VALUE
+ *      This routine returns the CRC of the header (following the CRC field)
+ *      and the zone data.
+ *
+ *****************************************************************************/
+static uint16_t irrCheckpointCrc(const irrCheckpoint_t *pCkpt)
+{
+    const uint8_t *pData;
+    uint16_t crc = CRC_INIT_VALUE;
+    uint16_t i;
+
+    pData = (const uint8_t *)pCkpt;
+    for (i = woffsetof(irrCheckpoint_t, configCheckSum); i < sizeof(*pCkpt); i++)
+    {
+        crcByte(pData[i], &crc);
+    }
+    pData = (const uint8_t *)irrMoistureBalance;
+    for (i = 0; i < pCkpt->numZones * sizeof(irrMoistureBalance[0]); i++)
+    {
+        crcByte(pData[i], &crc);
+    }
+    pData = (const uint8_t *)irrZone;
+    for (i = 0; i < pCkpt->numZones * sizeof(irrZoneState_t); i++)
+    {
+        crcByte(pData[i], &crc);
+    }
+
+    return crc;
+}
+
+
+/******************************************************************************
+ *
+ * irrCheckpointZoneCrc
+ *
+ * PURPOSE
+ *      This routine calculates the CRC of one zone's checkpoint data, used
+ *      to tell whether the zone must be written again.
+ *
+ * PARAMETERS
+ *      zi          IN      zone index (0-based)
+ *
+ * RETURN VALUE
+ *      This routine returns the CRC of the zone's moisture balance and
+ *      irrigation state.
+ *
+ *****************************************************************************/
+static uint16_t irrCheckpointZoneCrc(uint8_t zi)
+{
+    const uint8_t *pData;
+    uint16_t crc = CRC_INIT_VALUE;
+    uint16_t i;
+
+    pData = (const uint8_t *)&irrMoistureBalance[zi];
+    for (i = 0; i < sizeof(irrMoistureBalance[0]); i++)
+    {
+        crcByte(pData[i], &crc);
+    }
+    pData = (const uint8_t *)&irrZone[zi];
+    for (i = 0; i < sizeof(irrZoneState_t); i++)
+    {
+        crcByte(pData[i], &crc);
+    }
+
+    return crc;
+}
+
+
+/******************************************************************************
+ *
+ * irrCheckpointRestore
+ *
+ * PURPOSE
+ *      This routine is called at start-up to resume an irrigation program
+ *      that was interrupted by a reset or loss of power.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      The checkpoint is only used if it was saved with the configuration
+ *      now loaded.  The program is restored in the soaking state with the
+ *      current zone kept, the same as after a pause, so the first irrigation
+ *      poll restarts the interrupted zone where it left off.
+ *
+ *****************************************************************************/
+static void irrCheckpointRestore(void)
+{
+    irrCheckpoint_t ckpt;
+    uint16_t mbBytes;
+    uint8_t zi;
+
+    /* The checkpoint may be written from here on. */
+    irrCheckpointReady = TRUE;
+
+    drvEepromRead(IRR_CHECKPOINT_DATA, &ckpt, sizeof(ckpt));
+    if ((ckpt.version != IRR_CHECKPOINT_VERSION) ||
+        (ckpt.state == IRR_STATE_IDLE) ||
+        (ckpt.numZones == 0) ||
+        (ckpt.numZones > SYS_N_ZONES) ||
+        (ckpt.curZone > ckpt.numZones) ||
+        (ckpt.configCheckSum != config.sys.checkSum))
+    {
+        /* No usable checkpoint. */
+        return;
+    }
+
+    /* Zone data is read in place, then validated. */
+    mbBytes = ckpt.numZones * sizeof(irrMoistureBalance[0]);
+    drvEepromRead(IRR_CHECKPOINT_DATA + sizeof(ckpt),
+                  irrMoistureBalance,
+                  mbBytes);
+    drvEepromRead(IRR_CHECKPOINT_DATA + sizeof(ckpt) + mbBytes,
+                  irrZone,
+                  ckpt.numZones * sizeof(irrZoneState_t));
+    if (ckpt.crc != irrCheckpointCrc(&ckpt))
+    {
+        memset(irrMoistureBalance, 0, mbBytes);
+        memset(irrZone, 0, ckpt.numZones * sizeof(irrZoneState_t));
+        return;
+    }
+
+    /* The zone data in EEPROM now matches RAM. */
+    for (zi = 0; zi < ckpt.numZones; zi++)
+    {
+        irrCheckpointZoneSaved[zi] = irrCheckpointZoneCrc(zi);
+    }
+    irrCheckpointZones = ckpt.numZones;
+
+    /* Resume the program. */
+    sysState = ckpt.sysState;
+    sysTestRunTime = ckpt.testRunTime;
+    irrNumZones = ckpt.numZones;
+    irrProgram = ckpt.program;
+    irrOpMode = ckpt.opMode;
+    irrPulseMode = ckpt.pulseMode;
+    irrCurZone = ckpt.curZone;
+    irrState = IRR_STATE_SOAKING;
+    irrPgmStartTime = dtTickCount;
+
+    /* Trace irrigation resumed event. */
+    sysEvent(IRR_EVENT_IRR_RESUME, irrCurZone);
+}
 /******************************************************************************
 *
 *  detect the gallon per min, shut off when flow exceeds max or below min value 
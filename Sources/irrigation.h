@@ -33,6 +33,7 @@
 
 #define IRR_ET_MAX          1000    /* ET Max Value */
 #define IRR_SENSING_SECS    1       /* Seconds to wait for sensor readings */
+#define IRR_SECS_NONE       0xFFFFFFFF  /* No zone transition pending */
 
 /* Irrigation State */
 #define IRR_STATE_IDLE      0       /* Idle */
@@ -65,6 +66,10 @@
 /* Moisture Balance Limits */
 #define IRR_MB_MIN          (-10 * 100) /* minimum MB is -10.00 inches */
 
+/* Irrigation Checkpoint */
+#define IRR_CHECKPOINT_VERSION  1   /* Checkpoint Record Format Version */
+#define IRR_CHECKPOINT_SECS     60  /* Checkpoint interval while running */
+
 
 
 /******************************************************************************
@@ -95,6 +100,31 @@ typedef struct
 } irrZoneState_t;
 
 
+/*
+**  Irrigation Checkpoint Header
+**
+**  This structure heads the irrigation progress checkpoint kept in EEPROM
+**  (at IRR_CHECKPOINT_DATA) so an interrupted program can be resumed after
+**  a reset.  It is followed by irrMoistureBalance[] and irrZone[] for the
+**  first numZones zones.  A state of IRR_STATE_IDLE means no program was
+**  in progress.
+*/
+typedef struct
+{
+    uint16_t version;               /* checkpoint format version */
+    uint16_t crc;                   /* CRC of all following bytes */
+    uint16_t configCheckSum;        /* config image checksum when saved */
+    uint8_t sysState;               /* system state (irrigation cause) */
+    uint8_t state;                  /* irrigation state */
+    uint8_t program;                /* current program */
+    uint8_t opMode;                 /* program operating mode */
+    uint8_t pulseMode;              /* program pulse mode */
+    uint8_t curZone;                /* current zone (0 if soaking) */
+    uint8_t numZones;               /* number of zones that follow */
+    uint8_t testRunTime;            /* per-zone test run-time */
+} irrCheckpoint_t;
+
+
 
 /******************************************************************************
  *
@@ -150,6 +180,8 @@ uint32_t irrRemainingSoakSecs(void);
 uint16_t irrRemainingZoneSoakSecs(uint8_t zone);
 uint16_t irrRemainingZonePulseSecs(uint8_t zone);
 uint16_t irrRemainingZonePulses(uint8_t zone);
+uint32_t irrNextTransitionSecs(void);
+uint32_t irrScheduleNextStartSecs(void);
 uint16_t irrWeatherRuntimeCalc(uint8_t zi);
 bool_t irrIsCurrentGroupLeader(uint8_t zone);
 bool_t irrIsConfigGroupLeader(uint8_t zone);
@@ -161,6 +193,7 @@ int16_t irrMbGet(uint8_t zone);
 void irrMbSet(uint8_t zone, int16_t mbValue);
 void irrMbFix(void);
 bool_t irrCmdExpPulseOn(uint8_t program);
+void irrCheckpointSave(void);
 //static bool_t flowMinMax(uint8_t zi); 
 /* END irrigation */
 
@@ -29,6 +29,7 @@
 #include "global.h"
 #include "platform.h"
 #include "system.h"
+#include "drvRtc.h"
 
 
 
@@ -94,7 +95,7 @@ uint64_t ntohll(uint64_t netlonglong)
 
 /****** Stubs needed to run on Stage2 (pre-EVT hardware) platform. ***********/
 
-#include "hwExpOut.h"
+#include "drvExpBus.h"
 
 
 /*
@@ -103,11 +104,16 @@ uint64_t ntohll(uint64_t netlonglong)
 
 void debugPutc(char ch)
 {
+    /* The port carries the wired expansion bus when that is enabled. */
+    if (drvExpBusIsEnabled())
+    {
+        return;
+    }
     if (ch == '\n')
     {
         debugPutc('\r');
     }
-    while (hwExpOut_SendChar(ch) != ERR_OK)
+    while (!drvExpBusConsolePutc((uint8_t)ch))
     {
         ;
     }
@@ -154,4 +160,83 @@ void debugHexWrite(const uint8_t *pBuf, int length, bool_t withAscii)
 }
 
 
+/*
+ * Deferred debug trace.
+ */
+
+/* Format strings indexed by trace ID. */
+static const char * const debugTraceFmt[DEBUG_TRACE_N_IDS] =
+{
+    "trace id 0 (%u %u %u %u)\n",                       /* NONE */
+    "Rx WOIS msg type=%u len=%u\n",                     /* RADIO_RX */
+    "Tx ZigBee data FID=%02X len=%u type=%u\n",         /* RADIO_TX */
+    "Tx status FID=%02X status=%02X disc=%02X retries=%u\n", /* RADIO_TXSTAT */
+    "Rx WOIS Cmd INVALID CRC %04X (expected %04X)\n",   /* RADIO_CMD_CRC */
+    "Rx WOIS Xfer INVALID CRC %04X (expected %04X)\n",  /* RADIO_XFER_CRC */
+    "Rx WOIS Xfer mode=%02X seg=%u len=%u\n",           /* RADIO_XFER */
+    "Rx WOIS Cmd %02X rejected len=%u unit=%u\n",        /* RADIO_CMD_REJECT */
+};
+
+static debugTraceRec_t debugTraceRing[DEBUG_TRACE_SIZE];
+static uint8_t debugTraceHead = 0;      /* next record to write */
+static uint8_t debugTraceTail = 0;      /* next record to output */
+static uint16_t debugTraceLost = 0;     /* records overwritten since output */
+
+
+void debugTrace(uint8_t id, uint16_t a0, uint16_t a1, uint16_t a2, uint16_t a3)
+{
+    debugTraceRec_t *pRec = &debugTraceRing[debugTraceHead & (DEBUG_TRACE_SIZE - 1)];
+
+    pRec->time = drvMSGet();
+    pRec->arg[0] = a0;
+    pRec->arg[1] = a1;
+    pRec->arg[2] = a2;
+    pRec->arg[3] = a3;
+    pRec->id = id;
+    debugTraceHead++;
+
+    /* Ring full - drop the oldest record. */
+    if ((uint8_t)(debugTraceHead - debugTraceTail) > DEBUG_TRACE_SIZE)
+    {
+        debugTraceTail++;
+        debugTraceLost++;
+    }
+}
+
+
+void debugTracePoll(void)
+{
+    debugTraceRec_t *pRec;
+    char buf[72];
+    int len;
+
+    if (debugTraceHead == debugTraceTail)
+    {
+        return;
+    }
+#ifndef WIN32
+    /* Only format when the previous output has drained. */
+    if (drvExpBusConsoleTxBusy())
+    {
+        return;
+    }
+#endif
+
+    if (debugTraceLost != 0)
+    {
+        sprintf(buf, "[trace: %u lost]\n", debugTraceLost);
+        debugWrite(buf);
+        debugTraceLost = 0;
+    }
+
+    pRec = &debugTraceRing[debugTraceTail & (DEBUG_TRACE_SIZE - 1)];
+    len = sprintf(buf, "[%lu] ", (unsigned long)pRec->time);
+    sprintf(&buf[len],
+            debugTraceFmt[pRec->id < DEBUG_TRACE_N_IDS ? pRec->id : DEBUG_TRACE_NONE],
+            pRec->arg[0], pRec->arg[1], pRec->arg[2], pRec->arg[3]);
+    debugTraceTail++;
+    debugWrite(buf);
+}
+
+
 /* END platform */
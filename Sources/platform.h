@@ -102,6 +102,43 @@ void ledSet(uint8_t bitVec);
  */
 void debugHexWrite(const uint8_t *pBuf, int length, bool_t withAscii);
 
+/*
+ * Deferred debug trace.
+ *
+ * debugTrace() stores a compact binary record in a RAM ring buffer without
+ * formatting or touching the debug UART, so it is cheap enough for radio and
+ * transfer hot paths.  debugTracePoll() runs from the main loop and formats
+ * at most one record per pass, and only when the debug UART Tx buffer is
+ * empty.  If the ring fills, the oldest records are overwritten and a lost
+ * record count is reported with the next formatted record.
+ *
+ * Each record is output as "[<ms>] <text>" where <text> is the format string
+ * for the trace ID (see debugTraceFmt in platform.c) applied to the four
+ * record arguments.
+ */
+#define DEBUG_TRACE_SIZE            8   /* ring entries, must be power of 2 */
+
+/* Trace IDs - index into debugTraceFmt table, keep in sync. */
+#define DEBUG_TRACE_NONE            0
+#define DEBUG_TRACE_RADIO_RX        1   /* msgType, length, -, - */
+#define DEBUG_TRACE_RADIO_TX        2   /* frameId, length, msgType, - */
+#define DEBUG_TRACE_RADIO_TXSTAT    3   /* frameId, status, discovery, retries */
+#define DEBUG_TRACE_RADIO_CMD_CRC   4   /* crcMsg, crcExpected, -, - */
+#define DEBUG_TRACE_RADIO_XFER_CRC  5   /* crcMsg, crcExpected, -, - */
+#define DEBUG_TRACE_RADIO_XFER      6   /* xferMode, segment, dataLen, - */
+#define DEBUG_TRACE_RADIO_CMD_REJECT 7  /* cmd, dataLen, unitMask, - */
+#define DEBUG_TRACE_N_IDS           8
+
+typedef struct
+{
+    uint32_t time;                      /* drvMSGet() timestamp */
+    uint16_t arg[4];                    /* ID-specific arguments */
+    uint8_t id;                         /* DEBUG_TRACE_xxx */
+} debugTraceRec_t;
+
+void debugTrace(uint8_t id, uint16_t a0, uint16_t a1, uint16_t a2, uint16_t a3);
+void debugTracePoll(void);
+
 
 /* END platform */
 
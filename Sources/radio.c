@@ -42,6 +42,8 @@
 #include "moisture.h"
 #include "drvMoist.h"
 #include "drvSolenoid.h"
+#include "drvRtc.h"
+#include "drvExpBus.h"
 
 /* Radio Events */
 #define RADIO_EVENT_INIT        SYS_EVENT_RADIO + 1     /* Radio Init */
@@ -59,14 +61,22 @@
  *  This command pending queue is used by the AT Command send/retry logic.
  *
  *  NOTE:
- *      The command pending queue is implemented as double-linked list, using
+ *      The command pending queue is implemented as double-linked lists, using
  *      a fixed-size array of queue elements (radioCmdPending_t structures).
+ *      Commands waiting to be sent are on the auto-send list; commands
+ *      waiting for a response are on a retry timer wheel with one list per
+ *      second, so that adding, deleting and finding the next command due
+ *      never search the whole queue.  Unused elements are kept on a free
+ *      list, and each command identifier maps directly to its element.
  *
  *****************************************************************************/
 
 #define RADIO_CPQ_SIZE          16          /* max number of queue elements */
 #define RADIO_CPQ_NONE          0xFF        /* queue element does not exist */
-#define RADIO_CPQ_AUTOSEND      0xFFFFFFFF  /* cmd enqueued for auto-send */
+#define RADIO_CPQ_WHEEL_SIZE    (RADIO_CMD_RETRY_SECS + 2)  /* wheel seconds */
+#define RADIO_CPQ_SEND_LIST     RADIO_CPQ_WHEEL_SIZE    /* auto-send list */
+#define RADIO_CPQ_N_LISTS       (RADIO_CPQ_WHEEL_SIZE + 1)  /* number of lists */
+#define RADIO_CPQ_N_IDENTS      (RADIO_CMD_AUTO_LAST - RADIO_CMD_AUTO + 1)
 
 //#define RADIO_NHOPS             7          //maximum number of XBee hops
 
@@ -79,10 +89,155 @@ typedef struct
     uint8_t prev;           /* previous queue element index */
     uint8_t next;           /* next queue element index */
     uint8_t ident;          /* command identifier */
-    uint32_t timeSent;      /* retry info - time cmd sent or auto-send */
+    uint8_t list;           /* wheel slot or auto-send list holding element */
+    uint32_t timeDue;       /* retry info - tick count cmd is due to send */
 } radioCmdPending_t;
 
 
+/******************************************************************************
+ *
+ *  TX DATA QUEUE DEFINITIONS
+ *
+ *  The Tx data queue holds ZigBee Tx data frames until the radio transmit
+ *  buffer has room for them.  Frames are sent highest priority class first,
+ *  alternating between destinations within a class, with at most
+ *  RADIO_TXQ_DEST_INFLIGHT frames per destination awaiting Tx status.
+ *
+ *  NOTE:
+ *      A frame stays in the queue until its Tx status is received so that
+ *      failed transmissions can be retried.
+ *
+ *      A queue element holds the destination and a reference to the packet
+ *      buffer holding the payload; the ZigBee Tx header is written into the
+ *      packet buffer just before each transmission.
+ *
+ *      Frames for units on the wired expansion bus are queued the same way
+ *      and written to the bus transmit buffer when it has room.  The bus
+ *      has no Tx status, so a wired frame is done once it has been written.
+ *      A full radio or bus transmit buffer only holds back frames for that
+ *      transport.
+ *
+ *****************************************************************************/
+
+#define RADIO_TXQ_SIZE          4           /* max number of queued frames */
+#define RADIO_TXQ_NONE          0xFF        /* queue element does not exist */
+#define RADIO_TXQ_DEST_INFLIGHT 1           /* frames awaiting status per dest */
+#define RADIO_TXQ_STATUS_MS     5000        /* ms to wait for Tx status */
+
+/* Tx data queue element states */
+#define RADIO_TXQ_FREE          0           /* element not in use */
+#define RADIO_TXQ_PENDING       1           /* frame waiting to be sent */
+#define RADIO_TXQ_INFLIGHT      2           /* frame sent, awaiting Tx status */
+
+/* Tx data queue transports, as blocked transport mask bits */
+#define RADIO_TXQ_RADIO         0x01        /* sent over the air */
+#define RADIO_TXQ_WIRED         0x02        /* sent on the wired expansion bus */
+
+/*
+**  Tx Data Queue Element Structure
+*/
+typedef struct
+{
+    uint8_t state;          /* queue element state */
+    uint8_t prio;           /* priority class (RADIO_TXP_xxx) */
+    uint8_t retries;        /* retries remaining */
+    uint8_t len;            /* length of application payload data */
+    uint8_t pkt;            /* packet buffer holding the payload data */
+    uint8_t frameId;        /* frame identifier */
+    uint8_t stat;           /* protocol statistics entry (RADIO_PSTAT_xxx) */
+    uint8_t transport;      /* RADIO_TXQ_RADIO or RADIO_TXQ_WIRED */
+    uint8_t netAddr[RADIO_SZ_NET_AD];   /* destination network address */
+    uint8_t phyAddr[RADIO_SZ_MAC_ID];   /* destination phy address */
+    uint32_t time;          /* ms time queued, or time sent if in flight */
+} radioTxq_t;
+
+
+/******************************************************************************
+ *
+ *  PACKET BUFFER POOL DEFINITIONS
+ *
+ *  Radio packets are built and received in a small pool of fixed size
+ *  buffers instead of on the stack.  Buffers are reference counted, so one
+ *  message can be queued to several destinations without being copied, and
+ *  is returned to the pool when its last queue element is freed.
+ *
+ *  NOTE:
+ *      The pool is sized for a full Tx data queue of distinct messages plus
+ *      the packet being received and one message being built.
+ *
+ *****************************************************************************/
+
+#define RADIO_PKT_POOL_SIZE     (RADIO_TXQ_SIZE + 2)    /* buffers in pool */
+#define RADIO_PKT_NONE          0xFF        /* packet buffer does not exist */
+
+/*
+**  Packet Buffer Structure
+*/
+typedef struct
+{
+    uint8_t refs;           /* number of references held, 0 if free */
+    union
+    {
+        uint8_t raw[RADIO_MAXPACKET];   /* received API frame */
+        radioTxDataPacket_t tx;         /* Tx data packet */
+    } u;
+} radioPkt_t;
+
+
+/******************************************************************************
+ *
+ *  WOIS COMMAND DISPATCH DEFINITIONS
+ *
+ *  Received WOIS commands are dispatched through a table indexed by the
+ *  command code.  Each entry gives the command handler, the message log
+ *  text, the ack code, the allowed command data length and the unit types
+ *  that accept the command.  The handler fills in the ack data and returns
+ *  its length; radioProtocolCommandHandler does the checks, logging,
+ *  forwarding and ack send common to all commands.
+ *
+ *****************************************************************************/
+
+/* Command handler - returns ack data length */
+typedef uint8_t (*radioProtoCmdFunc_t)(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID,
+                                       uint8_t *pData);
+
+/* Unit types that accept a command */
+#define RADIO_CMDU_MASTER       0x01        /* master (or stand-alone) unit */
+#define RADIO_CMDU_EXP          0x02        /* expansion unit */
+#define RADIO_CMDU_ALL          (RADIO_CMDU_MASTER | RADIO_CMDU_EXP)
+
+/* Command flags */
+#define RADIO_CMDF_FORWARD      0x01        /* master forwards to expansion units */
+#define RADIO_CMDF_REBOOT       0x02        /* reboot after the ack is sent */
+
+/*
+**  Protocol statistics (radioProtoStat) are kept for each command and each
+**  transfer data type received, in entries assigned as they are first seen
+**  (see radioProtoStatEntry).  A message with the same type, CRC and source as
+**  the one before it, within RADIO_PSTAT_DUP_MS, is counted as a duplicate
+**  (the sender retried because our ack was lost or late).  Frames queued
+**  while a message is handled are tagged with its entry so that Tx status
+**  failures are counted against it.
+*/
+#define RADIO_PSTAT_DUP_MS      30000       /* duplicate window, in ms */
+#define RADIO_PSTAT_PAGE        3           /* GET_PROTOSTAT 16-byte records per ack */
+
+/*
+**  Command Dispatch Table Entry
+*/
+typedef struct
+{
+    radioProtoCmdFunc_t pFunc;  /* command handler, NULL if none */
+    const char *pLogDesc;       /* message log text, NULL for no log */
+    uint8_t ack;                /* ack code */
+    uint8_t minLen;             /* minimum command data length */
+    uint8_t maxLen;             /* maximum command data length */
+    uint8_t units;              /* RADIO_CMDU_xxx unit types accepted */
+    uint8_t flags;              /* RADIO_CMDF_xxx flags */
+} radioProtoCmdEnt_t;
+
+
 /*
 ** Bootloader Control Structure
 */
@@ -144,12 +299,12 @@ uint8_t radioStatusDb;                  /* last received signal strength */
 bool_t radioIsJoined;                   /* radio is joined in PAN if TRUE */
 bool_t radioYield;                      /* yield poll cycle if TRUE */
 uint8_t radioDataFrameIdNext;           /* next data frame ID to use */
-uint8_t radioTxDataRetriesRemaining;    /* last data frame retries remaining */
 char radioLastMsgDesc[25];              /* last message received description */
 char radioLastMsgDate[21];              /* last message received date/time */
 uint8_t radioLbState;                   /* loopback test state */
 bool_t radioDebug = FALSE;              /* generate debug messages if TRUE */
 bool_t radioMonitorRss = TRUE;          /* monitor recv sig strength if TRUE */
+static uint32_t radioUiStatus;          /* radio status last shown by UI */
 uint32_t newFirmwareSize=0;             /* size of new firmware to be downloaded */
 extern uint8_t  drvRadioRxBuf[];
 extern uint8_t  drvRadioTxBuf[];
@@ -179,19 +334,132 @@ uint8_t InitCount = 0;
 **  Radio Command Pending Table
 **  Data store used for the AT Command send and retry logic.
 */
-uint8_t radioCmdPendingFirst;           /* index of first (oldest) member */
-uint8_t radioCmdPendingLast;            /* index of last (newest) member */
+uint8_t radioCmdPendingFirst[RADIO_CPQ_N_LISTS];    /* first (oldest) members */
+uint8_t radioCmdPendingLast[RADIO_CPQ_N_LISTS];     /* last (newest) members */
+uint8_t radioCmdPendingFree;            /* index of first free member */
+uint8_t radioCmdPendingSlot[RADIO_CPQ_N_IDENTS];    /* member for each ident */
+uint32_t radioCmdWheelTime;             /* next timer wheel second to check */
 radioCmdPending_t radioCmdPending[RADIO_CPQ_SIZE];  /* queue data store */
 
 /*
-**  ZigBee Transmit Data Message Buffer
-**  Data store used for the last WOIS Command Response transmit packet.
+**  ZigBee Transmit Data Queue
+**  Data store for Tx data frames waiting to be sent or awaiting Tx status.
 */
-radioTxDataPacket_t radioTxDataPkt;     /* last Tx data packet buffer */
-uint16_t radioTxDataPktLen;             /* last Tx data packet length */
+static radioTxq_t radioTxq[RADIO_TXQ_SIZE];     /* queue data store */
+static radioPkt_t radioPkt[RADIO_PKT_POOL_SIZE];    /* packet buffer pool */
+static uint16_t radioPktAllocFails;     /* packet buffer pool exhausted count */
+static uint32_t radioTxqLastDest[RADIO_TXP_N];  /* last dest served per class */
+radioTxqStat_t radioTxqStat[RADIO_TXP_N];       /* queue time statistics */
+radioProtoStat_t radioProtoStat[RADIO_PSTAT_N];    /* protocol statistics */
+static uint8_t radioProtoStatCur = RADIO_PSTAT_NONE;    /* entry being handled */
+static uint8_t radioProtoStatLast = RADIO_PSTAT_NONE;   /* last message entry */
+static uint16_t radioProtoStatLastCrc;  /* last message CRC */
+static uint32_t radioProtoStatLastSrc;  /* last message source (MAC low 32) */
+static uint32_t radioProtoStatLastTime; /* last message ms time received */
+static bool_t radioProtoStatResetPending = FALSE; /* reset after message */
 uint32_t radioTxDataTime;               /* last Tx data send tick count */
 
 uint8_t expMoistValue[36];
+
+/*
+**  Expansion Status Digest Data
+**  The master caches the last digest received from each expansion unit;
+**  an expansion unit keeps the zone values it last reported to the master.
+*/
+radioExpDigest_t radioExpDigest[SYS_N_UNITS - 1];   /* master digest cache */
+static uint32_t radioDigestRefreshTime;         /* last background refresh */
+static uint8_t radioDigestSeq;                  /* last digest sequence sent */
+static uint8_t radioDigestMoist[SYS_N_UNIT_ZONES];      /* moisture sent */
+static int16_t radioDigestMb[SYS_N_UNIT_ZONES];         /* MB value sent */
+static uint16_t radioDigestRuntime[SYS_N_UNIT_ZONES];   /* runtime sent */
+
+/*
+**  Delta Config Distribution Data
+**  The master keeps the segment CRCs and unit image checksums of the last
+**  configuration it distributed; an expansion unit keeps the state of the
+**  delta it is receiving.
+*/
+static bool_t radioCfgDistActive;               /* delta segments being broadcast */
+static uint8_t radioCfgDistVersion;             /* delta distribution version */
+static uint32_t radioCfgDistSegs;               /* segments in this delta */
+static uint32_t radioCfgDistMask;               /* segments left to broadcast */
+static uint32_t radioCfgDistTime;               /* ms time of last delta send */
+static uint32_t radioCfgDistWait;               /* ms to wait before next send */
+static uint8_t radioCfgDistUnits;               /* units that accepted the delta */
+static uint8_t radioCfgDistFull;                /* units sent the full download */
+static uint8_t radioCfgDistRetries[SYS_N_UNITS - 1];    /* missing segment resends */
+static uint32_t radioCfgRepairMask[SYS_N_UNITS - 1];    /* segments to resend */
+static uint16_t radioCfgUnitCrc[SYS_N_UNITS - 1];       /* unit image checksum */
+static uint16_t radioCfgUnitBase[SYS_N_UNITS - 1];      /* previous unit checksum */
+static bool_t radioCfgSegCrcValid;              /* segment CRCs are valid */
+static uint16_t radioCfgSegCrc[RADIO_CFG_SEGS]; /* last distributed segment CRCs */
+static uint8_t radioCfgDeltaVersion;            /* delta being received, 0=none */
+static uint32_t radioCfgDeltaMask;              /* delta segments still expected */
+static uint16_t radioCfgDeltaCrc;               /* image checksum after the delta */
+
+/*
+**  Compressed (RLE) Config Transfer Data
+**  Compressed segments are a stream, so the image offset where the next
+**  segment starts is kept for each direction, along with the offset of the
+**  previous segment so that a repeated request can be answered again.
+*/
+static uint16_t radioCfgRleGetSeg;              /* next upload segment expected */
+static uint32_t radioCfgRleGetOffset;           /* snapshot offset of next segment */
+static uint32_t radioCfgRleGetPrev;             /* snapshot offset of last segment */
+static uint16_t radioCfgRlePutSeg;              /* next download segment expected */
+static uint32_t radioCfgRlePutOffset;           /* buffer offset of next segment */
+
+/*
+**  Wired Expansion Bus Data
+**  Units selected in config.sys.expBusWired exchange WOIS messages over the
+**  wired expansion bus instead of the radio.  Each frame body carries the
+**  destination and source MAC IDs followed by the WOIS message.
+*/
+#define RADIO_EXPBUS_HDR    (2 * RADIO_SZ_MAC_ID)   /* dest + source MAC IDs */
+static bool_t radioRxWired;                     /* Rx packet came over the wire */
+
+/*
+**  Remote Control LCD Subscription Data
+**  A subscribed remote control tool is pushed the runs of the LCD buffer
+**  that have changed since the last push, rather than polling the whole
+**  screen with RADIO_CMD_RC_GETLCD.  The shadow copy holds the screen as
+**  the subscriber last saw it.
+*/
+#define RADIO_RC_LCD_MIN_MS     100     /* shortest allowed push interval */
+#define RADIO_RC_LCD_LEASE_MS   60000   /* subscription lapses unless renewed */
+#define RADIO_RC_LCD_FULL       0x01    /* subscribe flag: resend full screen */
+#define RADIO_RC_LCD_HDR        3       /* push header: seq, position, cursor */
+static bool_t radioRcLcdActive;                 /* a subscriber is registered */
+static uint8_t radioRcLcdAddr[RADIO_SZ_MAC_ID + RADIO_SZ_NET_AD];  /* subscriber */
+static uint8_t radioRcLcdMsgId;                 /* subscribe command message ID */
+static uint8_t radioRcLcdSeq;                   /* last push sequence number */
+static uint8_t radioRcLcdGen;                   /* uiLcdGen at last push */
+static uint16_t radioRcLcdInterval;             /* min ms between pushes */
+static uint32_t radioRcLcdTime;                 /* ms time of last push */
+static uint32_t radioRcLcdRenewTime;            /* ms time of last subscribe */
+static uint8_t radioRcLcdPosition;              /* position last pushed */
+static uint8_t radioRcLcdCursor;                /* cursor last pushed */
+static char radioRcLcdShadow[sizeof(uiLcdBuf)]; /* screen last pushed */
+
+/*
+**  Radio Replay Benchmark Data
+**  Generated API frames are injected into the radio driver receive buffer
+**  and handled as if received from the radio.  While a replay is running
+**  response frames are counted and discarded instead of being sent, and
+**  the replayed traffic does not change the radio status.
+*/
+#define RADIO_REPLAY_MAC    0x0013A200FFFFFF00  /* replayed frame source */
+static bool_t radioReplayActive;                /* replay is running */
+static uint16_t radioReplayTxFrames;            /* responses discarded */
+const char * const radioReplayName[RADIO_REPLAY_N] =
+{
+    "noop",
+    "exstat",
+    "getlcd",
+    "cfgget",
+    "txstat",
+    "mix",
+};
 //uint8_t assocflag = 0;
 //uint8_t assocack = 0;
 //uint16_t statusflag = 0;
@@ -236,13 +504,123 @@ static void    radioPacketModemStatus(const uint8_t *pBuf, int16_t length);
 static void    radioPacketZigBeeTxStatus(const uint8_t *pBuf, int16_t length);
 static void    radioProtocolCommandHandler(const radioRxDataPacket_t *pPacket);
 static void    radioProtocolXferHandler(const radioRxDataPacket_t *pPacket);
+static uint8_t radioProtoCmdNoOp(const radioRxDataPacket_t *pPacket,
+                                 uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdInhibitOn(const radioRxDataPacket_t *pPacket,
+                                      uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdInhibitOff(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdForceOn(const radioRxDataPacket_t *pPacket,
+                                    uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdWeatherData(const radioRxDataPacket_t *pPacket,
+                                        uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdGetMoist(const radioRxDataPacket_t *pPacket,
+                                     uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdGetExStat(const radioRxDataPacket_t *pPacket,
+                                      uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdGetExStat2(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdGetExStat3(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdDigest(const radioRxDataPacket_t *pPacket,
+                                   uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdCfgGetSnap(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdCfgManifest(const radioRxDataPacket_t *pPacket,
+                                        uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdCfgPutStart(const radioRxDataPacket_t *pPacket,
+                                        uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdCfgPutApply(const radioRxDataPacket_t *pPacket,
+                                        uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdCfgDeltaStart(const radioRxDataPacket_t *pPacket,
+                                          uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdCfgDeltaApply(const radioRxDataPacket_t *pPacket,
+                                          uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdGetMb(const radioRxDataPacket_t *pPacket,
+                                  uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdSetMb(const radioRxDataPacket_t *pPacket,
+                                  uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdInitDateTime(const radioRxDataPacket_t *pPacket,
+                                         uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdSendFlow(const radioRxDataPacket_t *pPacket,
+                                     uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdDiagnose(const radioRxDataPacket_t *pPacket,
+                                     uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdGetRadioStat(const radioRxDataPacket_t *pPacket,
+                                         uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdFwPutStart(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdFwPutApply(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdIrrStart(const radioRxDataPacket_t *pPacket,
+                                     uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdIrrComplete(const radioRxDataPacket_t *pPacket,
+                                        uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdExpStatus(const radioRxDataPacket_t *pPacket,
+                                      uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdIrrStop(const radioRxDataPacket_t *pPacket,
+                                    uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdIrrResume(const radioRxDataPacket_t *pPacket,
+                                      uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdIrrSkip(const radioRxDataPacket_t *pPacket,
+                                    uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdIrrOff(const radioRxDataPacket_t *pPacket,
+                                   uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdIrrAuto(const radioRxDataPacket_t *pPacket,
+                                    uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdIrrStopOff(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdDeleteSc(const radioRxDataPacket_t *pPacket,
+                                     uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdScRemoved(const radioRxDataPacket_t *pPacket,
+                                      uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdExpGetConfig(const radioRxDataPacket_t *pPacket,
+                                         uint64_t expMacID, uint8_t *pData);
+static uint8_t radioProtoCmdGetProtoStat(const radioRxDataPacket_t *pPacket,
+                                         uint64_t expMacID, uint8_t *pData);
+static uint8_t radioTxPriorityGet(uint32_t phyAddrH,
+                                  uint32_t phyAddrL,
+                                  const uint8_t *pData,
+                                  int16_t lenData);
+static uint8_t radioPktAlloc(void);
+static void    radioPktRelease(uint8_t pkt);
+static uint8_t *radioPktData(uint8_t pkt);
+static bool_t  radioPktSend(uint8_t frameId,
+                            uint16_t netAddr,
+                            uint32_t phyAddrH,
+                            uint32_t phyAddrL,
+                            uint8_t pkt,
+                            int16_t lenData);
+static radioTxq_t *radioTxqAlloc(uint8_t prio);
+static void    radioTxqFree(radioTxq_t *pTxq);
+static uint8_t radioTxqSelect(uint8_t blocked);
+static void    radioTxqService(void);
+static void    radioTxqPoll(void);
+static bool_t  radioExpBusIsWired(uint64_t macId);
+static bool_t  radioExpBusSend(uint32_t phyAddrH,
+                               uint32_t phyAddrL,
+                               const uint8_t *pData,
+                               int16_t lenData);
+static void    radioExpBusPoll(void);
+static uint8_t radioReplayFrameBuild(uint8_t model,
+                                     uint16_t n,
+                                     uint8_t *pFrame);
+static uint16_t radioReplayDrain(uint8_t *pBuf);
+static uint8_t radioProtoStatEntry(uint8_t type, uint8_t code);
+static uint8_t radioProtoStatRx(const radioRxDataPacket_t *pPacket,
+                                uint8_t type,
+                                uint8_t code,
+                                uint16_t crc);
+static void    radioProtoStatDone(uint8_t stat, bool_t nack, uint32_t msStart);
 static void    radioProtocolSCAssocHandler(const radioRxDataPacket_t *pPacket);
 static void    radioProtocolSCStatusHandler(const radioRxDataPacket_t *pPacket);
 static void    radioProtocolLoopbackHandler(const radioRxDataPacket_t *pPacket);
 static void    radioProtoCmdGetWeatherValues(uint8_t *pData);
 static uint8_t radioProtoCmdGetMbValues(uint8_t firstZone, uint8_t *pData);
 static bool_t  radioProtoCmdSetMbValues(uint8_t *pData, uint8_t lenData);
+static uint8_t radioProtoCmdGetDigest(uint8_t lastSeq, uint8_t *pData);
 static void    radioProtocolFillAckDefaults(packetSCAckData_t *pAckPacket);
+static uint32_t radioSnsConSleepTimeGet(uint8_t sensorIndex);
 static void    radioProtocolAckSend(const radioRxDataPacket_t *pPacket,
                                     uint8_t cmdAck,
                                     const uint8_t *pData,
@@ -251,6 +629,10 @@ static void    radioProtocolRespSend(const radioRxDataPacket_t *pPacket,
                                      const void *pMsg,
                                      uint8_t msgType,
                                      uint8_t length);
+static void    radioProtocolPktRespSend(const radioRxDataPacket_t *pPacket,
+                                        uint8_t pkt,
+                                        uint8_t msgType,
+                                        uint8_t length);
 static bool_t  radioLoopbackDataSend(const uint8_t *pData,
                                      int16_t lenData);
                       
@@ -259,6 +641,8 @@ static void    radioExtAckSend(const radioRxDataPacket_t *pPacket,
                                uint8_t cmdAck,
                                const uint8_t *pData,
                                uint8_t lenData);
+static void    radioRcLcdSubscribe(const radioRxDataPacket_t *pPacket);
+static void    radioRcLcdPoll(void);
 static void    radioDebugAtResponse(radioResponsePacket_t *pPacket);
 static bool_t  radioCheckSumIsValid(const void *pData,
                                     uint8_t lenData,
@@ -272,7 +656,16 @@ static uint8_t radioCheckSensorAssocList(uint64_t sensorMAC);
 static void expansionBusForwardCmd(const radioRxDataPacket_t *pPacket);
 void expansionBusCmdHandler(const radioRxDataPacket_t *pPacket);
 void expansionSendCfgSeg0(const radioRxDataPacket_t *pPacket);
-static void expansionBusSingleCmd(const radioRxDataPacket_t *pPacket, uint64_t macId);
+static void expansionBusForwardPkt(uint8_t pkt, uint16_t destN, uint8_t length);
+static uint8_t expansionUnitIndex(uint64_t macId);
+static void expansionDigestApply(uint8_t unit, const uint8_t *pData, uint8_t lenData);
+static uint64_t expansionUnitMacGet(uint8_t unit);
+static void expansionCfgCrcCalc(uint16_t *pSegCrc, uint16_t *pUnitCrc);
+static void expansionCfgSegSend(uint8_t seg, uint64_t macId);
+static void expansionCfgDistPoll(void);
+static uint8_t radioCfgDeltaStart(const uint8_t *pData, uint8_t lenData, uint64_t srcMac);
+static void radioCfgDeltaSegment(const radioMsgXfer_t *pMsg, uint64_t srcMac);
+static uint8_t radioCfgDeltaApply(const uint8_t *pData, uint8_t lenData, uint8_t *pAck);
 static uint8_t ConvertZone(uint8_t bitZone);
 
 /******************************************************************************
@@ -296,6 +689,8 @@ static uint8_t ConvertZone(uint8_t bitZone);
  *****************************************************************************/
 void radioInit(void)
 {
+    uint8_t i;
+
     sysEvent(RADIO_EVENT_INIT, 0);
     dtDebug("Initializing radio...\n");
 
@@ -318,8 +713,11 @@ void radioInit(void)
     /* Initialize next radio Tx Data frame ID. */
     radioDataFrameIdNext = RADIO_DATA_FRAME_ID_FIRST;
 
-    /* Initialize Tx Data retries remaining to zero. */
-    radioTxDataRetriesRemaining = 0;
+    /* Discard any Tx data frames still queued. */
+    for (i = 0; i < RADIO_TXQ_SIZE; i++)
+    {
+        radioTxqFree(&radioTxq[i]);
+    }
 
     /* if config PAN ID is 0 then set to default PAN */
     if(config.sys.radioPanId == 0x0000)
@@ -335,6 +733,9 @@ void radioInit(void)
     /* Initialize radio yield state. */
     radioYield = FALSE;
 
+    /* Drop any remote control LCD subscription. */
+    radioRcLcdActive = FALSE;
+
     /* Initialize loopback test state. */
     radioLbState = RADIO_LBS_IDLE;
 }
@@ -362,8 +763,27 @@ void radioInit(void)
  *****************************************************************************/
 void radioPoll(void)
 {
-    uint8_t message[RADIO_MAXPACKET];
+    uint8_t rxPkt;
+    uint8_t *message;
     int16_t messageLength;
+    uint32_t uiStatus;
+
+    /* Notify UI of any radio or expansion unit status change. */
+    uiStatus = ((uint32_t)radioStatus << 24) |
+               ((uint32_t)radioStatusExpansion1 << 16) |
+               ((uint32_t)radioStatusExpansion2 << 8) |
+               radioStatusExpansion3;
+    if (uiStatus != radioUiStatus)
+    {
+        radioUiStatus = uiStatus;
+        uiNotify(UI_DEP_RADIO);
+    }
+
+    /* Send queued Tx data frames as the radio has room for them. */
+    radioTxqPoll();
+
+    /* Handle frames on the wired expansion bus. */
+    radioExpBusPoll();
 
     /* If status is "NOT POPULATED", test for radio presence. */
     if (radioStatus == RADIO_STATUS_NOTPOP)
@@ -418,19 +838,26 @@ void radioPoll(void)
 
 
     /* Get any new message packets received from the radio module. */
-    while ((messageLength = drvRadioRead(message, RADIO_MAXPACKET)) != 0)
+    rxPkt = radioPktAlloc();
+    if (rxPkt != RADIO_PKT_NONE)
     {
-        /* Process the received packet. */
-        radioPacketHandler(message, messageLength);
-
-        /* Check for yield flag set by handler. */
-        if (radioYield)
+        message = radioPkt[rxPkt].u.raw;
+        while ((messageLength = drvRadioRead(message, RADIO_MAXPACKET)) != 0)
         {
-            /* Yield has been requested, clear yield flag. */
-            radioYield = FALSE;
-            /* End the current radio poll cycle now. */
-            return;
+            /* Process the received packet. */
+            radioPacketHandler(message, messageLength);
+
+            /* Check for yield flag set by handler. */
+            if (radioYield)
+            {
+                /* Yield has been requested, clear yield flag. */
+                radioYield = FALSE;
+                /* End the current radio poll cycle now. */
+                radioPktRelease(rxPkt);
+                return;
+            }
         }
+        radioPktRelease(rxPkt);
     }
 
 
@@ -441,6 +868,9 @@ void radioPoll(void)
         return;
     }
 
+    /* Push LCD changes to a remote control subscriber. */
+    radioRcLcdPoll();
+
     /* if radio is scaning for gateway check for timeout */
     if(radioStatus == RADIO_STATUS_SCANNING)
     {
@@ -603,6 +1033,16 @@ void radioPoll(void)
            }
            radioCheckExpanStatusTime = dtTickCount;
         }
+
+        // keep the expansion status digest cache fresh for NOC status queries
+        if (dtElapsedSeconds(radioDigestRefreshTime) > RADIO_DIGEST_REFRESH_SECS)
+        {
+            expansionDigestRequest();
+            radioDigestRefreshTime = dtTickCount;
+        }
+        
+        // send the next delta config segment to the expansion units
+        expansionCfgDistPoll();
     } 
     else
     {
@@ -1007,9 +1447,8 @@ static void radioPacketZigBeeRxData(const uint8_t *pBuf, int16_t length)
     */
     if (radioDebug)
     {
-        debugWrite("Received ZigBee Data Packet.  API header:  ");
-        debugHexWrite(pBuf, woffsetof(radioRxDataPacket_t, data), FALSE);
-        debugHexWrite(pp->data, length - woffsetof(radioRxDataPacket_t, data), TRUE);
+        debugTrace(DEBUG_TRACE_RADIO_RX, hdr->msgType,
+                   length - woffsetof(radioRxDataPacket_t, data), 0, 0);
     }
 
     /*
@@ -1018,13 +1457,21 @@ static void radioPacketZigBeeRxData(const uint8_t *pBuf, int16_t length)
     if (hdr->version == RADIO_PROTOCOL_VER)
     {
         //set radio status to online since received a message over the air
-        radioStatus = RADIO_STATUS_ONLINE;
+        if (!radioRxWired && !radioReplayActive)
+        {
+            radioStatus = RADIO_STATUS_ONLINE;
+        }
         
         switch (hdr->msgType)
         {
             case RADIO_TYPE_CMD:
                 /* Handle WOIS radio command packet. */
                 radioProtocolCommandHandler(pp);
+                radioProtoStatCur = RADIO_PSTAT_NONE;
+                if (radioProtoStatResetPending)
+                {
+                    radioProtoStatReset();
+                }
                 break;
 
 
@@ -1037,6 +1484,11 @@ static void radioPacketZigBeeRxData(const uint8_t *pBuf, int16_t length)
             case RADIO_TYPE_XFER:
                 /* Handle WOIS bulk data transfer packet. */
                 radioProtocolXferHandler(pp);
+                radioProtoStatCur = RADIO_PSTAT_NONE;
+                if (radioProtoStatResetPending)
+                {
+                    radioProtoStatReset();
+                }
                 break;
 
             case RADIO_TYPE_LOOPBACK:
@@ -1076,7 +1528,7 @@ static void radioPacketZigBeeRxData(const uint8_t *pBuf, int16_t length)
         }
     }
 
-    if (radioMonitorRss)
+    if (radioMonitorRss && !radioRxWired && !radioReplayActive)
     {
         /* Get received signal strength. */
         radioCommandEnqueue(RADIO_CMD_DB);
@@ -1366,135 +1818,45 @@ static void radioPacketModemStatus(const uint8_t *pBuf, int16_t length)
 static void radioPacketZigBeeTxStatus(const uint8_t *pBuf, int16_t length)
 {
     radioTxStatPacket_t *pp = (radioTxStatPacket_t *)pBuf;
-    char debugBuf[8];
+    uint8_t i;
 
     if (radioDebug)
     {
-        debugWrite("Received ZigBee Transmit Status (FID=");
-        sprintf(debugBuf, "%02X):  ", pp->frameId);
-        debugWrite(debugBuf);
+        debugTrace(DEBUG_TRACE_RADIO_TXSTAT, pp->frameId, pp->status,
+                   pp->discovery, pp->retryCount);
     }
 
-    switch (pp->status)
+    /* Find the queued frame this status is for. */
+    for (i = 0; i < RADIO_TXQ_SIZE; i++)
     {
-        case RADIO_TXSTAT_OK:
-            /* Successful transmission */
-            /* Clear Tx Data retry counter if success for last message sent. */
-            if (pp->frameId == radioTxDataPkt.frameId)
-            {
-                radioTxDataRetriesRemaining = 0;
-            }
-            if (radioDebug)
-            {
-                debugWrite("SUCCESS!  ");
-            }
-            break;
-        case RADIO_TXSTAT_CCAF:
-            if (radioDebug)
-            {
-                debugWrite("FAILURE (CCA failure). ");
-            }
-            break;
-        case RADIO_TXSTAT_INVDEST:
-            if (radioDebug)
-            {
-                debugWrite("FAILURE (invalid destination endpoint). ");
-            }
-            break;
-        case RADIO_TXSTAT_ACKFAIL:
-            if (radioDebug)
-            {
-                debugWrite("FAILURE (network ACK failure). ");
-            }
-            break;
-        case RADIO_TXSTAT_NOTJOINED:
-            if (radioDebug)
-            {
-                debugWrite("FAILURE (not joined to network). ");
-            }
-            break;
-        case RADIO_TXSTAT_SELFADDR:
-            if (radioDebug)
-            {
-                debugWrite("FAILURE (self-addressed). ");
-            }
-            break;
-        case RADIO_TXSTAT_ADDRNFND:
-            if (radioDebug)
-            {
-                debugWrite("FAILURE (address not found). ");
-            }
-            break;
-        case RADIO_TXSTAT_ROUTNFND:
-            if (radioDebug)
-            {
-                debugWrite("FAILURE (route not found). ");
-            }
-            break;
-        default:
-            if (radioDebug)
-            {
-                debugWrite("UNKNOWN STATUS=0x");
-                sprintf(debugBuf, "%02X. ", pp->status);
-                debugWrite(debugBuf);
-            }
+        if ((radioTxq[i].state == RADIO_TXQ_INFLIGHT) &&
+            (radioTxq[i].frameId == pp->frameId))
+        {
             break;
+        }
     }
-
-    switch (pp->discovery)
+    if (i < RADIO_TXQ_SIZE)
     {
-        case RADIO_TXDISC_NOVHD:
-            if (radioDebug)
-            {
-                debugWrite("No discovery overhead.\n");
-            }
-            break;
-        case RADIO_TXDISC_ADDR:
-            if (radioDebug)
-            {
-                debugWrite("Used address discovery.\n");
-            }
-            break;
-        case RADIO_TXDISC_ROUTE:
-            if (radioDebug)
-            {
-                debugWrite("Used route discovery.\n");
-            }
-            break;
-        case RADIO_TXDISC_ADROUTE:
-            if (radioDebug)
-            {
-                debugWrite("Used both address and route discovery.\n");
-            }
-            break;
-        default:
-            if (radioDebug)
+        /* If failure and retries remaining, queue the frame to send again. */
+        if ((pp->status != RADIO_TXSTAT_OK) && (radioTxq[i].retries > 0))
+        {
+            radioTxq[i].retries--;
+            radioTxq[i].state = RADIO_TXQ_PENDING;
+        }
+        else
+        {
+            if ((pp->status != RADIO_TXSTAT_OK) &&
+                (radioTxq[i].stat != RADIO_PSTAT_NONE) &&
+                (radioProtoStat[radioTxq[i].stat].type != RADIO_PSTAT_FREE))
             {
-                debugWrite("Unknown discovery status.\n");
+                /* Response to a WOIS message was not delivered. */
+                radioProtoStat[radioTxq[i].stat].txFail++;
             }
-            break;
-    }
-
-    if (radioDebug)
-    {
-        /* Write hex message data to debug output. */
-        debugHexWrite(pBuf, length, TRUE);
-    }
-
-    /* If failure was on last frame sent, and retries remaining... */
-    if ((pp->frameId == radioTxDataPkt.frameId) &&
-        (radioTxDataRetriesRemaining > 0))
-    {
-        /* Decrement Tx Data retry counter. */
-        radioTxDataRetriesRemaining--;
-
-        if (radioDebug)
-        {
-            debugWrite("Re-");
+            radioTxqFree(&radioTxq[i]);
         }
 
-        /* Retry sending last Tx Data packet. */
-        radioDataWrite(&radioTxDataPkt, radioTxDataPktLen);
+        /* The destination may now send its next frame. */
+        radioTxqService();
     }
 }
 
@@ -2051,6 +2413,12 @@ bool_t radioCommandSend(uint8_t frameId,
  *      Specifying frameId of zero will suppress the Tx Status response from
  *      the RF module.
  *
+ *      The payload data is copied into a packet buffer, which is placed in
+ *      the Tx data queue and sent right away if the radio (or the wired
+ *      expansion bus, for a wired unit) has room for it and no higher
+ *      priority frame is waiting.  FALSE is returned if no packet buffer is
+ *      free or the queue is full of frames of equal or higher priority.
+ *
  *****************************************************************************/
 bool_t radioDataSend(uint8_t frameId,
                      uint16_t netAddr,
@@ -2059,39 +2427,119 @@ bool_t radioDataSend(uint8_t frameId,
                      const uint8_t *pData,
                      int16_t lenData)
 {
-    int i;
-    uint16_t length;
+    uint8_t pkt;
+    bool_t result;
 
-    radioTxDataPkt.apiType = RADIO_API_TXDATA;
-    radioTxDataPkt.frameId = frameId;
-    radioTxDataPkt.phyAddr[0] = (uint8_t)(phyAddrH >> 24);
-    radioTxDataPkt.phyAddr[1] = (uint8_t)((phyAddrH & 0x00FF0000) >> 16);
-    radioTxDataPkt.phyAddr[2] = (uint8_t)((phyAddrH & 0x0000FF00) >> 8);
-    radioTxDataPkt.phyAddr[3] = (uint8_t)(phyAddrH & 0x000000FF);
-    radioTxDataPkt.phyAddr[4] = (uint8_t)(phyAddrL >> 24);
-    radioTxDataPkt.phyAddr[5] = (uint8_t)((phyAddrL & 0x00FF0000) >> 16);
-    radioTxDataPkt.phyAddr[6] = (uint8_t)((phyAddrL & 0x0000FF00) >> 8);
-    radioTxDataPkt.phyAddr[7] = (uint8_t)(phyAddrL & 0x000000FF);
-    radioTxDataPkt.bcastRadius = 0;
-    radioTxDataPkt.options = 0x00; // use 0 for production Code, 0x08 tio enable trace route
-    radioTxDataPkt.netAddr[0] = netAddr >> 8;
-    radioTxDataPkt.netAddr[1] = netAddr & 0x00FF;
-    for (i = 0; i < lenData; i++)
+    /* Replayed traffic is only measured, never answered. */
+    if (radioReplayActive)
+    {
+        radioReplayTxFrames++;
+        return TRUE;
+    }
+
+    if (lenData > RADIO_MAXPAYLOAD)
+    {
+        return FALSE;
+    }
+    pkt = radioPktAlloc();
+    if (pkt == RADIO_PKT_NONE)
+    {
+        radioTxqStat[radioTxPriorityGet(phyAddrH, phyAddrL,
+                                        pData, lenData)].dropped++;
+        return FALSE;
+    }
+    memcpy(radioPktData(pkt), pData, lenData);
+
+    result = radioPktSend(frameId, netAddr, phyAddrH, phyAddrL, pkt, lenData);
+    radioPktRelease(pkt);
+    return result;
+}
+
+
+/******************************************************************************
+ *
+ * radioPktSend
+ *
+ * PURPOSE
+ *      This routine queues the ZigBee data packet payload held in a packet
+ *      buffer for sending to a destination.
+ *
+ * PARAMETERS
+ *      frameId     IN  frame identifier (corelates with any ZigBee Tx Status)
+ *      netAddr     IN  destination network address (16-bits)
+ *      phyAddrH    IN  destination phy address (high 32-bits)
+ *      phyAddrL    IN  destination phy address (low 32-bits)
+ *      pkt         IN  packet buffer holding the application payload data
+ *      lenData     IN  length of the application payload data
+ *
+ * RETURN VALUE
+ *      Return value is TRUE for success; FALSE for failure.
+ *
+ * NOTES
+ *      The queue element takes its own reference to the packet buffer, so
+ *      the caller still releases its reference when done.  The same packet
+ *      buffer may be queued to several destinations; the payload must not
+ *      be changed until the caller's reference is released.
+ *
+ *****************************************************************************/
+static bool_t radioPktSend(uint8_t frameId,
+                           uint16_t netAddr,
+                           uint32_t phyAddrH,
+                           uint32_t phyAddrL,
+                           uint8_t pkt,
+                           int16_t lenData)
+{
+    uint8_t prio;
+    radioTxq_t *pTxq;
+    uint8_t *pData = radioPktData(pkt);
+
+    /* Replayed traffic is only measured, never answered. */
+    if (radioReplayActive)
+    {
+        radioReplayTxFrames++;
+        return TRUE;
+    }
+
+    /* Find a free queue element for this frame's priority class. */
+    prio = radioTxPriorityGet(phyAddrH, phyAddrL, pData, lenData);
+    pTxq = radioTxqAlloc(prio);
+    if (pTxq == NULL)
     {
-        radioTxDataPkt.data[i] = pData[i];
+        radioTxqStat[prio].dropped++;
+        return FALSE;
     }
 
-    /* Set packet length. */
-    length = woffsetof(radioTxDataPacket_t, data) + lenData;
+    pTxq->frameId = frameId;
+    pTxq->stat = radioProtoStatCur;
+    pTxq->transport =
+        radioExpBusIsWired(((uint64_t)phyAddrH << 32) | phyAddrL) ?
+        RADIO_TXQ_WIRED : RADIO_TXQ_RADIO;
+    pTxq->phyAddr[0] = (uint8_t)(phyAddrH >> 24);
+    pTxq->phyAddr[1] = (uint8_t)((phyAddrH & 0x00FF0000) >> 16);
+    pTxq->phyAddr[2] = (uint8_t)((phyAddrH & 0x0000FF00) >> 8);
+    pTxq->phyAddr[3] = (uint8_t)(phyAddrH & 0x000000FF);
+    pTxq->phyAddr[4] = (uint8_t)(phyAddrL >> 24);
+    pTxq->phyAddr[5] = (uint8_t)((phyAddrL & 0x00FF0000) >> 16);
+    pTxq->phyAddr[6] = (uint8_t)((phyAddrL & 0x0000FF00) >> 8);
+    pTxq->phyAddr[7] = (uint8_t)(phyAddrL & 0x000000FF);
+    pTxq->netAddr[0] = netAddr >> 8;
+    pTxq->netAddr[1] = netAddr & 0x00FF;
+
+    /* Take a reference to the packet buffer holding the payload. */
+    radioPkt[pkt].refs++;
+    pTxq->pkt = pkt;
+    pTxq->len = (uint8_t)lenData;
 
     /* Set number of retries. */
-    radioTxDataRetriesRemaining = RADIO_TXD_N_RETRIES;
+    pTxq->retries = RADIO_TXD_N_RETRIES;
 
-    /* Set length of Tx Data packet. */
-    radioTxDataPktLen = length;
+    pTxq->prio = prio;
+    pTxq->time = drvMSGet();
+    pTxq->state = RADIO_TXQ_PENDING;
 
-    /* Send Tx Data packet. */
-    return radioDataWrite(&radioTxDataPkt, radioTxDataPktLen);
+    /* Send the frame if its transport has room for it. */
+    radioTxqService();
+    return TRUE;
 }
 
 
@@ -2112,20 +2560,11 @@ bool_t radioDataSend(uint8_t frameId,
  *****************************************************************************/
 bool_t radioDataWrite(radioTxDataPacket_t *msg, uint16_t length)
 {
-    char debugbuf[8];
-
     if (radioDebug)
     {
-        debugWrite("Sent ZigBee Data Packet (FID=");
-        sprintf(debugbuf, "%02X", msg->frameId);
-        debugWrite(debugbuf);
-        debugWrite(").  API header:  ");
-        debugHexWrite((uint8_t *)&radioTxDataPkt,
-                      woffsetof(radioTxDataPacket_t, data),
-                      FALSE);
-        debugHexWrite(radioTxDataPkt.data,
-                      length - woffsetof(radioTxDataPacket_t, data),
-                      TRUE);
+        debugTrace(DEBUG_TRACE_RADIO_TX, msg->frameId,
+                   length - woffsetof(radioTxDataPacket_t, data),
+                   ((radioMsgHeader_t *)msg->data)->msgType, 0);
     }
 
     radioTxDataTime = dtTickCount;
@@ -2135,1328 +2574,1013 @@ bool_t radioDataWrite(radioTxDataPacket_t *msg, uint16_t length)
 
 /******************************************************************************
  *
- * radioLoopbackDataSend
+ * radioTxPriorityGet
  *
  * PURPOSE
- *      This routine sends a ZigBee data packet to the RF module, using ZigBee
- *      explicit addressing to specify the XBee serial loopback data cluster
- *      ID on the destination endpoint.
+ *      This routine determines the Tx priority class of a data packet from
+ *      its message type and destination.
  *
  * PARAMETERS
  *      phyAddrH    IN  destination phy address (high 32-bits)
  *      phyAddrL    IN  destination phy address (low 32-bits)
- *      netAddr     IN  destination network address (16-bits)
- *      frameId     IN  frame identifier (corelates with any ZigBee Tx Status)
- *      pData       IN  pointer to start of loopback data
- *      lenData     IN  length of the loopback data
+ *      pData       IN  pointer to start of application payload data
+ *      lenData     IN  length of the application payload data
  *
  * RETURN VALUE
- *      Return value is TRUE for success; FALSE for failure.
- *
- * NOTES
- *      Specifying frameId of zero will suppress the Tx Status response from
- *      the RF module.
+ *      This routine returns the priority class (RADIO_TXP_xxx).
  *
  *****************************************************************************/
-
-static bool_t radioLoopbackDataSend(const uint8_t *pData, int16_t lenData)
+static uint8_t radioTxPriorityGet(uint32_t phyAddrH,
+                                  uint32_t phyAddrL,
+                                  const uint8_t *pData,
+                                  int16_t lenData)
 {
-    return radioDataSend(RADIO_API_TXDATA,0xFFFE,0x00000000,0x0000FFFF, pData,lenData);
-}
+    uint64_t dest = ((uint64_t)phyAddrH << 32) | phyAddrL;
 
+    if (lenData >= sizeof(radioMsgHeader_t))
+    {
+        switch (((const radioMsgHeader_t *)pData)->msgType)
+        {
+            case RADIO_TYPE_SC_ASSOC:
+            case RADIO_TYPE_SC_STATUS:
+            case RADIO_TYPE_SC_DEASSOC:
+                /* sensor concentrator valve state and sleep time */
+                return RADIO_TXP_VALVE;
+            case RADIO_TYPE_XFER:
+                return RADIO_TXP_BULK;
+            default:
+                break;
+        }
+    }
+
+    /* commands and acks between the master and its expansion units */
+    if ((expansionUnitIndex(dest) < (SYS_N_UNITS - 1)) ||
+        ((config.sys.unitType != UNIT_TYPE_MASTER) &&
+         (dest == config.sys.masterMac)))
+    {
+        return RADIO_TXP_IRR;
+    }
+
+    return RADIO_TXP_NOC;
+}
 
 
 /******************************************************************************
  *
- * radioProtocolCommandHandler
+ * radioTxqAlloc
  *
  * PURPOSE
- *      This routine handles received WaterOptimizer application command
- *      packets.
+ *      This routine allocates a Tx data queue element for a new frame.
  *
  * PARAMETERS
- *      pPacket     IN  pointer to start of packet
+ *      prio        IN  priority class of the new frame
  *
  * RETURN VALUE
- *      None.
+ *      This routine returns a pointer to the queue element, or NULL if the
+ *      queue is full of frames of equal or higher priority.
+ *
+ * NOTES
+ *      When the queue is full, the newest waiting frame of the lowest
+ *      priority class below prio is dropped to make room.
  *
  *****************************************************************************/
-static void radioProtocolCommandHandler(const radioRxDataPacket_t *pPacket)
+static radioTxq_t *radioTxqAlloc(uint8_t prio)
 {
-    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
-    uint16_t crc;
-    uint16_t crcMsg;
-    uint8_t cmdAck;
-    uint32_t etData;
-    uint32_t rainfall;
-    int i;
-    uint8_t data[55];
-    uint8_t lenData = 0;
-    int16_t result;
-    char debugBuf[40];
-    uint64_t expMacID;
-    uint16_t tempMoistFailedSensors=0;
-    uint8_t offset=0;
-
-    /* Compute the CRC. */
-    crc = crc16(((uint8_t *)pMsg) + 4,
-                     RADIO_CMD_HEADER_SIZE - 4 + pMsg->dataLen);
+    uint8_t i;
+    uint8_t victim = RADIO_TXQ_NONE;
+    uint32_t now = drvMSGet();
 
-    /* Verify the CRC in the command message. */
-    
-    
-    crcMsg = (pMsg->hdr.crcHigh << 8) | pMsg->hdr.crcLow;
-    
-    if (crcMsg != crc)
+    for (i = 0; i < RADIO_TXQ_SIZE; i++)
     {
-        if (radioDebug)
+        if (radioTxq[i].state == RADIO_TXQ_FREE)
         {
-            debugWrite("Received WOIS Cmd with INVALID CRC ");
-            sprintf(debugBuf,"%04X (Expected %04X)\n.",
-                crcMsg, crc);
-            debugWrite(debugBuf);
+            return &radioTxq[i];
+        }
+        if ((radioTxq[i].state == RADIO_TXQ_PENDING) &&
+            (radioTxq[i].prio > prio))
+        {
+            if ((victim == RADIO_TXQ_NONE) ||
+                (radioTxq[i].prio > radioTxq[victim].prio) ||
+                ((radioTxq[i].prio == radioTxq[victim].prio) &&
+                 ((now - radioTxq[i].time) < (now - radioTxq[victim].time))))
+            {
+                victim = i;
+            }
         }
-        return;
-    } 
-    
-
-    if (pMsg->hdr.msgType == RADIO_TYPE_ACK)
-    {
-        /* Debug test command acknowledge.  Send to debug test command handler. */
-        radioExtCommandHandler(pPacket);
-        return;
-    }
-    
-    //dtflag = pMsg->cmd;
-    //get the source address
-    expMacID = U8TOU64(pPacket->phyAddr[0],
-                       pPacket->phyAddr[1],
-                       pPacket->phyAddr[2],
-                       pPacket->phyAddr[3],
-                       pPacket->phyAddr[4],
-                       pPacket->phyAddr[5],
-                       pPacket->phyAddr[6],
-                       pPacket->phyAddr[7]);
-    
-    /* inform the system that communication was received from the proper expansion */
-    if(expMacID ==config.sys.expMac1)
-    {
-        radioStatusExpansion1 = EXPANSION_CONNECTED;
-        radioSentExpan1Msg = FALSE;
-        sysFaultClear(SYS_FAULT_EXPAN_1);
-    }
-    else if(expMacID ==config.sys.expMac2)
-    {
-        radioStatusExpansion2 = EXPANSION_CONNECTED;
-        radioSentExpan2Msg = FALSE;
-        sysFaultClear(SYS_FAULT_EXPAN_2);
     }
-    else if(expMacID ==config.sys.expMac3)
+
+    if (victim == RADIO_TXQ_NONE)
     {
-        radioStatusExpansion3 = EXPANSION_CONNECTED;
-        radioSentExpan3Msg = FALSE;
-        sysFaultClear(SYS_FAULT_EXPAN_3);
+        return NULL;
     }
-    else if(expMacID ==config.sys.masterMac)
+    radioTxqStat[radioTxq[victim].prio].dropped++;
+    radioTxqFree(&radioTxq[victim]);
+    return &radioTxq[victim];
+}
+
+
+/******************************************************************************
+ *
+ * radioTxqFree
+ *
+ * PURPOSE
+ *      This routine frees a Tx data queue element and releases its reference
+ *      to the packet buffer holding the payload.
+ *
+ * PARAMETERS
+ *      pTxq        IN  pointer to the queue element
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ *****************************************************************************/
+static void radioTxqFree(radioTxq_t *pTxq)
+{
+    if (pTxq->state != RADIO_TXQ_FREE)
     {
-        radioSentMasterMsg = FALSE;
-        sysFaultClear(SYS_FAULT_EXPAN_MASTER);
+        pTxq->state = RADIO_TXQ_FREE;
+        radioPktRelease(pTxq->pkt);
+        pTxq->pkt = RADIO_PKT_NONE;
     }
+}
 
-    /* Handle the command. */
-    switch (pMsg->cmd)
-    {
-        case RADIO_CMD_NO_OP:
-            radioMessageLog("No Op");
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: NO OP\n");
-            }
-            /* Do nothing but acknowledge. */
-            cmdAck = RADIO_ACK_NO_OP;
-            
-            /* forward message onto expasion units if master */
-            if((config.sys.unitType == UNIT_TYPE_MASTER)&&
-               (expMacID != config.sys.expMac1)&&
-               (expMacID != config.sys.expMac2)&&
-               (expMacID != config.sys.expMac3))
-            {
-                expansionBusForwardCmd(pPacket);
-            }
-            /* send updated time to unit that sent NO OP */
-            if((config.sys.unitType == UNIT_TYPE_MASTER)&&
-               ((expMacID == config.sys.expMac1)||
-               (expMacID == config.sys.expMac2)||
-               (expMacID == config.sys.expMac3)))
-            {
-                expansionBusSendCmd(RADIO_CMD_INIT_DATETIME, expMacID);
-            }
-            break;
 
-        case RADIO_CMD_INHIBIT_ON:
-            radioMessageLog("Inhibit On");
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: INHIBIT ON\n");
-            }
-            /* Set Inhibit On. */
-            sysInhibitOn();
-            cmdAck = RADIO_ACK_INHIBIT_ON;
-            
-            /* forward message onto expasion units if master */
-            if((config.sys.unitType == UNIT_TYPE_MASTER)&&
-               (expMacID != config.sys.expMac1)&&
-               (expMacID != config.sys.expMac2)&&
-               (expMacID != config.sys.expMac3))
-            {
-                expansionBusForwardCmd(pPacket);
-            }
-            
-            break;
+/******************************************************************************
+ *
+ * radioTxqSelect
+ *
+ * PURPOSE
+ *      This routine selects the next Tx data queue frame to send.
+ *
+ * PARAMETERS
+ *      blocked     IN  mask of transports with a full transmit buffer
+ *
+ * RETURN VALUE
+ *      This routine returns the queue element index of the frame to send,
+ *      or RADIO_TXQ_NONE if no frame can be sent now.
+ *
+ * NOTES
+ *      The highest priority class is served first.  Within a class a frame
+ *      for a different destination than the last one served is preferred,
+ *      then the frame that has waited longest.  Frames for a destination
+ *      that already has RADIO_TXQ_DEST_INFLIGHT frames awaiting Tx status
+ *      are held back.
+ *
+ *****************************************************************************/
+static uint8_t radioTxqSelect(uint8_t blocked)
+{
+    uint8_t i;
+    uint8_t j;
+    uint8_t nInFlight;
+    uint8_t best = RADIO_TXQ_NONE;
+    bool_t isRepeat;
+    bool_t bestIsRepeat = FALSE;
+    uint32_t now = drvMSGet();
+    radioTxq_t *pTxq;
+
+    for (i = 0; i < RADIO_TXQ_SIZE; i++)
+    {
+        pTxq = &radioTxq[i];
+        if ((pTxq->state != RADIO_TXQ_PENDING) ||
+            ((pTxq->transport & blocked) != 0))
+        {
+            continue;
+        }
 
-        case RADIO_CMD_INHIBIT_OFF:
-            radioMessageLog("Inhibit Off");
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: INHIBIT OFF\n");
-            }
-            /* Set Inhibit Off. */
-            sysInhibitOff();
-            cmdAck = RADIO_ACK_INHIBIT_OFF;
-            
-            /* forward message onto expasion units if master */
-            if((config.sys.unitType == UNIT_TYPE_MASTER)&
-               (expMacID != config.sys.expMac1)&&
-               (expMacID != config.sys.expMac2)&&
-               (expMacID != config.sys.expMac3))
+        /* Limit the frames awaiting Tx status for each destination. */
+        nInFlight = 0;
+        for (j = 0; j < RADIO_TXQ_SIZE; j++)
+        {
+            if ((radioTxq[j].state == RADIO_TXQ_INFLIGHT) &&
+                (memcmp(radioTxq[j].phyAddr,
+                        pTxq->phyAddr,
+                        RADIO_SZ_MAC_ID) == 0))
             {
-                expansionBusForwardCmd(pPacket);
+                nInFlight++;
             }
-            break;
+        }
+        if (nInFlight >= RADIO_TXQ_DEST_INFLIGHT)
+        {
+            continue;
+        }
 
-        case RADIO_CMD_FORCE_ON:
-            radioMessageLog("Force On");
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: FORCE ON\n");
-            }
-            /* Force On. */
-            irrCmdForceOn();
-            cmdAck = RADIO_ACK_FORCE_ON;
-            break;
+        isRepeat = (U8TOU32(pTxq->phyAddr[4],
+                            pTxq->phyAddr[5],
+                            pTxq->phyAddr[6],
+                            pTxq->phyAddr[7]) ==
+                    radioTxqLastDest[pTxq->prio]);
+
+        if ((best == RADIO_TXQ_NONE) ||
+            (pTxq->prio < radioTxq[best].prio) ||
+            ((pTxq->prio == radioTxq[best].prio) &&
+             ((bestIsRepeat && !isRepeat) ||
+              ((isRepeat == bestIsRepeat) &&
+               ((now - pTxq->time) > (now - radioTxq[best].time))))))
+        {
+            best = i;
+            bestIsRepeat = isRepeat;
+        }
+    }
 
-        case RADIO_CMD_WEATHER_DATA:
-            if (pMsg->dataLen != 8)
-            {
-                /* Incorrect data length. */
-                if (radioDebug)
-                {
-                    debugWrite("WOIS Cmd: WEATHER UPDATE - Bad data len.\n");
-                }
-                return;
-            }
-            /* Extract the 4 bytes of ET data from the command message. */
-            etData = U8TOU32(pMsg->data[0],
-                             pMsg->data[1],
-                             pMsg->data[2],
-                             pMsg->data[3]);
-            /* Extract the 4 bytes of rainfall data from the command message. */
-            rainfall = U8TOU32(pMsg->data[4],
-                               pMsg->data[5],
-                               pMsg->data[6],
-                               pMsg->data[7]);
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: WEATHER UPDATE (ET=0x");
-                sprintf(debugBuf, "%08X", etData);
-                debugWrite(debugBuf);
-                debugWrite("; Rain=0x");
-                sprintf(debugBuf, "%08X)\n", rainfall);
-                debugWrite(debugBuf);
-            }
-            cmdAck = RADIO_ACK_WEATHER_DATA;
-            lenData = 2;
-            /* Attempt to apply weather update data. */
-            if (radioProtoCmdWeatherUpdate(etData, rainfall))
-            {
-                /* Weather update applied successfully. */
-                radioMessageLog("Weather Update");
-                data[0] = RADIO_RESULT_SUCCESS;
-            }
-            else
-            {
-                /* Weather data not applied; accumulator re-sync occurred. */
-                radioMessageLog("Weather Sync");
-                data[0] = RADIO_RESULT_FAILURE;
-            }
-            /* Indicate if system is configured for Weather mode. */
-            if (config.sys.opMode == CONFIG_OPMODE_WEATHER)
-            {
-                /* Weather operation mode in use. */
-                data[1] = RADIO_WEATHER_MODE_ON;
-            }
-            else
-            {
-                /* Weather operation mode not in use. */
-                data[1] = RADIO_WEATHER_MODE_OFF;
-            }
-            
-            /* forward message onto expasion units if master */
-            if((config.sys.unitType == UNIT_TYPE_MASTER)&&
-               (expMacID != config.sys.expMac1)&&
-               (expMacID != config.sys.expMac2)&&
-               (expMacID != config.sys.expMac3))
-            {
-                expansionBusForwardCmd(pPacket);
-            }
-            break;
+    return best;
+}
 
-        case RADIO_CMD_GET_MOIST:
-            radioMessageLog("Get Moisture");
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: GET MOISTURE VALUES\n");
-            }
-            cmdAck = RADIO_ACK_GET_MOIST;
-            lenData = config.sys.numZones;
-            for (i = 0; i < lenData; i++)
-            {
-                /* Get zone moisture value. */
-                data[i] = sysRadioMoistValueGet(i);
-            }
-            break;
 
-        case RADIO_CMD_GET_EXSTAT:
-            radioMessageLog("Get Ext Status");
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: GET EXTENDED STATUS\n");
-            }
-            cmdAck = RADIO_ACK_GET_EXSTAT;
-            /* Get Extended System Status data. */
-            lenData = sysRadioExtStatusGet(data);
-            break;
-        case RADIO_CMD_GET_EXSTAT_2:
-            radioMessageLog("Get Ext Status Part 2");
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: GET EXTENDED STATUS 2\n");
-            }
-            cmdAck = RADIO_ACK_GET_EXSTAT_2;
-            for(i=0; i<(SYS_N_ZONES/2); i++)
-            {
-                data[2*i]=(irrDailyRuntimePerZone[i] >> 8);
-                data[2*i+1]=(irrDailyRuntimePerZone[i] & 0xFF);    
-            }
-            lenData = 48;
-            break;
-        
-        case RADIO_CMD_GET_EXSTAT_3:
-            radioMessageLog("Get Ext Status Part 3");
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: GET EXTENDED STATUS 3\n");
-            }
-            cmdAck = RADIO_ACK_GET_EXSTAT_3;
-            for(i=0; i<(SYS_N_ZONES/2); i++)
-            {
-                data[2*i]=(irrDailyRuntimePerZone[i+24] >> 8);
-                data[2*i+1]=(irrDailyRuntimePerZone[i+24] & 0xFF);    
-            }
-            lenData = 48;
-            break;
-            
-        case RADIO_CMD_CFG_GET_SNAP:
-            radioMessageLog("Start Cfg Upload");
-            debugWrite("WOIS Cmd: START CONFIGURATION UPLOAD\n");
-            cmdAck = RADIO_ACK_CFG_GET_SNAP;
-            lenData = 8;
-            /* Configuration Version */
-            data[0] = (uint8_t)(ntohs(config.sys.version) >> 8);
-            data[1] = (uint8_t)(ntohs(config.sys.version) & 0xFF);
-            /* Configuration Checksum */
-            data[2] = (uint8_t)(ntohs(config.sys.checkSum) >> 8);
-            data[3] = (uint8_t)(ntohs(config.sys.checkSum) & 0xFF);
-            /* Configuration Data Image Size */
-            data[4] = (uint8_t)(CONFIG_IMAGE_SIZE >> 8);
-            data[5] = (uint8_t)(CONFIG_IMAGE_SIZE & 0xFF);
-            /* Configuration Data Segment Count */
-            data[6] = (uint8_t)(RADIO_CFG_SEGS >> 8);
-            data[7] = (uint8_t)(RADIO_CFG_SEGS & 0xFF);
-            /* Save configuration snapshot to upload buffer. */
-            configSnapshotSave();
-            break;
+/******************************************************************************
+ *
+ * radioTxqService
+ *
+ * PURPOSE
+ *      This routine writes queued Tx data frames to the radio, or to the
+ *      wired expansion bus, while their transmit buffer has room for them.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      The ZigBee Tx header is written in front of the payload in the
+ *      packet buffer for each transmission, since a packet buffer may be
+ *      shared by frames for several destinations.
+ *
+ *****************************************************************************/
+static void radioTxqService(void)
+{
+    uint8_t i;
+    uint8_t blocked = 0;
+    uint32_t queueMs;
+    radioTxq_t *pTxq;
+    radioTxqStat_t *pStat;
+    radioTxDataPacket_t *pPkt;
 
-        case RADIO_CMD_CFG_PUT_START:
-            radioMessageLog("Start Cfg Download");
-            debugWrite("WOIS Cmd: START CONFIGURATION DOWNLOAD\n");
-            cmdAck = RADIO_ACK_CFG_PUT_START;
-            lenData = 8;
-            /* Configuration Version */
-            data[0] = (uint8_t)(ntohs(config.sys.version) >> 8);
-            data[1] = (uint8_t)(ntohs(config.sys.version) & 0xFF);
-            /* Configuration Checksum */
-            data[2] = (uint8_t)(ntohs(config.sys.checkSum) >> 8);
-            data[3] = (uint8_t)(ntohs(config.sys.checkSum) & 0xFF);
-            /* Configuration Data Image Size */
-            data[4] = (uint8_t)(CONFIG_IMAGE_SIZE >> 8);
-            data[5] = (uint8_t)(CONFIG_IMAGE_SIZE & 0xFF);
-            /* Configuration Data Segment Count */
-            data[6] = (uint8_t)(RADIO_CFG_SEGS >> 8);
-            data[7] = (uint8_t)(RADIO_CFG_SEGS & 0xFF);
-            /* Clear configuration download buffer to all 0xFF's. */
-            configBufferClear();
-            break;
+    for (;;)
+    {
+        i = radioTxqSelect(blocked);
+        if (i == RADIO_TXQ_NONE)
+        {
+            return;
+        }
+        pTxq = &radioTxq[i];
 
-        case RADIO_CMD_CFG_PUT_APPLY:
-            radioMessageLog("Apply Cfg Download");
-            debugWrite("WOIS Cmd: APPLY DOWNLOADED CONFIGURATION\n");
-            cmdAck = RADIO_ACK_CFG_PUT_APPLY;
-            lenData = 3;
-            /* Request to Apply the configuration image in the download buffer. */
-            result = configBufferLoad();
-            if (result == -1)
+        if (pTxq->transport == RADIO_TXQ_WIRED)
+        {
+            if (!radioExpBusSend(U8TOU32(pTxq->phyAddr[0],
+                                         pTxq->phyAddr[1],
+                                         pTxq->phyAddr[2],
+                                         pTxq->phyAddr[3]),
+                                 U8TOU32(pTxq->phyAddr[4],
+                                         pTxq->phyAddr[5],
+                                         pTxq->phyAddr[6],
+                                         pTxq->phyAddr[7]),
+                                 radioPktData(pTxq->pkt),
+                                 pTxq->len))
             {
-                data[0] = RADIO_RESULT_SUCCESS;     /* success */
-                data[1] = 0;
-                data[2] = 0;
-                debugWrite("Configuration applied.\n");
-                
-               sysFaultClear(SYS_FAULT_EXPAN_MASTER);
-               sysFaultClear(SYS_FAULT_EXPAN_1);
-               sysFaultClear(SYS_FAULT_EXPAN_2);
-               sysFaultClear(SYS_FAULT_EXPAN_3);
+                /* Bus transmit buffer full; try again next poll. */
+                blocked |= RADIO_TXQ_WIRED;
+                continue;
             }
-            else
+        }
+        else
+        {
+            pPkt = &radioPkt[pTxq->pkt].u.tx;
+            pPkt->apiType = RADIO_API_TXDATA;
+            pPkt->frameId = pTxq->frameId;
+            memcpy(pPkt->phyAddr, pTxq->phyAddr, RADIO_SZ_MAC_ID);
+            memcpy(pPkt->netAddr, pTxq->netAddr, RADIO_SZ_NET_AD);
+            pPkt->bcastRadius = 0;
+            pPkt->options = 0x00; // use 0 for production Code, 0x08 tio enable trace route
+
+            if (!radioDataWrite(pPkt,
+                                woffsetof(radioTxDataPacket_t, data) +
+                                pTxq->len))
             {
-                data[0] = RADIO_RESULT_FAILURE;     /* failure */
-                data[1] = result >> 8;      /* offset to bad config data MSB */
-                data[2] = result & 0x00FF;  /* offset to bad config data LSB */
-                debugWrite("Configuration not applied - invalid image.\n");
+                /* Radio transmit buffer full; try again next poll. */
+                blocked |= RADIO_TXQ_RADIO;
+                continue;
             }
-            break;
+        }
 
-        case RADIO_CMD_GET_MB_VALUES:
-            radioMessageLog("Get MB Values");
-            if (pMsg->dataLen != 1)
-            {
-                /* Incorrect data length. */
-                if (radioDebug)
-                {
-                    debugWrite("WOIS Cmd: GET MB VALUES - Bad data len.\n");
-                }
-                return;
-            }
-            if (radioDebug)
+        /* Record queue time for the first transmission of the frame. */
+        if (pTxq->retries == RADIO_TXD_N_RETRIES)
+        {
+            queueMs = drvMSGet() - pTxq->time;
+            pStat = &radioTxqStat[pTxq->prio];
+            pStat->sent++;
+            pStat->totalMs += queueMs;
+            if (queueMs > pStat->maxMs)
             {
-                debugWrite("WOIS Cmd: GET MB VALUES (start zone=");
-                sprintf(debugBuf, "%d)\n", pMsg->data[0]);
-                debugWrite(debugBuf);
+                pStat->maxMs = (queueMs > 0xFFFF) ? 0xFFFF : (uint16_t)queueMs;
             }
-            /* Get Moisture Balance Values data. */
-            lenData = radioProtoCmdGetMbValues(pMsg->data[0], data);
-            cmdAck = RADIO_ACK_GET_MB_VALUES;
-            break;
+        }
+        radioTxqLastDest[pTxq->prio] = U8TOU32(pTxq->phyAddr[4],
+                                               pTxq->phyAddr[5],
+                                               pTxq->phyAddr[6],
+                                               pTxq->phyAddr[7]);
 
-        case RADIO_CMD_SET_MB_VALUES:
-            radioMessageLog("Set MB Values");
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: SET MB VALUES (start zone=");
-                sprintf(debugBuf, "%d)\n", pMsg->data[0]);
-                debugWrite(debugBuf);
-            }
-            cmdAck = RADIO_ACK_SET_MB_VALUES;
-            lenData = 1;
-            /* Set Moisture Balance Values from command data. */
-            if (radioProtoCmdSetMbValues(pMsg->data, pMsg->dataLen))
-            {
-                data[0] = RADIO_RESULT_SUCCESS;
-            }
-            else
-            {
-                data[0] = RADIO_RESULT_FAILURE;
-            }
-            break;
+        /* A frame ID of zero, or a wired frame, has no Tx status. */
+        if ((pTxq->frameId == 0) || (pTxq->transport == RADIO_TXQ_WIRED))
+        {
+            radioTxqFree(pTxq);
+        }
+        else
+        {
+            pTxq->state = RADIO_TXQ_INFLIGHT;
+            pTxq->time = drvMSGet();
+        }
+    }
+}
 
-        /* INIT DATE/TIME */
-        case RADIO_CMD_INIT_DATETIME:
-            radioMessageLog("Init Date/Time");
-            //dtflag = 88;
-            //dtdata = 
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: Init Date/Time\n");
-            }
-            cmdAck = RADIO_ACK_INIT_DATETIME;
-            lenData = 1;
-            /* Initialize response status to indicate failure. */
-            data[0] = RADIO_RESULT_FAILURE;
-            /* Only allow clock to be set if a date/time error is present. */
-            //if (sysErrorOn(SYS_ERROR_DATETIME))
-            {
-                if (pMsg->dataLen == 6)
-                {
-                    /* Set date/time in system real time clock. */
-                    
-                    if ( dtSetClock(  (uint16_t)((int)(pMsg->data[0]) + 2000),
-                                       pMsg->data[1],
-                                       pMsg->data[2],
-                                       pMsg->data[3],
-                                       pMsg->data[4],
-                                       pMsg->data[5] )   )
-                    {
-                        /* Update response status to indicate success. */
-                        data[0] = RADIO_RESULT_SUCCESS;
-                    }
-                }
-            }
-            
-            /* forward message onto expasion units if master */
-            if(config.sys.unitType == UNIT_TYPE_MASTER)
-            {
-                expansionBusForwardCmd(pPacket);
-            }
-            break;
-        case RADIO_CMD_SEND_FLOW:
-            cmdAck = RADIO_ACK_SEND_FLOW;
-            lenData = 4;
-            data[0] = RADIO_RESULT_FAILURE;
-            if (pMsg->dataLen == 4) {
-                slaveGPM = pMsg->data[0];
-                slaveFlowDelay = U8TOU16(pMsg->data[1],pMsg->data[2]);
-                slaveFindFlow = pMsg->data[3];
-                data[0] = RADIO_RESULT_SUCCESS;
-            }
-            break;
-        case RADIO_CMD_DIAGNOSE:
-            radioMessageLog("Diagnose");
-            if (pMsg->dataLen > 32)
-            {
-                /* Incorrect data length. */
-                if (radioDebug)
-                {
-                    debugWrite("WOIS Cmd: DIAGNOSE - Data len > 32.\n");
-                }
-                return;
-            }
-            memcpy(debugBuf, pMsg->data, pMsg->dataLen);
-            debugBuf[pMsg->dataLen] = '\0';
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: DIAGNOSE - '");
-                debugWrite(debugBuf);
-                debugWrite("'\n");
-            }
-            /*
-            **  NOTE:  No Diagnose commands are currently defined.
-            **         Always send "?" for the response string.
-            */
-            cmdAck = RADIO_ACK_DIAGNOSE;
-            lenData = 2;
-            data[0] = '?';
-            data[1] = '\0';
-            break;
-            
-        case RADIO_CMD_FW_PUT_START:
-            radioMessageLog("Start FW Download");
-            debugWrite("WOIS Cmd: START FIRWMARE DOWNLOAD\n");
-            cmdAck = RADIO_ACK_FW_PUT_START;
-            lenData = 8;
-            
-            /* Extract the 4 bytes of new firmware image size from the command message. */
-            newFirmwareSize = U8TOU32(pMsg->data[0],
-                                      pMsg->data[1],
-                                      pMsg->data[2],
-                                      pMsg->data[3]);
-            
-            /* Current Firmware Version */
-            data[0] = (uint8_t)(ntohs(sysFirmwareVer.major));
-            data[1] = (uint8_t)(ntohs(sysFirmwareVer.minor));
-            data[2] = (uint8_t)(ntohs(sysFirmwareVer.patch));
-            data[3] = (uint8_t)(ntohs(sysFirmwareVer.seq));
-            
-            /* Clear area of flash to all 0xFF's for firmware download. */
-            if(extFlashFWErase(EXT_FLASH_SEC_0) == TRUE)
-            {
-              data[4] = RADIO_RESULT_SUCCESS;  
-            } 
-            else
-            {
-              data[4] = RADIO_RESULT_FAILURE;
-            }
-            
-             /* Future Expansion */
-            data[5] = 0;            
-            data[6] = 0;                   
-            data[7] = 0;
-            break;
-
-        case RADIO_CMD_FW_PUT_APPLY:
-            radioMessageLog("Apply FW Download");
-            debugWrite("WOIS Cmd: APPLY DOWNLOADED FIRMWARE\n");
-            cmdAck = RADIO_ACK_FW_PUT_APPLY;
-            lenData = 3;
-            /* Request to start the bootloader again */
-            data[0] = RADIO_RESULT_SUCCESS;     /* success */
-            data[1] = 0;
-            data[2] = 0;
-            break;
-            
-        case RADIO_CMD_IRR_START:
-            radioMessageLog("Exp Irr Start");
-            debugWrite("WOIS Cmd: IRRIGATION START\n");
-            cmdAck = RADIO_ACK_IRR_START;
-            lenData = 1;
-            
-             radioCmdIrrStart = TRUE;             /*denotes that was told to start early */
-             
-            /* start irrigation program */
-            switch(pMsg->data[1])
-            {
-                case SYS_STATE_TEST:
-                      irrCmdTest();
-                      data[0] = RADIO_RESULT_SUCCESS;     /* success */
-                      break;
-                case SYS_STATE_MANUAL:
-                      sysManualProgram=pMsg->data[0];
-                      sysManualOpMode=pMsg->data[2];
-                      sysManualPulseMode=pMsg->data[3];
-                      irrCmdManualStart();
-                      data[0] = RADIO_RESULT_SUCCESS;     /* success */
-                      break;
-                case SYS_STATE_FORCE:
-                    irrCmdForceOn();
-                    data[0] = RADIO_RESULT_SUCCESS;     /* success */
-                    break;
-                default:
-                    if(irrCmdExpPulseOn(pMsg->data[0]))
-                    {
-                        data[0] = RADIO_RESULT_SUCCESS;     /* success */
-                    } 
-                    else 
-                    {
-                        data[0] = RADIO_RESULT_FAILURE;     /* failure */
-                    }
-                    break;
-            }
-            break;
-            
-        case RADIO_CMD_IRR_COMPLETE:
-            radioMessageLog("Exp Irr Mode End");
-            debugWrite("Expansion Cmd: IRRIGATION COMPLETE\n");
-            pMsg->cmd= RADIO_ACK_IRR_COMPLETE;
-            lenData=0;
-            
-            /*check to see if other expansion units to send to */
-             if((config.sys.unitType == UNIT_TYPE_MASTER) && (config.sys.numUnits > 0))
-             {
-
-                 if((expMacID == config.sys.expMac1)&&(config.sys.numUnits > 1)&&
-                    (config.sys.expMac2 != 0x0013A20000000000))
-                 {
-                    /* pass batan to expansion 2 */
-                     expansionBusSendCmd(RADIO_CMD_IRR_START,config.sys.expMac2);
-                     irrCurUnitRunning = UNIT_TYPE_EXPANSION_2;
-                 } 
-                 else if((expMacID == config.sys.expMac2)&&(config.sys.numUnits ==3)&&
-                            (config.sys.expMac3 != 0x0013A20000000000))
-                 {      
-                    /* pass batan to expansion 3 */
-                     expansionBusSendCmd(RADIO_CMD_IRR_START,config.sys.expMac3);
-                     irrCurUnitRunning = UNIT_TYPE_EXPANSION_3;
-                 } 
-                 else 
-                 {
-                     /* release control variable */
-                     irrExpRunningProg = IRR_PGM_NONE;
-                     sysState = SYS_STATE_IDLE;
-                     expansionIrrState =IRR_STATE_IDLE;
-                     expansionIrrCurZone = 0;
-                     irrCurUnitRunning = UNIT_TYPE_MASTER;
-                 }
-                 
-             }
-             break;
-          case RADIO_CMD_EXPANSION_STATUS:
-              radioMessageLog("Expansion Status");
-              debugWrite("Expansion Cmd: EXPANSION STATUS\n");
-              pMsg->cmd= RADIO_ACK_EXPANSION_STATUS;
-              lenData=0;
-              
-              /*Expansion irrigation state */              
-              if(((irrCurUnitRunning == UNIT_TYPE_EXPANSION_1)&&(expMacID == config.sys.expMac1)) ||
-                  ((irrCurUnitRunning == UNIT_TYPE_EXPANSION_2)&&(expMacID == config.sys.expMac2))||
-                  ((irrCurUnitRunning == UNIT_TYPE_EXPANSION_3)&&(expMacID == config.sys.expMac3))                  )
-              {                
-                  /* take care of case where an expansion unit loses comm for a brief period of time
-                   * less than the timeout detection and comes back. for example a power glitch
-                   */
-                  if((pMsg->data[0] == 0) && (pMsg->data[1] == 0) && 
-                     (sysState != SYS_STATE_AUTORUN)&&(sysState != SYS_STATE_IDLE))
-                  {
-                     /* release control variable */
-                     irrExpRunningProg = IRR_PGM_NONE;
-                     sysState = SYS_STATE_IDLE;
-                     expansionIrrState =IRR_STATE_IDLE;
-                     expansionIrrCurZone = 0;
-                     irrCurUnitRunning = UNIT_TYPE_MASTER;
-                  }
-                  else 
-                  {
-                      expansionSysState=pMsg->data[0];
-                      expansionIrrState =pMsg->data[1];
-                      expansionIrrCurZone =pMsg->data[2];
-                  }
-              } 
-              else if((irrCurUnitRunning == UNIT_TYPE_MASTER)&&(pMsg->data[2] != 0))
-              {
-                  expansionSysState=pMsg->data[0];
-                  expansionIrrState =pMsg->data[1];
-                  expansionIrrCurZone =pMsg->data[2];
-              }
-                
-              /* Expansion System Error Flags */
-              expansionSysErrorFlags = U8TOU16(pMsg->data[3],
-                                               pMsg->data[4]);
-              /* Expansion System Fault Flags */
-              expansionSysFaultFlags = U8TOU32(pMsg->data[5],
-                                               pMsg->data[6],
-                                               pMsg->data[7],               
-                                               pMsg->data[8]);
-              
-              /* update list with moisture sensor failures and runtimes from other units */
-              if(config.sys.unitType == UNIT_TYPE_MASTER)
-              {               
-                  /* moisture sensor zone failures */
-                  tempMoistFailedSensors = U8TOU16(pMsg->data[9],pMsg->data[10]);
-                  if(expMacID == config.sys.expMac1)
-                    {
-                          offset = 13;
-                    }
-                    else if(expMacID == config.sys.expMac2)
-                    {      
-                          offset = 25;
-                    }
-                    else if(expMacID == config.sys.expMac3)
-                    {      
-                          offset = 37;
-                    }
-              
-                    for(i=0; i<SYS_N_UNIT_ZONES; i++)
-                    {
-                        if((tempMoistFailedSensors&(((uint16_t)1)<<i)) != 0)
-                        {
-                            moistFailureSet(i+offset);
-                        }
-                        else
-                        {
-                            moistFailureClear(i+offset);
-                        }
-                        
-                        /*update per zone runtimes */
-                        irrDailyRuntimePerZone[i+offset-1] = U8TOU16(pMsg->data[2*i+11],pMsg->data[2*i+12]);
-                    }
-              }
-              
-              /* if expansion unit state is idle and is the last unit then have master go to idle*/
-              if(expansionSysState == SYS_STATE_IDLE)
-              {
-
-                  if(((config.sys.numUnits == 1)&&(expMacID == config.sys.expMac1)) ||
-                     ((config.sys.numUnits == 2)&&(expMacID == config.sys.expMac2)) ||
-                     ((config.sys.numUnits == 3)&&(expMacID == config.sys.expMac3))) 
-                  {                     
-                     /* release control variable */
-                     irrExpRunningProg = IRR_PGM_NONE;
-                     sysState = SYS_STATE_IDLE;
-                     expansionIrrState =IRR_STATE_IDLE;
-                     expansionIrrCurZone = 0;
-                  }
-              }
-              break;
-              
-          case RADIO_CMD_IRR_STOP:
-              radioMessageLog("Irr Stop");
-              debugWrite("Expansion Cmd: IRRIGATION STOP\n");
-              pMsg->cmd= RADIO_ACK_IRR_STOP;
-              lenData=0;
-              irrCmdStop();
-              /* release control variables */
-              irrExpRunningProg = IRR_PGM_NONE;
-              sysState = SYS_STATE_IDLE;
-              expansionIrrState =IRR_STATE_IDLE;
-              expansionIrrCurZone = 0;
-              break;
-          case RADIO_CMD_IRR_RESUME:
-              radioMessageLog("Irr Resume");
-              debugWrite("Expansion Cmd: IRRIGATION RESUME\n");
-              pMsg->cmd= RADIO_ACK_IRR_RESUME;
-              lenData=0;
-              sysResume();
-              break;
-          case RADIO_CMD_IRR_SKIP:
-              radioMessageLog("Irr Skip");
-              debugWrite("Expansion Cmd: IRRIGATION SKIP\n");
-              pMsg->cmd= RADIO_ACK_IRR_SKIP;
-              lenData=0;
-              irrCmdSkip();
-              break;
-          case RADIO_CMD_IRR_OFF:
-              radioMessageLog("Irr Off");
-              debugWrite("Expansion Cmd: IRRIGATION OFF\n");
-              pMsg->cmd= RADIO_ACK_IRR_OFF;
-              lenData=0;
-              /* Clear any pending auto programs. */
-              irrAutoPgmPending = IRR_PGM_NONE;
-
-              /* Stop any irrigation. */
-              irrCmdStop();
-
-              /* Set the system Off. */
-              sysIsAuto = FALSE;
-              break;
-          case RADIO_CMD_IRR_AUTO:
-              pMsg->cmd= RADIO_ACK_IRR_AUTO;
-              lenData=0;
-              /* Set the system state to Auto. */
-              sysIsAuto = TRUE;
-              break;
-          case RADIO_CMD_IRR_STOP_OFF:
-              radioMessageLog("Irr Stop Off");
-              debugWrite("Expansion Cmd: IRRIGATION STOP OFF\n");
-              pMsg->cmd= RADIO_ACK_IRR_STOP_OFF;
-              lenData=0;
-              irrStop = FALSE;
-              break;
-          case RADIO_CMD_DELETE_SC:
-              radioMessageLog("Delete an SC");
-              debugWrite("Expansion Cmd: Delete an SC\n");
-              pMsg->cmd= RADIO_ACK_DELETE_SC;
-              scDeleteList[pMsg->data[0]]=TRUE;       
-              break; 
-          case RADIO_CMD_SC_IS_REMOVED:
-              radioMessageLog("EXP Deleted SC");
-              debugWrite("Expansion Cmd: SC Deleted\n");
-              pMsg->cmd= RADIO_ACK_SC_IS_REMOVED;
-              radioRemoveSensorAssocList(config.sys.assocSensorCon[pMsg->data[0]].macId);       
-              break;
-          case RADIO_CMD_EXPAN_GET_CONFIG:
-              radioMessageLog("EXP Requested Config");
-              debugWrite("Expansion Cmd: Requested Configuration\n");
-              pMsg->cmd= RADIO_ACK_EXPAN_GET_CONFIG;
-              if(config.sys.unitType == UNIT_TYPE_MASTER) 
-              {                   
-                   expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, expMacID);     
-              }
-              break;
-          default:
-             /* Unknown command - call extended command handler. */
-             radioExtCommandHandler(pPacket);
-             return;
-             break;  /* not reached */
-    }
-
-    /* Send acknowledgement packet. */
-    radioProtocolAckSend(pPacket, cmdAck, data, lenData);
-
-    /* if apply firmware command was sent then reboot processor *
-     * this is done here so ACK to the apply command can be sent */
-    if(pMsg->cmd==RADIO_CMD_FW_PUT_APPLY)
-    {
-           sprintf(&uiLcdBuf[LCD_RC(0,0)], "Updating Firmware....Rebooting....      ");
-           sprintf(&uiLcdBuf[LCD_RC(1,0)], "                                        ");
-           sprintf(&uiLcdBuf[LCD_RC(2,0)], "                                        ");
-           sprintf(&uiLcdBuf[LCD_RC(3,0)], "                                        ");
-           uiLcdCursor = 160;
-            /* Write LCD buffer to hardware device driver. */
-           drvLcdWrite(uiLcdBuf, uiLcdCursor);
-           hwCpu_Delay100US(5000);
-           drvProcessorReboot();
-    }
-    
-    /* Yield control back to the system main polling loop. */
-    radioYield = TRUE;
-}
 
 /******************************************************************************
  *
- * radioProtocolSCAssocHandler
+ * radioTxqPoll
  *
  * PURPOSE
- *      This routine handles received Association Messages from the 
- *      sensor concentrator.
+ *      This routine is called from the radio polling loop to release frames
+ *      whose Tx status never arrived and to send waiting frames.
  *
  * PARAMETERS
- *      pPacket     IN  pointer to start of packet
+ *      None.
  *
  * RETURN VALUE
  *      None.
  *
  *****************************************************************************/
-static void    radioProtocolSCAssocHandler(const radioRxDataPacket_t *pPacket) 
+static void radioTxqPoll(void)
 {
-    radioMsgHeader_t *pMsg = (radioMsgHeader_t *)&pPacket->data[0];
-    packetSCAckData_t AckPacket;
-    uint8_t sensorIndex=MAX_NUM_SC;
-    char pBuf[40];
-    
-    
-    //assocflag++;
-    // fill with default values as safeguard
-    radioProtocolFillAckDefaults(&AckPacket);
+    uint8_t i;
 
-    /* get the source address */
-    uint64_t sensorMacID = U8TOU64(pPacket->phyAddr[0],
-                             pPacket->phyAddr[1],
-                             pPacket->phyAddr[2],
-                             pPacket->phyAddr[3],
-                             pPacket->phyAddr[4],
-                             pPacket->phyAddr[5],
-                             pPacket->phyAddr[6],
-                             pPacket->phyAddr[7]);
-                             
-    /* check to see if Sensor Concentrator is associated or been accepted to be associated
-     * if it isnt, but it into temporary storage and notify the sensor concentrator UI that 
-     * an sensor concentrator is trying to associate 
-     */
-    sensorIndex=radioCheckSensorAssocList(sensorMacID);
-    if(sensorIndex == MAX_NUM_SC) 
-    {     
-        if((associateSCMode == TRUE) && (newSensorConcenFound == FALSE))
-        {
-            unassociatedSnsConMacId = sensorMacID;
-            newSensorConcenFound = TRUE;
-        }
-    }
-    else
+    for (i = 0; i < RADIO_TXQ_SIZE; i++)
     {
-        /* FOR six associate retry, then RESET */
-        if (assocFlag[sensorIndex] == TRUE)
-            assocCnt[sensorIndex]++;
-        else
-            assocCnt[sensorIndex] = 0;
-        
-        //cnt2 = assocCnt[sensorIndex]; 
-        if (assocCnt[sensorIndex] == 6) {
-            assocFlag[sensorIndex] = FALSE;
-            assocCnt[sensorIndex] = 0;
-            radioReset();
-        } 
-        
-        
-        /* put message into radio log*/
-        //radioMessageLog("SC Associate Message");
-        
-        sprintf(pBuf,"SC Assoc Msg %08X",(uint32_t)(sensorMacID & 0xFFFFFFFF));
-        radioMessageLog(pBuf);
-    
-        /*build ACK packet*/
-        
-        /*check to see if unit is in irrigation mode */
-        if((sysState != SYS_STATE_IDLE) && (expansionSysState != SYS_STATE_IDLE ))
+        if ((radioTxq[i].state == RADIO_TXQ_INFLIGHT) &&
+            ((drvMSGet() - radioTxq[i].time) > RADIO_TXQ_STATUS_MS))
         {
-            AckPacket.sleepTime = SC_SLEEP_TIME_IRR;  /*hardcoded default values stored in config,h*/
+            radioTxqFree(&radioTxq[i]);
         }
-        else
-        {
-            AckPacket.sleepTime = SC_SLEEP_TIME;  /*hardcoded default values stored in config,h*/
-        }
-        
-        AckPacket.command = SC_ASSOCIATE;
-        
-        /*send MAC address off WO that is in control of it */
-        
-        switch(config.sys.assocSensorCon[sensorIndex].zoneRange)
-        {             
-            case UNIT_TYPE_MASTER:
-                if(config.sys.unitType == UNIT_TYPE_MASTER)
-                {
-                    AckPacket.controlMacId = radioMacId;
-                }
-                else
-                {
-                    AckPacket.controlMacId = config.sys.masterMac;
-                }
-                break;
-            case UNIT_TYPE_EXPANSION_1:
-                AckPacket.controlMacId = config.sys.expMac1;
-                break;
-            case UNIT_TYPE_EXPANSION_2:
-                AckPacket.controlMacId = config.sys.expMac2;
-                break;
-            case UNIT_TYPE_EXPANSION_3:
-                AckPacket.controlMacId = config.sys.expMac3;
-                break;
-        } 
-        //AckPacket.controlMacId = 0xFFFF;
-        AckPacket.hibTemp =SC_HIBERNATE_TEMP_C;          /*hardcoded default values stored in config,h*/
-        AckPacket.hibThresTime =SC_HIBERNATE_THRES_TIME; /*hardcoded default values stored in config,h*/
-        AckPacket.solenoidState = SC_ALL_CHAN_OFF;       /* all solenoids turned off, defined in config.h */
-    
-        /* Send acknowledgement packet. */
-        radioProtocolRespSend(pPacket, &AckPacket, RADIO_TYPE_SC_STATUS,sizeof(packetSCAckData_t));
-        //assocack++;
-        
-        
     }
-    
-    /* Yield control back to the system main polling loop. */
-    radioYield = TRUE;
+
+    radioTxqService();
 }
 
- 
+
 /******************************************************************************
  *
- * ConvertZone
+ * radioPktAlloc
  *
  * PURPOSE
- *      Convert the zone from a bitmapped to an index
+ *      This routine allocates a buffer from the packet buffer pool.
  *
  * PARAMETERS
- *      bitZone     the current zone in bitmap form, 0100 is valve 3
+ *      None.
  *
  * RETURN VALUE
- *      the current zone in ordinal form, 0100 is valve 4.
+ *      This routine returns the packet buffer index, holding one reference
+ *      for the caller, or RADIO_PKT_NONE if the pool is exhausted.
  *
  *****************************************************************************/
-uint8_t ConvertZone(uint8_t bitZone)
+static uint8_t radioPktAlloc(void)
 {
-  uint8_t ret = 0;
-  
-  //no way to prevent user from passing in bad values
+    uint8_t i;
 
-  switch(bitZone)
-  {
-  case SC_CHAN_1_ON:
-    ret = 0;
-    break;
-  case SC_CHAN_2_ON:
-    ret = 1;
-    break;
-  case SC_CHAN_3_ON:
-    ret = 2;
-    break;
-  case SC_CHAN_4_ON:
-    ret = 3;
-    break;
-  }
-  return ret;
+    for (i = 0; i < RADIO_PKT_POOL_SIZE; i++)
+    {
+        if (radioPkt[i].refs == 0)
+        {
+            radioPkt[i].refs = 1;
+            return i;
+        }
+    }
+
+    radioPktAllocFails++;
+    return RADIO_PKT_NONE;
 }
 
+
 /******************************************************************************
  *
- * radioProtocolSCStatusHandler
+ * radioPktRelease
  *
  * PURPOSE
- *      This routine handles received status packets of sensor information
- *      from the sensor concentrator.
- *
- * NOTES
- *      When an SC checks in we have two primary tasks to carry out:
- * 
- *      1) Update internal data structures with information reported
- *         from the SC
- *
- *      2) Push some pieces of state to the SC which tells it how to
- *         operate.
- * 
- *      At any given time there can be a single SC whose state differs
- *      from the status quo.  Basically, one SC whose solenoid will
- *      be instructed to turn on.  For all other SCs, they should be
- *      instructed to be off.  The "current" SC is driven by the zone
- *      logic from irrigation.c
+ *      This routine releases a reference to a packet buffer.  The buffer is
+ *      returned to the pool when its last reference is released.
  *
  * PARAMETERS
- *      pPacket     IN  pointer to start of packet
+ *      pkt         IN  packet buffer index
  *
  * RETURN VALUE
  *      None.
  *
  *****************************************************************************/
-static void    radioProtocolSCStatusHandler(const radioRxDataPacket_t *pPacket)
+static void radioPktRelease(uint8_t pkt)
 {
-    packetSCStatus_t *pMsg = (packetSCStatus_t *)&pPacket->data[0];
-    uint16_t crc;
-    uint16_t crcMsg;
-    packetSCAckData_t AckPacket;
-    uint8_t sensorIndex=MAX_NUM_SC;
-    uint8_t i;
-    uint8_t unitTypeZoneOffset;    
-    uint8_t sensorZone;
-    char pBuf[40];
-    
-    //statusflag++;
-    
-    /* fill with defaults */
-    radioProtocolFillAckDefaults(&AckPacket);
-
-     /* Compute the CRC. */
-    crc = crc16(((uint8_t *)pMsg) + 4,
-                     RADIO_SC_STATUS_HEADER_SIZE - 4);
-
-    /* Verify the CRC in the command message. */
-    crcMsg = (pMsg->hdr.crcHigh << 8) | pMsg->hdr.crcLow;
-    if (crcMsg != crc)
+    if ((pkt < RADIO_PKT_POOL_SIZE) && (radioPkt[pkt].refs > 0))
     {
-        /* Ignore this packet. */
-        return;
+        radioPkt[pkt].refs--;
     }
-    
-    /* get the source address */
-    uint64_t sensorMacID = U8TOU64(pPacket->phyAddr[0],
-                             pPacket->phyAddr[1],
-                             pPacket->phyAddr[2],
-                             pPacket->phyAddr[3],
-                             pPacket->phyAddr[4],
-                             pPacket->phyAddr[5],
-                             pPacket->phyAddr[6],
-                             pPacket->phyAddr[7]);
-                             
-    /* check to see if MAC is in list and if it isnt tell it to deassociate */
-    sensorIndex=radioCheckSensorAssocList(sensorMacID);
-    
-    if((sensorIndex != MAX_NUM_SC)  && (scDeleteList[sensorIndex] == FALSE)) 
-    {    
-    
-        /*  indicate this hub already associated this controller */
-        assocFlag[sensorIndex] = TRUE;
-         
-        /* make sure that it is associated with this unit */
-        if(config.sys.assocSensorCon[sensorIndex].zoneRange == config.sys.unitType)
-        {
-            /* parse the data packet for the values */
-            
-            /* system state values */
-            snsConInfo[sensorIndex].chargeRate = pMsg->chargeRate;
-            snsConInfo[sensorIndex].battVoltage = (pMsg->battVoltage);
-            snsConInfo[sensorIndex].solenoidState = pMsg->solenoidState;
-            
-            /* Setup response as if this is a normal unit */
-            AckPacket.solenoidState = SC_ALL_CHAN_OFF;
+}
 
-            /* Check if this SC is the one that the irrigation logic
-             * would like to modify state on.
-             */
-             
-            if(irrSnsConSolUnitIndex == sensorIndex)
-            {
-                /* clear timeout flag */ 
-                sysFaultClear(SYS_FAULT_SNSCON);
-                
-                /* Tell SC to use solenoid state from irrigation logic */
-                AckPacket.solenoidState = irrSnsConSolenoidChan;
-                
-                if(irrSnsConSolenoidChan != SC_ALL_CHAN_OFF)
-                {
-                        uint8_t currentZone = config.sys.assocSensorCon[sensorIndex].channelZone[ConvertZone(irrSnsConSolenoidChan)];
-                        
-                        drvSolenoidSet(currentZone + 1, TRUE);
-                        
-                }
-                
-                if(sysIsInhibited && sysInhibitStop)
-                {          
-                    sysIsInhibited = FALSE;
-                    sysInhibitStop = FALSE;
-                    sysInhibitOffTime = dtTickCount;
-                }
-                
-                //KAV update timeout since the SC for this zone has checked in
-                radioSnsConCheckinTime = dtTickCount;
-                
-                /* release system from soak into water since SC checked in */
-                scCheckedIn = TRUE;
-                sysResume();
-            }
 
-            
-            /*set zone offset to account for expansion bus */
-            switch(config.sys.unitType)
-            {
-                case UNIT_TYPE_MASTER:
-                    unitTypeZoneOffset = 0;
-                    break;
-                case UNIT_TYPE_EXPANSION_1:
-                    unitTypeZoneOffset = 12;
-                    break;  
-                case UNIT_TYPE_EXPANSION_2:
-                    unitTypeZoneOffset = 24;
-                    break;
-                case UNIT_TYPE_EXPANSION_3:
-                    unitTypeZoneOffset = 36;
-                    break;
-            }
-            
-            /* set moisture values for respective zones */
-            for(i=0; i<SC_NUM_CHAN_UNIT; i++)
-            {
-                
-                sensorZone = config.sys.assocSensorCon[sensorIndex].channelZone[i];
-                
-                /*verify that channel is assigned to a valid zone before proceeding */
-                if(sensorZone != SC_CHAN_NOT_ASSIGNED) 
-                {
-                    /*apply offset to account for expansion bus */
-                    sensorZone -= unitTypeZoneOffset;
-                    
-                    /* verify that zone is configured to be a wireless sensor */     
-                    if(config.zone[sensorZone].sensorType == SNS_WIRELESS_MOIST)
-                    {
-                        drvMoistValueSet(sensorZone+1,(uint8_t)pMsg->sensor_chan[i]);
-                    }
-                }
-            }
-            
-            /*put message into radio log */
-            //radioMessageLog("SC Status Message");
-            sprintf(pBuf,"SC Status Msg %08X",(uint32_t)(sensorMacID & 0xFFFFFFFF));
-            radioMessageLog(pBuf);
-    
-            /* build ACK packet */
-            AckPacket.command = SC_ASSOCIATE;
-            
-            /* set controller mac id */
-            switch(config.sys.assocSensorCon[sensorIndex].zoneRange)
-            {             
-                case UNIT_TYPE_MASTER:
-                    if(config.sys.unitType == UNIT_TYPE_MASTER)
-                    {
-                        AckPacket.controlMacId = radioMacId;
-                    }
-                    else
-                    {
-                        AckPacket.controlMacId = config.sys.masterMac;
-                    }
-                    break;
-                case UNIT_TYPE_EXPANSION_1:
-                    AckPacket.controlMacId = config.sys.expMac1;
-                    break;
-                case UNIT_TYPE_EXPANSION_2:
-                    AckPacket.controlMacId = config.sys.expMac2;
-                    break;
-                case UNIT_TYPE_EXPANSION_3:
-                    AckPacket.controlMacId = config.sys.expMac3;
-                    break;
-            }
-        }
-    }
-    else //sc needs to be deleted
-    {
-      /* if in the list but commanded to delete then do so */
-      if(scDeleteList[sensorIndex] == TRUE)
-      {
-          scDeleteIndex=sensorIndex;
-          expansionBusSendCmd(RADIO_CMD_SC_IS_REMOVED, config.sys.masterMac);
-          radioRemoveSensorAssocList(sensorMacID);
-           
-      }
-      
-      /* build NACK packet */
-      AckPacket.command = SC_DEASSOCIATE;
-      AckPacket.controlMacId = 0;
-      AckPacket.solenoidState = SC_ALL_CHAN_OFF;       /* all solenoids turned off, defined in config.h */
-    }
+/******************************************************************************
+ *
+ * radioPktData
+ *
+ * PURPOSE
+ *      This routine returns the start of the ZigBee Tx data payload in a
+ *      packet buffer, where outgoing messages are built.
+ *
+ * PARAMETERS
+ *      pkt         IN  packet buffer index
+ *
+ * RETURN VALUE
+ *      This routine returns a pointer to the payload data.
+ *
+ *****************************************************************************/
+static uint8_t *radioPktData(uint8_t pkt)
+{
+    return radioPkt[pkt].u.tx.data;
+}
 
-      
-    //do this for all SCs even if we are deleting them  
-      
-    /*check to see if unit is in irrigation mode */
-    if((sysState != SYS_STATE_IDLE) || (expansionSysState != SYS_STATE_IDLE ))
+
+/******************************************************************************
+ *
+ * radioExpBusIsWired
+ *
+ * PURPOSE
+ *      This routine determines whether messages to a unit are carried on the
+ *      wired expansion bus.
+ *
+ * PARAMETERS
+ *      macId       IN  destination phy address (MAC ID)
+ *
+ * RETURN VALUE
+ *      Return value is TRUE if the unit is on the wired expansion bus.
+ *
+ * NOTES
+ *      On the master, each expansion unit whose bit is set in
+ *      config.sys.expBusWired is wired.  On an expansion unit, the master is
+ *      wired if this unit's own bit is set.
+ *
+ *****************************************************************************/
+static bool_t radioExpBusIsWired(uint64_t macId)
+{
+    uint8_t wired = config.sys.expBusWired;
+
+    if ((wired == 0) || (macId == 0))
     {
-        if(sysIsInhibited || sysIsPaused)
-        {
-            // Turn off the wireless and wired solenoid if we are paused or inhibited
-            AckPacket.solenoidState = SC_ALL_CHAN_OFF;
-            
-            
-            if(irrSnsConSolenoidChan != SC_ALL_CHAN_OFF)
-            {
-                drvSolenoidSet(config.sys.assocSensorCon[sensorIndex].channelZone[ConvertZone(irrSnsConSolenoidChan)]+1, FALSE);
-            }
-        }
+        return FALSE;
+    }
 
-        // if we are in irrigation but the system is inhibited, we want to use a longer
-        // sleep time so as to not kill battery life on the SCs.  For paused, we assume
-        // that somebody is at the controller
-        AckPacket.sleepTime = sysIsInhibited ? SC_SLEEP_TIME : SC_SLEEP_TIME_IRR;
-    } 
-    else 
+    if (config.sys.unitType == UNIT_TYPE_MASTER)
     {
-        AckPacket.sleepTime = SC_SLEEP_TIME;
+        return (((wired & (1 << UNIT_TYPE_EXPANSION_1)) != 0 &&
+                 macId == config.sys.expMac1) ||
+                ((wired & (1 << UNIT_TYPE_EXPANSION_2)) != 0 &&
+                 macId == config.sys.expMac2) ||
+                ((wired & (1 << UNIT_TYPE_EXPANSION_3)) != 0 &&
+                 macId == config.sys.expMac3));
     }
 
-    AckPacket.hibTemp = SC_HIBERNATE_TEMP_C;            /*hardcoded default values stored in config,h*/
-    AckPacket.hibThresTime = SC_HIBERNATE_THRES_TIME;    /*hardcoded default values stored in config,h*/
-                                                           
-    /* Send acknowledgement packet. */
-    radioProtocolRespSend(pPacket, &AckPacket, RADIO_TYPE_SC_STATUS,sizeof(packetSCAckData_t));
-    //statusack++;
-    /* Yield control back to the system main polling loop. */
-    radioYield = TRUE;
+    return ((wired & (1 << config.sys.unitType)) != 0 &&
+            macId == config.sys.masterMac);
 }
 
 
-
 /******************************************************************************
  *
- * radioRemoveSensorAssocHandler
+ * radioExpBusSend
  *
  * PURPOSE
- *      This routine handles received status packets of sensor information
- *      from the sensor concentrator.
+ *      This routine sends a WOIS message to a unit on the wired expansion
+ *      bus.
  *
  * PARAMETERS
- *      sensorMAC     IN  MAC of sensor concentrator to remove
+ *      phyAddrH    IN  destination phy address (high 32-bits)
+ *      phyAddrL    IN  destination phy address (low 32-bits)
+ *      pData       IN  pointer to start of application payload data
+ *      lenData     IN  length of the application payload data
+ *
+ * RETURN VALUE
+ *      Return value is TRUE for success; FALSE for failure.
+ *
+ * NOTES
+ *      This is called from the Tx data queue, which keeps the frame and
+ *      tries again next poll if the bus transmit buffer has no room for it.
+ *
+ *****************************************************************************/
+static bool_t radioExpBusSend(uint32_t phyAddrH,
+                              uint32_t phyAddrL,
+                              const uint8_t *pData,
+                              int16_t lenData)
+{
+    uint8_t frame[RADIO_EXPBUS_HDR + RADIO_MAXPAYLOAD];
+    int i;
+
+    if (lenData > RADIO_MAXPAYLOAD)
+    {
+        return FALSE;
+    }
+    for (i = 0; i < RADIO_SZ_MAC_ID; i++)
+    {
+        frame[i] = (uint8_t)((i < 4) ? (phyAddrH >> (24 - 8 * i)) :
+                                       (phyAddrL >> (56 - 8 * i)));
+        frame[RADIO_SZ_MAC_ID + i] =
+            (uint8_t)(radioMacId >> (56 - 8 * i));
+    }
+    memcpy(&frame[RADIO_EXPBUS_HDR], pData, lenData);
+    return drvExpBusWrite(frame, (uint8_t)(RADIO_EXPBUS_HDR + lenData));
+}
+
+
+/******************************************************************************
+ *
+ * radioExpBusPoll
+ *
+ * PURPOSE
+ *      This routine is called from the radio polling loop to service the
+ *      wired expansion bus and pass received WOIS messages to the protocol
+ *      handlers.
+ *
+ * PARAMETERS
+ *      None.
  *
  * RETURN VALUE
  *      None.
  *
+ * NOTES
+ *      A received frame is rebuilt in place as a ZigBee Rx Data packet from
+ *      its source MAC ID, so the handlers (and any acknowledgement they send)
+ *      work the same as for a message received over the air.
+ *
  *****************************************************************************/
-void radioRemoveSensorAssocHandler(uint64_t sensorMAC)
+static void radioExpBusPoll(void)
 {
-   packetSCAckData_t AckPacket;
-   uint8_t sensorIndex = radioRemoveSensorAssocList(sensorMAC);
-   uint16_t length = sizeof(packetSCAckData_t);
-   
-   // fill ack with default values
-   radioProtocolFillAckDefaults(&AckPacket);
-   
-   if(sensorIndex != MAX_NUM_SC)
-   {
-        //build ACK packet
-        AckPacket.sleepTime = 5;
-        AckPacket.command = SC_DEASSOCIATE;
-        AckPacket.controlMacId = 0;
-        
-        /* Send acknowledgement packet. */
-        radioMsgHeader_t *pHdr = (radioMsgHeader_t *)(&AckPacket);
-        uint32_t destH = ((sensorMAC >> 32)&0x00000000FFFFFFFF);
-        uint32_t destL = (sensorMAC &0x00000000FFFFFFFF);
-        uint16_t destN = 0xFFFE;
+    uint8_t pkt;
+    uint8_t *frame;
+    radioRxDataPacket_t *pPacket;
+    uint8_t length;
+    uint64_t dest;
+    uint8_t i;
 
-        pHdr->version = RADIO_PROTOCOL_VER;
-        pHdr->msgType = RADIO_TYPE_SC_STATUS;
-        radioMsgInsertCrc(pHdr, length);
-        radioDataSend(radioDataFrameId(),
-                  destN,
-                  destH,
-                  destL,
-                  ((uint8_t *)&AckPacket),
-                  length);
-   }
-   
-   /* Yield control back to the system main polling loop. */
-    radioYield = TRUE;     
+    /* The wired bus owns the port only while a wired unit is configured. */
+    drvExpBusEnable(config.sys.expBusWired != 0);
+    drvExpBusPoll();
+
+    pkt = radioPktAlloc();
+    if (pkt == RADIO_PKT_NONE)
+    {
+        return;
+    }
+    frame = radioPkt[pkt].u.raw;
+    pPacket = (radioRxDataPacket_t *)frame;
+
+    while ((length = drvExpBusRead(frame, RADIO_EXPBUS_HDR +
+                                          RADIO_MAXPAYLOAD)) > RADIO_EXPBUS_HDR)
+    {
+        dest = 0;
+        for (i = 0; i < RADIO_SZ_MAC_ID; i++)
+        {
+            dest = (dest << 8) | frame[i];
+        }
+        if (dest != radioMacId)
+        {
+            /* not for this unit */
+            continue;
+        }
+
+        /* The Rx header is shorter than the bus header; move fields down. */
+        memmove(pPacket->phyAddr, &frame[RADIO_SZ_MAC_ID], RADIO_SZ_MAC_ID);
+        length -= RADIO_EXPBUS_HDR;
+        memmove(pPacket->data, &frame[RADIO_EXPBUS_HDR], length);
+        pPacket->apiType = RADIO_API_RXDATA;
+        pPacket->netAddr[0] = 0xFF;
+        pPacket->netAddr[1] = 0xFE;
+        pPacket->options = 0;
+
+        radioRxWired = TRUE;
+        radioPacketZigBeeRxData(frame,
+                                woffsetof(radioRxDataPacket_t, data) + length);
+        radioRxWired = FALSE;
+    }
+
+    radioPktRelease(pkt);
 }
 
 
 /******************************************************************************
  *
- * radioProtocolXferHandler
+ * radioReplayRun
  *
  * PURPOSE
- *      This routine handles received WaterOptimizer bulk data transfer
+ *      This routine runs the radio replay benchmark, feeding generated radio
+ *      traffic through the radio driver receive path and the radio packet
+ *      handlers, and measuring how long it takes to handle.
+ *
+ * PARAMETERS
+ *      model       IN  traffic model (RADIO_REPLAY_xxx)
+ *      count       IN  number of frames to replay
+ *      pResult     OUT benchmark result
+ *
+ * RETURN VALUE
+ *      Return value is TRUE if the replay was run; FALSE if the traffic
+ *      model is not valid or no packet buffers are free.
+ *
+ * NOTES
+ *      Frames are injected until the driver receive buffer reaches its flow
+ *      control threshold, then read and handled the same as in radioPoll.
+ *      The driver only injects between whole frames, so once a real radio
+ *      frame starts arriving injection waits until it has been handled.
+ *      The replay stops if nothing can be handled for RADIO_REPLAY_STALL_MS.
+ *      The elapsed time includes building and injecting the frames, which
+ *      is small next to handling them.  The drvMSGet() clock is coarse, so
+ *      enough frames should be replayed to run for at least a second.  The
+ *      watchdog is serviced (and power checked) after each batch.
+ *
+ *      Radio frames received while the replay runs are handled with their
+ *      responses discarded, so the replay should be run on a quiet network.
+ *
+ *****************************************************************************/
+bool_t radioReplayRun(uint8_t model,
+                      uint16_t count,
+                      radioReplayResult_t *pResult)
+{
+    uint8_t txPkt;
+    uint8_t rxPkt;
+    uint8_t length;
+    uint16_t handled;
+    uint32_t start;
+    uint32_t progress;
+
+    memset(pResult, 0, sizeof(*pResult));
+    if (model >= RADIO_REPLAY_N)
+    {
+        return FALSE;
+    }
+
+    txPkt = radioPktAlloc();
+    rxPkt = radioPktAlloc();
+    if ((txPkt == RADIO_PKT_NONE) || (rxPkt == RADIO_PKT_NONE))
+    {
+        radioPktRelease(txPkt);
+        radioPktRelease(rxPkt);
+        return FALSE;
+    }
+
+    /* Handle any real radio traffic already received. */
+    (void)radioReplayDrain(radioPkt[rxPkt].u.raw);
+
+    radioReplayTxFrames = 0;
+    radioReplayActive = TRUE;
+    start = drvMSGet();
+    progress = start;
+
+    while (pResult->frames < count)
+    {
+        length = radioReplayFrameBuild(model,
+                                       pResult->frames,
+                                       radioPkt[txPkt].u.raw);
+        if (drvRadioRxInject(radioPkt[txPkt].u.raw, length))
+        {
+            pResult->frames++;
+            continue;
+        }
+
+        /* Receive buffer is full or holds real radio bytes; handle it. */
+        handled = radioReplayDrain(radioPkt[rxPkt].u.raw);
+        if (handled != 0)
+        {
+            progress = drvMSGet();
+        }
+        else if ((drvMSGet() - progress) > RADIO_REPLAY_STALL_MS)
+        {
+            /* a real frame never completed */
+            break;
+        }
+        pResult->handled += handled;
+
+        /* A long run outlasts the watchdog; service it once per batch. */
+        sysExecutionExtend();
+    }
+    pResult->handled += radioReplayDrain(radioPkt[rxPkt].u.raw);
+
+    pResult->ms = drvMSGet() - start;
+    radioReplayActive = FALSE;
+    pResult->txFrames = radioReplayTxFrames;
+
+    radioPktRelease(txPkt);
+    radioPktRelease(rxPkt);
+    return TRUE;
+}
+
+
+/******************************************************************************
+ *
+ * radioReplayFrameBuild
+ *
+ * PURPOSE
+ *      This routine builds the next radio API frame of a replay benchmark
+ *      traffic model.
+ *
+ * PARAMETERS
+ *      model       IN  traffic model (RADIO_REPLAY_xxx)
+ *      n           IN  number of the frame within the replay
+ *      pFrame      OUT buffer for the API frame (RADIO_MAXPACKET bytes)
+ *
+ * RETURN VALUE
+ *      This routine returns the length of the API frame.
+ *
+ * NOTES
+ *      Only traffic that does not change the controller state is modelled:
+ *      status and LCD polls, config image segment gets and Tx status for
+ *      frame ID zero, which never matches a frame awaiting status.
+ *
+ *****************************************************************************/
+static uint8_t radioReplayFrameBuild(uint8_t model,
+                                     uint16_t n,
+                                     uint8_t *pFrame)
+{
+    radioRxDataPacket_t *pPacket = (radioRxDataPacket_t *)pFrame;
+    radioTxStatPacket_t *pStat = (radioTxStatPacket_t *)pFrame;
+    radioMsgCmd_t *pCmd = (radioMsgCmd_t *)pPacket->data;
+    radioMsgXfer_t *pXfer = (radioMsgXfer_t *)pPacket->data;
+    uint16_t seg;
+    uint8_t length;
+    uint8_t i;
+
+    if (model == RADIO_REPLAY_MIX)
+    {
+        model = (uint8_t)(n % RADIO_REPLAY_MIX);
+    }
+
+    if (model == RADIO_REPLAY_TXSTAT)
+    {
+        pStat->apiType = RADIO_API_TXSTAT;
+        pStat->frameId = 0;
+        pStat->netAddr[0] = 0xFF;
+        pStat->netAddr[1] = 0xFE;
+        pStat->retryCount = 0;
+        pStat->status = RADIO_TXSTAT_OK;
+        pStat->discovery = 0;
+        return sizeof(radioTxStatPacket_t);
+    }
+
+    pPacket->apiType = RADIO_API_RXDATA;
+    for (i = 0; i < RADIO_SZ_MAC_ID; i++)
+    {
+        pPacket->phyAddr[i] =
+            (uint8_t)((uint64_t)RADIO_REPLAY_MAC >> (56 - 8 * i));
+    }
+    pPacket->netAddr[0] = 0xFF;
+    pPacket->netAddr[1] = 0xFE;
+    pPacket->options = 0;
+
+    if (model == RADIO_REPLAY_CFGGET)
+    {
+        pXfer->hdr.version = RADIO_PROTOCOL_VER;
+        pXfer->hdr.msgType = RADIO_TYPE_XFER;
+        seg = (uint16_t)(n % RADIO_CFG_SEGS);
+        pXfer->segHigh = (uint8_t)(seg >> 8);
+        pXfer->segLow = (uint8_t)(seg & 0xFF);
+        pXfer->xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_GET_REQ;
+        pXfer->dataLen = 0;
+        length = RADIO_XFER_HEADER_SIZE;
+    }
+    else
+    {
+        pCmd->hdr.version = RADIO_PROTOCOL_VER;
+        pCmd->hdr.msgType = RADIO_TYPE_CMD;
+        pCmd->msgId = (uint8_t)n;
+        pCmd->dataLen = 0;
+        switch (model)
+        {
+            case RADIO_REPLAY_EXSTAT:
+                pCmd->cmd = RADIO_CMD_GET_EXSTAT;
+                break;
+            case RADIO_REPLAY_GETLCD:
+                /* Line checksums that never match, so all lines are sent. */
+                pCmd->cmd = RADIO_CMD_RC_GETLCD;
+                pCmd->dataLen = 8;
+                memset(pCmd->data, 0, 8);
+                break;
+            default:
+                pCmd->cmd = RADIO_CMD_NO_OP;
+                break;
+        }
+        length = RADIO_CMD_HEADER_SIZE + pCmd->dataLen;
+    }
+    radioMsgInsertCrc(pPacket->data, length);
+
+    return (uint8_t)(woffsetof(radioRxDataPacket_t, data) + length);
+}
+
+
+/******************************************************************************
+ *
+ * radioReplayDrain
+ *
+ * PURPOSE
+ *      This routine reads and handles all frames waiting in the radio driver
+ *      receive buffer.
+ *
+ * PARAMETERS
+ *      pBuf        IN  buffer for received frames (RADIO_MAXPACKET bytes)
+ *
+ * RETURN VALUE
+ *      This routine returns the number of frames handled.
+ *
+ *****************************************************************************/
+static uint16_t radioReplayDrain(uint8_t *pBuf)
+{
+    int16_t length;
+    uint16_t n = 0;
+
+    while ((length = drvRadioRead(pBuf, RADIO_MAXPACKET)) != 0)
+    {
+        radioPacketHandler(pBuf, length);
+        n++;
+    }
+
+    return n;
+}
+
+
+/******************************************************************************
+ *
+ * radioLoopbackDataSend
+ *
+ * PURPOSE
+ *      This routine sends a ZigBee data packet to the RF module, using ZigBee
+ *      explicit addressing to specify the XBee serial loopback data cluster
+ *      ID on the destination endpoint.
+ *
+ * PARAMETERS
+ *      phyAddrH    IN  destination phy address (high 32-bits)
+ *      phyAddrL    IN  destination phy address (low 32-bits)
+ *      netAddr     IN  destination network address (16-bits)
+ *      frameId     IN  frame identifier (corelates with any ZigBee Tx Status)
+ *      pData       IN  pointer to start of loopback data
+ *      lenData     IN  length of the loopback data
+ *
+ * RETURN VALUE
+ *      Return value is TRUE for success; FALSE for failure.
+ *
+ * NOTES
+ *      Specifying frameId of zero will suppress the Tx Status response from
+ *      the RF module.
+ *
+ *****************************************************************************/
+
+static bool_t radioLoopbackDataSend(const uint8_t *pData, int16_t lenData)
+{
+    return radioDataSend(RADIO_API_TXDATA,0xFFFE,0x00000000,0x0000FFFF, pData,lenData);
+}
+
+
+
+/******************************************************************************
+ *
+ *  PROTOCOL COMMAND DISPATCH TABLE
+ *
+ *  Indexed by WOIS command code.  Entries with no handler (and command codes
+ *  past the end of the table) are passed to radioExtCommandHandler.
+ *
+ *****************************************************************************/
+
+static const radioProtoCmdEnt_t radioProtoCmdTable[RADIO_PROTO_CMD_N] =
+{
+    /* 0x00 RADIO_CMD_NO_OP */
+    { radioProtoCmdNoOp, "No Op", RADIO_ACK_NO_OP,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, RADIO_CMDF_FORWARD },
+    /* 0x01 RADIO_CMD_INHIBIT_ON */
+    { radioProtoCmdInhibitOn, "Inhibit On", RADIO_ACK_INHIBIT_ON,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, RADIO_CMDF_FORWARD },
+    /* 0x02 RADIO_CMD_INHIBIT_OFF */
+    { radioProtoCmdInhibitOff, "Inhibit Off", RADIO_ACK_INHIBIT_OFF,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, RADIO_CMDF_FORWARD },
+    /* 0x03 RADIO_CMD_FORCE_ON */
+    { radioProtoCmdForceOn, "Force On", RADIO_ACK_FORCE_ON,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x04 RADIO_CMD_ET_DATA (DEPRECATED) */
+    { NULL, NULL, 0, 0, 0, 0, 0 },
+    /* 0x05 RADIO_CMD_GET_MOIST */
+    { radioProtoCmdGetMoist, "Get Moisture", RADIO_ACK_GET_MOIST,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x06 RADIO_CMD_GET_EXSTAT */
+    { radioProtoCmdGetExStat, "Get Ext Status", RADIO_ACK_GET_EXSTAT,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x07 RADIO_CMD_CFG_GET_SNAP */
+    { radioProtoCmdCfgGetSnap, "Start Cfg Upload", RADIO_ACK_CFG_GET_SNAP,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x08 RADIO_CMD_CFG_PUT_START */
+    { radioProtoCmdCfgPutStart, "Start Cfg Download", RADIO_ACK_CFG_PUT_START,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x09 RADIO_CMD_CFG_PUT_APPLY */
+    { radioProtoCmdCfgPutApply, "Apply Cfg Download", RADIO_ACK_CFG_PUT_APPLY,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x0A RADIO_CMD_GET_ET_VALUES (DEPRECATED) */
+    { NULL, NULL, 0, 0, 0, 0, 0 },
+    /* 0x0B RADIO_CMD_GET_MANUFDATA (FUTURE) */
+    { NULL, NULL, 0, 0, 0, 0, 0 },
+    /* 0x0C RADIO_CMD_SET_ACTION (FUTURE) */
+    { NULL, NULL, 0, 0, 0, 0, 0 },
+    /* 0x0D RADIO_CMD_INIT_DATETIME */
+    { radioProtoCmdInitDateTime, "Init Date/Time", RADIO_ACK_INIT_DATETIME,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x0E RADIO_CMD_GET_RADIOSTAT */
+    { radioProtoCmdGetRadioStat, "Get Radio Status", RADIO_ACK_GET_RADIOSTAT,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x0F RADIO_CMD_DIAGNOSE */
+    { radioProtoCmdDiagnose, "Diagnose", RADIO_ACK_DIAGNOSE,
+      0, 32, RADIO_CMDU_ALL, 0 },
+    /* 0x10 RADIO_CMD_WEATHER_DATA */
+    { radioProtoCmdWeatherData, NULL, RADIO_ACK_WEATHER_DATA,
+      8, 8, RADIO_CMDU_ALL, RADIO_CMDF_FORWARD },
+    /* 0x11 RADIO_CMD_GET_MB_VALUES */
+    { radioProtoCmdGetMb, "Get MB Values", RADIO_ACK_GET_MB_VALUES,
+      1, 1, RADIO_CMDU_ALL, 0 },
+    /* 0x12 RADIO_CMD_SET_MB_VALUES */
+    { radioProtoCmdSetMb, "Set MB Values", RADIO_ACK_SET_MB_VALUES,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x13 RADIO_CMD_FW_PUT_START */
+    { radioProtoCmdFwPutStart, "Start FW Download", RADIO_ACK_FW_PUT_START,
+      4, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x14 RADIO_CMD_FW_PUT_APPLY */
+    { radioProtoCmdFwPutApply, "Apply FW Download", RADIO_ACK_FW_PUT_APPLY,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, RADIO_CMDF_REBOOT },
+    /* 0x15 RADIO_CMD_IRR_START */
+    { radioProtoCmdIrrStart, "Exp Irr Start", RADIO_ACK_IRR_START,
+      4, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x16 RADIO_CMD_IRR_COMPLETE */
+    { radioProtoCmdIrrComplete, "Exp Irr Mode End", RADIO_ACK_IRR_COMPLETE,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x17 RADIO_CMD_EXPANSION_STATUS */
+    { radioProtoCmdExpStatus, "Expansion Status", RADIO_ACK_EXPANSION_STATUS,
+      11 + (2 * SYS_N_UNIT_ZONES), RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x18 RADIO_CMD_IRR_STOP */
+    { radioProtoCmdIrrStop, "Irr Stop", RADIO_ACK_IRR_STOP,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x19 RADIO_CMD_IRR_RESUME */
+    { radioProtoCmdIrrResume, "Irr Resume", RADIO_ACK_IRR_RESUME,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x1A RADIO_CMD_IRR_SKIP */
+    { radioProtoCmdIrrSkip, "Irr Skip", RADIO_ACK_IRR_SKIP,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x1B RADIO_CMD_IRR_OFF */
+    { radioProtoCmdIrrOff, "Irr Off", RADIO_ACK_IRR_OFF,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x1C RADIO_CMD_IRR_AUTO */
+    { radioProtoCmdIrrAuto, NULL, RADIO_ACK_IRR_AUTO,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x1D RADIO_CMD_IRR_STOP_OFF */
+    { radioProtoCmdIrrStopOff, "Irr Stop Off", RADIO_ACK_IRR_STOP_OFF,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x1E RADIO_CMD_GET_EXSTAT_2 */
+    { radioProtoCmdGetExStat2, "Get Ext Status Part 2", RADIO_ACK_GET_EXSTAT_2,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x1F RADIO_CMD_GET_EXSTAT_3 */
+    { radioProtoCmdGetExStat3, "Get Ext Status Part 3", RADIO_ACK_GET_EXSTAT_3,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x20 RADIO_CMD_DELETE_SC */
+    { radioProtoCmdDeleteSc, "Delete an SC", RADIO_ACK_DELETE_SC,
+      1, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x21 RADIO_CMD_SC_IS_REMOVED */
+    { radioProtoCmdScRemoved, "EXP Deleted SC", RADIO_ACK_SC_IS_REMOVED,
+      1, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x22 RADIO_CMD_EXPAN_GET_CONFIG */
+    { radioProtoCmdExpGetConfig, "EXP Requested Config", RADIO_ACK_EXPAN_GET_CONFIG,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x23 (unused) */
+    { NULL, NULL, 0, 0, 0, 0, 0 },
+    /* 0x24 RADIO_CMD_EXPAN_DIGEST */
+    { radioProtoCmdDigest, "Get Status Digest", RADIO_ACK_EXPAN_DIGEST,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x25 (unused) */
+    { NULL, NULL, 0, 0, 0, 0, 0 },
+    /* 0x26 RADIO_CMD_SEND_FLOW */
+    { radioProtoCmdSendFlow, NULL, RADIO_ACK_SEND_FLOW,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x27 RADIO_CMD_CFG_DELTA_START */
+    { radioProtoCmdCfgDeltaStart, "Start Cfg Delta", RADIO_ACK_CFG_DELTA_START,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x28 RADIO_CMD_CFG_DELTA_APPLY */
+    { radioProtoCmdCfgDeltaApply, "Apply Cfg Delta", RADIO_ACK_CFG_DELTA_APPLY,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x29 RADIO_CMD_CFG_MANIFEST */
+    { radioProtoCmdCfgManifest, "Get Cfg Manifest", RADIO_ACK_CFG_MANIFEST,
+      0, RADIO_MAXAPPDATA, RADIO_CMDU_ALL, 0 },
+    /* 0x2A RADIO_CMD_GET_PROTOSTAT */
+    { radioProtoCmdGetProtoStat, "Get Protocol Stats", RADIO_ACK_GET_PROTOSTAT,
+      0, 2, RADIO_CMDU_ALL, 0 },
+};
+
+
+/******************************************************************************
+ *
+ * radioProtocolCommandHandler
+ *
+ * PURPOSE
+ *      This routine handles received WaterOptimizer application command
  *      packets.
  *
  * PARAMETERS
@@ -3465,327 +3589,2633 @@ void radioRemoveSensorAssocHandler(uint64_t sensorMAC)
  * RETURN VALUE
  *      None.
  *
+ * NOTES
+ *      The command is looked up in radioProtoCmdTable.  Its data length and
+ *      the unit type are checked, the message is logged, the command is
+ *      forwarded to the expansion units if required, and the command handler
+ *      is called to fill in the acknowledgement data.  Commands that fail
+ *      the checks are dropped without an acknowledgement.  Each command,
+ *      including those passed to the extended command handler, is counted
+ *      in the protocol statistics (radioProtoStat).
+ *
  *****************************************************************************/
-static void radioProtocolXferHandler(const radioRxDataPacket_t *pPacket)
+static void radioProtocolCommandHandler(const radioRxDataPacket_t *pPacket)
 {
-    radioMsgXfer_t *pMsg = (radioMsgXfer_t *)&pPacket->data[0];
-    radioMsgXfer_t resp;
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    const radioProtoCmdEnt_t *pEnt;
     uint16_t crc;
     uint16_t crcMsg;
-    uint32_t i;
-    //uint16_t segmentIndex;
-    char debugBuf[40];
-        /* rebuild the MAC of the source of the packet */
-    uint64_t expUnitMacID;
-    
-
+    uint8_t data[55];
+    uint8_t lenData;
+    uint8_t unit;
+    uint8_t stat;
+    uint32_t msStart = drvMSGet();
+    uint64_t expMacID;
 
     /* Compute the CRC. */
     crc = crc16(((uint8_t *)pMsg) + 4,
-                     RADIO_XFER_HEADER_SIZE - 4 + pMsg->dataLen);
+                     RADIO_CMD_HEADER_SIZE - 4 + pMsg->dataLen);
+
+    /* Verify the CRC in the command message. */
+
 
-    /* Verify the CRC in the received message. */
     crcMsg = (pMsg->hdr.crcHigh << 8) | pMsg->hdr.crcLow;
+
     if (crcMsg != crc)
     {
         if (radioDebug)
         {
-            debugWrite("Received WOIS Xfer Packet with INVALID CRC ");
-            sprintf(debugBuf,"%04X (Expected %04X)\n.",
-                crcMsg, crc);
-            debugWrite(debugBuf);
+            debugTrace(DEBUG_TRACE_RADIO_CMD_CRC, crcMsg, crc, 0, 0);
         }
-        /* Ignore this packet. */
         return;
     }
 
-    /* Handle according to the transfer mode. */
-    switch (pMsg->xferMode)
+
+    if (pMsg->hdr.msgType == RADIO_TYPE_ACK)
     {
-        case RADIO_XMODE_CONFIG | RADIO_XMODE_GET_REQ:
-            radioMessageLog("Get Cfg Segment");
-            /* Get requested segment index from message header. */
-            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
-            if (radioDebug)
-            {
-                debugWrite("WOIS Xfer Req: GET CONFIG SEGMENT ");
-                sprintf(debugBuf, "%d\n", segmentIndex);
-                debugWrite(debugBuf);
-            }
-            resp.xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_GET_ACK;
-            /* Set segment index in response header. */
-            resp.segHigh = pMsg->segHigh;
-            resp.segLow = pMsg->segLow;
-            /* Verify segment index is within range. */
-            if (segmentIndex < RADIO_CFG_SEGS)
-            {
-                /* Send the requested snapshot segment. */
-                i = segmentIndex * RADIO_MAXSEGMENT;
-                nBytes = CONFIG_IMAGE_SIZE - i;
-                if (nBytes > RADIO_MAXSEGMENT)
-                {
-                    nBytes = RADIO_MAXSEGMENT;
-                }
-                configSnapshotRead(i, resp.data, nBytes);
-                resp.dataLen = (uint8_t)nBytes;
-            }
-            else
-            {
-                /* Invalid segment index - send ack with no data. */
-                resp.dataLen = 0;
-            }
-            break;
+        /* Debug test command acknowledge.  Send to debug test command handler. */
+        radioExtCommandHandler(pPacket);
+        return;
+    }
 
-        case RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_REQ:
-            radioMessageLog("Put Cfg Segment");
-            /* Get segment index from message header. */
-            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
-            if (radioDebug)
-            {
-                debugWrite("WOIS Xfer Req: PUT CONFIG SEGMENT ");
-                sprintf(debugBuf, "%d\n", segmentIndex);
-                debugWrite(debugBuf);
-            }
-            resp.dataLen = 0;
-            /* Set segment index in response header. */
-            resp.segHigh = pMsg->segHigh;
-            resp.segLow = pMsg->segLow;
-            /* Verify segment index is within range. */
-            if (segmentIndex < RADIO_CFG_SEGS)
-            {
-                /* Compute image offset and size of this download segment. */
-                i = segmentIndex * RADIO_MAXSEGMENT;
-                nBytes = CONFIG_IMAGE_SIZE - i;
-                if (nBytes > RADIO_MAXSEGMENT)
-                {
-                    nBytes = RADIO_MAXSEGMENT;
-                }
-                if (pMsg->dataLen != nBytes)
-                {
-                    /* Incorrect data length. */
-                    debugWrite("ERROR: Bad put config segment data length.\n");
-                    resp.xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_NACK;
-                }
-                else
-                {
-                    configBufferWrite(&pMsg->data, i, nBytes);
-                    resp.xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_ACK;
-                }
-            }
-            else
-            {
-                /* Invalid segment index. */
-                resp.xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_NACK;
-            }
-            break;
-        
-        /*
-        **  EXPANSION BUS:  Master sending config file to expansion units ACK
-        */
-        case RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_ACK:
-            radioMessageLog("Expan Cfg Seg ACK");
-            /* Get requested segment index from message header. */
-            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
-            segmentIndex++;
-            if (radioDebug)
-            {
-                debugWrite("WOIS Xfer Req: GET CONFIG SEGMENT ");
-                sprintf(debugBuf, "%d\n", segmentIndex);
-                debugWrite(debugBuf);
-            }
-            resp.xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_REQ;
-            /* Set segment index in response header. */
-            resp.segHigh = (segmentIndex >>8);
-            resp.segLow = (segmentIndex & 0x00FF);
-            /* Verify segment index is within range. */
-            if (segmentIndex < RADIO_CFG_SEGS)
-            {
-                /* Send the requested snapshot segment. */
-                i = segmentIndex * RADIO_MAXSEGMENT;
-                nBytes = CONFIG_IMAGE_SIZE - i;
-                if (nBytes > RADIO_MAXSEGMENT)
-                {
-                    nBytes = RADIO_MAXSEGMENT;
-                }
-                configSnapshotRead(i, resp.data, nBytes);
-                resp.dataLen = (uint8_t)nBytes;
-            }
-            else 
-            {
-               /* issue the command to the expansion unit to apply
-                * the new downloaded configuration */
-                expUnitMacID = U8TOU64(pPacket->phyAddr[0],
-                             pPacket->phyAddr[1],
-                             pPacket->phyAddr[2],
-                             pPacket->phyAddr[3],
-                             pPacket->phyAddr[4],
-                             pPacket->phyAddr[5],
-                             pPacket->phyAddr[6],
-                             pPacket->phyAddr[7]);
-                             
-               expansionBusSendCmd(RADIO_CMD_CFG_PUT_APPLY, expUnitMacID);
-               return; 
-            }
-            break;
-        
-        /*
-        **  EXPANSION BUS:  Master sending config file to expansion units NACK
-        */    
-        case RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_NACK:
-            break; 
-        
-        /*
-        **  FIRMWARE DOWNLOAD: receiving new firmware from gateway
-        */        
-        case RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_REQ:
-            radioMessageLog("Put FW Segment");
-            /* Get segment index from message header. */
-            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
-            if (radioDebug)
-            {
-                debugWrite("WOIS Xfer Req: PUT FW SEGMENT ");
-                sprintf(debugBuf, "%d\n", segmentIndex);
-                debugWrite(debugBuf);
-            }
-            
-            if(segmentIndex ==0)
-            {
-              newFirmwareSize = U8TOU32(pMsg->data[8],pMsg->data[9],
-                                  pMsg->data[10],pMsg->data[11]);
-              magicNum = U8TOU32(pMsg->data[0],pMsg->data[1],
-                                  pMsg->data[2],pMsg->data[3]);
-            }
+    //dtflag = pMsg->cmd;
+    //get the source address
+    expMacID = U8TOU64(pPacket->phyAddr[0],
+                       pPacket->phyAddr[1],
+                       pPacket->phyAddr[2],
+                       pPacket->phyAddr[3],
+                       pPacket->phyAddr[4],
+                       pPacket->phyAddr[5],
+                       pPacket->phyAddr[6],
+                       pPacket->phyAddr[7]);
 
-            resp.dataLen = 0;
-            /* Set segment index in response header. */
-            resp.segHigh = pMsg->segHigh;
-            resp.segLow = pMsg->segLow;
-            
-            
-            /* Verify segment index is within range. */
-            if (segmentIndex < RADIO_FW_SEGS)
-            {
-                /* Compute image offset and size of this download segment. */
-                i = segmentIndex * RADIO_MAXSEGMENT;
-                nBytes = newFirmwareSize + BULK_FW_HDR_SIZE - i;
-                if (nBytes > RADIO_MAXSEGMENT)
-                {
-                    nBytes = RADIO_MAXSEGMENT;
-                }
-                if (pMsg->dataLen != nBytes)
-                {
-                    /* Incorrect data length. */
-                    debugWrite("ERROR: Bad put config segment data length.\n");
-                    resp.xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_NACK;
-                }
-                else
-                {
-                    if(segmentIndex ==0)
-                    {
-                            //copy off the firmware header to be writtent o external
-                            //flash once all packets have been received
-                            memcpy(ImageData,&pMsg->data, BULK_FW_HDR_SIZE);
-                        
-                            if(drvExtFlashWrite((&pMsg->data[BULK_FW_HDR_SIZE]),EXT_FLASH_SEC_1, (nBytes-BULK_FW_HDR_SIZE))) 
-                            {
-                               resp.xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_ACK;
-                            }
-                            else 
-                            {
-                               resp.xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_NACK;
-                               //drvExtFlashRead(EXT_FLASH_SEC_1,spiTest,(nBytes-BULK_FW_HDR_SIZE));
-                            }
+    /* inform the system that communication was received from the proper expansion */
+    if(expMacID ==config.sys.expMac1)
+    {
+        radioStatusExpansion1 = EXPANSION_CONNECTED;
+        radioSentExpan1Msg = FALSE;
+        sysFaultClear(SYS_FAULT_EXPAN_1);
+    }
+    else if(expMacID ==config.sys.expMac2)
+    {
+        radioStatusExpansion2 = EXPANSION_CONNECTED;
+        radioSentExpan2Msg = FALSE;
+        sysFaultClear(SYS_FAULT_EXPAN_2);
+    }
+    else if(expMacID ==config.sys.expMac3)
+    {
+        radioStatusExpansion3 = EXPANSION_CONNECTED;
+        radioSentExpan3Msg = FALSE;
+        sysFaultClear(SYS_FAULT_EXPAN_3);
+    }
+    else if(expMacID ==config.sys.masterMac)
+    {
+        radioSentMasterMsg = FALSE;
+        sysFaultClear(SYS_FAULT_EXPAN_MASTER);
+    }
 
-                    } 
-                    else
-                    {
-                        if(extFlashBufferWrite(&pMsg->data, (i-BULK_FW_HDR_SIZE), nBytes))
-                        {                      
-                            resp.xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_ACK;
-                            
-                            //check to see if this is the last packet
-                            //if so then write the firmware header to external flash
-                            if((i-BULK_FW_HDR_SIZE+nBytes)==newFirmwareSize)
-                            {
-                                if(drvExtFlashWrite(ImageData,FW_NEW_INFO_SPI_ADDR,  BULK_FW_HDR_SIZE) == FALSE) 
-                                {
-                                    resp.xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_NACK;
-                                }
-                                
-                                
-                            }
-                        } 
-                        else 
-                        {
-                            resp.xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_NACK;
-                        }
-                    }
-                }
-            }
-            else
-            {
-                /* Invalid segment index. */
-                resp.xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_NACK;
-            }
-            break;
-            
-        /*
-        **  FLOW SENSOR DATA 24hrs:  Read Access to Raw EEPROM Data
-        */            
-        case RADIO_XMODE_FLOW | RADIO_XMODE_GET_REQ:
-            radioMessageLog("Get Flow Segment");
-            /* Get requested segment index from message header. */
-            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
-            if (radioDebug)
-            {
-                debugWrite("WOIS Xfer Req: GET FLOW DATA SEGMENT ");
-                sprintf(debugBuf, "%d\n", segmentIndex);
-                debugWrite(debugBuf);
-            }
-            resp.xferMode = RADIO_XMODE_FLOW | RADIO_XMODE_GET_ACK;
-            /* Set segment index in response header. */
-            resp.segHigh = pMsg->segHigh;
-            resp.segLow = pMsg->segLow;
-            /* Verify segment index is within range. */
-            if (segmentIndex < RADIO_FLOW_SEGS)
-            {
-                /* Send the requested snapshot segment. */
-                i = segmentIndex * RADIO_MAXSEGMENT;
-                nBytes = FLOW_DATA_SIZE - i;
-                if (nBytes > RADIO_MAXSEGMENT)
-                {
-                    nBytes = RADIO_MAXSEGMENT;
-                }
-                drvEepromRead(FLOW_SNS_DATA + i, resp.data, nBytes);
-                resp.dataLen = (uint8_t)nBytes;
-            }
-            else
-            {
-                /* Invalid segment index - send ack with no data. */
-                resp.dataLen = 0;
-            }
-            break;
-        
-        /*
-        **  LEVEL SENSOR DATA 24hrs:  Read Access to Raw EEPROM Data
-        */            
-        case RADIO_XMODE_LEVEL | RADIO_XMODE_GET_REQ:
-            radioMessageLog("Get LevelSegment");
-            /* Get requested segment index from message header. */
-            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
-            if (radioDebug)
-            {
-                debugWrite("WOIS Xfer Req: GET LEVEL DATA SEGMENT ");
-                sprintf(debugBuf, "%d\n", segmentIndex);
-                debugWrite(debugBuf);
-            }
-            resp.xferMode = RADIO_XMODE_LEVEL | RADIO_XMODE_GET_ACK;
-            /* Set segment index in response header. */
-            resp.segHigh = pMsg->segHigh;
-            resp.segLow = pMsg->segLow;
-            /* Verify segment index is within range. */
-            if (segmentIndex < RADIO_LEVEL_SEGS)
-            {
+    stat = radioProtoStatRx(pPacket, RADIO_PSTAT_CMD, pMsg->cmd, crc);
+
+    /* Look up the command. */
+    if ((pMsg->cmd >= RADIO_PROTO_CMD_N) ||
+        (radioProtoCmdTable[pMsg->cmd].pFunc == NULL))
+    {
+        /* Unknown command - call extended command handler. */
+        radioExtCommandHandler(pPacket);
+        radioProtoStatDone(stat, FALSE, msStart);
+        return;
+    }
+    pEnt = &radioProtoCmdTable[pMsg->cmd];
+
+    /* Check the command data length and that this unit type accepts it. */
+    unit = (config.sys.unitType == UNIT_TYPE_MASTER) ?
+           RADIO_CMDU_MASTER : RADIO_CMDU_EXP;
+    if ((pMsg->dataLen < pEnt->minLen) ||
+        (pMsg->dataLen > pEnt->maxLen) ||
+        ((pEnt->units & unit) == 0))
+    {
+        if (radioDebug)
+        {
+            debugTrace(DEBUG_TRACE_RADIO_CMD_REJECT, pMsg->cmd,
+                       pMsg->dataLen, unit, 0);
+        }
+        radioProtoStatDone(stat, TRUE, msStart);
+        return;
+    }
+
+    if (pEnt->pLogDesc != NULL)
+    {
+        radioMessageLog(pEnt->pLogDesc);
+    }
+
+    /* Handle the command. */
+    lenData = pEnt->pFunc(pPacket, expMacID, data);
+
+    /* forward message onto expasion units if master */
+    if (((pEnt->flags & RADIO_CMDF_FORWARD) != 0) &&
+        (config.sys.unitType == UNIT_TYPE_MASTER) &&
+        (expMacID != config.sys.expMac1) &&
+        (expMacID != config.sys.expMac2) &&
+        (expMacID != config.sys.expMac3))
+    {
+        expansionBusForwardCmd(pPacket);
+    }
+
+    /* Send acknowledgement packet. */
+    radioProtocolAckSend(pPacket, pEnt->ack, data, lenData);
+    radioProtoStatDone(stat, FALSE, msStart);
+
+    /* if apply firmware command was sent then reboot processor *
+     * this is done here so ACK to the apply command can be sent */
+    if ((pEnt->flags & RADIO_CMDF_REBOOT) != 0)
+    {
+           sprintf(&uiLcdBuf[LCD_RC(0,0)], "Updating Firmware....Rebooting....      ");
+           sprintf(&uiLcdBuf[LCD_RC(1,0)], "                                        ");
+           sprintf(&uiLcdBuf[LCD_RC(2,0)], "                                        ");
+           sprintf(&uiLcdBuf[LCD_RC(3,0)], "                                        ");
+           uiLcdCursor = 160;
+            /* Write LCD buffer to hardware device driver. */
+           drvLcdWrite(uiLcdBuf, uiLcdCursor);
+           hwCpu_Delay100US(5000);
+           drvProcessorReboot();
+    }
+
+    /* Yield control back to the system main polling loop. */
+    radioYield = TRUE;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdNoOp
+ *
+ * PURPOSE
+ *      This routine handles the No Op command.  A master sends the current
+ *      date and time to an expansion unit that sends it a No Op.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdNoOp(const radioRxDataPacket_t *pPacket,
+                                 uint64_t expMacID,
+                                 uint8_t *pData)
+{
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: NO OP\n");
+    }
+
+    /* send updated time to unit that sent NO OP */
+    if((config.sys.unitType == UNIT_TYPE_MASTER)&&
+       ((expMacID == config.sys.expMac1)||
+       (expMacID == config.sys.expMac2)||
+       (expMacID == config.sys.expMac3)))
+    {
+        expansionBusSendCmd(RADIO_CMD_INIT_DATETIME, expMacID);
+    }
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdInhibitOn
+ *
+ * PURPOSE
+ *      This routine handles the Inhibit On command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdInhibitOn(const radioRxDataPacket_t *pPacket,
+                                      uint64_t expMacID,
+                                      uint8_t *pData)
+{
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: INHIBIT ON\n");
+    }
+    /* Set Inhibit On. */
+    sysInhibitOn();
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdInhibitOff
+ *
+ * PURPOSE
+ *      This routine handles the Inhibit Off command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdInhibitOff(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID,
+                                       uint8_t *pData)
+{
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: INHIBIT OFF\n");
+    }
+    /* Set Inhibit Off. */
+    sysInhibitOff();
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdForceOn
+ *
+ * PURPOSE
+ *      This routine handles the Force On command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdForceOn(const radioRxDataPacket_t *pPacket,
+                                    uint64_t expMacID,
+                                    uint8_t *pData)
+{
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: FORCE ON\n");
+    }
+    /* Force On. */
+    irrCmdForceOn();
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdWeatherData
+ *
+ * PURPOSE
+ *      This routine handles the Weather Update command, which carries the
+ *      ET and rainfall accumulator values.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdWeatherData(const radioRxDataPacket_t *pPacket,
+                                        uint64_t expMacID,
+                                        uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    uint32_t etData;
+    uint32_t rainfall;
+    char debugBuf[40];
+
+    /* Extract the 4 bytes of ET data from the command message. */
+    etData = U8TOU32(pMsg->data[0],
+                     pMsg->data[1],
+                     pMsg->data[2],
+                     pMsg->data[3]);
+    /* Extract the 4 bytes of rainfall data from the command message. */
+    rainfall = U8TOU32(pMsg->data[4],
+                       pMsg->data[5],
+                       pMsg->data[6],
+                       pMsg->data[7]);
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: WEATHER UPDATE (ET=0x");
+        sprintf(debugBuf, "%08X", etData);
+        debugWrite(debugBuf);
+        debugWrite("; Rain=0x");
+        sprintf(debugBuf, "%08X)\n", rainfall);
+        debugWrite(debugBuf);
+    }
+    /* Attempt to apply weather update data. */
+    if (radioProtoCmdWeatherUpdate(etData, rainfall))
+    {
+        /* Weather update applied successfully. */
+        radioMessageLog("Weather Update");
+        pData[0] = RADIO_RESULT_SUCCESS;
+    }
+    else
+    {
+        /* Weather data not applied; accumulator re-sync occurred. */
+        radioMessageLog("Weather Sync");
+        pData[0] = RADIO_RESULT_FAILURE;
+    }
+    /* Indicate if system is configured for Weather mode. */
+    if (config.sys.opMode == CONFIG_OPMODE_WEATHER)
+    {
+        /* Weather operation mode in use. */
+        pData[1] = RADIO_WEATHER_MODE_ON;
+    }
+    else
+    {
+        /* Weather operation mode not in use. */
+        pData[1] = RADIO_WEATHER_MODE_OFF;
+    }
+    return 2;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdGetMoist
+ *
+ * PURPOSE
+ *      This routine handles the Get Moisture Values command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdGetMoist(const radioRxDataPacket_t *pPacket,
+                                     uint64_t expMacID,
+                                     uint8_t *pData)
+{
+    uint8_t lenData;
+    int i;
+
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: GET MOISTURE VALUES\n");
+    }
+    lenData = config.sys.numZones;
+    for (i = 0; i < lenData; i++)
+    {
+        /* Get zone moisture value. */
+        pData[i] = sysRadioMoistValueGet(i);
+    }
+    return lenData;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdGetExStat
+ *
+ * PURPOSE
+ *      This routine handles the Get Extended System Status command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdGetExStat(const radioRxDataPacket_t *pPacket,
+                                      uint64_t expMacID,
+                                      uint8_t *pData)
+{
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: GET EXTENDED STATUS\n");
+    }
+    /* Get Extended System Status data. */
+    return sysRadioExtStatusGet(pData);
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdGetExStat2
+ *
+ * PURPOSE
+ *      This routine handles the Get Extended System Status Part 2 command,
+ *      which returns the daily runtimes of zones 1-24.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdGetExStat2(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID,
+                                       uint8_t *pData)
+{
+    int i;
+
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: GET EXTENDED STATUS 2\n");
+    }
+    for(i=0; i<(SYS_N_ZONES/2); i++)
+    {
+        pData[2*i]=(irrDailyRuntimePerZone[i] >> 8);
+        pData[2*i+1]=(irrDailyRuntimePerZone[i] & 0xFF);
+    }
+    /* Expansion zones are served from the digest cache; refresh if stale. */
+    expansionDigestRequest();
+    return 48;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdGetExStat3
+ *
+ * PURPOSE
+ *      This routine handles the Get Extended System Status Part 3 command,
+ *      which returns the daily runtimes of zones 25-48.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdGetExStat3(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID,
+                                       uint8_t *pData)
+{
+    int i;
+
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: GET EXTENDED STATUS 3\n");
+    }
+    for(i=0; i<(SYS_N_ZONES/2); i++)
+    {
+        pData[2*i]=(irrDailyRuntimePerZone[i+24] >> 8);
+        pData[2*i+1]=(irrDailyRuntimePerZone[i+24] & 0xFF);
+    }
+    /* Expansion zones are served from the digest cache; refresh if stale. */
+    expansionDigestRequest();
+    return 48;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdDigest
+ *
+ * PURPOSE
+ *      This routine handles the Get Status Digest command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdDigest(const radioRxDataPacket_t *pPacket,
+                                   uint64_t expMacID,
+                                   uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: GET STATUS DIGEST\n");
+    }
+    return radioProtoCmdGetDigest((pMsg->dataLen > 0) ? pMsg->data[0] : 0,
+                                  pData);
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdCfgGetSnap
+ *
+ * PURPOSE
+ *      This routine handles the Start Configuration Upload command, which
+ *      saves a configuration snapshot for upload.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdCfgGetSnap(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID,
+                                       uint8_t *pData)
+{
+    debugWrite("WOIS Cmd: START CONFIGURATION UPLOAD\n");
+    /* Configuration Version */
+    pData[0] = (uint8_t)(ntohs(config.sys.version) >> 8);
+    pData[1] = (uint8_t)(ntohs(config.sys.version) & 0xFF);
+    /* Configuration Checksum */
+    pData[2] = (uint8_t)(ntohs(config.sys.checkSum) >> 8);
+    pData[3] = (uint8_t)(ntohs(config.sys.checkSum) & 0xFF);
+    /* Configuration Data Image Size */
+    pData[4] = (uint8_t)(CONFIG_IMAGE_SIZE >> 8);
+    pData[5] = (uint8_t)(CONFIG_IMAGE_SIZE & 0xFF);
+    /* Configuration Data Segment Count */
+    pData[6] = (uint8_t)(RADIO_CFG_SEGS >> 8);
+    pData[7] = (uint8_t)(RADIO_CFG_SEGS & 0xFF);
+    /* Save configuration snapshot to upload buffer. */
+    configSnapshotSave();
+    return 8;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdCfgManifest
+ *
+ * PURPOSE
+ *      This routine handles the Get Config Manifest command, which returns
+ *      the CRC-16 of each RADIO_MAXSEGMENT block of the config snapshot.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ * NOTES
+ *      The CRCs start at the block given in the command data (2 bytes).  A
+ *      request for block 0 first saves the snapshot (which is skipped if the
+ *      config is unchanged).  The NOC then uploads only the segments whose
+ *      CRC differs from its cached copy.
+ *      Ack data: version (2), checksum (2), segment count (2), first
+ *      block (2), then up to RADIO_CFG_MANIFEST_CRCS block CRCs (2 each).
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdCfgManifest(const radioRxDataPacket_t *pPacket,
+                                        uint64_t expMacID,
+                                        uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    uint16_t block = 0;
+    uint16_t crc;
+    uint8_t lenData;
+    int i;
+
+    if (pMsg->dataLen >= 2)
+    {
+        block = U8TOU16(pMsg->data[0], pMsg->data[1]);
+    }
+    if (block == 0)
+    {
+        configSnapshotSave();
+    }
+    pData[0] = (uint8_t)(ntohs(config.sys.version) >> 8);
+    pData[1] = (uint8_t)(ntohs(config.sys.version) & 0xFF);
+    pData[2] = (uint8_t)(ntohs(config.sys.checkSum) >> 8);
+    pData[3] = (uint8_t)(ntohs(config.sys.checkSum) & 0xFF);
+    pData[4] = (uint8_t)(RADIO_CFG_SEGS >> 8);
+    pData[5] = (uint8_t)(RADIO_CFG_SEGS & 0xFF);
+    pData[6] = (uint8_t)(block >> 8);
+    pData[7] = (uint8_t)(block & 0xFF);
+    lenData = 8;
+    for (i = block;
+         (i < RADIO_CFG_SEGS) && (i < block + RADIO_CFG_MANIFEST_CRCS);
+         i++)
+    {
+        crc = configSnapshotBlockCrc((uint16_t)i);
+        pData[lenData++] = (uint8_t)(crc >> 8);
+        pData[lenData++] = (uint8_t)(crc & 0xFF);
+    }
+    return lenData;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdCfgPutStart
+ *
+ * PURPOSE
+ *      This routine handles the Start Configuration Download command, which
+ *      clears the configuration download buffer.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdCfgPutStart(const radioRxDataPacket_t *pPacket,
+                                        uint64_t expMacID,
+                                        uint8_t *pData)
+{
+    debugWrite("WOIS Cmd: START CONFIGURATION DOWNLOAD\n");
+    /* Configuration Version */
+    pData[0] = (uint8_t)(ntohs(config.sys.version) >> 8);
+    pData[1] = (uint8_t)(ntohs(config.sys.version) & 0xFF);
+    /* Configuration Checksum */
+    pData[2] = (uint8_t)(ntohs(config.sys.checkSum) >> 8);
+    pData[3] = (uint8_t)(ntohs(config.sys.checkSum) & 0xFF);
+    /* Configuration Data Image Size */
+    pData[4] = (uint8_t)(CONFIG_IMAGE_SIZE >> 8);
+    pData[5] = (uint8_t)(CONFIG_IMAGE_SIZE & 0xFF);
+    /* Configuration Data Segment Count */
+    pData[6] = (uint8_t)(RADIO_CFG_SEGS >> 8);
+    pData[7] = (uint8_t)(RADIO_CFG_SEGS & 0xFF);
+    /* Clear configuration download buffer to all 0xFF's. */
+    configBufferClear();
+    /* A full download replaces any delta being received. */
+    radioCfgDeltaVersion = 0;
+    return 8;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdCfgPutApply
+ *
+ * PURPOSE
+ *      This routine handles the Apply Downloaded Configuration command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdCfgPutApply(const radioRxDataPacket_t *pPacket,
+                                        uint64_t expMacID,
+                                        uint8_t *pData)
+{
+    int16_t result;
+
+    debugWrite("WOIS Cmd: APPLY DOWNLOADED CONFIGURATION\n");
+    /* Request to Apply the configuration image in the download buffer. */
+    result = configBufferLoad();
+    if (result == -1)
+    {
+        pData[0] = RADIO_RESULT_SUCCESS;    /* success */
+        pData[1] = 0;
+        pData[2] = 0;
+        debugWrite("Configuration applied.\n");
+
+       sysFaultClear(SYS_FAULT_EXPAN_MASTER);
+       sysFaultClear(SYS_FAULT_EXPAN_1);
+       sysFaultClear(SYS_FAULT_EXPAN_2);
+       sysFaultClear(SYS_FAULT_EXPAN_3);
+    }
+    else
+    {
+        pData[0] = RADIO_RESULT_FAILURE;    /* failure */
+        pData[1] = result >> 8;     /* offset to bad config data MSB */
+        pData[2] = result & 0x00FF; /* offset to bad config data LSB */
+        debugWrite("Configuration not applied - invalid image.\n");
+    }
+    return 3;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdCfgDeltaStart
+ *
+ * PURPOSE
+ *      This routine handles the Start Delta Config Distribution command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdCfgDeltaStart(const radioRxDataPacket_t *pPacket,
+                                          uint64_t expMacID,
+                                          uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+
+    pData[0] = radioCfgDeltaStart(pMsg->data, pMsg->dataLen, expMacID);
+    return 1;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdCfgDeltaApply
+ *
+ * PURPOSE
+ *      This routine handles the Apply Delta Config command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdCfgDeltaApply(const radioRxDataPacket_t *pPacket,
+                                          uint64_t expMacID,
+                                          uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+
+    return radioCfgDeltaApply(pMsg->data, pMsg->dataLen, pData);
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdGetMb
+ *
+ * PURPOSE
+ *      This routine handles the Get Moisture Balance Values command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdGetMb(const radioRxDataPacket_t *pPacket,
+                                  uint64_t expMacID,
+                                  uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    char debugBuf[40];
+
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: GET MB VALUES (start zone=");
+        sprintf(debugBuf, "%d)\n", pMsg->data[0]);
+        debugWrite(debugBuf);
+    }
+    /* Get Moisture Balance Values data. */
+    return radioProtoCmdGetMbValues(pMsg->data[0], pData);
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdSetMb
+ *
+ * PURPOSE
+ *      This routine handles the Set Moisture Balance Values command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdSetMb(const radioRxDataPacket_t *pPacket,
+                                  uint64_t expMacID,
+                                  uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    char debugBuf[40];
+
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: SET MB VALUES (start zone=");
+        sprintf(debugBuf, "%d)\n", pMsg->data[0]);
+        debugWrite(debugBuf);
+    }
+    /* Set Moisture Balance Values from command data. */
+    if (radioProtoCmdSetMbValues(pMsg->data, pMsg->dataLen))
+    {
+        pData[0] = RADIO_RESULT_SUCCESS;
+    }
+    else
+    {
+        pData[0] = RADIO_RESULT_FAILURE;
+    }
+    return 1;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdInitDateTime
+ *
+ * PURPOSE
+ *      This routine handles the Init Date/Time command.  A master forwards
+ *      the command to the expansion units.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdInitDateTime(const radioRxDataPacket_t *pPacket,
+                                         uint64_t expMacID,
+                                         uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+
+    //dtflag = 88;
+    //dtdata =
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: Init Date/Time\n");
+    }
+    /* Initialize response status to indicate failure. */
+    pData[0] = RADIO_RESULT_FAILURE;
+    /* Only allow clock to be set if a date/time error is present. */
+    //if (sysErrorOn(SYS_ERROR_DATETIME))
+    {
+        if (pMsg->dataLen == 6)
+        {
+            /* Set date/time in system real time clock. */
+
+            if ( dtSetClock(  (uint16_t)((int)(pMsg->data[0]) + 2000),
+                               pMsg->data[1],
+                               pMsg->data[2],
+                               pMsg->data[3],
+                               pMsg->data[4],
+                               pMsg->data[5] )   )
+            {
+                /* Update response status to indicate success. */
+                pData[0] = RADIO_RESULT_SUCCESS;
+            }
+        }
+    }
+
+    /* forward message onto expasion units if master */
+    if(config.sys.unitType == UNIT_TYPE_MASTER)
+    {
+        expansionBusForwardCmd(pPacket);
+    }
+    return 1;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdSendFlow
+ *
+ * PURPOSE
+ *      This routine handles the Send Flow command, which carries the master
+ *      unit's flow meter settings to an expansion unit.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdSendFlow(const radioRxDataPacket_t *pPacket,
+                                     uint64_t expMacID,
+                                     uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+
+    pData[0] = RADIO_RESULT_FAILURE;
+    if (pMsg->dataLen == 4) {
+        slaveGPM = pMsg->data[0];
+        slaveFlowDelay = U8TOU16(pMsg->data[1],pMsg->data[2]);
+        slaveFindFlow = pMsg->data[3];
+        pData[0] = RADIO_RESULT_SUCCESS;
+    }
+    return 4;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdDiagnose
+ *
+ * PURPOSE
+ *      This routine handles the Diagnose command.  The command data is a
+ *      text string; the response is a text string.  Unknown commands get
+ *      "?" for the response.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdDiagnose(const radioRxDataPacket_t *pPacket,
+                                     uint64_t expMacID,
+                                     uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    char debugBuf[40];
+    drvSysRam_t ram;
+
+    memcpy(debugBuf, pMsg->data, pMsg->dataLen);
+    debugBuf[pMsg->dataLen] = '\0';
+    if (radioDebug)
+    {
+        debugWrite("WOIS Cmd: DIAGNOSE - '");
+        debugWrite(debugBuf);
+        debugWrite("'\n");
+    }
+    if (strcmp(debugBuf, "ram") == 0)
+    {
+        /* RAM usage and stack high-water mark */
+        drvSysRamGet(&ram);
+        sprintf((char *)pData, "data=%u bss=%u heap=%u stack=%u used=%u",
+                ram.data,
+                ram.bss,
+                ram.heap,
+                ram.stack,
+                ram.stackUsed);
+        return (uint8_t)(strlen((char *)pData) + 1);
+    }
+
+    pData[0] = '?';
+    pData[1] = '\0';
+    return 2;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdGetRadioStat
+ *
+ * PURPOSE
+ *      This routine handles the Get Radio Status command, which returns the
+ *      Tx data queue statistics.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ * NOTES
+ *      Ack data for each priority class: frames sent (2), frames dropped
+ *      (2), average and longest time queued in ms (2 each).
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdGetRadioStat(const radioRxDataPacket_t *pPacket,
+                                         uint64_t expMacID,
+                                         uint8_t *pData)
+{
+    uint8_t lenData = 0;
+    uint32_t avgMs;
+    int i;
+
+    for (i = 0; i < RADIO_TXP_N; i++)
+    {
+        avgMs = (radioTxqStat[i].sent == 0) ? 0 :
+            radioTxqStat[i].totalMs / radioTxqStat[i].sent;
+        if (avgMs > 0xFFFF)
+        {
+            avgMs = 0xFFFF;
+        }
+        pData[lenData++] = (uint8_t)(radioTxqStat[i].sent >> 8);
+        pData[lenData++] = (uint8_t)(radioTxqStat[i].sent & 0xFF);
+        pData[lenData++] = (uint8_t)(radioTxqStat[i].dropped >> 8);
+        pData[lenData++] = (uint8_t)(radioTxqStat[i].dropped & 0xFF);
+        pData[lenData++] = (uint8_t)(avgMs >> 8);
+        pData[lenData++] = (uint8_t)(avgMs & 0xFF);
+        pData[lenData++] = (uint8_t)(radioTxqStat[i].maxMs >> 8);
+        pData[lenData++] = (uint8_t)(radioTxqStat[i].maxMs & 0xFF);
+    }
+    return lenData;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdGetProtoStat
+ *
+ * PURPOSE
+ *      This routine handles the Get Protocol Statistics command, which
+ *      returns the per command and per transfer data type statistics.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ * NOTES
+ *      Command data: first entry to return (1, default 0), flags (1,
+ *      RADIO_PROTOSTAT_RESET to clear the statistics after this read).
+ *      Ack data: next entry to request (1, RADIO_PSTAT_NONE when done),
+ *      then up to RADIO_PSTAT_PAGE records for entries in use: entry type
+ *      (1, RADIO_PSTAT_xxx), command code or transfer type (1), received
+ *      (2), acked (2), nacked (2), duplicates (2), Tx failures (2), average
+ *      and longest processing time in ms (2 each).
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdGetProtoStat(const radioRxDataPacket_t *pPacket,
+                                         uint64_t expMacID,
+                                         uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    radioProtoStat_t *pStat;
+    uint8_t lenData = 1;
+    uint8_t nRec = 0;
+    uint16_t nDone;
+    uint32_t avgMs;
+    uint8_t i;
+
+    i = (pMsg->dataLen > 0) ? pMsg->data[0] : 0;
+    for (; i < RADIO_PSTAT_N; i++)
+    {
+        pStat = &radioProtoStat[i];
+        if ((pStat->type == RADIO_PSTAT_FREE) || (nRec == RADIO_PSTAT_PAGE))
+        {
+            /* Entries are assigned in order; the rest are free. */
+            break;
+        }
+        nDone = pStat->ack + pStat->nack;
+        avgMs = (nDone == 0) ? 0 : pStat->totalMs / nDone;
+        if (avgMs > 0xFFFF)
+        {
+            avgMs = 0xFFFF;
+        }
+        pData[lenData++] = pStat->type;
+        pData[lenData++] = pStat->code;
+        pData[lenData++] = (uint8_t)(pStat->rx >> 8);
+        pData[lenData++] = (uint8_t)(pStat->rx & 0xFF);
+        pData[lenData++] = (uint8_t)(pStat->ack >> 8);
+        pData[lenData++] = (uint8_t)(pStat->ack & 0xFF);
+        pData[lenData++] = (uint8_t)(pStat->nack >> 8);
+        pData[lenData++] = (uint8_t)(pStat->nack & 0xFF);
+        pData[lenData++] = (uint8_t)(pStat->dup >> 8);
+        pData[lenData++] = (uint8_t)(pStat->dup & 0xFF);
+        pData[lenData++] = (uint8_t)(pStat->txFail >> 8);
+        pData[lenData++] = (uint8_t)(pStat->txFail & 0xFF);
+        pData[lenData++] = (uint8_t)(avgMs >> 8);
+        pData[lenData++] = (uint8_t)(avgMs & 0xFF);
+        pData[lenData++] = (uint8_t)(pStat->maxMs >> 8);
+        pData[lenData++] = (uint8_t)(pStat->maxMs & 0xFF);
+        nRec++;
+    }
+    pData[0] = ((i < RADIO_PSTAT_N) &&
+                (radioProtoStat[i].type != RADIO_PSTAT_FREE)) ?
+               i : RADIO_PSTAT_NONE;
+
+    if ((pMsg->dataLen > 1) && ((pMsg->data[1] & RADIO_PROTOSTAT_RESET) != 0))
+    {
+        radioProtoStatReset();
+    }
+    return lenData;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoStatRx
+ *
+ * PURPOSE
+ *      This routine counts a received WOIS message in the protocol
+ *      statistics and makes its entry the one being handled.
+ *
+ * PARAMETERS
+ *      pPacket     IN  pointer to start of packet
+ *      type        IN  message type (RADIO_PSTAT_CMD or RADIO_PSTAT_XFER)
+ *      code        IN  command code or transfer type
+ *      crc         IN  message CRC
+ *
+ * RETURN VALUE
+ *      The protocol statistics entry, or RADIO_PSTAT_NONE if the message
+ *      is not counted (replayed traffic).
+ *
+ *****************************************************************************/
+static uint8_t radioProtoStatRx(const radioRxDataPacket_t *pPacket,
+                                uint8_t type,
+                                uint8_t code,
+                                uint16_t crc)
+{
+    uint8_t stat;
+    uint32_t src;
+    uint32_t now;
+
+    /* Replayed traffic is not counted. */
+    if (radioReplayActive)
+    {
+        return RADIO_PSTAT_NONE;
+    }
+
+    stat = radioProtoStatEntry(type, code);
+
+    src = U8TOU32(pPacket->phyAddr[4],
+                  pPacket->phyAddr[5],
+                  pPacket->phyAddr[6],
+                  pPacket->phyAddr[7]);
+    now = drvMSGet();
+
+    radioProtoStat[stat].rx++;
+    if ((stat == radioProtoStatLast) &&
+        (crc == radioProtoStatLastCrc) &&
+        (src == radioProtoStatLastSrc) &&
+        ((now - radioProtoStatLastTime) < RADIO_PSTAT_DUP_MS))
+    {
+        radioProtoStat[stat].dup++;
+    }
+    radioProtoStatLast = stat;
+    radioProtoStatLastCrc = crc;
+    radioProtoStatLastSrc = src;
+    radioProtoStatLastTime = now;
+
+    radioProtoStatCur = stat;
+    return stat;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoStatEntry
+ *
+ * PURPOSE
+ *      This routine finds the protocol statistics entry for a message,
+ *      assigning a free entry the first time the message is received.
+ *
+ * PARAMETERS
+ *      type        IN  message type (RADIO_PSTAT_CMD or RADIO_PSTAT_XFER)
+ *      code        IN  command code or transfer type
+ *
+ * RETURN VALUE
+ *      The protocol statistics entry.
+ *
+ * NOTES
+ *      Entries are assigned in order, so the search stops at the first
+ *      free entry.  When no entry is free the last entry is used for all
+ *      remaining messages.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoStatEntry(uint8_t type, uint8_t code)
+{
+    uint8_t i;
+    radioProtoStat_t *pStat;
+
+    for (i = 0; i < RADIO_PSTAT_N - 1; i++)
+    {
+        pStat = &radioProtoStat[i];
+        if (pStat->type == RADIO_PSTAT_FREE)
+        {
+            pStat->type = type;
+            pStat->code = code;
+            return i;
+        }
+        if ((pStat->type == type) && (pStat->code == code))
+        {
+            return i;
+        }
+    }
+
+    radioProtoStat[i].type = RADIO_PSTAT_OTHER;
+    radioProtoStat[i].code = 0;
+    return i;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoStatDone
+ *
+ * PURPOSE
+ *      This routine counts the outcome and processing time of a WOIS
+ *      message in the protocol statistics.
+ *
+ * PARAMETERS
+ *      stat        IN  protocol statistics entry (from radioProtoStatRx)
+ *      nack        IN  TRUE if the message was rejected or NACKed
+ *      msStart     IN  ms time the message handling started
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ *****************************************************************************/
+static void radioProtoStatDone(uint8_t stat, bool_t nack, uint32_t msStart)
+{
+    uint32_t ms;
+
+    if (stat == RADIO_PSTAT_NONE)
+    {
+        return;
+    }
+
+    if (nack)
+    {
+        radioProtoStat[stat].nack++;
+    }
+    else
+    {
+        radioProtoStat[stat].ack++;
+    }
+
+    ms = drvMSGet() - msStart;
+    radioProtoStat[stat].totalMs += ms;
+    if (ms > radioProtoStat[stat].maxMs)
+    {
+        radioProtoStat[stat].maxMs = (ms > 0xFFFF) ? 0xFFFF : (uint16_t)ms;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoStatReset
+ *
+ * PURPOSE
+ *      This routine clears the protocol statistics.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      When called while a WOIS message is being handled, the reset is
+ *      done once the message has been counted, so the cleared entry is not
+ *      charged for it.  Queued responses are untagged so their Tx failures
+ *      are not charged to whichever entry is assigned next.
+ *
+ *****************************************************************************/
+void radioProtoStatReset(void)
+{
+    uint8_t i;
+
+    if (radioProtoStatCur != RADIO_PSTAT_NONE)
+    {
+        /* Done by the dispatcher after radioProtoStatDone(). */
+        radioProtoStatResetPending = TRUE;
+        return;
+    }
+
+    memset(radioProtoStat, 0, sizeof(radioProtoStat));
+    radioProtoStatLast = RADIO_PSTAT_NONE;
+    for (i = 0; i < RADIO_TXQ_SIZE; i++)
+    {
+        radioTxq[i].stat = RADIO_PSTAT_NONE;
+    }
+    radioProtoStatResetPending = FALSE;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdFwPutStart
+ *
+ * PURPOSE
+ *      This routine handles the Start Firmware Download command, which
+ *      erases the external flash area for the new firmware image.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdFwPutStart(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID,
+                                       uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+
+    debugWrite("WOIS Cmd: START FIRWMARE DOWNLOAD\n");
+
+    /* Extract the 4 bytes of new firmware image size from the command message. */
+    newFirmwareSize = U8TOU32(pMsg->data[0],
+                              pMsg->data[1],
+                              pMsg->data[2],
+                              pMsg->data[3]);
+
+    /* Current Firmware Version */
+    pData[0] = (uint8_t)(ntohs(sysFirmwareVer.major));
+    pData[1] = (uint8_t)(ntohs(sysFirmwareVer.minor));
+    pData[2] = (uint8_t)(ntohs(sysFirmwareVer.patch));
+    pData[3] = (uint8_t)(ntohs(sysFirmwareVer.seq));
+
+    /* Clear area of flash to all 0xFF's for firmware download. */
+    if(extFlashFWErase(EXT_FLASH_SEC_0) == TRUE)
+    {
+      pData[4] = RADIO_RESULT_SUCCESS;
+    }
+    else
+    {
+      pData[4] = RADIO_RESULT_FAILURE;
+    }
+
+     /* Future Expansion */
+    pData[5] = 0;
+    pData[6] = 0;
+    pData[7] = 0;
+    return 8;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdFwPutApply
+ *
+ * PURPOSE
+ *      This routine handles the Apply Downloaded Firmware command.  The
+ *      processor is rebooted into the bootloader once the ack is sent.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdFwPutApply(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID,
+                                       uint8_t *pData)
+{
+    debugWrite("WOIS Cmd: APPLY DOWNLOADED FIRMWARE\n");
+    /* Request to start the bootloader again */
+    pData[0] = RADIO_RESULT_SUCCESS;    /* success */
+    pData[1] = 0;
+    pData[2] = 0;
+    return 3;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdIrrStart
+ *
+ * PURPOSE
+ *      This routine handles the Irrigation Start command sent by the master
+ *      to start irrigation on an expansion unit.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdIrrStart(const radioRxDataPacket_t *pPacket,
+                                     uint64_t expMacID,
+                                     uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+
+    debugWrite("WOIS Cmd: IRRIGATION START\n");
+
+     radioCmdIrrStart = TRUE;             /*denotes that was told to start early */
+
+    /* start irrigation program */
+    switch(pMsg->data[1])
+    {
+        case SYS_STATE_TEST:
+              irrCmdTest();
+              pData[0] = RADIO_RESULT_SUCCESS;    /* success */
+              break;
+        case SYS_STATE_MANUAL:
+              sysManualProgram=pMsg->data[0];
+              sysManualOpMode=pMsg->data[2];
+              sysManualPulseMode=pMsg->data[3];
+              irrCmdManualStart();
+              pData[0] = RADIO_RESULT_SUCCESS;    /* success */
+              break;
+        case SYS_STATE_FORCE:
+            irrCmdForceOn();
+            pData[0] = RADIO_RESULT_SUCCESS;    /* success */
+            break;
+        default:
+            if(irrCmdExpPulseOn(pMsg->data[0]))
+            {
+                pData[0] = RADIO_RESULT_SUCCESS;    /* success */
+            }
+            else
+            {
+                pData[0] = RADIO_RESULT_FAILURE;    /* failure */
+            }
+            break;
+    }
+    return 1;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdIrrComplete
+ *
+ * PURPOSE
+ *      This routine handles the Irrigation Complete command sent by an
+ *      expansion unit to the master.  The master passes the baton to the
+ *      next expansion unit, or releases control if it was the last.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdIrrComplete(const radioRxDataPacket_t *pPacket,
+                                        uint64_t expMacID,
+                                        uint8_t *pData)
+{
+    debugWrite("Expansion Cmd: IRRIGATION COMPLETE\n");
+
+    /*check to see if other expansion units to send to */
+     if((config.sys.unitType == UNIT_TYPE_MASTER) && (config.sys.numUnits > 0))
+     {
+
+         if((expMacID == config.sys.expMac1)&&(config.sys.numUnits > 1)&&
+            (config.sys.expMac2 != 0x0013A20000000000))
+         {
+            /* pass batan to expansion 2 */
+             expansionBusSendCmd(RADIO_CMD_IRR_START,config.sys.expMac2);
+             irrCurUnitRunning = UNIT_TYPE_EXPANSION_2;
+         }
+         else if((expMacID == config.sys.expMac2)&&(config.sys.numUnits ==3)&&
+                    (config.sys.expMac3 != 0x0013A20000000000))
+         {
+            /* pass batan to expansion 3 */
+             expansionBusSendCmd(RADIO_CMD_IRR_START,config.sys.expMac3);
+             irrCurUnitRunning = UNIT_TYPE_EXPANSION_3;
+         }
+         else
+         {
+             /* release control variable */
+             irrExpRunningProg = IRR_PGM_NONE;
+             sysState = SYS_STATE_IDLE;
+             expansionIrrState =IRR_STATE_IDLE;
+             expansionIrrCurZone = 0;
+             irrCurUnitRunning = UNIT_TYPE_MASTER;
+         }
+
+     }
+     return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdExpStatus
+ *
+ * PURPOSE
+ *      This routine handles the Expansion Status command, which relays an
+ *      expansion unit's irrigation state, error and fault flags, moisture
+ *      sensor failures and zone runtimes to the master.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdExpStatus(const radioRxDataPacket_t *pPacket,
+                                      uint64_t expMacID,
+                                      uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    uint16_t tempMoistFailedSensors=0;
+    uint8_t offset=0;
+    int i;
+
+      debugWrite("Expansion Cmd: EXPANSION STATUS\n");
+
+      /*Expansion irrigation state */
+      if(((irrCurUnitRunning == UNIT_TYPE_EXPANSION_1)&&(expMacID == config.sys.expMac1)) ||
+          ((irrCurUnitRunning == UNIT_TYPE_EXPANSION_2)&&(expMacID == config.sys.expMac2))||
+          ((irrCurUnitRunning == UNIT_TYPE_EXPANSION_3)&&(expMacID == config.sys.expMac3))                  )
+      {
+          /* take care of case where an expansion unit loses comm for a brief period of time
+           * less than the timeout detection and comes back. for example a power glitch
+           */
+          if((pMsg->data[0] == 0) && (pMsg->data[1] == 0) &&
+             (sysState != SYS_STATE_AUTORUN)&&(sysState != SYS_STATE_IDLE))
+          {
+             /* release control variable */
+             irrExpRunningProg = IRR_PGM_NONE;
+             sysState = SYS_STATE_IDLE;
+             expansionIrrState =IRR_STATE_IDLE;
+             expansionIrrCurZone = 0;
+             irrCurUnitRunning = UNIT_TYPE_MASTER;
+          }
+          else
+          {
+              expansionSysState=pMsg->data[0];
+              expansionIrrState =pMsg->data[1];
+              expansionIrrCurZone =pMsg->data[2];
+          }
+      }
+      else if((irrCurUnitRunning == UNIT_TYPE_MASTER)&&(pMsg->data[2] != 0))
+      {
+          expansionSysState=pMsg->data[0];
+          expansionIrrState =pMsg->data[1];
+          expansionIrrCurZone =pMsg->data[2];
+      }
+
+      /* Expansion System Error Flags */
+      expansionSysErrorFlags = U8TOU16(pMsg->data[3],
+                                       pMsg->data[4]);
+      /* Expansion System Fault Flags */
+      expansionSysFaultFlags = U8TOU32(pMsg->data[5],
+                                       pMsg->data[6],
+                                       pMsg->data[7],
+                                       pMsg->data[8]);
+
+      /* update list with moisture sensor failures and runtimes from other units */
+      if(config.sys.unitType == UNIT_TYPE_MASTER)
+      {
+          /* moisture sensor zone failures */
+          tempMoistFailedSensors = U8TOU16(pMsg->data[9],pMsg->data[10]);
+          if(expMacID == config.sys.expMac1)
+            {
+                  offset = 13;
+            }
+            else if(expMacID == config.sys.expMac2)
+            {
+                  offset = 25;
+            }
+            else if(expMacID == config.sys.expMac3)
+            {
+                  offset = 37;
+            }
+
+            for(i=0; i<SYS_N_UNIT_ZONES; i++)
+            {
+                if((tempMoistFailedSensors&(((uint16_t)1)<<i)) != 0)
+                {
+                    moistFailureSet(i+offset);
+                }
+                else
+                {
+                    moistFailureClear(i+offset);
+                }
+
+                /*update per zone runtimes */
+                irrDailyRuntimePerZone[i+offset-1] = U8TOU16(pMsg->data[2*i+11],pMsg->data[2*i+12]);
+            }
+      }
+
+      /* if expansion unit state is idle and is the last unit then have master go to idle*/
+      if(expansionSysState == SYS_STATE_IDLE)
+      {
+
+          if(((config.sys.numUnits == 1)&&(expMacID == config.sys.expMac1)) ||
+             ((config.sys.numUnits == 2)&&(expMacID == config.sys.expMac2)) ||
+             ((config.sys.numUnits == 3)&&(expMacID == config.sys.expMac3)))
+          {
+             /* release control variable */
+             irrExpRunningProg = IRR_PGM_NONE;
+             sysState = SYS_STATE_IDLE;
+             expansionIrrState =IRR_STATE_IDLE;
+             expansionIrrCurZone = 0;
+          }
+      }
+      return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdIrrStop
+ *
+ * PURPOSE
+ *      This routine handles the Irrigation Stop command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdIrrStop(const radioRxDataPacket_t *pPacket,
+                                    uint64_t expMacID,
+                                    uint8_t *pData)
+{
+    debugWrite("Expansion Cmd: IRRIGATION STOP\n");
+    irrCmdStop();
+    /* release control variables */
+    irrExpRunningProg = IRR_PGM_NONE;
+    sysState = SYS_STATE_IDLE;
+    expansionIrrState =IRR_STATE_IDLE;
+    expansionIrrCurZone = 0;
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdIrrResume
+ *
+ * PURPOSE
+ *      This routine handles the Irrigation Resume command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdIrrResume(const radioRxDataPacket_t *pPacket,
+                                      uint64_t expMacID,
+                                      uint8_t *pData)
+{
+    debugWrite("Expansion Cmd: IRRIGATION RESUME\n");
+    sysResume();
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdIrrSkip
+ *
+ * PURPOSE
+ *      This routine handles the Irrigation Skip command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdIrrSkip(const radioRxDataPacket_t *pPacket,
+                                    uint64_t expMacID,
+                                    uint8_t *pData)
+{
+    debugWrite("Expansion Cmd: IRRIGATION SKIP\n");
+    irrCmdSkip();
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdIrrOff
+ *
+ * PURPOSE
+ *      This routine handles the Irrigation Off command, which stops any
+ *      irrigation and sets the system Off.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdIrrOff(const radioRxDataPacket_t *pPacket,
+                                   uint64_t expMacID,
+                                   uint8_t *pData)
+{
+    debugWrite("Expansion Cmd: IRRIGATION OFF\n");
+    /* Clear any pending auto programs. */
+    irrAutoPgmPending = IRR_PGM_NONE;
+
+    /* Stop any irrigation. */
+    irrCmdStop();
+
+    /* Set the system Off. */
+    sysIsAuto = FALSE;
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdIrrAuto
+ *
+ * PURPOSE
+ *      This routine handles the Irrigation Auto command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdIrrAuto(const radioRxDataPacket_t *pPacket,
+                                    uint64_t expMacID,
+                                    uint8_t *pData)
+{
+    /* Set the system state to Auto. */
+    sysIsAuto = TRUE;
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdIrrStopOff
+ *
+ * PURPOSE
+ *      This routine handles the Irrigation Stop Off command.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdIrrStopOff(const radioRxDataPacket_t *pPacket,
+                                       uint64_t expMacID,
+                                       uint8_t *pData)
+{
+    debugWrite("Expansion Cmd: IRRIGATION STOP OFF\n");
+    irrStop = FALSE;
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdDeleteSc
+ *
+ * PURPOSE
+ *      This routine handles the Delete SC command sent by the master to
+ *      have an expansion unit de-associate a sensor concentrator.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdDeleteSc(const radioRxDataPacket_t *pPacket,
+                                     uint64_t expMacID,
+                                     uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+
+    debugWrite("Expansion Cmd: Delete an SC\n");
+    if (pMsg->data[0] < MAX_NUM_SC)
+    {
+        scDeleteList[pMsg->data[0]]=TRUE;
+    }
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdScRemoved
+ *
+ * PURPOSE
+ *      This routine handles the SC Is Removed command sent by an expansion
+ *      unit when it has de-associated a sensor concentrator.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdScRemoved(const radioRxDataPacket_t *pPacket,
+                                      uint64_t expMacID,
+                                      uint8_t *pData)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+
+    debugWrite("Expansion Cmd: SC Deleted\n");
+    if (pMsg->data[0] < MAX_NUM_SC)
+    {
+        radioRemoveSensorAssocList(config.sys.assocSensorCon[pMsg->data[0]].macId);
+    }
+    return 0;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdExpGetConfig
+ *
+ * PURPOSE
+ *      This routine handles the Get Config command sent by an expansion unit
+ *      to request the configuration from the master.
+ *
+ * PARAMETERS / RETURN VALUE
+ *      See radioProtoCmdFunc_t.
+ *
+ *****************************************************************************/
+static uint8_t radioProtoCmdExpGetConfig(const radioRxDataPacket_t *pPacket,
+                                         uint64_t expMacID,
+                                         uint8_t *pData)
+{
+    debugWrite("Expansion Cmd: Requested Configuration\n");
+    if(config.sys.unitType == UNIT_TYPE_MASTER)
+    {
+         expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, expMacID);
+    }
+    return 0;
+}
+
+/******************************************************************************
+ *
+ * radioProtocolSCAssocHandler
+ *
+ * PURPOSE
+ *      This routine handles received Association Messages from the 
+ *      sensor concentrator.
+ *
+ * PARAMETERS
+ *      pPacket     IN  pointer to start of packet
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ *****************************************************************************/
+static void    radioProtocolSCAssocHandler(const radioRxDataPacket_t *pPacket) 
+{
+    radioMsgHeader_t *pMsg = (radioMsgHeader_t *)&pPacket->data[0];
+    packetSCAckData_t AckPacket;
+    uint8_t sensorIndex=MAX_NUM_SC;
+    char pBuf[40];
+    
+    
+    //assocflag++;
+    // fill with default values as safeguard
+    radioProtocolFillAckDefaults(&AckPacket);
+
+    /* get the source address */
+    uint64_t sensorMacID = U8TOU64(pPacket->phyAddr[0],
+                             pPacket->phyAddr[1],
+                             pPacket->phyAddr[2],
+                             pPacket->phyAddr[3],
+                             pPacket->phyAddr[4],
+                             pPacket->phyAddr[5],
+                             pPacket->phyAddr[6],
+                             pPacket->phyAddr[7]);
+                             
+    /* check to see if Sensor Concentrator is associated or been accepted to be associated
+     * if it isnt, but it into temporary storage and notify the sensor concentrator UI that 
+     * an sensor concentrator is trying to associate 
+     */
+    sensorIndex=radioCheckSensorAssocList(sensorMacID);
+    if(sensorIndex == MAX_NUM_SC) 
+    {     
+        if((associateSCMode == TRUE) && (newSensorConcenFound == FALSE))
+        {
+            unassociatedSnsConMacId = sensorMacID;
+            newSensorConcenFound = TRUE;
+            uiNotify(UI_DEP_RADIO);
+        }
+    }
+    else
+    {
+        /* FOR six associate retry, then RESET */
+        if (assocFlag[sensorIndex] == TRUE)
+            assocCnt[sensorIndex]++;
+        else
+            assocCnt[sensorIndex] = 0;
+        
+        //cnt2 = assocCnt[sensorIndex]; 
+        if (assocCnt[sensorIndex] == 6) {
+            assocFlag[sensorIndex] = FALSE;
+            assocCnt[sensorIndex] = 0;
+            radioReset();
+        } 
+        
+        
+        /* put message into radio log*/
+        //radioMessageLog("SC Associate Message");
+        
+        sprintf(pBuf,"SC Assoc Msg %08X",(uint32_t)(sensorMacID & 0xFFFFFFFF));
+        radioMessageLog(pBuf);
+    
+        /*build ACK packet*/
+        
+        /* schedule next check-in from the irrigation plan */
+        AckPacket.sleepTime = radioSnsConSleepTimeGet(sensorIndex);
+        
+        AckPacket.command = SC_ASSOCIATE;
+        
+        /*send MAC address off WO that is in control of it */
+        
+        switch(config.sys.assocSensorCon[sensorIndex].zoneRange)
+        {             
+            case UNIT_TYPE_MASTER:
+                if(config.sys.unitType == UNIT_TYPE_MASTER)
+                {
+                    AckPacket.controlMacId = radioMacId;
+                }
+                else
+                {
+                    AckPacket.controlMacId = config.sys.masterMac;
+                }
+                break;
+            case UNIT_TYPE_EXPANSION_1:
+                AckPacket.controlMacId = config.sys.expMac1;
+                break;
+            case UNIT_TYPE_EXPANSION_2:
+                AckPacket.controlMacId = config.sys.expMac2;
+                break;
+            case UNIT_TYPE_EXPANSION_3:
+                AckPacket.controlMacId = config.sys.expMac3;
+                break;
+        } 
+        //AckPacket.controlMacId = 0xFFFF;
+        AckPacket.hibTemp =SC_HIBERNATE_TEMP_C;          /*hardcoded default values stored in config,h*/
+        AckPacket.hibThresTime =SC_HIBERNATE_THRES_TIME; /*hardcoded default values stored in config,h*/
+        AckPacket.solenoidState = SC_ALL_CHAN_OFF;       /* all solenoids turned off, defined in config.h */
+    
+        /* Send acknowledgement packet. */
+        radioProtocolRespSend(pPacket, &AckPacket, RADIO_TYPE_SC_STATUS,sizeof(packetSCAckData_t));
+        //assocack++;
+        
+        
+    }
+    
+    /* Yield control back to the system main polling loop. */
+    radioYield = TRUE;
+}
+
+ 
+/******************************************************************************
+ *
+ * ConvertZone
+ *
+ * PURPOSE
+ *      Convert the zone from a bitmapped to an index
+ *
+ * PARAMETERS
+ *      bitZone     the current zone in bitmap form, 0100 is valve 3
+ *
+ * RETURN VALUE
+ *      the current zone in ordinal form, 0100 is valve 4.
+ *
+ *****************************************************************************/
+uint8_t ConvertZone(uint8_t bitZone)
+{
+  uint8_t ret = 0;
+  
+  //no way to prevent user from passing in bad values
+
+  switch(bitZone)
+  {
+  case SC_CHAN_1_ON:
+    ret = 0;
+    break;
+  case SC_CHAN_2_ON:
+    ret = 1;
+    break;
+  case SC_CHAN_3_ON:
+    ret = 2;
+    break;
+  case SC_CHAN_4_ON:
+    ret = 3;
+    break;
+  }
+  return ret;
+}
+
+/******************************************************************************
+ *
+ * radioProtocolSCStatusHandler
+ *
+ * PURPOSE
+ *      This routine handles received status packets of sensor information
+ *      from the sensor concentrator.
+ *
+ * NOTES
+ *      When an SC checks in we have two primary tasks to carry out:
+ * 
+ *      1) Update internal data structures with information reported
+ *         from the SC
+ *
+ *      2) Push some pieces of state to the SC which tells it how to
+ *         operate.
+ * 
+ *      At any given time there can be a single SC whose state differs
+ *      from the status quo.  Basically, one SC whose solenoid will
+ *      be instructed to turn on.  For all other SCs, they should be
+ *      instructed to be off.  The "current" SC is driven by the zone
+ *      logic from irrigation.c
+ *
+ * PARAMETERS
+ *      pPacket     IN  pointer to start of packet
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ *****************************************************************************/
+static void    radioProtocolSCStatusHandler(const radioRxDataPacket_t *pPacket)
+{
+    packetSCStatus_t *pMsg = (packetSCStatus_t *)&pPacket->data[0];
+    uint16_t crc;
+    uint16_t crcMsg;
+    packetSCAckData_t AckPacket;
+    uint8_t sensorIndex=MAX_NUM_SC;
+    uint8_t i;
+    uint8_t unitTypeZoneOffset;    
+    uint8_t sensorZone;
+    char pBuf[40];
+    
+    //statusflag++;
+    
+    /* fill with defaults */
+    radioProtocolFillAckDefaults(&AckPacket);
+
+     /* Compute the CRC. */
+    crc = crc16(((uint8_t *)pMsg) + 4,
+                     RADIO_SC_STATUS_HEADER_SIZE - 4);
+
+    /* Verify the CRC in the command message. */
+    crcMsg = (pMsg->hdr.crcHigh << 8) | pMsg->hdr.crcLow;
+    if (crcMsg != crc)
+    {
+        /* Ignore this packet. */
+        return;
+    }
+    
+    /* get the source address */
+    uint64_t sensorMacID = U8TOU64(pPacket->phyAddr[0],
+                             pPacket->phyAddr[1],
+                             pPacket->phyAddr[2],
+                             pPacket->phyAddr[3],
+                             pPacket->phyAddr[4],
+                             pPacket->phyAddr[5],
+                             pPacket->phyAddr[6],
+                             pPacket->phyAddr[7]);
+                             
+    /* check to see if MAC is in list and if it isnt tell it to deassociate */
+    sensorIndex=radioCheckSensorAssocList(sensorMacID);
+    
+    if((sensorIndex != MAX_NUM_SC)  && (scDeleteList[sensorIndex] == FALSE)) 
+    {    
+    
+        /*  indicate this hub already associated this controller */
+        assocFlag[sensorIndex] = TRUE;
+         
+        /* make sure that it is associated with this unit */
+        if(config.sys.assocSensorCon[sensorIndex].zoneRange == config.sys.unitType)
+        {
+            /* parse the data packet for the values */
+            
+            /* system state values */
+            snsConInfo[sensorIndex].chargeRate = pMsg->chargeRate;
+            snsConInfo[sensorIndex].battVoltage = (pMsg->battVoltage);
+            snsConInfo[sensorIndex].solenoidState = pMsg->solenoidState;
+            
+            /* Setup response as if this is a normal unit */
+            AckPacket.solenoidState = SC_ALL_CHAN_OFF;
+
+            /* Check if this SC is the one that the irrigation logic
+             * would like to modify state on.
+             */
+             
+            if(irrSnsConSolUnitIndex == sensorIndex)
+            {
+                /* clear timeout flag */ 
+                sysFaultClear(SYS_FAULT_SNSCON);
+                
+                /* Tell SC to use solenoid state from irrigation logic */
+                AckPacket.solenoidState = irrSnsConSolenoidChan;
+                
+                if(irrSnsConSolenoidChan != SC_ALL_CHAN_OFF)
+                {
+                        uint8_t currentZone = config.sys.assocSensorCon[sensorIndex].channelZone[ConvertZone(irrSnsConSolenoidChan)];
+                        
+                        drvSolenoidSet(currentZone + 1, TRUE);
+                        
+                }
+                
+                if(sysIsInhibited && sysInhibitStop)
+                {          
+                    sysIsInhibited = FALSE;
+                    sysInhibitStop = FALSE;
+                    sysInhibitOffTime = dtTickCount;
+                }
+                
+                //KAV update timeout since the SC for this zone has checked in
+                radioSnsConCheckinTime = dtTickCount;
+                
+                /* release system from soak into water since SC checked in */
+                scCheckedIn = TRUE;
+                sysResume();
+            }
+
+            
+            /*set zone offset to account for expansion bus */
+            switch(config.sys.unitType)
+            {
+                case UNIT_TYPE_MASTER:
+                    unitTypeZoneOffset = 0;
+                    break;
+                case UNIT_TYPE_EXPANSION_1:
+                    unitTypeZoneOffset = 12;
+                    break;  
+                case UNIT_TYPE_EXPANSION_2:
+                    unitTypeZoneOffset = 24;
+                    break;
+                case UNIT_TYPE_EXPANSION_3:
+                    unitTypeZoneOffset = 36;
+                    break;
+            }
+            
+            /* set moisture values for respective zones */
+            for(i=0; i<SC_NUM_CHAN_UNIT; i++)
+            {
+                
+                sensorZone = config.sys.assocSensorCon[sensorIndex].channelZone[i];
+                
+                /*verify that channel is assigned to a valid zone before proceeding */
+                if(sensorZone != SC_CHAN_NOT_ASSIGNED) 
+                {
+                    /*apply offset to account for expansion bus */
+                    sensorZone -= unitTypeZoneOffset;
+                    
+                    /* verify that zone is configured to be a wireless sensor */     
+                    if(config.zone[sensorZone].sensorType == SNS_WIRELESS_MOIST)
+                    {
+                        drvMoistValueSet(sensorZone+1,(uint8_t)pMsg->sensor_chan[i]);
+                    }
+                }
+            }
+            
+            /*put message into radio log */
+            //radioMessageLog("SC Status Message");
+            sprintf(pBuf,"SC Status Msg %08X",(uint32_t)(sensorMacID & 0xFFFFFFFF));
+            radioMessageLog(pBuf);
+    
+            /* build ACK packet */
+            AckPacket.command = SC_ASSOCIATE;
+            
+            /* set controller mac id */
+            switch(config.sys.assocSensorCon[sensorIndex].zoneRange)
+            {             
+                case UNIT_TYPE_MASTER:
+                    if(config.sys.unitType == UNIT_TYPE_MASTER)
+                    {
+                        AckPacket.controlMacId = radioMacId;
+                    }
+                    else
+                    {
+                        AckPacket.controlMacId = config.sys.masterMac;
+                    }
+                    break;
+                case UNIT_TYPE_EXPANSION_1:
+                    AckPacket.controlMacId = config.sys.expMac1;
+                    break;
+                case UNIT_TYPE_EXPANSION_2:
+                    AckPacket.controlMacId = config.sys.expMac2;
+                    break;
+                case UNIT_TYPE_EXPANSION_3:
+                    AckPacket.controlMacId = config.sys.expMac3;
+                    break;
+            }
+        }
+    }
+    else //sc needs to be deleted
+    {
+      /* if in the list but commanded to delete then do so */
+      if(scDeleteList[sensorIndex] == TRUE)
+      {
+          scDeleteIndex=sensorIndex;
+          expansionBusSendCmd(RADIO_CMD_SC_IS_REMOVED, config.sys.masterMac);
+          radioRemoveSensorAssocList(sensorMacID);
+           
+      }
+      
+      /* build NACK packet */
+      AckPacket.command = SC_DEASSOCIATE;
+      AckPacket.controlMacId = 0;
+      AckPacket.solenoidState = SC_ALL_CHAN_OFF;       /* all solenoids turned off, defined in config.h */
+    }
+
+      
+    //do this for all SCs even if we are deleting them  
+      
+    /*check to see if unit is in irrigation mode */
+    if((sysState != SYS_STATE_IDLE) || (expansionSysState != SYS_STATE_IDLE ))
+    {
+        if(sysIsInhibited || sysIsPaused)
+        {
+            // Turn off the wireless and wired solenoid if we are paused or inhibited
+            AckPacket.solenoidState = SC_ALL_CHAN_OFF;
+            
+            
+            if(irrSnsConSolenoidChan != SC_ALL_CHAN_OFF)
+            {
+                drvSolenoidSet(config.sys.assocSensorCon[sensorIndex].channelZone[ConvertZone(irrSnsConSolenoidChan)]+1, FALSE);
+            }
+        }
+
+    } 
+
+    /* schedule next check-in from the irrigation plan */
+    AckPacket.sleepTime = radioSnsConSleepTimeGet(sensorIndex);
+
+    AckPacket.hibTemp = SC_HIBERNATE_TEMP_C;            /*hardcoded default values stored in config,h*/
+    AckPacket.hibThresTime = SC_HIBERNATE_THRES_TIME;    /*hardcoded default values stored in config,h*/
+                                                           
+    /* Send acknowledgement packet. */
+    radioProtocolRespSend(pPacket, &AckPacket, RADIO_TYPE_SC_STATUS,sizeof(packetSCAckData_t));
+    //statusack++;
+    /* Yield control back to the system main polling loop. */
+    radioYield = TRUE;
+}
+
+
+
+/******************************************************************************
+ *
+ * radioRemoveSensorAssocHandler
+ *
+ * PURPOSE
+ *      This routine handles received status packets of sensor information
+ *      from the sensor concentrator.
+ *
+ * PARAMETERS
+ *      sensorMAC     IN  MAC of sensor concentrator to remove
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ *****************************************************************************/
+void radioRemoveSensorAssocHandler(uint64_t sensorMAC)
+{
+   packetSCAckData_t AckPacket;
+   uint8_t sensorIndex = radioRemoveSensorAssocList(sensorMAC);
+   uint16_t length = sizeof(packetSCAckData_t);
+   
+   // fill ack with default values
+   radioProtocolFillAckDefaults(&AckPacket);
+   
+   if(sensorIndex != MAX_NUM_SC)
+   {
+        //build ACK packet
+        AckPacket.sleepTime = 5;
+        AckPacket.command = SC_DEASSOCIATE;
+        AckPacket.controlMacId = 0;
+        
+        /* Send acknowledgement packet. */
+        radioMsgHeader_t *pHdr = (radioMsgHeader_t *)(&AckPacket);
+        uint32_t destH = ((sensorMAC >> 32)&0x00000000FFFFFFFF);
+        uint32_t destL = (sensorMAC &0x00000000FFFFFFFF);
+        uint16_t destN = 0xFFFE;
+
+        pHdr->version = RADIO_PROTOCOL_VER;
+        pHdr->msgType = RADIO_TYPE_SC_STATUS;
+        radioMsgInsertCrc(pHdr, length);
+        radioDataSend(radioDataFrameId(),
+                  destN,
+                  destH,
+                  destL,
+                  ((uint8_t *)&AckPacket),
+                  length);
+   }
+   
+   /* Yield control back to the system main polling loop. */
+    radioYield = TRUE;     
+}
+
+
+/******************************************************************************
+ *
+ * radioProtocolXferHandler
+ *
+ * PURPOSE
+ *      This routine handles received WaterOptimizer bulk data transfer
+ *      packets.
+ *
+ * PARAMETERS
+ *      pPacket     IN  pointer to start of packet
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ *****************************************************************************/
+static void radioProtocolXferHandler(const radioRxDataPacket_t *pPacket)
+{
+    radioMsgXfer_t *pMsg = (radioMsgXfer_t *)&pPacket->data[0];
+    radioMsgXfer_t *pResp;
+    uint8_t pkt;
+    uint16_t crc;
+    uint16_t crcMsg;
+    uint32_t i;
+    //uint16_t segmentIndex;
+        /* rebuild the MAC of the source of the packet */
+    uint64_t expUnitMacID;
+    uint8_t stat;
+    uint32_t msStart = drvMSGet();
+    
+
+
+    /* Compute the CRC. */
+    crc = crc16(((uint8_t *)pMsg) + 4,
+                     RADIO_XFER_HEADER_SIZE - 4 + pMsg->dataLen);
+
+    /* Verify the CRC in the received message. */
+    crcMsg = (pMsg->hdr.crcHigh << 8) | pMsg->hdr.crcLow;
+    if (crcMsg != crc)
+    {
+        if (radioDebug)
+        {
+            debugTrace(DEBUG_TRACE_RADIO_XFER_CRC, crcMsg, crc, 0, 0);
+        }
+        /* Ignore this packet. */
+        return;
+    }
+
+    if (radioDebug)
+    {
+        debugTrace(DEBUG_TRACE_RADIO_XFER, pMsg->xferMode,
+                   (pMsg->segHigh << 8) | pMsg->segLow, pMsg->dataLen, 0);
+    }
+    /*
+    **  Build the response directly in a packet buffer.  Without a buffer
+    **  the request is dropped for the sender to retry, except for a delta
+    **  segment, which is not acknowledged.
+    */
+    pkt = radioPktAlloc();
+    if (pkt == RADIO_PKT_NONE)
+    {
+        if (pMsg->xferMode != (RADIO_XMODE_CONFIG | RADIO_XMODE_DELTA_PUT))
+        {
+            return;
+        }
+        pResp = NULL;
+    }
+    else
+    {
+        pResp = (radioMsgXfer_t *)radioPktData(pkt);
+    }
+
+    stat = radioProtoStatRx(pPacket,
+                            RADIO_PSTAT_XFER,
+                            pMsg->xferMode & 0xF0,
+                            crc);
+
+    /* Handle according to the transfer mode. */
+    switch (pMsg->xferMode)
+    {
+        case RADIO_XMODE_CONFIG | RADIO_XMODE_GET_REQ:
+            radioMessageLog("Get Cfg Segment");
+            /* Get requested segment index from message header. */
+            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
+            pResp->xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_GET_ACK;
+            /* Set segment index in response header. */
+            pResp->segHigh = pMsg->segHigh;
+            pResp->segLow = pMsg->segLow;
+            /* Verify segment index is within range. */
+            if (segmentIndex < RADIO_CFG_SEGS)
+            {
+                /* Send the requested snapshot segment. */
+                i = segmentIndex * RADIO_MAXSEGMENT;
+                nBytes = CONFIG_IMAGE_SIZE - i;
+                if (nBytes > RADIO_MAXSEGMENT)
+                {
+                    nBytes = RADIO_MAXSEGMENT;
+                }
+                configSnapshotRead(i, pResp->data, nBytes);
+                pResp->dataLen = (uint8_t)nBytes;
+            }
+            else
+            {
+                /* Invalid segment index - send ack with no data. */
+                pResp->dataLen = 0;
+            }
+            break;
+
+        case RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_REQ:
+            radioMessageLog("Put Cfg Segment");
+            /* Get segment index from message header. */
+            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
+            pResp->dataLen = 0;
+            /* Set segment index in response header. */
+            pResp->segHigh = pMsg->segHigh;
+            pResp->segLow = pMsg->segLow;
+            /* Verify segment index is within range. */
+            if (segmentIndex < RADIO_CFG_SEGS)
+            {
+                /* Compute image offset and size of this download segment. */
+                i = segmentIndex * RADIO_MAXSEGMENT;
+                nBytes = CONFIG_IMAGE_SIZE - i;
+                if (nBytes > RADIO_MAXSEGMENT)
+                {
+                    nBytes = RADIO_MAXSEGMENT;
+                }
+                if (pMsg->dataLen != nBytes)
+                {
+                    /* Incorrect data length. */
+                    debugWrite("ERROR: Bad put config segment data length.\n");
+                    pResp->xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_NACK;
+                }
+                else
+                {
+                    configBufferWrite(&pMsg->data, i, nBytes);
+                    pResp->xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_ACK;
+                    if (configBufferError() != -1)
+                    {
+                        /* Image is invalid - NACK with offset of bad field. */
+                        debugWrite("ERROR: Invalid config image field.\n");
+                        crc = (uint16_t)configBufferError();
+                        pResp->data[0] = (uint8_t)(crc >> 8);
+                        pResp->data[1] = (uint8_t)(crc & 0xFF);
+                        pResp->dataLen = 2;
+                        pResp->xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_NACK;
+                    }
+                }
+            }
+            else
+            {
+                /* Invalid segment index. */
+                pResp->xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_NACK;
+            }
+            break;
+        
+        /*
+        **  CONFIG IMAGE, RLE ENCODED:  Upload from Config Snapshot
+        **
+        **  Segments must be requested in order starting at 0 (the previous
+        **  segment may be requested again).  A segment with no data marks
+        **  the end of the image.  See configSnapshotRleEncode().
+        */
+        case RADIO_XMODE_CONFIG_RLE | RADIO_XMODE_GET_REQ:
+            radioMessageLog("Get Cfg RLE Segment");
+            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
+            pResp->xferMode = RADIO_XMODE_CONFIG_RLE | RADIO_XMODE_GET_ACK;
+            pResp->segHigh = pMsg->segHigh;
+            pResp->segLow = pMsg->segLow;
+            pResp->dataLen = 0;
+            if (segmentIndex == 0)
+            {
+                radioCfgRleGetOffset = 0;
+            }
+            else if (segmentIndex == radioCfgRleGetSeg - 1)
+            {
+                radioCfgRleGetOffset = radioCfgRleGetPrev;
+            }
+            else if (segmentIndex != radioCfgRleGetSeg)
+            {
+                /* Out of sequence. */
+                pResp->xferMode = RADIO_XMODE_CONFIG_RLE | RADIO_XMODE_GET_NACK;
+                break;
+            }
+            radioCfgRleGetPrev = radioCfgRleGetOffset;
+            radioCfgRleGetSeg = segmentIndex + 1;
+            pResp->dataLen = configSnapshotRleEncode(&radioCfgRleGetOffset,
+                                                   pResp->data,
+                                                   RADIO_MAXSEGMENT);
+            break;
+
+        /*
+        **  CONFIG IMAGE, RLE ENCODED:  Download to Config Buffer
+        **
+        **  Segments must be sent in order starting at 0; a repeat of the
+        **  previous segment is acknowledged without being written again.
+        **  The image is applied with RADIO_CMD_CFG_PUT_APPLY as usual.
+        */
+        case RADIO_XMODE_CONFIG_RLE | RADIO_XMODE_PUT_REQ:
+            radioMessageLog("Put Cfg RLE Segment");
+            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
+            pResp->xferMode = RADIO_XMODE_CONFIG_RLE | RADIO_XMODE_PUT_NACK;
+            pResp->segHigh = pMsg->segHigh;
+            pResp->segLow = pMsg->segLow;
+            pResp->dataLen = 0;
+            if (segmentIndex == 0)
+            {
+                radioCfgRlePutSeg = 0;
+                radioCfgRlePutOffset = 0;
+            }
+            if ((segmentIndex == radioCfgRlePutSeg - 1) && (segmentIndex != 0))
+            {
+                /* Repeated segment - already written. */
+                pResp->xferMode = RADIO_XMODE_CONFIG_RLE | RADIO_XMODE_PUT_ACK;
+            }
+            else if ((segmentIndex == radioCfgRlePutSeg) &&
+                     (pMsg->dataLen <= RADIO_MAXSEGMENT) &&
+                     configBufferRleWrite(pMsg->data,
+                                          pMsg->dataLen,
+                                          &radioCfgRlePutOffset))
+            {
+                radioCfgRlePutSeg = segmentIndex + 1;
+                pResp->xferMode = RADIO_XMODE_CONFIG_RLE | RADIO_XMODE_PUT_ACK;
+                if (configBufferError() != -1)
+                {
+                    /* Image is invalid - NACK with offset of bad field. */
+                    debugWrite("ERROR: Invalid config image field.\n");
+                    crc = (uint16_t)configBufferError();
+                    pResp->data[0] = (uint8_t)(crc >> 8);
+                    pResp->data[1] = (uint8_t)(crc & 0xFF);
+                    pResp->dataLen = 2;
+                    pResp->xferMode = RADIO_XMODE_CONFIG_RLE | RADIO_XMODE_PUT_NACK;
+                }
+            }
+            else
+            {
+                debugWrite("ERROR: Bad put config RLE segment.\n");
+            }
+            break;
+
+        /*
+        **  EXPANSION BUS:  Master sending config file to expansion units ACK
+        */
+        case RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_ACK:
+            radioMessageLog("Expan Cfg Seg ACK");
+            /* Get requested segment index from message header. */
+            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
+            segmentIndex++;
+            pResp->xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_REQ;
+            /* Set segment index in response header. */
+            pResp->segHigh = (segmentIndex >>8);
+            pResp->segLow = (segmentIndex & 0x00FF);
+            /* Verify segment index is within range. */
+            if (segmentIndex < RADIO_CFG_SEGS)
+            {
+                /* Send the requested snapshot segment. */
+                i = segmentIndex * RADIO_MAXSEGMENT;
+                nBytes = CONFIG_IMAGE_SIZE - i;
+                if (nBytes > RADIO_MAXSEGMENT)
+                {
+                    nBytes = RADIO_MAXSEGMENT;
+                }
+                configSnapshotRead(i, pResp->data, nBytes);
+                pResp->dataLen = (uint8_t)nBytes;
+            }
+            else 
+            {
+               /* issue the command to the expansion unit to apply
+                * the new downloaded configuration */
+                expUnitMacID = U8TOU64(pPacket->phyAddr[0],
+                             pPacket->phyAddr[1],
+                             pPacket->phyAddr[2],
+                             pPacket->phyAddr[3],
+                             pPacket->phyAddr[4],
+                             pPacket->phyAddr[5],
+                             pPacket->phyAddr[6],
+                             pPacket->phyAddr[7]);
+                             
+               radioPktRelease(pkt);
+               expansionBusSendCmd(RADIO_CMD_CFG_PUT_APPLY, expUnitMacID);
+               return; 
+            }
+            break;
+        
+        /*
+        **  EXPANSION BUS:  Master sending config file to expansion units NACK
+        */    
+        case RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_NACK:
+            break; 
+        
+        /*
+        **  EXPANSION BUS:  Delta config segment from master, not acknowledged
+        */
+        case RADIO_XMODE_CONFIG | RADIO_XMODE_DELTA_PUT:
+            radioMessageLog("Delta Cfg Segment");
+            radioPktRelease(pkt);
+            expUnitMacID = U8TOU64(pPacket->phyAddr[0],
+                             pPacket->phyAddr[1],
+                             pPacket->phyAddr[2],
+                             pPacket->phyAddr[3],
+                             pPacket->phyAddr[4],
+                             pPacket->phyAddr[5],
+                             pPacket->phyAddr[6],
+                             pPacket->phyAddr[7]);
+            radioCfgDeltaSegment(pMsg, expUnitMacID);
+            return;
+        
+        /*
+        **  FIRMWARE DOWNLOAD: receiving new firmware from gateway
+        */        
+        case RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_REQ:
+            radioMessageLog("Put FW Segment");
+            /* Get segment index from message header. */
+            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
+            
+            if(segmentIndex ==0)
+            {
+              newFirmwareSize = U8TOU32(pMsg->data[8],pMsg->data[9],
+                                  pMsg->data[10],pMsg->data[11]);
+              magicNum = U8TOU32(pMsg->data[0],pMsg->data[1],
+                                  pMsg->data[2],pMsg->data[3]);
+            }
+
+            pResp->dataLen = 0;
+            /* Set segment index in response header. */
+            pResp->segHigh = pMsg->segHigh;
+            pResp->segLow = pMsg->segLow;
+            
+            
+            /* Verify segment index is within range. */
+            if (segmentIndex < RADIO_FW_SEGS)
+            {
+                /* Compute image offset and size of this download segment. */
+                i = segmentIndex * RADIO_MAXSEGMENT;
+                nBytes = newFirmwareSize + BULK_FW_HDR_SIZE - i;
+                if (nBytes > RADIO_MAXSEGMENT)
+                {
+                    nBytes = RADIO_MAXSEGMENT;
+                }
+                if (pMsg->dataLen != nBytes)
+                {
+                    /* Incorrect data length. */
+                    debugWrite("ERROR: Bad put config segment data length.\n");
+                    pResp->xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_NACK;
+                }
+                else
+                {
+                    if(segmentIndex ==0)
+                    {
+                            //copy off the firmware header to be writtent o external
+                            //flash once all packets have been received
+                            memcpy(ImageData,&pMsg->data, BULK_FW_HDR_SIZE);
+                        
+                            if(drvExtFlashWrite((&pMsg->data[BULK_FW_HDR_SIZE]),EXT_FLASH_SEC_1, (nBytes-BULK_FW_HDR_SIZE))) 
+                            {
+                               pResp->xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_ACK;
+                            }
+                            else 
+                            {
+                               pResp->xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_NACK;
+                               //drvExtFlashRead(EXT_FLASH_SEC_1,spiTest,(nBytes-BULK_FW_HDR_SIZE));
+                            }
+
+                    } 
+                    else
+                    {
+                        if(extFlashBufferWrite(&pMsg->data, (i-BULK_FW_HDR_SIZE), nBytes))
+                        {                      
+                            pResp->xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_ACK;
+                            
+                            //check to see if this is the last packet
+                            //if so then write the firmware header to external flash
+                            if((i-BULK_FW_HDR_SIZE+nBytes)==newFirmwareSize)
+                            {
+                                if(drvExtFlashWrite(ImageData,FW_NEW_INFO_SPI_ADDR,  BULK_FW_HDR_SIZE) == FALSE) 
+                                {
+                                    pResp->xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_NACK;
+                                }
+                                
+                                
+                            }
+                        } 
+                        else 
+                        {
+                            pResp->xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_NACK;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                /* Invalid segment index. */
+                pResp->xferMode = RADIO_XMODE_WOIS_FW | RADIO_XMODE_PUT_NACK;
+            }
+            break;
+            
+        /*
+        **  FLOW SENSOR DATA 24hrs:  Read Access to Raw EEPROM Data
+        */            
+        case RADIO_XMODE_FLOW | RADIO_XMODE_GET_REQ:
+            radioMessageLog("Get Flow Segment");
+            /* Get requested segment index from message header. */
+            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
+            pResp->xferMode = RADIO_XMODE_FLOW | RADIO_XMODE_GET_ACK;
+            /* Set segment index in response header. */
+            pResp->segHigh = pMsg->segHigh;
+            pResp->segLow = pMsg->segLow;
+            /* Verify segment index is within range. */
+            if (segmentIndex < RADIO_FLOW_SEGS)
+            {
+                /* Send the requested snapshot segment. */
+                i = segmentIndex * RADIO_MAXSEGMENT;
+                nBytes = FLOW_DATA_SIZE - i;
+                if (nBytes > RADIO_MAXSEGMENT)
+                {
+                    nBytes = RADIO_MAXSEGMENT;
+                }
+                drvEepromRead(FLOW_SNS_DATA + i, pResp->data, nBytes);
+                pResp->dataLen = (uint8_t)nBytes;
+            }
+            else
+            {
+                /* Invalid segment index - send ack with no data. */
+                pResp->dataLen = 0;
+            }
+            break;
+        
+        /*
+        **  LEVEL SENSOR DATA 24hrs:  Read Access to Raw EEPROM Data
+        */            
+        case RADIO_XMODE_LEVEL | RADIO_XMODE_GET_REQ:
+            radioMessageLog("Get LevelSegment");
+            /* Get requested segment index from message header. */
+            segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
+            pResp->xferMode = RADIO_XMODE_LEVEL | RADIO_XMODE_GET_ACK;
+            /* Set segment index in response header. */
+            pResp->segHigh = pMsg->segHigh;
+            pResp->segLow = pMsg->segLow;
+            /* Verify segment index is within range. */
+            if (segmentIndex < RADIO_LEVEL_SEGS)
+            {
                 /* Send the requested snapshot segment. */
                 i = segmentIndex * RADIO_MAXSEGMENT;
                 nBytes = LEVEL_DATA_SIZE - i;
@@ -3793,13 +6223,13 @@ static void radioProtocolXferHandler(const radioRxDataPacket_t *pPacket)
                 {
                     nBytes = RADIO_MAXSEGMENT;
                 }
-                drvEepromRead(LEVEL_SNS_DATA + i, resp.data, nBytes);
-                resp.dataLen = (uint8_t)nBytes;
+                drvEepromRead(LEVEL_SNS_DATA + i, pResp->data, nBytes);
+                pResp->dataLen = (uint8_t)nBytes;
             }
             else
             {
                 /* Invalid segment index - send ack with no data. */
-                resp.dataLen = 0;
+                pResp->dataLen = 0;
             }
             break;
             
@@ -3809,17 +6239,10 @@ static void radioProtocolXferHandler(const radioRxDataPacket_t *pPacket)
         case RADIO_XMODE_EEPROM | RADIO_XMODE_GET_REQ:
             /* Get requested segment index from message header. */
             segmentIndex = (pMsg->segHigh << 8) | pMsg->segLow;
-            if (radioDebug)
-            {
-                debugWrite("WOIS Xfer Req: GET EEPROM SEGMENT ");
-                sprintf(debugBuf, "%d (address=0x%04X)\n", segmentIndex,
-                    segmentIndex * RADIO_MAXSEGMENT);
-                debugWrite(debugBuf);
-            }
-            resp.xferMode = RADIO_XMODE_EEPROM | RADIO_XMODE_GET_ACK;
+            pResp->xferMode = RADIO_XMODE_EEPROM | RADIO_XMODE_GET_ACK;
             /* Set segment index in response header. */
-            resp.segHigh = pMsg->segHigh;
-            resp.segLow = pMsg->segLow;
+            pResp->segHigh = pMsg->segHigh;
+            pResp->segLow = pMsg->segLow;
             /* Verify segment index is within range. */
             if (segmentIndex < RADIO_EEPROM_SEGS)
             {
@@ -3830,504 +6253,1145 @@ static void radioProtocolXferHandler(const radioRxDataPacket_t *pPacket)
                 {
                     nBytes = RADIO_MAXSEGMENT;
                 }
-                drvEepromRead(i, resp.data, nBytes);
-                resp.dataLen = (uint8_t)nBytes;
+                drvEepromRead(i, pResp->data, nBytes);
+                pResp->dataLen = (uint8_t)nBytes;
             }
             else
             {
                 /* Invalid segment index - send ack with no data. */
-                resp.dataLen = 0;
+                pResp->dataLen = 0;
+            }
+            break;
+
+        /*
+        **  SYSTEM EVENT JOURNAL:  Read Entries by Sequence Number
+        **
+        **  The request data holds the first sequence number wanted (4 bytes).
+        **  The ack returns up to one segment of journal entries starting at
+        **  that sequence number (or the oldest entry kept, if later), or no
+        **  data if there are no newer entries.
+        */
+        case RADIO_XMODE_JOURNAL | RADIO_XMODE_GET_REQ:
+            radioMessageLog("Get Event Journal");
+            pResp->xferMode = RADIO_XMODE_JOURNAL | RADIO_XMODE_GET_ACK;
+            pResp->segHigh = pMsg->segHigh;
+            pResp->segLow = pMsg->segLow;
+            pResp->dataLen = 0;
+            if (pMsg->dataLen >= 4)
+            {
+                pResp->dataLen = (uint8_t)(sizeof(sysJournalEntry_t) *
+                    sysJournalRead(U8TOU32(pMsg->data[0], pMsg->data[1],
+                                           pMsg->data[2], pMsg->data[3]),
+                                   (sysJournalEntry_t *)pResp->data,
+                                   RADIO_MAXSEGMENT / sizeof(sysJournalEntry_t)));
+            }
+            break;
+
+        /*
+        **  SYSTEM EVENT JOURNAL QUERY:  Read Filtered Entries
+        **
+        **  Request data:  resume sequence number (4), subsystem mask (1),
+        **  type low (2), type high (2), packed date from (4), date to (4).
+        **  Ack data:  resume sequence number (4), journal next sequence
+        **  number (4), then up to 3 matching journal entries.  The NOC
+        **  repeats the request with the returned resume sequence number
+        **  until it reaches the journal next sequence number.
+        */
+        case RADIO_XMODE_JQUERY | RADIO_XMODE_GET_REQ:
+            radioMessageLog("Query Event Journal");
+            pResp->xferMode = RADIO_XMODE_JQUERY | RADIO_XMODE_GET_ACK;
+            pResp->segHigh = pMsg->segHigh;
+            pResp->segLow = pMsg->segLow;
+            pResp->dataLen = 0;
+            if (pMsg->dataLen >= 17)
+            {
+                sysJournalFilter_t filter;
+                uint32_t seq;
+                uint32_t nextSeq;
+
+                seq = U8TOU32(pMsg->data[0], pMsg->data[1],
+                              pMsg->data[2], pMsg->data[3]);
+                filter.subsysMask = pMsg->data[4];
+                filter.typeLow = U8TOU16(pMsg->data[5], pMsg->data[6]);
+                filter.typeHigh = U8TOU16(pMsg->data[7], pMsg->data[8]);
+                filter.dateFrom = U8TOU32(pMsg->data[9], pMsg->data[10],
+                                          pMsg->data[11], pMsg->data[12]);
+                filter.dateTo = U8TOU32(pMsg->data[13], pMsg->data[14],
+                                        pMsg->data[15], pMsg->data[16]);
+                i = sysJournalQuery(&filter, &seq,
+                                    (sysJournalEntry_t *)&pResp->data[8],
+                                    (RADIO_MAXSEGMENT - 8) / sizeof(sysJournalEntry_t));
+                nextSeq = sysJournalNextSeqGet();
+                pResp->data[0] = (uint8_t)(seq >> 24);
+                pResp->data[1] = (uint8_t)(seq >> 16);
+                pResp->data[2] = (uint8_t)(seq >> 8);
+                pResp->data[3] = (uint8_t)(seq);
+                pResp->data[4] = (uint8_t)(nextSeq >> 24);
+                pResp->data[5] = (uint8_t)(nextSeq >> 16);
+                pResp->data[6] = (uint8_t)(nextSeq >> 8);
+                pResp->data[7] = (uint8_t)(nextSeq);
+                pResp->dataLen = (uint8_t)(8 + i * sizeof(sysJournalEntry_t));
             }
             break;
 
-        default:
-            /* Unknown or unsupported transfer mode. */
-#ifdef WIN32
-            radioTestProtocolXferHandler(pPacket);
-#endif
-            return;
-            break;  /* not reached */
+        default:
+            /* Unknown or unsupported transfer mode. */
+#ifdef WIN32
+            radioTestProtocolXferHandler(pPacket);
+#endif
+            radioPktRelease(pkt);
+            return;
+            break;  /* not reached */
+    }
+
+    /* Send acknowledgement. */
+    radioProtocolPktRespSend(pPacket,
+                             pkt,
+                             RADIO_TYPE_XFER,
+                             RADIO_XFER_HEADER_SIZE + pResp->dataLen);
+    radioProtoStatDone(stat,
+                       ((pResp->xferMode & 0x0F) == RADIO_XMODE_GET_NACK) ||
+                       ((pResp->xferMode & 0x0F) == RADIO_XMODE_PUT_NACK),
+                       msStart);
+    radioPktRelease(pkt);
+
+    /* Yield control back to the system polling loop. */
+    radioYield = TRUE;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtocolLoopbackHandler
+ *
+ * PURPOSE
+ *      This routine handles received loopback test reply packets.
+ *
+ * PARAMETERS
+ *      pPacket     IN  pointer to start of packet
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      This routine changes the Loopback Test State from RADIO_LBS_TESTING
+ *      to RADIO_LBS_SUCCESS when it receives a packet.  This routine also
+ *      logs the received messsage as a "Loopback Reply".  The content of
+ *      the packet is not verified.  Justification for not verifying the
+ *      packet data is to allow maximum versatility with minimum overhead.
+ *      Many data checks have already occurred for the packet to reach this
+ *      handler, including proper XBee API framing and checksum as well as
+ *      the first two payload data bytes matching the protocol version and
+ *      loopback test packet type value specifications.
+ *      If the Loopback Test State is not RADIO_LBS_TESTING, the packet is
+ *      silently discarded.
+ *
+ *****************************************************************************/
+static void radioProtocolLoopbackHandler(const radioRxDataPacket_t *pPacket)
+{
+    uint64_t rxSerialNum = U8TOU64(pPacket->data[2],pPacket->data[3],
+                                   pPacket->data[4],pPacket->data[5],
+                                   pPacket->data[6],pPacket->data[7],
+                                   pPacket->data[8],pPacket->data[9]);
+    uint64_t configSerialNum = U8TOU64(configSerialNumber[0], configSerialNumber[1],
+                                      configSerialNumber[2], configSerialNumber[3],
+                                      configSerialNumber[4], configSerialNumber[5],
+                                      configSerialNumber[6], configSerialNumber[7]);
+                                      
+    switch (radioLbState)
+    {
+        case RADIO_LBS_IDLE:
+            /* Ignore the packet. */
+            break;
+        case RADIO_LBS_START:
+            /* Ignore the packet. */
+            break;
+        case RADIO_LBS_TESTING:
+            /* Version check not really needed, just to reference pPacket. */
+            if((pPacket->data[0] == RADIO_PROTOCOL_VER) && (rxSerialNum == configSerialNum))
+            {
+                // Change loopback state to indicate success. //
+                radioStatus = RADIO_STATUS_ONLINE;
+                radioLbState = RADIO_LBS_SUCCESS;
+                radioMessageLog("Loopback Reply");        
+                
+            }     
+            
+            break;
+        case RADIO_LBS_SUCCESS:
+            /* Ignore the packet. */
+            break;
+        case RADIO_LBS_FAIL:
+            /* Ignore the packet. */
+            break;
+        default:
+            /* Ignore the packet. */
+            break;
+    }
+}
+
+/******************************************************************************
+ *
+ * radioLoopbackTestStart
+ *
+ * PURPOSE
+ *      This routine is called to start a loopback test.  The test sends a
+ *      single test packet to the PAN coordinator.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      This routine changes the Loopback Test State (radioLbState) variable
+ *      to RADIO_LBS_START, signalling the radio logic to send an XBee loopback
+ *      test packet to the coordinator's default MAC address.  Test progress
+ *      can be monitored by reading the radioLbState variable.  It is up to
+ *      the caller of this routine to determine when the test has completed
+ *      or timed out.  The caller must explicitly cancel any loopback test it
+ *      starts (see radioLoopbackTestCancel routine).
+ *
+ *****************************************************************************/
+void radioLoopbackTestStart(void)
+{
+    radioLbState = RADIO_LBS_START;
+}
+
+
+/******************************************************************************
+ *
+ * radioLoopbackTestStart
+ *
+ * PURPOSE
+ *      This routine is called to cancel a loopback test.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      This routine changes the Loopback Test State (radioLbState) variable
+ *      to RADIO_LBS_IDLE, indicating that a loopback test is no longer in
+ *      progress.  If a loopback test response packet is received while in the
+ *      RADIO_LBS_IDLE state, it will be silently discarded.
+ *
+ *****************************************************************************/
+void radioLoopbackTestCancel(void)
+{
+    radioLbState = RADIO_LBS_IDLE;
+    
+    if(radioStatus == RADIO_STATUS_SCANNING)
+    {
+      radioStatus = RADIO_STATUS_OFFLINE;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * radioLoopbackTest
+ *
+ * PURPOSE
+ *      This routine is called from within the radio logic subsystem to start
+ *      a loopback test.  This routine clears the last received message log
+ *      and RSSI variables and sends a single test packet to the coordinator's
+ *      default MAC address.  The test packet consists of a 2-byte header for
+ *      protocol version and message type (indicating this is a loopback test
+ *      message) followed by the WOIS serial number for additional test data.
+ *      This routine changes the Loopback Test State (radioLbState) variable
+ *      to RADIO_LBS_TESTING if the radio driver write call succeeds.  If the
+ *      the driver write call fails, the radioLbState is set to RADIO_LBS_FAIL.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      If the loopback test is successful, the radio logic will receive a
+ *      ZigBee data packet containing data that is identical to the test
+ *      packet sent.  Upon receiving this loopback test response, the radio
+ *      subsystem calls the radioProtocolLoopbackHandler routine to
+ *      handle the received loopback test response packet.  If the radio
+ *      Loopback Test State is RADIO_LBS_TESTING when the response packet
+ *      is received, the radioLbState variable is set to RADIO_LBS_SUCCESS.
+ *      The radioLbState variable does not change back to RADIO_LBS_IDLE
+ *      automatically; a loopback test must be explicitely cancelled (see
+ *      radioLoopbackTestCancel routine).
+ *
+ *****************************************************************************/
+static void radioLoopbackTest(void)
+{
+    uint8_t data[CONFIG_SN_SIZE + 2];
+
+    /*
+    ** Construct loopback test data packet.
+    */
+
+    /* First byte specifies WOIS protocol version. */
+    data[0] = RADIO_PROTOCOL_VER;
+    /* Second byte indicates this is a loopback test packet type. */
+    data[1] = RADIO_TYPE_LOOPBACK;
+
+    /* Copy WOIS serial number for use as test data. */
+    memcpy(&data[2], configSerialNumber, CONFIG_SN_SIZE);
+
+    /* Send loopback test data packet to the coordinator's default address. */
+    if (radioLoopbackDataSend(data, sizeof(data)))
+    {
+        /* Change loopback state to testing, waiting for loopback response. */
+        radioLbState = RADIO_LBS_TESTING;
+        
+        if(radioStatus == RADIO_STATUS_OFFLINE)
+        {
+          radioStatus = RADIO_STATUS_SCANNING;
+        }
+    }
+    else
+    {
+        /* Write to radio UART buffer returned failure. */
+        radioLbState = RADIO_LBS_FAIL;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdWeatherUpdate
+ *
+ * PURPOSE
+ *      This routine is called to process received Weather data.
+ *
+ * PARAMETERS
+ *      etAccum     IN  received ET data accumulator value
+ *      rainAccum   IN  received Rainfall accumulator value
+ *
+ * RETURN VALUE
+ *      This routine returns TRUE if the weather data was successfully
+ *      applied; otherwise this routine returns FALSE to indicate a
+ *      failure.  Failure can occur if either the ET accumulator or
+ *      rainfall accumulator are out of range.  When either accumulator
+ *      value is out of range, no weather data is extracted however stored
+ *      accumulator values are synchronized with the received accumulator
+ *      values.
+ *
+ *****************************************************************************/
+bool_t radioProtoCmdWeatherUpdate(uint32_t etAccum, uint32_t rainAccum)
+{
+    uint32_t etAccumDelta;
+    uint32_t rainAccumDelta;
+    uint16_t etData;
+    uint16_t rainfall;
+    bool_t result = FALSE;
+
+    /* Calculate ET and Rainfall deltas. */
+    etAccumDelta = etAccum - radioEtAccumulator;
+    rainAccumDelta = rainAccum - radioRainAccumulator;
+
+    if (etAccumDelta <= RADIO_ET_MAX_DELTA &&
+        rainAccumDelta <= RADIO_RAIN_MAX_DELTA)
+    {
+        /* ET and Rainfall deltas are positive and within limits. */
+        etData = (int16_t)etAccumDelta;
+        rainfall = (int16_t)rainAccumDelta;
+
+        /* Apply weather update. */
+        irrWeatherUpdate(etData, rainfall);
+        /* Set return value to indicate success. */
+        result = TRUE;
+    }
+
+    /* Update radio ET and Rainfall accumulators with last received values. */
+    radioEtAccumulator = etAccum;
+    radioRainAccumulator = rainAccum;
+
+    return result;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdGetWeatherValues
+ *
+ * PURPOSE
+ *      This routine is called to format the response data for 'Get Weather
+ *      Values' WOIS radio commands.
+ *
+ * PARAMETERS
+ *      pData       OUT     points to command-specific response data
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      This routine always formats 8 bytes in the caller's pData buffer.
+ *      The first 4 bytes contain the current ET Accumulator value and
+ *      the next 4 bytes contain the current Rainfall Accumulator value.
+ *
+ *****************************************************************************/
+void radioProtoCmdGetWeatherValues(uint8_t *pData)
+{
+    /* Set ET accumulator value in data. */
+    pData[0] = (uint8_t)(radioEtAccumulator >> 24);
+    pData[1] = (uint8_t)((radioEtAccumulator & 0x00FF0000) >> 16);
+    pData[2] = (uint8_t)((radioEtAccumulator & 0x0000FF00) >> 8);
+    pData[3] = (uint8_t)(radioEtAccumulator & 0x000000FF);
+    /* Set Rainfall accumulator value in data. */
+    pData[4] = (uint8_t)(radioRainAccumulator >> 24);
+    pData[5] = (uint8_t)((radioRainAccumulator & 0x00FF0000) >> 16);
+    pData[6] = (uint8_t)((radioRainAccumulator & 0x0000FF00) >> 8);
+    pData[7] = (uint8_t)(radioRainAccumulator & 0x000000FF);
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdGetMbValues
+ *
+ * PURPOSE
+ *      This routine is called to format the response data for 'Get MB Values'
+ *      WOIS radio commands.
+ *
+ * PARAMETERS
+ *      firstZone   IN      specifies the first zone to format
+ *      pData       OUT     points to command-specific response data
+ *
+ * RETURN VALUE
+ *      This routine returns the count of command-specific response bytes
+ *      copied into the pData buffer.  The return value can range from 1 to 49.
+ *      This routine always formats at least 1 byte in the caller's pData
+ *      buffer, indicating the firstZone parameter.  The MB values for up to 24
+ *      zones can be represented in subsequent 2-byte fields; the actual zone
+ *      value count is limited by the number of configured zones.  To retrieve
+ *      all MB values in a WOIS system having more than 24 zones, two commands
+ *      are needed.  If the firstZone parameter is zero or greater than the
+ *      number of configured zones, this routine formats only the firstZone
+ *      parameter.
+ *
+ *****************************************************************************/
+uint8_t radioProtoCmdGetMbValues(uint8_t firstZone, uint8_t *pData)
+{
+    uint8_t lenData;        /* length of command-specific response data */
+    uint8_t lastZone;       /* last zone to send */
+    uint8_t zone;           /* zone number */
+    uint8_t di;             /* data index */
+    uint16_t mbValue;       /* MB; represented as an unsigned 2-byte value */
+
+    /* Set First Zone number in data. */
+    pData[0] = firstZone;
+    /* Set data length to minimum length (with no zone values returned). */
+    lenData = 1;
+    /* Insure First Zone is within limits. */
+    if ((firstZone > 0) &&
+        (firstZone <= config.sys.numZones))
+    {
+        /* Calculate Last Zone, assuming the 24 zone maximum. */
+        lastZone = firstZone + 24 - 1;
+        /* Insure Last Zone is within configured zone limits. */
+        if (lastZone > config.sys.numZones)
+        {
+            /* Limit Last Zone to last configured zone. */
+            lastZone = config.sys.numZones;
+        }
+        /* Set data index to next available position. */
+        di = lenData;
+        /* Set MB values in data. */
+        for (zone = firstZone; zone <= lastZone; zone++)
+        {
+            /* Get moisture balance value and set in data buffer. */
+            mbValue = (uint16_t)irrMbGet(zone);
+            pData[di] = (uint8_t)(mbValue >> 8);
+            di++;
+            pData[di] = (uint8_t)(mbValue & 0x00FF);
+            di++;
+            lenData += 2;
+        }
+    }
+
+    return lenData;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtoCmdSetMbValues
+ *
+ * PURPOSE
+ *      This routine is called to apply the MB data received by 'Set MB Values'
+ *      WOIS radio commands.  This routine supports setting from 1 to 24
+ *      contiguous zones.
+ *
+ * PARAMETERS
+ *      pData   IN  points to the command data
+ *      lenData IN  length of the command data
+ *
+ * RETURN VALUE
+ *      This routine returns TRUE if the MB data was applied successfully;
+ *      otherwise FALSE is returned to indicate a failure.  Failure occurs
+ *      if the zone is out of range or a MB value is out of range.
+ *
+ * NOTES
+ *      This routine verifies all MB data before committing any changes.
+ *      Failure status indicates no changes were made; success status
+ *      indicates all changes were made.
+ *      This routine allows the MB to be set for all possible zones, including
+ *      those not currently configured.
+ *
+ *****************************************************************************/
+bool_t radioProtoCmdSetMbValues(uint8_t *pData, uint8_t lenData)
+{
+    uint8_t zoneStart = pData[0];
+    uint8_t zoneLimit = zoneStart + ((lenData - 1) / 2);
+    uint8_t zone;
+    uint8_t di;
+    int16_t mbValue;
+
+    /* Verify first zone (1-48). */
+    if ((zoneStart < 1) || (zoneStart > SYS_N_ZONES))
+    {
+        /* First zone is out-of-range. */
+        return FALSE;
+    }
+
+    /* Verify zone limit (2-49). */
+    if ((zoneLimit < 2) || (zoneLimit > SYS_N_ZONES + 1))
+    {
+        /* Zone limit is out-of-range. */
+        return FALSE;
+    }
+
+    /*
+    **  Verify data length.
+    **  There is a 1-byte first zone header, followed by
+    **  1 to 24 2-byte zone MB values.
+    **  Smallest data size of 3 allows setting one zone MB value.
+    **  Largest data size of 49 allows setting 24 zone MB values.
+    */
+
+    /* Verify data length is within limits. */
+    if ((lenData < 3) || (lenData > 49))
+    {
+        /* Data length is out-of-range. */
+        return FALSE;
+    }
+
+    /* Verify data length is odd. */
+    if ((lenData + 1) / 2 == (lenData / 2))
+    {
+        /* Data length is even; there is an unnecessary extra data byte. */
+        return FALSE;
+    }
+
+    /*
+    **  First iterate through all MB values to check validity.
+    */
+
+    /* Set data index to first MB value. */
+    di = 1;
+    /* Verify MB values. */
+    for (zone = zoneStart; zone < zoneLimit; zone++)
+    {
+        /* Get MB value. */
+        mbValue = (int16_t)U8TOU16(pData[di], pData[di + 1]);
+        if ((mbValue < IRR_MB_MIN) || (mbValue > CONFIG_RZWWS_MAX))
+        {
+            /* MB value is out-of-range. */
+            return FALSE;
+        }
+        /* Increment data index to next value. */
+        di += 2;
     }
 
-    /* Send acknowledgement. */
-    radioProtocolRespSend(pPacket,
-                          &resp,
-                          RADIO_TYPE_XFER,
-                          RADIO_XFER_HEADER_SIZE + resp.dataLen);
+    /*
+    **  Now that validity is assured, apply the MB values.
+    */
 
-    /* Yield control back to the system polling loop. */
-    radioYield = TRUE;
+    /* Set data index to first MB value. */
+    di = 1;
+    /* Apply MB values. */
+    for (zone = zoneStart; zone < zoneLimit; zone++)
+    {
+        /* Don't modify zones beyond configuration limit. */
+        if (zone > config.sys.numZones)
+        {
+            break;
+        }
+        /* Get MB value. */
+        mbValue = (int16_t)U8TOU16(pData[di], pData[di + 1]);
+        /* Apply MB value to zone. */
+        irrMbSet(zone, mbValue);
+        /* Increment data index to next value. */
+        di += 2;
+    }
+
+    return TRUE;
 }
 
 
 /******************************************************************************
  *
- * radioProtocolLoopbackHandler
+ * radioProtoCmdGetDigest
  *
  * PURPOSE
- *      This routine handles received loopback test reply packets.
+ *      This routine is called to format the response data for 'Get Status
+ *      Digest' expansion bus commands.  The digest combines moisture values,
+ *      MB values and daily zone runtimes in a single response.
  *
  * PARAMETERS
- *      pPacket     IN  pointer to start of packet
+ *      lastSeq     IN      last digest sequence number received by the
+ *                          master (0=none)
+ *      pData       OUT     points to command-specific response data
  *
  * RETURN VALUE
- *      None.
+ *      This routine returns the count of command-specific response bytes
+ *      copied into the pData buffer.
  *
  * NOTES
- *      This routine changes the Loopback Test State from RADIO_LBS_TESTING
- *      to RADIO_LBS_SUCCESS when it receives a packet.  This routine also
- *      logs the received messsage as a "Loopback Reply".  The content of
- *      the packet is not verified.  Justification for not verifying the
- *      packet data is to allow maximum versatility with minimum overhead.
- *      Many data checks have already occurred for the packet to reach this
- *      handler, including proper XBee API framing and checksum as well as
- *      the first two payload data bytes matching the protocol version and
- *      loopback test packet type value specifications.
- *      If the Loopback Test State is not RADIO_LBS_TESTING, the packet is
- *      silently discarded.
+ *      Zone entries are only included for zones whose values changed since
+ *      the last digest.  If lastSeq does not match the last digest sent, the
+ *      master missed a response and all zones are sent again.  When more
+ *      zones changed than fit in one response, RADIO_DIGEST_FLAG_MORE is set
+ *      and the master requests the remainder.  See radio.h for the layout.
  *
  *****************************************************************************/
-static void radioProtocolLoopbackHandler(const radioRxDataPacket_t *pPacket)
+static uint8_t radioProtoCmdGetDigest(uint8_t lastSeq, uint8_t *pData)
 {
-    uint64_t rxSerialNum = U8TOU64(pPacket->data[2],pPacket->data[3],
-                                   pPacket->data[4],pPacket->data[5],
-                                   pPacket->data[6],pPacket->data[7],
-                                   pPacket->data[8],pPacket->data[9]);
-    uint64_t configSerialNum = U8TOU64(configSerialNumber[0], configSerialNumber[1],
-                                      configSerialNumber[2], configSerialNumber[3],
-                                      configSerialNumber[4], configSerialNumber[5],
-                                      configSerialNumber[6], configSerialNumber[7]);
-                                      
-    switch (radioLbState)
+    uint8_t lenData = RADIO_DIGEST_HDR_SIZE;    /* response data length */
+    uint8_t flags = 0;                          /* digest flags */
+    uint16_t zoneMask = 0;                      /* zones included */
+    uint8_t nZones = 0;                         /* zone entries included */
+    uint8_t zi;                                 /* zone index */
+    uint8_t moist;                              /* zone moisture value */
+    int16_t mbValue;                            /* zone MB value */
+    uint16_t runtime;                           /* zone daily runtime */
+
+    if ((lastSeq == 0) || (lastSeq != radioDigestSeq))
     {
-        case RADIO_LBS_IDLE:
-            /* Ignore the packet. */
-            break;
-        case RADIO_LBS_START:
-            /* Ignore the packet. */
-            break;
-        case RADIO_LBS_TESTING:
-            /* Version check not really needed, just to reference pPacket. */
-            if((pPacket->data[0] == RADIO_PROTOCOL_VER) && (rxSerialNum == configSerialNum))
-            {
-                // Change loopback state to indicate success. //
-                radioStatus = RADIO_STATUS_ONLINE;
-                radioLbState = RADIO_LBS_SUCCESS;
-                radioMessageLog("Loopback Reply");        
-                
-            }     
-            
-            break;
-        case RADIO_LBS_SUCCESS:
-            /* Ignore the packet. */
-            break;
-        case RADIO_LBS_FAIL:
-            /* Ignore the packet. */
-            break;
-        default:
-            /* Ignore the packet. */
+        /* Forget values last sent so every zone is reported again. */
+        flags |= RADIO_DIGEST_FLAG_FULL;
+        memset(radioDigestMoist, 0xFF, sizeof(radioDigestMoist));
+    }
+
+    /* Advance digest sequence number, skipping zero. */
+    radioDigestSeq++;
+    if (radioDigestSeq == 0)
+    {
+        radioDigestSeq = 1;
+    }
+
+    pData[0] = radioDigestSeq;
+
+    /* Add an entry for each changed zone. */
+    for (zi = 0; zi < SYS_N_UNIT_ZONES; zi++)
+    {
+        moist = sysRadioMoistValueGet(zi);
+        mbValue = irrMbGet(zi + 1);
+        runtime = irrDailyRuntimePerZone[zi];
+
+        if ((moist == radioDigestMoist[zi]) &&
+            (mbValue == radioDigestMb[zi]) &&
+            (runtime == radioDigestRuntime[zi]))
+        {
+            /* Master already has this zone's values. */
+            continue;
+        }
+        if (nZones == RADIO_DIGEST_MAX_ZONES)
+        {
+            /* No room left; master will ask for the rest. */
+            flags |= RADIO_DIGEST_FLAG_MORE;
             break;
+        }
+
+        zoneMask |= (uint16_t)1 << zi;
+        pData[lenData++] = moist;
+        pData[lenData++] = (uint8_t)((uint16_t)mbValue >> 8);
+        pData[lenData++] = (uint8_t)((uint16_t)mbValue & 0x00FF);
+        pData[lenData++] = (uint8_t)(runtime >> 8);
+        pData[lenData++] = (uint8_t)(runtime & 0x00FF);
+
+        radioDigestMoist[zi] = moist;
+        radioDigestMb[zi] = mbValue;
+        radioDigestRuntime[zi] = runtime;
+        nZones++;
     }
+
+    pData[1] = flags;
+    pData[2] = (uint8_t)(zoneMask >> 8);
+    pData[3] = (uint8_t)(zoneMask & 0xFF);
+
+    return lenData;
 }
 
+
 /******************************************************************************
  *
- * radioLoopbackTestStart
+ * radioProtocolAckSend
  *
  * PURPOSE
- *      This routine is called to start a loopback test.  The test sends a
- *      single test packet to the PAN coordinator.
+ *      This routine sends command acknowledgement messages in response to
+ *      received WaterOptimizer application command packets.
  *
  * PARAMETERS
- *      None.
+ *      pPacket     IN  pointer to start of received command packet
+ *      cmdAck      IN  application command acknowledgement response code
+ *      pData       IN  pointer to start of command-specific response data
+ *      lenData     IN  length of the command-specific response data
  *
  * RETURN VALUE
  *      None.
  *
- * NOTES
- *      This routine changes the Loopback Test State (radioLbState) variable
- *      to RADIO_LBS_START, signalling the radio logic to send an XBee loopback
- *      test packet to the coordinator's default MAC address.  Test progress
- *      can be monitored by reading the radioLbState variable.  It is up to
- *      the caller of this routine to determine when the test has completed
- *      or timed out.  The caller must explicitly cancel any loopback test it
- *      starts (see radioLoopbackTestCancel routine).
- *
  *****************************************************************************/
-void radioLoopbackTestStart(void)
+static void radioProtocolAckSend(const radioRxDataPacket_t *pPacket,
+                                 uint8_t cmdAck,
+                                 const uint8_t *pData,
+                                 uint8_t lenData)
 {
-    radioLbState = RADIO_LBS_START;
+    uint8_t pkt;
+    radioMsgAck_t *pMsg;
+    radioMsgCmd_t *cmdMsg = (radioMsgCmd_t *)&pPacket->data[0];
+
+    /* Build the acknowledgement directly in a packet buffer. */
+    pkt = radioPktAlloc();
+    if (pkt == RADIO_PKT_NONE)
+    {
+        return;
+    }
+    pMsg = (radioMsgAck_t *)radioPktData(pkt);
+
+    pMsg->msgId = cmdMsg->msgId;
+    pMsg->cmd = cmdAck;
+    pMsg->dataLen = RADIO_ACK_MIN_DATA_SIZE + lenData;
+
+    memcpy(pMsg->data, configSerialNumber, CONFIG_SN_SIZE);
+
+    sysRadioResponseBytes(&pMsg->data[8], &pMsg->data[9]);
+
+    memcpy(&pMsg->data[10], pData, lenData);
+
+    radioProtocolPktRespSend(pPacket,
+                             pkt,
+                             RADIO_TYPE_ACK,
+                             RADIO_CMD_HEADER_SIZE + pMsg->dataLen);
+    radioPktRelease(pkt);
 }
 
 
 /******************************************************************************
  *
- * radioLoopbackTestStart
+ * radioProtocolFillAckDefaults
  *
  * PURPOSE
- *      This routine is called to cancel a loopback test.
+ *      This routine fills an SC ACK packet with default values
  *
  * PARAMETERS
- *      None.
+ *      pAckPacket  IN  pointer to uninitialized ACK packet
  *
  * RETURN VALUE
  *      None.
  *
- * NOTES
- *      This routine changes the Loopback Test State (radioLbState) variable
- *      to RADIO_LBS_IDLE, indicating that a loopback test is no longer in
- *      progress.  If a loopback test response packet is received while in the
- *      RADIO_LBS_IDLE state, it will be silently discarded.
- *
  *****************************************************************************/
-void radioLoopbackTestCancel(void)
+static void radioProtocolFillAckDefaults(packetSCAckData_t *pAckPacket)
 {
-    radioLbState = RADIO_LBS_IDLE;
-    
-    if(radioStatus == RADIO_STATUS_SCANNING)
-    {
-      radioStatus = RADIO_STATUS_OFFLINE;
-    }
+    pAckPacket->command = SC_DEASSOCIATE;
+    pAckPacket->controlMacId = 0;
+    pAckPacket->hibTemp = SC_HIBERNATE_TEMP_C;
+    pAckPacket->hibThresTime = SC_HIBERNATE_THRES_TIME;
+    pAckPacket->sleepTime = SC_SLEEP_TIME;
+    pAckPacket->solenoidState = SC_ALL_CHAN_OFF;
 }
 
 
 /******************************************************************************
  *
- * radioLoopbackTest
+ * radioSnsConSleepTimeGet
  *
  * PURPOSE
- *      This routine is called from within the radio logic subsystem to start
- *      a loopback test.  This routine clears the last received message log
- *      and RSSI variables and sends a single test packet to the coordinator's
- *      default MAC address.  The test packet consists of a 2-byte header for
- *      protocol version and message type (indicating this is a loopback test
- *      message) followed by the WOIS serial number for additional test data.
- *      This routine changes the Loopback Test State (radioLbState) variable
- *      to RADIO_LBS_TESTING if the radio driver write call succeeds.  If the
- *      the driver write call fails, the radioLbState is set to RADIO_LBS_FAIL.
+ *      This routine computes the sleep time to send to a sensor concentrator
+ *      in its ACK packet, so that it checks in again shortly after the next
+ *      planned valve change on one of its channels.
  *
  * PARAMETERS
- *      None.
+ *      sensorIndex IN  index into the sensor concentrator association list
  *
  * RETURN VALUE
- *      None.
+ *      This routine returns the sleep time in seconds, between
+ *      SC_SLEEP_TIME_MIN and SC_SLEEP_TIME.
  *
  * NOTES
- *      If the loopback test is successful, the radio logic will receive a
- *      ZigBee data packet containing data that is identical to the test
- *      packet sent.  Upon receiving this loopback test response, the radio
- *      subsystem calls the radioProtocolLoopbackHandler routine to
- *      handle the received loopback test response packet.  If the radio
- *      Loopback Test State is RADIO_LBS_TESTING when the response packet
- *      is received, the radioLbState variable is set to RADIO_LBS_SUCCESS.
- *      The radioLbState variable does not change back to RADIO_LBS_IDLE
- *      automatically; a loopback test must be explicitely cancelled (see
- *      radioLoopbackTestCancel routine).
+ *      While irrigating, an SC with an unfinished zone on one of its
+ *      channels is woken at the next irrZoneTransition() time, since that
+ *      is when its valve can next be turned on or off.  All other SCs, and
+ *      all SCs while idle, sleep the full SC_SLEEP_TIME unless a scheduled
+ *      program start falls within that interval.
+ *
+ *      If irrigation is inhibited, the long sleep time is used to save SC
+ *      battery life.  If paused, we assume that somebody is at the
+ *      controller and use the fixed irrigating sleep time.  SCs controlled
+ *      by another unit keep the fixed sleep times.
+ *
+ *****************************************************************************/
+static uint32_t radioSnsConSleepTimeGet(uint8_t sensorIndex)
+{
+    uint32_t sleepTime = SC_SLEEP_TIME;     /* sleep time to send */
+    uint32_t secs = IRR_SECS_NONE;          /* secs until next valve change */
+    bool_t isIrrigating;                    /* any unit is irrigating */
+    bool_t havePending = FALSE;             /* SC has unfinished zone */
+    uint8_t zoneOffset;                     /* first zone index on this unit */
+    uint8_t zi;                             /* zone index */
+    uint8_t ch;                             /* SC channel index */
+
+    isIrrigating = (sysState != SYS_STATE_IDLE) ||
+                   (expansionSysState != SYS_STATE_IDLE);
+
+    if (sensorIndex >= MAX_NUM_SC)
+    {
+        return SC_SLEEP_TIME;
+    }
+
+    if (isIrrigating && sysIsInhibited)
+    {
+        return SC_SLEEP_TIME;
+    }
+
+    if ((isIrrigating && sysIsPaused) ||
+        (config.sys.assocSensorCon[sensorIndex].zoneRange != config.sys.unitType))
+    {
+        return isIrrigating ? SC_SLEEP_TIME_IRR : SC_SLEEP_TIME;
+    }
+
+    if (sysState != SYS_STATE_IDLE)
+    {
+        /* Check for unfinished zones on this SC's channels. */
+        zoneOffset = config.sys.unitType * SYS_N_UNIT_ZONES;
+        for (ch = 0; ch < SC_NUM_CHAN_UNIT; ch++)
+        {
+            zi = config.sys.assocSensorCon[sensorIndex].channelZone[ch];
+            if ((zi == SC_CHAN_NOT_ASSIGNED) ||
+                (zi < zoneOffset) ||
+                (zi >= zoneOffset + SYS_N_UNIT_ZONES))
+            {
+                continue;
+            }
+            zi -= zoneOffset;
+            if (((zi + 1) == irrCurZone) || (irrRemainingZoneSecs(zi + 1) > 0))
+            {
+                havePending = TRUE;
+                break;
+            }
+        }
+        if (havePending)
+        {
+            secs = irrNextTransitionSecs();
+        }
+    }
+    else
+    {
+        /* Wake for the next scheduled program start. */
+        secs = irrScheduleNextStartSecs();
+    }
+
+    if ((secs != IRR_SECS_NONE) &&
+        ((secs + SC_WAKE_MARGIN_SECS) < sleepTime))
+    {
+        sleepTime = secs + SC_WAKE_MARGIN_SECS;
+    }
+    if (sleepTime < SC_SLEEP_TIME_MIN)
+    {
+        sleepTime = SC_SLEEP_TIME_MIN;
+    }
+
+    return sleepTime;
+}
+
+
+/******************************************************************************
+ *
+ * radioProtocolRespSend
+ *
+ * PURPOSE
+ *      This routine sends protocol response messages to the destination
+ *      address specified in the received data packet.
+ *
+ * PARAMETERS
+ *      pPacket     IN  pointer to start of received data packet
+ *      pMsg        IN  pointer to start of protocol response message
+ *      msgType     IN  protocol message type
+ *      length      IN  length of the protocol response message
+ *
+ * RETURN VALUE
+ *      None.
  *
  *****************************************************************************/
-static void radioLoopbackTest(void)
+static void radioProtocolRespSend(const radioRxDataPacket_t *pPacket,
+                                  const void *pMsg,
+                                  uint8_t msgType,
+                                  uint8_t length)
 {
-    uint8_t data[CONFIG_SN_SIZE + 2];
-
-    /*
-    ** Construct loopback test data packet.
-    */
-
-    /* First byte specifies WOIS protocol version. */
-    data[0] = RADIO_PROTOCOL_VER;
-    /* Second byte indicates this is a loopback test packet type. */
-    data[1] = RADIO_TYPE_LOOPBACK;
-
-    /* Copy WOIS serial number for use as test data. */
-    memcpy(&data[2], configSerialNumber, CONFIG_SN_SIZE);
+    uint8_t pkt;
 
-    /* Send loopback test data packet to the coordinator's default address. */
-    if (radioLoopbackDataSend(data, sizeof(data)))
+    if (length > RADIO_MAXPAYLOAD)
     {
-        /* Change loopback state to testing, waiting for loopback response. */
-        radioLbState = RADIO_LBS_TESTING;
-        
-        if(radioStatus == RADIO_STATUS_OFFLINE)
-        {
-          radioStatus = RADIO_STATUS_SCANNING;
-        }
+        return;
     }
-    else
+    pkt = radioPktAlloc();
+    if (pkt == RADIO_PKT_NONE)
     {
-        /* Write to radio UART buffer returned failure. */
-        radioLbState = RADIO_LBS_FAIL;
+        return;
     }
+    memcpy(radioPktData(pkt), pMsg, length);
+    radioProtocolPktRespSend(pPacket, pkt, msgType, length);
+    radioPktRelease(pkt);
 }
 
 
 /******************************************************************************
  *
- * radioProtoCmdWeatherUpdate
+ * radioProtocolPktRespSend
  *
  * PURPOSE
- *      This routine is called to process received Weather data.
+ *      This routine sends a protocol response message built in a packet
+ *      buffer to the destination address specified in the received data
+ *      packet.
  *
  * PARAMETERS
- *      etAccum     IN  received ET data accumulator value
- *      rainAccum   IN  received Rainfall accumulator value
+ *      pPacket     IN  pointer to start of received data packet
+ *      pkt         IN  packet buffer holding the protocol response message
+ *      msgType     IN  protocol message type
+ *      length      IN  length of the protocol response message
  *
  * RETURN VALUE
- *      This routine returns TRUE if the weather data was successfully
- *      applied; otherwise this routine returns FALSE to indicate a
- *      failure.  Failure can occur if either the ET accumulator or
- *      rainfall accumulator are out of range.  When either accumulator
- *      value is out of range, no weather data is extracted however stored
- *      accumulator values are synchronized with the received accumulator
- *      values.
+ *      None.
+ *
+ * NOTES
+ *      The caller keeps its reference to the packet buffer and releases it
+ *      when done.
  *
  *****************************************************************************/
-bool_t radioProtoCmdWeatherUpdate(uint32_t etAccum, uint32_t rainAccum)
+static void radioProtocolPktRespSend(const radioRxDataPacket_t *pPacket,
+                                     uint8_t pkt,
+                                     uint8_t msgType,
+                                     uint8_t length)
 {
-    uint32_t etAccumDelta;
-    uint32_t rainAccumDelta;
-    uint16_t etData;
-    uint16_t rainfall;
-    bool_t result = FALSE;
+    uint8_t *pMsg = radioPktData(pkt);
+    radioMsgHeader_t *pHdr = (radioMsgHeader_t *)pMsg;
+    uint32_t destH = U8TOU32(pPacket->phyAddr[0],
+                             pPacket->phyAddr[1],
+                             pPacket->phyAddr[2],
+                             pPacket->phyAddr[3]);
+    uint32_t destL = U8TOU32(pPacket->phyAddr[4],
+                             pPacket->phyAddr[5],
+                             pPacket->phyAddr[6],
+                             pPacket->phyAddr[7]);
+    uint16_t destN = U8TOU16(pPacket->netAddr[0], pPacket->netAddr[1]);
 
-    /* Calculate ET and Rainfall deltas. */
-    etAccumDelta = etAccum - radioEtAccumulator;
-    rainAccumDelta = rainAccum - radioRainAccumulator;
+    pHdr->version = RADIO_PROTOCOL_VER;
+    pHdr->msgType = msgType;
+    radioMsgInsertCrc(pMsg, length);
+    radioPktSend(radioDataFrameId(),
+                 destN,
+                 destH,
+                 destL,
+                 pkt,
+                 length);
+}
 
-    if (etAccumDelta <= RADIO_ET_MAX_DELTA &&
-        rainAccumDelta <= RADIO_RAIN_MAX_DELTA)
-    {
-        /* ET and Rainfall deltas are positive and within limits. */
-        etData = (int16_t)etAccumDelta;
-        rainfall = (int16_t)rainAccumDelta;
 
-        /* Apply weather update. */
-        irrWeatherUpdate(etData, rainfall);
-        /* Set return value to indicate success. */
-        result = TRUE;
-    }
+/******************************************************************************
+ *
+ * radioMsgInsertCrc
+ *
+ * PURPOSE
+ *      This routine calculates and inserts the correct CRC checksum into
+ *      the caller's protocol message.
+ *
+ * PARAMETERS
+ *      pMsg        IN/OUT  pointer to message
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ *****************************************************************************/
+void radioMsgInsertCrc(const void *pMsg, uint8_t length)
+{
+    uint16_t crc;
+    radioMsgHeader_t *hdr = (radioMsgHeader_t *)pMsg;
 
-    /* Update radio ET and Rainfall accumulators with last received values. */
-    radioEtAccumulator = etAccum;
-    radioRainAccumulator = rainAccum;
+    crc = crc16((uint8_t *)pMsg + 4, length - 4);
 
-    return result;
+    hdr->crcHigh = (uint8_t)(crc >> 8);
+    hdr->crcLow = (uint8_t)(crc & 0x00FF);
 }
 
 
 /******************************************************************************
  *
- * radioProtoCmdGetWeatherValues
+ * radioDataFrameId
  *
  * PURPOSE
- *      This routine is called to format the response data for 'Get Weather
- *      Values' WOIS radio commands.
+ *      This routine is called to generate a Frame ID to use in the API header
+ *      for ZigBee Transmit Data frames.  The Frame ID value is incremented on
+ *      each call, until a maximum value is reached and the value wraps around
+ *      to the beginning of its range.  This routine returns at least 100
+ *      unique values before recycling.
  *
  * PARAMETERS
- *      pData       OUT     points to command-specific response data
+ *      None.
  *
  * RETURN VALUE
- *      None.
+ *      This routine returns a value for use in the Frame ID field of the
+ *      ZigBee Tx Data API header.
  *
  * NOTES
- *      This routine always formats 8 bytes in the caller's pData buffer.
- *      The first 4 bytes contain the current ET Accumulator value and
- *      the next 4 bytes contain the current Rainfall Accumulator value.
+ *      The Frame ID is used to correlate ZigBee Transmit Status responses
+ *      with their respective ZigBee Transmit Data frames.  This allows the
+ *      potential for a ZigBee Tx Data frame to be retransmitted when a
+ *      transmission failure is reported by the ZigBee radio module.
  *
  *****************************************************************************/
-void radioProtoCmdGetWeatherValues(uint8_t *pData)
+uint8_t radioDataFrameId(void)
 {
-    /* Set ET accumulator value in data. */
-    pData[0] = (uint8_t)(radioEtAccumulator >> 24);
-    pData[1] = (uint8_t)((radioEtAccumulator & 0x00FF0000) >> 16);
-    pData[2] = (uint8_t)((radioEtAccumulator & 0x0000FF00) >> 8);
-    pData[3] = (uint8_t)(radioEtAccumulator & 0x000000FF);
-    /* Set Rainfall accumulator value in data. */
-    pData[4] = (uint8_t)(radioRainAccumulator >> 24);
-    pData[5] = (uint8_t)((radioRainAccumulator & 0x00FF0000) >> 16);
-    pData[6] = (uint8_t)((radioRainAccumulator & 0x0000FF00) >> 8);
-    pData[7] = (uint8_t)(radioRainAccumulator & 0x000000FF);
+    uint8_t frameId = radioDataFrameIdNext;
+
+    if (++radioDataFrameIdNext > RADIO_DATA_FRAME_ID_MAX)
+    {
+        radioDataFrameIdNext = RADIO_DATA_FRAME_ID_FIRST;
+    }
+
+    return (frameId);
 }
 
 
 /******************************************************************************
  *
- * radioProtoCmdGetMbValues
+ * radioCmdPendingInit
  *
  * PURPOSE
- *      This routine is called to format the response data for 'Get MB Values'
- *      WOIS radio commands.
+ *      This routine initializes the command-pending queue, setting all
+ *      entries unused.
  *
  * PARAMETERS
- *      firstZone   IN      specifies the first zone to format
- *      pData       OUT     points to command-specific response data
+ *      None.
  *
  * RETURN VALUE
- *      This routine returns the count of command-specific response bytes
- *      copied into the pData buffer.  The return value can range from 1 to 49.
- *      This routine always formats at least 1 byte in the caller's pData
- *      buffer, indicating the firstZone parameter.  The MB values for up to 24
- *      zones can be represented in subsequent 2-byte fields; the actual zone
- *      value count is limited by the number of configured zones.  To retrieve
- *      all MB values in a WOIS system having more than 24 zones, two commands
- *      are needed.  If the firstZone parameter is zero or greater than the
- *      number of configured zones, this routine formats only the firstZone
- *      parameter.
+ *      None.
  *
  *****************************************************************************/
-uint8_t radioProtoCmdGetMbValues(uint8_t firstZone, uint8_t *pData)
+static void radioCmdPendingInit(void)
 {
-    uint8_t lenData;        /* length of command-specific response data */
-    uint8_t lastZone;       /* last zone to send */
-    uint8_t zone;           /* zone number */
-    uint8_t di;             /* data index */
-    uint16_t mbValue;       /* MB; represented as an unsigned 2-byte value */
+    uint8_t i;
 
-    /* Set First Zone number in data. */
-    pData[0] = firstZone;
-    /* Set data length to minimum length (with no zone values returned). */
-    lenData = 1;
-    /* Insure First Zone is within limits. */
-    if ((firstZone > 0) &&
-        (firstZone <= config.sys.numZones))
+    /* Initialize the auto-send list and retry timer wheel to empty. */
+    for (i = 0; i < RADIO_CPQ_N_LISTS; i++)
     {
-        /* Calculate Last Zone, assuming the 24 zone maximum. */
-        lastZone = firstZone + 24 - 1;
-        /* Insure Last Zone is within configured zone limits. */
-        if (lastZone > config.sys.numZones)
-        {
-            /* Limit Last Zone to last configured zone. */
-            lastZone = config.sys.numZones;
-        }
-        /* Set data index to next available position. */
-        di = lenData;
-        /* Set MB values in data. */
-        for (zone = firstZone; zone <= lastZone; zone++)
-        {
-            /* Get moisture balance value and set in data buffer. */
-            mbValue = (uint16_t)irrMbGet(zone);
-            pData[di] = (uint8_t)(mbValue >> 8);
-            di++;
-            pData[di] = (uint8_t)(mbValue & 0x00FF);
-            di++;
-            lenData += 2;
-        }
+        radioCmdPendingFirst[i] = RADIO_CPQ_NONE;
+        radioCmdPendingLast[i] = RADIO_CPQ_NONE;
     }
+    radioCmdWheelTime = dtTickCount;
 
-    return lenData;
+    /* No command identifier has a queue element. */
+    for (i = 0; i < RADIO_CPQ_N_IDENTS; i++)
+    {
+        radioCmdPendingSlot[i] = RADIO_CPQ_NONE;
+    }
+
+    /* Link all elements into the free list. */
+    for (i = 0; i < RADIO_CPQ_SIZE; i++)
+    {
+        radioCmdPending[i].inUse = FALSE;
+        radioCmdPending[i].prev = RADIO_CPQ_NONE;
+        radioCmdPending[i].next = i + 1;
+    }
+    radioCmdPending[RADIO_CPQ_SIZE - 1].next = RADIO_CPQ_NONE;
+    radioCmdPendingFree = 0;
 }
 
 
 /******************************************************************************
  *
- * radioProtoCmdSetMbValues
+ * radioCmdPendingAdd
  *
  * PURPOSE
- *      This routine is called to apply the MB data received by 'Set MB Values'
- *      WOIS radio commands.  This routine supports setting from 1 to 24
- *      contiguous zones.
+ *      This routine adds a command to the command-pending queue.  If the
+ *      command was just sent, the 'send' flag should be set to FALSE
+ *      and the command is placed on the retry timer wheel, due for retry
+ *      RADIO_CMD_RETRY_SECS from now.
+ *      If the caller wishes to enqueue a command for automatic sending,
+ *      the 'send' flag should be set to TRUE.  The command is placed on the
+ *      auto-send list, informing the Command Retry Manager to send the
+ *      command at its next opportunity.
  *
  * PARAMETERS
- *      pData   IN  points to the command data
- *      lenData IN  length of the command data
+ *      ident   IN  command identifier
+ *      send    IN  Set to TRUE to request command to be enqueued for auto-send
+ *                  with auto-retry if no response is received before time-out.
+ *                  If the command has just been sent, set to FALSE to request
+ *                  the command to be enqueued for auto-retry only.
  *
  * RETURN VALUE
- *      This routine returns TRUE if the MB data was applied successfully;
- *      otherwise FALSE is returned to indicate a failure.  Failure occurs
- *      if the zone is out of range or a MB value is out of range.
- *
- * NOTES
- *      This routine verifies all MB data before committing any changes.
- *      Failure status indicates no changes were made; success status
- *      indicates all changes were made.
- *      This routine allows the MB to be set for all possible zones, including
- *      those not currently configured.
+ *      Returns TRUE if the command was successfully added.  Returns FALSE
+ *      if the command pending queue is full or the identifier is not an
+ *      automated command identifier.
  *
  *****************************************************************************/
-bool_t radioProtoCmdSetMbValues(uint8_t *pData, uint8_t lenData)
+static bool_t radioCmdPendingAdd(uint8_t ident, bool_t send)
 {
-    uint8_t zoneStart = pData[0];
-    uint8_t zoneLimit = zoneStart + ((lenData - 1) / 2);
-    uint8_t zone;
-    uint8_t di;
-    int16_t mbValue;
-
-    /* Verify first zone (1-48). */
-    if ((zoneStart < 1) || (zoneStart > SYS_N_ZONES))
+    uint8_t i;
+    uint8_t list;
+
+    if ((ident < RADIO_CMD_AUTO) || (ident > RADIO_CMD_AUTO_LAST))
     {
-        /* First zone is out-of-range. */
         return FALSE;
     }
 
-    /* Verify zone limit (2-49). */
-    if ((zoneLimit < 2) || (zoneLimit > SYS_N_ZONES + 1))
+    /* First delete any previous instance of this command. */
+    radioCmdPendingDelete(ident);
+
+    /* Take an element from the free list. */
+    i = radioCmdPendingFree;
+    if (i == RADIO_CPQ_NONE)
     {
-        /* Zone limit is out-of-range. */
         return FALSE;
     }
+    radioCmdPendingFree = radioCmdPending[i].next;
 
-    /*
-    **  Verify data length.
-    **  There is a 1-byte first zone header, followed by
-    **  1 to 24 2-byte zone MB values.
-    **  Smallest data size of 3 allows setting one zone MB value.
-    **  Largest data size of 49 allows setting 24 zone MB values.
-    */
+    /* Mark element in use and store command identifier. */
+    radioCmdPending[i].inUse = TRUE;
+    radioCmdPending[i].ident = ident;
+    radioCmdPendingSlot[ident - RADIO_CMD_AUTO] = i;
 
-    /* Verify data length is within limits. */
-    if ((lenData < 3) || (lenData > 49))
+    if (send)
     {
-        /* Data length is out-of-range. */
-        return FALSE;
+        /* Enqueue for immediate send. */
+        list = RADIO_CPQ_SEND_LIST;
+        radioCmdPending[i].timeDue = dtTickCount;
     }
-
-    /* Verify data length is odd. */
-    if ((lenData + 1) / 2 == (lenData / 2))
+    else
     {
-        /* Data length is even; there is an unnecessary extra data byte. */
-        return FALSE;
+        /* Enqueue on the timer wheel slot for the second the retry is due. */
+        radioCmdPending[i].timeDue = dtTickCount + RADIO_CMD_RETRY_SECS + 1;
+        list = (uint8_t)(radioCmdPending[i].timeDue % RADIO_CPQ_WHEEL_SIZE);
     }
+    radioCmdPending[i].list = list;
 
-    /*
-    **  First iterate through all MB values to check validity.
-    */
-
-    /* Set data index to first MB value. */
-    di = 1;
-    /* Verify MB values. */
-    for (zone = zoneStart; zone < zoneLimit; zone++)
+    /* Append to the end of the list, keeping each list oldest first. */
+    radioCmdPending[i].prev = radioCmdPendingLast[list];
+    radioCmdPending[i].next = RADIO_CPQ_NONE;
+    if (radioCmdPendingLast[list] != RADIO_CPQ_NONE)
     {
-        /* Get MB value. */
-        mbValue = (int16_t)U8TOU16(pData[di], pData[di + 1]);
-        if ((mbValue < IRR_MB_MIN) || (mbValue > CONFIG_RZWWS_MAX))
-        {
-            /* MB value is out-of-range. */
-            return FALSE;
-        }
-        /* Increment data index to next value. */
-        di += 2;
+        /* Link last member to this new member. */
+        radioCmdPending[radioCmdPendingLast[list]].next = i;
     }
-
-    /*
-    **  Now that validity is assured, apply the MB values.
-    */
-
-    /* Set data index to first MB value. */
-    di = 1;
-    /* Apply MB values. */
-    for (zone = zoneStart; zone < zoneLimit; zone++)
+    else
     {
-        /* Don't modify zones beyond configuration limit. */
-        if (zone > config.sys.numZones)
-        {
-            break;
-        }
-        /* Get MB value. */
-        mbValue = (int16_t)U8TOU16(pData[di], pData[di + 1]);
-        /* Apply MB value to zone. */
-        irrMbSet(zone, mbValue);
-        /* Increment data index to next value. */
-        di += 2;
+        /* Set first member to this new member. */
+        radioCmdPendingFirst[list] = i;
     }
+    radioCmdPendingLast[list] = i;
 
     return TRUE;
 }
@@ -4335,1635 +7399,2415 @@ bool_t radioProtoCmdSetMbValues(uint8_t *pData, uint8_t lenData)
 
 /******************************************************************************
  *
- * radioProtocolAckSend
+ * radioCmdPendingDelete
  *
  * PURPOSE
- *      This routine sends command acknowledgement messages in response to
- *      received WaterOptimizer application command packets.
+ *      This routine removes a command from the command-pending queue.
  *
  * PARAMETERS
- *      pPacket     IN  pointer to start of received command packet
- *      cmdAck      IN  application command acknowledgement response code
- *      pData       IN  pointer to start of command-specific response data
- *      lenData     IN  length of the command-specific response data
+ *      ident       IN  command identifier
  *
  * RETURN VALUE
  *      None.
  *
  *****************************************************************************/
-static void radioProtocolAckSend(const radioRxDataPacket_t *pPacket,
-                                 uint8_t cmdAck,
-                                 const uint8_t *pData,
-                                 uint8_t lenData)
+static void radioCmdPendingDelete(uint8_t ident)
 {
-    radioMsgAck_t msg;
-    radioMsgCmd_t *cmdMsg = (radioMsgCmd_t *)&pPacket->data[0];
-
-    msg.msgId = cmdMsg->msgId;
-    msg.cmd = cmdAck;
-    msg.dataLen = RADIO_ACK_MIN_DATA_SIZE + lenData;
-
-    memcpy(msg.data, configSerialNumber, CONFIG_SN_SIZE);
+    uint8_t i;
+    uint8_t list;
 
-    sysRadioResponseBytes(&msg.data[8], &msg.data[9]);
+    if ((ident < RADIO_CMD_AUTO) || (ident > RADIO_CMD_AUTO_LAST))
+    {
+        return;
+    }
+    i = radioCmdPendingSlot[ident - RADIO_CMD_AUTO];
+    if (i == RADIO_CPQ_NONE)
+    {
+        return;
+    }
+    list = radioCmdPending[i].list;
 
-    memcpy(&msg.data[10], pData, lenData);
+    /* Unlink this element from its list. */
+    if (radioCmdPending[i].prev != RADIO_CPQ_NONE)
+    {
+        /* Update previous link member's next index. */
+        radioCmdPending[radioCmdPending[i].prev].next =
+            radioCmdPending[i].next;
+    }
+    else
+    {
+        /* This element was first in list. Update first index. */
+        radioCmdPendingFirst[list] = radioCmdPending[i].next;
+    }
+    if (radioCmdPending[i].next != RADIO_CPQ_NONE)
+    {
+        /* Update next link member's prev index. */
+        radioCmdPending[radioCmdPending[i].next].prev =
+            radioCmdPending[i].prev;
+    }
+    else
+    {
+        /* This element was last in list. Update last index. */
+        radioCmdPendingLast[list] = radioCmdPending[i].prev;
+    }
 
-    radioProtocolRespSend(pPacket,
-                          &msg,
-                          RADIO_TYPE_ACK,
-                          RADIO_CMD_HEADER_SIZE + msg.dataLen);
+    /* Return this element to the free list. */
+    radioCmdPending[i].inUse = FALSE;
+    radioCmdPending[i].prev = RADIO_CPQ_NONE;
+    radioCmdPending[i].next = radioCmdPendingFree;
+    radioCmdPendingFree = i;
+    radioCmdPendingSlot[ident - RADIO_CMD_AUTO] = RADIO_CPQ_NONE;
 }
 
 
 /******************************************************************************
  *
- * radioProtocolFillAckDefaults
+ * radioCmdPendingGet
  *
  * PURPOSE
- *      This routine fills an SC ACK packet with default values
+ *      This routine finds the next eligible command to send.  The oldest
+ *      command enqueued for auto-send is returned first.  If there is none,
+ *      the retry timer wheel is advanced to the current time to find the
+ *      oldest timed-out command.  If an eligible command is found, it is
+ *      removed from the command-pending queue and returned to the caller.
  *
  * PARAMETERS
- *      pAckPacket  IN  pointer to uninitialized ACK packet
+ *      pIdent  OUT     If the return value is TRUE, this parameter is set to
+ *                      the identifier of a command to be sent or retried.
  *
  * RETURN VALUE
- *      None.
+ *      This routine returns TRUE if an eligible command was found to send or
+ *      retry.  This routine returns FALSE if no eligible command was found.
+ *
+ * NOTES
+ *      Each wheel slot holds the commands due in the seconds that map to
+ *      it, oldest first, so only the first member of a slot is checked.
+ *      At most RADIO_CPQ_WHEEL_SIZE slots are visited per call.
  *
  *****************************************************************************/
-static void radioProtocolFillAckDefaults(packetSCAckData_t *pAckPacket)
+static bool_t radioCmdPendingGet(uint8_t *pIdent)
 {
-    pAckPacket->command = SC_DEASSOCIATE;
-    pAckPacket->controlMacId = 0;
-    pAckPacket->hibTemp = SC_HIBERNATE_TEMP_C;
-    pAckPacket->hibThresTime = SC_HIBERNATE_THRES_TIME;
-    pAckPacket->sleepTime = SC_SLEEP_TIME;
-    pAckPacket->solenoidState = SC_ALL_CHAN_OFF;
+    uint8_t i;
+
+    /* First take the oldest command enqueued for auto-send. */
+    i = radioCmdPendingFirst[RADIO_CPQ_SEND_LIST];
+    if (i != RADIO_CPQ_NONE)
+    {
+        *pIdent = radioCmdPending[i].ident;
+        radioCmdPendingDelete(radioCmdPending[i].ident);
+        return TRUE;
+    }
+
+    /* Don't revisit the wheel more than once if the poll loop fell behind. */
+    if ((dtTickCount - radioCmdWheelTime) >= RADIO_CPQ_WHEEL_SIZE)
+    {
+        radioCmdWheelTime = dtTickCount - RADIO_CPQ_WHEEL_SIZE + 1;
+    }
+
+    /* Next advance the wheel to find a command that has timed-out. */
+    while ((int32_t)(dtTickCount - radioCmdWheelTime) >= 0)
+    {
+        i = radioCmdPendingFirst[radioCmdWheelTime % RADIO_CPQ_WHEEL_SIZE];
+        if ((i != RADIO_CPQ_NONE) &&
+            ((int32_t)(dtTickCount - radioCmdPending[i].timeDue) >= 0))
+        {
+            *pIdent = radioCmdPending[i].ident;
+            radioCmdPendingDelete(radioCmdPending[i].ident);
+            return TRUE;
+        }
+        radioCmdWheelTime++;
+    }
+
+    return FALSE;
 }
 
 
 /******************************************************************************
  *
- * radioProtocolRespSend
+ * radioDebugAtResponse
  *
  * PURPOSE
- *      This routine sends protocol response messages to the destination
- *      address specified in the received data packet.
+ *      This routine formats the AT command response received from an XBee
+ *      API AT command response packet and writes it to the debug output.
  *
  * PARAMETERS
- *      pPacket     IN  pointer to start of received data packet
- *      pMsg        IN  pointer to start of protocol response message
- *      msgType     IN  protocol message type
- *      length      IN  length of the protocol response message
+ *      pPacket     IN  pointer to XBee API AT Command response packet
  *
  * RETURN VALUE
  *      None.
  *
+ * NOTES
+ *      This routine currently supports only "AI" command responses.
+ *
  *****************************************************************************/
-static void radioProtocolRespSend(const radioRxDataPacket_t *pPacket,
-                                  const void *pMsg,
-                                  uint8_t msgType,
-                                  uint8_t length)
+static void radioDebugAtResponse(radioResponsePacket_t *pPacket)
 {
-    radioMsgHeader_t *pHdr = (radioMsgHeader_t *)pMsg;
-    uint32_t destH = U8TOU32(pPacket->phyAddr[0],
-                             pPacket->phyAddr[1],
-                             pPacket->phyAddr[2],
-                             pPacket->phyAddr[3]);
-    uint32_t destL = U8TOU32(pPacket->phyAddr[4],
-                             pPacket->phyAddr[5],
-                             pPacket->phyAddr[6],
-                             pPacket->phyAddr[7]);
-    uint16_t destN = U8TOU16(pPacket->netAddr[0], pPacket->netAddr[1]);
-
-    pHdr->version = RADIO_PROTOCOL_VER;
-    pHdr->msgType = msgType;
-    radioMsgInsertCrc(pMsg, length);
-    radioDataSend(radioDataFrameId(),
-                  destN,
-                  destH,
-                  destL,
-                  (uint8_t *)pMsg,
-                  length);
+    if (pPacket->frameId == RADIO_CMD_AI)
+    {
+        switch (pPacket->data[0])
+        {
+            case RADIO_AISTAT_JOINED:
+                debugWrite(" - AI status = JOINED");
+                break;
+            case RADIO_AISTAT_NOPANS:
+                debugWrite(" - AI status = NO PANS FOUND");
+                break;
+            case RADIO_AISTAT_NOVALPANS:
+                debugWrite(" - AI status = NO VALID PANS FOUND");
+                break;
+            case RADIO_AISTAT_NJEXP:
+                debugWrite(" - AI status = PAN NOT ALLOWING JOINS");
+                break;
+            case RADIO_AISTAT_NJFAIL:
+                debugWrite(" - AI status = JOIN ATTEMPT FAILED");
+                break;
+            case RADIO_AISTAT_COFAIL:
+                debugWrite(" - AI status = COORDINATOR START FAILED");
+                break;
+            case RADIO_AISTAT_CHECKING:
+                debugWrite(" - AI status = CHECKING FOR EXISTING COORDINATOR");
+                break;
+            case RADIO_AISTAT_SCANNING:
+                debugWrite(" - AI status = SCANNING FOR PARENT");
+                break;
+            default:
+                debugWrite(" - AI status = (unknown)");
+                break;
+        }
+    }
 }
 
 
 /******************************************************************************
  *
- * radioMsgInsertCrc
+ * radioMessageLog
  *
  * PURPOSE
- *      This routine calculates and inserts the correct CRC checksum into
- *      the caller's protocol message.
+ *      This routine logs a received radio message for radio communications
+ *      audit and debug use.
  *
  * PARAMETERS
- *      pMsg        IN/OUT  pointer to message
+ *      pMsgDesc    IN  pointer to message description string (up to 20 chars)
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      The message description string must be terminated with a null and
+ *      is truncated if longer than 20 characters.
+ *      Currently, only the last message is saved for audit purposes, however
+ *      if this routine is modified in the future to maintain a list of
+ *      previous messages, a more efficient date/time storage mechanism would
+ *      be desirable.
+ *      The date/time string only changes once per second, so it is only
+ *      reformatted when the tick count has advanced since the last message
+ *      (or the string has been cleared by the UI).
+ *
+ *****************************************************************************/
+static void radioMessageLog(const char *pMsgDesc)
+{
+    static uint32_t lastTick = 0;
+    char buf[41];
+    int len;
+
+    /* Safely copy message description string to global memory. */
+    len = (int)strlen(pMsgDesc);
+    if (len > 25)
+    {
+        len = 25;
+    }
+    memcpy(radioLastMsgDesc, pMsgDesc, len);
+    radioLastMsgDesc[len] = '\0';
+
+    if ((lastTick == dtTickCount) && (radioLastMsgDate[0] != '\0'))
+    {
+        return;
+    }
+    lastTick = dtTickCount;
+
+    /* Safely copy date/time string to global memory. */
+    dtFormatDebugDateTime(buf);
+    len = (int)strlen(buf);
+    if (len > 20)
+    {
+        len = 20;
+    }
+    memcpy(radioLastMsgDate, buf, len);
+    radioLastMsgDate[len] = '\0';
+}
+
+
+
+/******************************************************************************
  *
- * RETURN VALUE
- *      None.
+ *  RADIO FEATURE DEMO AND WINDOWS-BASED TEST EXTENSIONS
  *
  *****************************************************************************/
-void radioMsgInsertCrc(const void *pMsg, uint8_t length)
-{
-    uint16_t crc;
-    radioMsgHeader_t *hdr = (radioMsgHeader_t *)pMsg;
-
-    crc = crc16((uint8_t *)pMsg + 4, length - 4);
-
-    hdr->crcHigh = (uint8_t)(crc >> 8);
-    hdr->crcLow = (uint8_t)(crc & 0x00FF);
-}
 
 
 /******************************************************************************
  *
- * radioDataFrameId
+ * radioExtCommandHandler
  *
  * PURPOSE
- *      This routine is called to generate a Frame ID to use in the API header
- *      for ZigBee Transmit Data frames.  The Frame ID value is incremented on
- *      each call, until a maximum value is reached and the value wraps around
- *      to the beginning of its range.  This routine returns at least 100
- *      unique values before recycling.
+ *      This routine is called by the WOIS protocol command handler to handle
+ *      commands it doesn't recognize.  This routine provides Debug and Demo
+ *      command implementations outside the normal command handler.
  *
  * PARAMETERS
- *      None.
+ *      pPacket     IN      pointer to received command packet
  *
  * RETURN VALUE
- *      This routine returns a value for use in the Frame ID field of the
- *      ZigBee Tx Data API header.
+ *      None.
  *
  * NOTES
- *      The Frame ID is used to correlate ZigBee Transmit Status responses
- *      with their respective ZigBee Transmit Data frames.  This allows the
- *      potential for a ZigBee Tx Data frame to be retransmitted when a
- *      transmission failure is reported by the ZigBee radio module.
+ *      This routine contains hooks used on the Windows-based WOIS simulation
+ *      platform; these hooks are only compiled if the preprocessor definition
+ *      for "WIN32" is set.
  *
  *****************************************************************************/
-uint8_t radioDataFrameId(void)
+static void radioExtCommandHandler(const radioRxDataPacket_t *pPacket)
 {
-    uint8_t frameId = radioDataFrameIdNext;
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    uint8_t data[50];
+    bool_t msgSent = FALSE;
+    int i;
 
-    if (++radioDataFrameIdNext > RADIO_DATA_FRAME_ID_MAX)
+    /* Handle the command. */
+    switch (pMsg->cmd)
     {
-        radioDataFrameIdNext = RADIO_DATA_FRAME_ID_FIRST;
-    }
+        case RADIO_CMD_RC_TEST:
+            if (radioDebug)
+            {
+                debugWrite("WOIS Cmd: RC TEST\n");
+            }
+            radioProtocolAckSend(pPacket, RADIO_ACK_RC_TEST, NULL, 0);
+            break;
 
-    return (frameId);
+        case RADIO_CMD_RC_EVENT:
+            if (radioDebug)
+            {
+                debugWrite("WOIS Cmd: RC EVENT\n");
+            }
+            for (i = 0; i < pMsg->dataLen; i++)
+            {
+                drvKeypadPut(pMsg->data[i]);
+            }
+
+            /* DESIGN CHANGE NOTE:  Don't ACK remote control event commands. */
+            /* radioExtAckSend(pPacket, RADIO_ACK_RC_EVENT, NULL, 0); */
+
+            /* Yield remaining radio poll cycle so UI can process the event. */
+            radioYield = TRUE;
+            break;
+
+        case RADIO_CMD_RC_GETLCD:
+            if (radioDebug)
+            {
+                debugWrite("WOIS Cmd: RC GET LCD\n");
+            }
+            data[0] = uiPosition;
+            data[1] = (uiLcdCursor == DRV_LCD_CURSOR_OFF) ? 0xFF : uiLcdCursor;
+
+            /*
+            **  The Get LCD command sends a checksum of each of its four lines
+            **  of LCD data.  Compare these against checksums of the current
+            **  LCD content and send LCD data for each line that is different.
+            */
+            if (!radioCheckSumIsValid(uiLcdBuf, 40, pMsg->data[0], pMsg->data[1]))
+            {
+                data[2] = 0;
+                memcpy(&data[3], uiLcdBuf, 40);
+                radioExtAckSend(pPacket, RADIO_ACK_RC_GETLCD, data, 43);
+                msgSent = TRUE;
+            }
+
+            if (!radioCheckSumIsValid(uiLcdBuf + 40, 40, pMsg->data[2], pMsg->data[3]))
+            {
+                data[2] = 1;
+                memcpy(&data[3], uiLcdBuf + 40, 40);
+                radioExtAckSend(pPacket, RADIO_ACK_RC_GETLCD, data, 43);
+                msgSent = TRUE;
+            }
+
+            if (!radioCheckSumIsValid(uiLcdBuf + 80, 40, pMsg->data[4], pMsg->data[5]))
+            {
+                data[2] = 2;
+                memcpy(&data[3], uiLcdBuf + 80, 40);
+                radioExtAckSend(pPacket, RADIO_ACK_RC_GETLCD, data, 43);
+                msgSent = TRUE;
+            }
+
+            if (!radioCheckSumIsValid(uiLcdBuf + 120, 40, pMsg->data[6], pMsg->data[7]))
+            {
+                data[2] = 3;
+                memcpy(&data[3], uiLcdBuf + 120, 40);
+                radioExtAckSend(pPacket, RADIO_ACK_RC_GETLCD, data, 43);
+                msgSent = TRUE;
+            }
+
+            if (!msgSent)
+            {
+                /* No screen data changed, just send cursor and function. */
+                radioExtAckSend(pPacket, RADIO_ACK_RC_GETLCD, data, 2);
+            }
+
+            /* Yield for other subsystems to have a poll opportunity. */
+            radioYield = TRUE;
+            break;
+
+        case RADIO_CMD_RC_SUBLCD:
+            if (radioDebug)
+            {
+                debugWrite("WOIS Cmd: RC SUBSCRIBE LCD\n");
+            }
+            radioRcLcdSubscribe(pPacket);
+            break;
+
+        /* SAVE EVENT LOG */
+        case RADIO_CMD_EVENT_LOG:
+            if (pMsg->dataLen == 1)
+            {
+                if (pMsg->data[0] == 1)
+                {
+                    debugWrite("WOIS Cmd: Event Log Save\n");
+                    configEventLogSave();
+                }
+                else
+                {
+                    debugWrite("WOIS Cmd: Event Log Query\n");
+                }
+                data[0] = (uint8_t)(SYS_EVENT_LIMIT >> 8);
+                data[1] = (uint8_t)(SYS_EVENT_LIMIT & 0x00FF);
+                data[2] = (uint8_t)(sizeof(sysEventLog_t) >> 8);
+                data[3] = (uint8_t)(sizeof(sysEventLog_t) & 0x00FF);
+                data[4] = (uint8_t)(CONFIG_EVENT_LOG >> 8);
+                data[5] = (uint8_t)(CONFIG_EVENT_LOG & 0x00FF);
+                radioProtocolAckSend(pPacket, RADIO_ACK_EVENT_LOG, data, 6);
+            }
+            break;
+
+        case RADIO_CMD_GET_FW_VER:
+            if (radioDebug)
+            {
+                debugWrite("WOIS Cmd: Get Firmware Version\n");
+            }
+            data[0] = sysFirmwareVer.major;
+            data[1] = sysFirmwareVer.minor;
+            data[2] = sysFirmwareVer.patch;
+            data[3] = sysFirmwareVer.seq;
+            radioProtocolAckSend(pPacket, RADIO_ACK_GET_FW_VER, data, 4);
+            break;
+
+#ifdef WIN32
+        // These cases are for instrumenting remote control on the Windows platform.
+        case RADIO_ACK_RC_TEST:
+            RemoteControlTestAck((char *)pMsg->data, pMsg->dataLen);
+            break;
+
+        case RADIO_ACK_RC_EVENT:
+            RemoteControlEventAck(pMsg->msgId);
+            break;
+
+        case RADIO_ACK_RC_GETLCD:
+            RemoteControlGetLcdAck((char *)pMsg->data, pMsg->dataLen);
+            break;
+
+        case RADIO_ACK_GET_FW_VER:
+            GetFwVerAck((char *)pMsg->data, pMsg->dataLen);
+            break;
+
+        case RADIO_ACK_CFG_PUT_START:
+            CloneStartAck();
+            break;
+
+        case RADIO_ACK_CFG_PUT_APPLY:
+            CloneApplyAck(pMsg->data[10], U8TOU16(pMsg->data[11], pMsg->data[12]));
+            break;
+
+        case RADIO_ACK_CFG_GET_SNAP:
+            CloneUpStartAck();
+            break;
+
+        case RADIO_ACK_EVENT_LOG:
+            CloneEvtStartAck((char *)pMsg->data, pMsg->dataLen);
+            break;
+
+        case RADIO_ACK_GET_MOIST:
+            GetMoistAck((char *)pMsg->data, pMsg->dataLen);
+            break;
+
+        case RADIO_ACK_GET_EXSTAT:
+            GetExStatAck((char *)pMsg->data, pMsg->dataLen);
+            break;
+
+        case RADIO_ACK_GET_MB_VALUES:
+            GetMbValuesAck((char *)pMsg->data, pMsg->dataLen);
+            break;
+
+        case RADIO_ACK_SET_MB_VALUES:
+            SetMbValuesAck((char *)pMsg->data, pMsg->dataLen);
+            break;
+
+        case RADIO_ACK_WEATHER_DATA:
+            WeatherUpdateAck((char *)pMsg->data, pMsg->dataLen);
+            break;
+
+        case RADIO_ACK_INIT_DATETIME:
+            InitDateTimeAck((char *)pMsg->data, pMsg->dataLen);
+            break;
+#endif
+
+        default:
+            /* Unknown command. */
+            break;  /* not reached */
+    }
 }
 
 
 /******************************************************************************
  *
- * radioCmdPendingInit
+ * radioCheckSumIsValid
  *
  * PURPOSE
- *      This routine initializes the command-pending queue, setting all
- *      entries unused.
+ *      This routine is called to verify the CRC-16 checksum of a block of
+ *      data matches the high and low CRC bytes provided.
  *
  * PARAMETERS
- *      None.
+ *      pData   IN  pointer to start of data
+ *      lenData IN  length of data
+ *      sumH    IN  high byte of CRC checksum
+ *      sumL    IN  low byte of CRC checksum
  *
  * RETURN VALUE
- *      None.
+ *      This routine returns TRUE if the CRC-16 checksum of the provided data
+ *      matches the high and low CRC bytes provided; otherwise FALSE is
+ *      returned.
+ *
+ * NOTES
+ *      This routine is used by the remote control LCD screen get command.
  *
  *****************************************************************************/
-static void radioCmdPendingInit(void)
+static bool_t radioCheckSumIsValid(const void *pData,
+                                   uint8_t lenData,
+                                   uint8_t sumH,
+                                   uint8_t sumL)
 {
-    uint8_t i;
-
-    /* Initialize radio command pending list to empty. */
-    radioCmdPendingFirst = RADIO_CPQ_NONE;
-    radioCmdPendingLast = RADIO_CPQ_NONE;
+    uint16_t sum = crc16(pData, lenData);
 
-    for (i = 0; i < RADIO_CPQ_SIZE; i++)
-    {
-        radioCmdPending[i].inUse = FALSE;
-        radioCmdPending[i].prev = RADIO_CPQ_NONE;
-        radioCmdPending[i].next = RADIO_CPQ_NONE;
-    }
+    return ((sumH == (sum >> 8)) && (sumL == (sum & 0x00FF)));
 }
 
 
 /******************************************************************************
  *
- * radioCmdPendingAdd
+ * radioExtAckSend
  *
  * PURPOSE
- *      This routine adds a command to the command-pending queue.  If the
- *      command was just sent, the 'send' flag should be set to FALSE
- *      and the current time will be noted for command-retry purposes.
- *      If the caller wishes to enqueue a command for automatic sending,
- *      the 'send' flag should be set to TRUE.  The send time will be
- *      set to zero, informing the Command Retry Manager to send the command
- *      at its next opportunity.
+ *      This routine provides the same interface as the radioProtocolAckSend
+ *      function but sends command acknowledgement messages without the 10-byte
+ *      standard response data (serial number and current status).  The only
+ *      data sent in the command acknowledgement is the data provided by the
+ *      caller.  This routine allows smaller, more efficient response packets
+ *      and is intended for use with debug and remote control commands.
  *
  * PARAMETERS
- *      ident   IN  command identifier
- *      send    IN  Set to TRUE to request command to be enqueued for auto-send
- *                  with auto-retry if no response is received before time-out.
- *                  If the command has just been sent, set to FALSE to request
- *                  the command to be enqueued for auto-retry only.
+ *      pPacket     IN  pointer to start of received command packet
+ *      cmdAck      IN  application command acknowledgement response code
+ *      pData       IN  pointer to start of command response data
+ *      lenData     IN  length of the command response data
  *
  * RETURN VALUE
- *      Returns TRUE if the command was successfully added.  Returns FALSE
- *      if the command pending queue is full.
+ *      None.
  *
  *****************************************************************************/
-static bool_t radioCmdPendingAdd(uint8_t ident, bool_t send)
+static void radioExtAckSend(const radioRxDataPacket_t *pPacket,
+                            uint8_t cmdAck,
+                            const uint8_t *pData,
+                            uint8_t lenData)
 {
-    bool_t wasAdded = FALSE;
-    uint8_t i;
-
-    /* First delete any previous instances of this command. */
-    radioCmdPendingDelete(ident);
+    uint8_t pkt;
+    radioMsgAck_t *pMsg;
+    radioMsgCmd_t *cmdMsg = (radioMsgCmd_t *)&pPacket->data[0];
 
-    /* Now add this command to the pending queue. */
-    for (i = 0; i < RADIO_CPQ_SIZE; i++)
+    /* Build the acknowledgement directly in a packet buffer. */
+    pkt = radioPktAlloc();
+    if (pkt == RADIO_PKT_NONE)
     {
-        /* Find an empty slot in the array. */
-        if (!radioCmdPending[i].inUse)
-        {
-            /* Mark slot in use. */
-            radioCmdPending[i].inUse = TRUE;
-            /* Store command identifier. */
-            radioCmdPending[i].ident = ident;
-            if (send)
-            {
-                /* Set time value to elicit immediate retry. */
-                radioCmdPending[i].timeSent = RADIO_CPQ_AUTOSEND;
-            }
-            else
-            {
-                /* Store current time tick count. */
-                radioCmdPending[i].timeSent = dtTickCount;
-            }
-            /* Update forward and backward links. */
-            radioCmdPending[i].prev = radioCmdPendingLast;
-            radioCmdPending[i].next = RADIO_CPQ_NONE;
-            if (radioCmdPendingLast != RADIO_CPQ_NONE)
-            {
-                /* Link last member to this new member. */
-                radioCmdPending[radioCmdPendingLast].next = i;
-            }
-            /* Set last member to this new member. */
-            radioCmdPendingLast = i;
-            /* Check if a first member already exists. */
-            if (radioCmdPendingFirst == RADIO_CPQ_NONE)
-            {
-                /* Set first member to this new member. */
-                radioCmdPendingFirst = i;
-            }
-            wasAdded = TRUE;
-            break;
-        }
+        return;
     }
+    pMsg = (radioMsgAck_t *)radioPktData(pkt);
 
-    return wasAdded;
+    pMsg->msgId = cmdMsg->msgId;
+    pMsg->cmd = cmdAck;
+    pMsg->dataLen = lenData;
+
+    memcpy(pMsg->data, pData, lenData);
+
+    radioProtocolPktRespSend(pPacket,
+                             pkt,
+                             RADIO_TYPE_ACK,
+                             RADIO_CMD_HEADER_SIZE + pMsg->dataLen);
+    radioPktRelease(pkt);
 }
 
 
 /******************************************************************************
  *
- * radioCmdPendingDelete
+ * radioRcLcdSubscribe
  *
  * PURPOSE
- *      This routine removes a command from the command-pending queue.  All
- *      instances of the command are removed.
+ *      This routine handles the Remote Control Subscribe LCD command, which
+ *      registers (or renews, or cancels) a subscription to LCD changes.
  *
  * PARAMETERS
- *      ident       IN  command identifier
+ *      pPacket     IN      pointer to received command packet
  *
  * RETURN VALUE
  *      None.
  *
+ * NOTES
+ *      Command data is:
+ *          [0] minimum push interval in 100 ms units (0 = unsubscribe)
+ *          [1] flags (RADIO_RC_LCD_FULL to resend the full screen)
+ *
+ *      A new subscriber, or a subscriber asking for a resync (e.g. after a
+ *      gap in push sequence numbers), is sent the full screen on the next
+ *      push.  Only one subscriber is kept; a new one replaces the old one.
+ *      The subscription lapses unless the command is repeated within
+ *      RADIO_RC_LCD_LEASE_MS.
+ *
+ *      The ack echoes the accepted interval and the lease in seconds.
+ *
  *****************************************************************************/
-static void radioCmdPendingDelete(uint8_t ident)
+static void radioRcLcdSubscribe(const radioRxDataPacket_t *pPacket)
 {
-    uint8_t i;
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    uint8_t data[2];
+    uint16_t interval;
+    bool_t full = FALSE;
 
-    for (i = 0; i < RADIO_CPQ_SIZE; i++)
+    interval = (pMsg->dataLen >= 1) ? (uint16_t)(pMsg->data[0] * 100) : 0;
+    if (pMsg->dataLen >= 2)
+    {
+        full = ((pMsg->data[1] & RADIO_RC_LCD_FULL) != 0);
+    }
+
+    if (interval == 0)
+    {
+        radioRcLcdActive = FALSE;
+    }
+    else
     {
-        if (radioCmdPending[i].inUse)
+        if (interval < RADIO_RC_LCD_MIN_MS)
         {
-            if (radioCmdPending[i].ident == ident)
-            {
-                /* Unlink this element from the linked-list. */
-                if (radioCmdPending[i].prev != RADIO_CPQ_NONE)
-                {
-                    /* Update previous link member's next index. */
-                    radioCmdPending[radioCmdPending[i].prev].next =
-                        radioCmdPending[i].next;
-                }
-                else
-                {
-                    /* This element was first in list. Update first index. */
-                    radioCmdPendingFirst = radioCmdPending[i].next;
-                }
-                if (radioCmdPending[i].next != RADIO_CPQ_NONE)
-                {
-                    /* Update next link member's prev index. */
-                    radioCmdPending[radioCmdPending[i].next].prev =
-                        radioCmdPending[i].prev;
-                }
-                else
-                {
-                    /* This element was last in list. Update last index. */
-                    radioCmdPendingLast = radioCmdPending[i].prev;
-                }
-                /* Clean-up this deleted array element. */
-                radioCmdPending[i].inUse = FALSE;
-                radioCmdPending[i].prev = RADIO_CPQ_NONE;
-                radioCmdPending[i].next = RADIO_CPQ_NONE;
-            }
+            interval = RADIO_RC_LCD_MIN_MS;
+        }
+        if (!radioRcLcdActive ||
+            (memcmp(radioRcLcdAddr, pPacket->phyAddr, RADIO_SZ_MAC_ID) != 0))
+        {
+            full = TRUE;
+        }
+        if (full)
+        {
+            /* Shadow never matches the LCD buffer, which has no nulls. */
+            memset(radioRcLcdShadow, '\0', sizeof(radioRcLcdShadow));
+            radioRcLcdPosition = 0xFF;
+            radioRcLcdGen = (uint8_t)(uiLcdGen - 1);
+            radioRcLcdSeq = 0xFF;
         }
+        memcpy(radioRcLcdAddr, pPacket->phyAddr, RADIO_SZ_MAC_ID);
+        memcpy(&radioRcLcdAddr[RADIO_SZ_MAC_ID],
+               pPacket->netAddr,
+               RADIO_SZ_NET_AD);
+        radioRcLcdMsgId = pMsg->msgId;
+        radioRcLcdInterval = interval;
+        radioRcLcdRenewTime = drvMSGet();
+        radioRcLcdTime = radioRcLcdRenewTime - interval;
+        radioRcLcdActive = TRUE;
     }
+
+    data[0] = (uint8_t)(interval / 100);
+    data[1] = (uint8_t)(RADIO_RC_LCD_LEASE_MS / 1000);
+    radioExtAckSend(pPacket, RADIO_ACK_RC_SUBLCD, data, sizeof(data));
 }
 
 
 /******************************************************************************
  *
- * radioCmdPendingGet
+ * radioRcLcdPoll
  *
  * PURPOSE
- *      This routine searches the command pending queue to find the next
- *      eligible command to send.  The queue is first searched for the oldest
- *      command that has been enqueued for auto-send.
- *      If no auto-send commands are found, then the queue is searched for the
- *      the oldest timed-out command.  If an eligible command is found, it is
- *      removed from the command-pending queue and returned to the caller.
+ *      This routine is called from the radio polling loop to push LCD
+ *      changes to the remote control subscriber, if any.
  *
  * PARAMETERS
- *      pIdent  OUT     If the return value is TRUE, this parameter is set to
- *                      the identifier of a command to be sent or retried.
+ *      None.
  *
  * RETURN VALUE
- *      This routine returns TRUE if an eligible command was found to send or
- *      retry.  This routine returns FALSE if no eligible command was found.
+ *      None.
+ *
+ * NOTES
+ *      At most one push is sent per subscription interval, and only when the
+ *      UI has updated the LCD since the last push.  Each push carries:
+ *          [0] sequence number (incremented per push)
+ *          [1] function switch position
+ *          [2] cursor location (0xFF = off)
+ *      followed by changed runs of the LCD buffer, each as offset, length
+ *      and characters.  Runs that don't fit are sent in the next push.
  *
  *****************************************************************************/
-static bool_t radioCmdPendingGet(uint8_t *pIdent)
+static void radioRcLcdPoll(void)
 {
+    radioRxDataPacket_t packet;
+    uint8_t data[RADIO_MAXAPPDATA];
+    uint8_t len;
+    uint8_t cursor;
+    uint8_t start;
+    uint8_t end;
+    uint8_t run;
     uint8_t i;
 
-    /* First search for a command enqueued for auto-send. */
-    i = radioCmdPendingFirst;
-    while (i != RADIO_CPQ_NONE)
+    if (!radioRcLcdActive)
     {
-        if (radioCmdPending[i].timeSent == RADIO_CPQ_AUTOSEND)
-        {
-            *pIdent = radioCmdPending[i].ident;
-            radioCmdPendingDelete(radioCmdPending[i].ident);
-            return TRUE;
-        }
-        i = radioCmdPending[i].next;
+        return;
+    }
+    if ((drvMSGet() - radioRcLcdRenewTime) > RADIO_RC_LCD_LEASE_MS)
+    {
+        /* Subscriber has gone away. */
+        radioRcLcdActive = FALSE;
+        return;
+    }
+    if ((radioRcLcdGen == uiLcdGen) ||
+        ((drvMSGet() - radioRcLcdTime) < radioRcLcdInterval) ||
+        (radioStatus != RADIO_STATUS_ONLINE))
+    {
+        return;
     }
-    /* Next search for a command that has timed-out. */
-    i = radioCmdPendingFirst;
-    while (i != RADIO_CPQ_NONE)
+
+    cursor = (uiLcdCursor == (uint8_t)DRV_LCD_CURSOR_OFF) ? 0xFF : uiLcdCursor;
+    data[0] = (uint8_t)(radioRcLcdSeq + 1);
+    data[1] = uiPosition;
+    data[2] = cursor;
+    len = RADIO_RC_LCD_HDR;
+
+    /* Collect changed runs while they fit in the message. */
+    i = 0;
+    while ((i < sizeof(uiLcdBuf)) && (len + 3 <= sizeof(data)))
     {
-        if (dtElapsedSeconds(radioCmdPending[i].timeSent) > RADIO_CMD_RETRY_SECS)
+        if (uiLcdBuf[i] == radioRcLcdShadow[i])
         {
-            *pIdent = radioCmdPending[i].ident;
-            radioCmdPendingDelete(radioCmdPending[i].ident);
-            return TRUE;
+            i++;
+            continue;
+        }
+        start = i;
+        end = i + 1;
+        /* Extend the run over short unchanged gaps (cheaper than a header). */
+        while ((end < sizeof(uiLcdBuf)) &&
+               ((uiLcdBuf[end] != radioRcLcdShadow[end]) ||
+                ((end + 2 < sizeof(uiLcdBuf)) &&
+                 ((uiLcdBuf[end + 1] != radioRcLcdShadow[end + 1]) ||
+                  (uiLcdBuf[end + 2] != radioRcLcdShadow[end + 2])))))
+        {
+            end++;
+        }
+        run = end - start;
+        if (run > sizeof(data) - len - 2)
+        {
+            run = (uint8_t)(sizeof(data) - len - 2);
         }
-        i = radioCmdPending[i].next;
+        data[len++] = start;
+        data[len++] = run;
+        memcpy(&data[len], &uiLcdBuf[start], run);
+        memcpy(&radioRcLcdShadow[start], &uiLcdBuf[start], run);
+        len += run;
+        i = start + run;
     }
 
-    return FALSE;
+    if ((i >= sizeof(uiLcdBuf)) ||
+        (memcmp(&uiLcdBuf[i], &radioRcLcdShadow[i], sizeof(uiLcdBuf) - i) == 0))
+    {
+        /* Subscriber is now up to date with this LCD update. */
+        radioRcLcdGen = uiLcdGen;
+    }
+
+    if ((len == RADIO_RC_LCD_HDR) &&
+        (uiPosition == radioRcLcdPosition) &&
+        (cursor == radioRcLcdCursor))
+    {
+        /* Screen was redrawn without changing. */
+        return;
+    }
+
+    /* Rebuild enough of a command packet to address the ack. */
+    memcpy(packet.phyAddr, radioRcLcdAddr, RADIO_SZ_MAC_ID);
+    memcpy(packet.netAddr, &radioRcLcdAddr[RADIO_SZ_MAC_ID], RADIO_SZ_NET_AD);
+    ((radioMsgCmd_t *)&packet.data[0])->msgId = radioRcLcdMsgId;
+
+    radioExtAckSend(&packet, RADIO_ACK_RC_LCDDELTA, data, len);
+    radioRcLcdSeq++;
+    radioRcLcdPosition = uiPosition;
+    radioRcLcdCursor = cursor;
+    radioRcLcdTime = drvMSGet();
 }
 
 
+
 /******************************************************************************
  *
- * radioDebugAtResponse
+ *  RADIO SENSOR CONCENTRATOR FUNCTIONS
+ *
+ *****************************************************************************/
+
+/******************************************************************************
+ *
+ * radioCheckSensorAssocList
  *
  * PURPOSE
- *      This routine formats the AT command response received from an XBee
- *      API AT command response packet and writes it to the debug output.
+ *      This routine provides the same interface as the radioProtocolAckSend
+ *      function but sends command acknowledgement messages without the 10-byte
+ *      standard response data (serial number and current status).  The only
+ *      data sent in the command acknowledgement is the data provided by the
+ *      caller.  This routine allows smaller, more efficient response packets
+ *      and is intended for use with debug and remote control commands.
  *
  * PARAMETERS
- *      pPacket     IN  pointer to XBee API AT Command response packet
+ *      sensorMAC     IN  MAC ID of sensor concentrator that sent message
  *
  * RETURN VALUE
- *      None.
- *
- * NOTES
- *      This routine currently supports only "AI" command responses.
+ *      uint8_t    returns the index in the list at which MAC was found.
+ *                 returns MAX_NUM_SC if not found.
  *
  *****************************************************************************/
-static void radioDebugAtResponse(radioResponsePacket_t *pPacket)
+static uint8_t radioCheckSensorAssocList(uint64_t sensorMAC)
 {
-    if (pPacket->frameId == RADIO_CMD_AI)
-    {
-        switch (pPacket->data[0])
-        {
-            case RADIO_AISTAT_JOINED:
-                debugWrite(" - AI status = JOINED");
-                break;
-            case RADIO_AISTAT_NOPANS:
-                debugWrite(" - AI status = NO PANS FOUND");
-                break;
-            case RADIO_AISTAT_NOVALPANS:
-                debugWrite(" - AI status = NO VALID PANS FOUND");
-                break;
-            case RADIO_AISTAT_NJEXP:
-                debugWrite(" - AI status = PAN NOT ALLOWING JOINS");
-                break;
-            case RADIO_AISTAT_NJFAIL:
-                debugWrite(" - AI status = JOIN ATTEMPT FAILED");
-                break;
-            case RADIO_AISTAT_COFAIL:
-                debugWrite(" - AI status = COORDINATOR START FAILED");
-                break;
-            case RADIO_AISTAT_CHECKING:
-                debugWrite(" - AI status = CHECKING FOR EXISTING COORDINATOR");
-                break;
-            case RADIO_AISTAT_SCANNING:
-                debugWrite(" - AI status = SCANNING FOR PARENT");
-                break;
-            default:
-                debugWrite(" - AI status = (unknown)");
-                break;
-        }
-    }
+   uint8_t  i;
+   uint8_t retIndex = MAX_NUM_SC;
+   
+   for(i=0; i<MAX_NUM_SC; i++)
+   {
+      if(config.sys.assocSensorCon[i].macId == sensorMAC)
+      {
+          retIndex =i;
+          break;
+      }
+   }
+   
+   return retIndex;      
 }
 
 
 /******************************************************************************
  *
- * radioMessageLog
+ * radioAddSensorAssocList
  *
  * PURPOSE
- *      This routine logs a received radio message for radio communications
- *      audit and debug use.
+ *      This routine provides the same interface as the radioProtocolAckSend
+ *      function but sends command acknowledgement messages without the 10-byte
+ *      standard response data (serial number and current status).  The only
+ *      data sent in the command acknowledgement is the data provided by the
+ *      caller.  This routine allows smaller, more efficient response packets
+ *      and is intended for use with debug and remote control commands.
  *
  * PARAMETERS
- *      pMsgDesc    IN  pointer to message description string (up to 20 chars)
+ *      sensorMAC     IN  MAC ID of sensor concentrator that sent message
  *
  * RETURN VALUE
- *      None.
- *
- * NOTES
- *      The message description string must be terminated with a null and
- *      is truncated if longer than 20 characters.
- *      Currently, only the last message is saved for audit purposes, however
- *      if this routine is modified in the future to maintain a list of
- *      previous messages, a more efficient date/time storage mechanism would
- *      be desirable.
- *
- *****************************************************************************/
-static void radioMessageLog(const char *pMsgDesc)
-{
-    char buf[41];
-    int len;
-
-    /* Safely copy message description string to global memory. */
-    len = (int)strlen(pMsgDesc);
-    if (len > 25)
-    {
-        len = 25;
-    }
-    memcpy(radioLastMsgDesc, pMsgDesc, len);
-    radioLastMsgDesc[len] = '\0';
-
-    /* Safely copy date/time string to global memory. */
-    dtFormatDebugDateTime(buf);
-    len = (int)strlen(buf);
-    if (len > 20)
-    {
-        len = 20;
-    }
-    memcpy(radioLastMsgDate, buf, len);
-    radioLastMsgDate[len] = '\0';
-}
-
-
-
-/******************************************************************************
- *
- *  RADIO FEATURE DEMO AND WINDOWS-BASED TEST EXTENSIONS
+ *      uint_8    index in associated sensor list where it was added.
  *
  *****************************************************************************/
-
+uint8_t radioAddSensorAssocList(uint64_t sensorMAC)
+{
+   uint8_t  i;
+   bool_t retIndex = MAX_NUM_SC;
+   
+   for(i=0; i<MAX_NUM_SC; i++)
+   {
+      if(config.sys.assocSensorCon[i].macId == 0)
+      {
+          retIndex=i;
+          config.sys.assocSensorCon[i].macId = sensorMAC;
+          config.sys.numSensorCon += 1;
+          break;
+      }
+   }
+   
+   return retIndex;      
+}
 
 /******************************************************************************
  *
- * radioExtCommandHandler
+ * radioRemoveSensorAssocList
  *
  * PURPOSE
- *      This routine is called by the WOIS protocol command handler to handle
- *      commands it doesn't recognize.  This routine provides Debug and Demo
- *      command implementations outside the normal command handler.
+ *      This routine removes a sensor concentrator MAC ID from the associated
+ *      list.  It does this by setting that list index to 0. This returns the 
+ *      that it was removed from.
  *
  * PARAMETERS
- *      pPacket     IN      pointer to received command packet
+ *      sensorMAC     IN  MAC ID of sensor concentrator that sent message
  *
  * RETURN VALUE
- *      None.
- *
- * NOTES
- *      This routine contains hooks used on the Windows-based WOIS simulation
- *      platform; these hooks are only compiled if the preprocessor definition
- *      for "WIN32" is set.
+ *      uint_8    index in associated sensor list where it was removed from.
  *
  *****************************************************************************/
-static void radioExtCommandHandler(const radioRxDataPacket_t *pPacket)
+uint8_t radioRemoveSensorAssocList(uint64_t sensorMAC)
 {
-    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
-    uint8_t data[50];
-    bool_t msgSent = FALSE;
-    int i;
+    uint8_t  i, j;
+    bool_t retIndex = MAX_NUM_SC;
+    uint8_t chanZone;
+    int8_t assocSensorConIndex;
 
-    /* Handle the command. */
-    switch (pMsg->cmd)
+    // find the index in config.sys.assocSensorCon of the provided sensorMAC
+    assocSensorConIndex = -1;
+    for(i = 0; i < MAX_NUM_SC; i++)
     {
-        case RADIO_CMD_RC_TEST:
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: RC TEST\n");
-            }
-            radioProtocolAckSend(pPacket, RADIO_ACK_RC_TEST, NULL, 0);
-            break;
-
-        case RADIO_CMD_RC_EVENT:
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: RC EVENT\n");
-            }
-            for (i = 0; i < pMsg->dataLen; i++)
-            {
-                drvKeypadPut(pMsg->data[i]);
-            }
-
-            /* DESIGN CHANGE NOTE:  Don't ACK remote control event commands. */
-            /* radioExtAckSend(pPacket, RADIO_ACK_RC_EVENT, NULL, 0); */
-
-            /* Yield remaining radio poll cycle so UI can process the event. */
-            radioYield = TRUE;
+        if(config.sys.assocSensorCon[i].macId == sensorMAC)
+        {
+            assocSensorConIndex = i;
             break;
+        }
+    }
 
-        case RADIO_CMD_RC_GETLCD:
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: RC GET LCD\n");
-            }
-            data[0] = uiPosition;
-            data[1] = (uiLcdCursor == DRV_LCD_CURSOR_OFF) ? 0xFF : uiLcdCursor;
-
-            /*
-            **  The Get LCD command sends a checksum of each of its four lines
-            **  of LCD data.  Compare these against checksums of the current
-            **  LCD content and send LCD data for each line that is different.
-            */
-            if (!radioCheckSumIsValid(uiLcdBuf, 40, pMsg->data[0], pMsg->data[1]))
-            {
-                data[2] = 0;
-                memcpy(&data[3], uiLcdBuf, 40);
-                radioExtAckSend(pPacket, RADIO_ACK_RC_GETLCD, data, 43);
-                msgSent = TRUE;
-            }
-
-            if (!radioCheckSumIsValid(uiLcdBuf + 40, 40, pMsg->data[2], pMsg->data[3]))
-            {
-                data[2] = 1;
-                memcpy(&data[3], uiLcdBuf + 40, 40);
-                radioExtAckSend(pPacket, RADIO_ACK_RC_GETLCD, data, 43);
-                msgSent = TRUE;
-            }
-
-            if (!radioCheckSumIsValid(uiLcdBuf + 80, 40, pMsg->data[4], pMsg->data[5]))
-            {
-                data[2] = 2;
-                memcpy(&data[3], uiLcdBuf + 80, 40);
-                radioExtAckSend(pPacket, RADIO_ACK_RC_GETLCD, data, 43);
-                msgSent = TRUE;
-            }
-
-            if (!radioCheckSumIsValid(uiLcdBuf + 120, 40, pMsg->data[6], pMsg->data[7]))
-            {
-                data[2] = 3;
-                memcpy(&data[3], uiLcdBuf + 120, 40);
-                radioExtAckSend(pPacket, RADIO_ACK_RC_GETLCD, data, 43);
-                msgSent = TRUE;
-            }
-
-            if (!msgSent)
-            {
-                /* No screen data changed, just send cursor and function. */
-                radioExtAckSend(pPacket, RADIO_ACK_RC_GETLCD, data, 2);
-            }
-
-            /* Yield for other subsystems to have a poll opportunity. */
-            radioYield = TRUE;
-            break;
+    // clear out measurement storage as well
+    snsConInfo[assocSensorConIndex].chargeRate = 0;
+    snsConInfo[assocSensorConIndex].battVoltage = 0;
+    snsConInfo[assocSensorConIndex].solenoidState = 0;
+    config.sys.assocSensorCon[assocSensorConIndex].macId = 0;
+    scDeleteList[assocSensorConIndex] = FALSE;
+    
+    //Look to see if any other SCs after this one are marked for deleteion
+            
+    for(i= assocSensorConIndex; i<MAX_NUM_SC; i++)
+    {
+      if(scDeleteList[i] == TRUE)
+      {
+        //Move remaining SCs up one in the list to keep the position correct
+        while( i< MAX_NUM_SC)
+        {
+          scDeleteList[i-1] = scDeleteList[i]; 
+          i++;
+        }
+        break;
+      }
+    }
 
-        /* SAVE EVENT LOG */
-        case RADIO_CMD_EVENT_LOG:
-            if (pMsg->dataLen == 1)
-            {
-                if (pMsg->data[0] == 1)
-                {
-                    debugWrite("WOIS Cmd: Event Log Save\n");
-                    configEventLogSave();
-                }
-                else
-                {
-                    debugWrite("WOIS Cmd: Event Log Query\n");
-                }
-                data[0] = (uint8_t)(SYS_EVENT_LIMIT >> 8);
-                data[1] = (uint8_t)(SYS_EVENT_LIMIT & 0x00FF);
-                data[2] = (uint8_t)(sizeof(sysEventLog_t) >> 8);
-                data[3] = (uint8_t)(sizeof(sysEventLog_t) & 0x00FF);
-                data[4] = (uint8_t)(CONFIG_EVENT_LOG >> 8);
-                data[5] = (uint8_t)(CONFIG_EVENT_LOG & 0x00FF);
-                radioProtocolAckSend(pPacket, RADIO_ACK_EVENT_LOG, data, 6);
-            }
-            break;
+    
+    if(config.sys.numSensorCon != 0)
+    {
+        config.sys.numSensorCon -= 1;
+    }
 
-        case RADIO_CMD_GET_FW_VER:
-            if (radioDebug)
-            {
-                debugWrite("WOIS Cmd: Get Firmware Version\n");
-            }
-            data[0] = sysFirmwareVer.major;
-            data[1] = sysFirmwareVer.minor;
-            data[2] = sysFirmwareVer.patch;
-            data[3] = sysFirmwareVer.seq;
-            radioProtocolAckSend(pPacket, RADIO_ACK_GET_FW_VER, data, 4);
-            break;
+    // change the zone settings back to defaults and no sensor for each zone
+    // associated with this sensor concentrator
+    for(i = 0; i < SC_NUM_CHAN_UNIT; i++)
+    {
+        chanZone = config.sys.assocSensorCon[assocSensorConIndex].channelZone[i];
+        if(chanZone != SC_CHAN_NOT_ASSIGNED)
+        {
+            config.zone[chanZone].snsConChan = SC_NONE_SELECTED;
+            config.zone[chanZone].snsConTableIndex = ZONE_SC_INDEX_NONE;
+            config.zone[chanZone].sensorType = SNS_NONE;
+            config.zone[chanZone].group = CONFIG_GROUP_NONE;
+        }
+        config.sys.assocSensorCon[assocSensorConIndex].channelZone[i] = SC_CHAN_NOT_ASSIGNED;
+    }
 
-#ifdef WIN32
-        // These cases are for instrumenting remote control on the Windows platform.
-        case RADIO_ACK_RC_TEST:
-            RemoteControlTestAck((char *)pMsg->data, pMsg->dataLen);
-            break;
+    // Clean up items from config.zone where the snsConTableIndex to be
+    // removed is referenced (but not a part of channelZone).
+    for(i = 0; i < SYS_N_ZONES; i++)
+    {
+        if (config.zone[i].snsConTableIndex == assocSensorConIndex)
+        {
+            config.zone[i].snsConChan = SC_NONE_SELECTED;
+            config.zone[i].snsConTableIndex = ZONE_SC_INDEX_NONE;
+            config.zone[i].sensorType = SNS_NONE;
+            config.zone[i].group = CONFIG_GROUP_NONE;
+        }
+    }
 
-        case RADIO_ACK_RC_EVENT:
-            RemoteControlEventAck(pMsg->msgId);
-            break;
+    // Move the remaining SCs down one.  This allows us to maintain the
+    // invariant that is always the lowest indices of assocSensorCon that
+    // are filled.  For each sensor concentrator shifted, we must also change
+    // the index pointers (for now, just zones)
+    for(i = assocSensorConIndex; i < MAX_NUM_SC; i++)
+    {
+         if(config.sys.assocSensorCon[i+1].macId != 0)
+         {
+             // update assocSensorCon
+             config.sys.assocSensorCon[i].macId = config.sys.assocSensorCon[i+1].macId;
+             config.sys.assocSensorCon[i + 1].macId = 0;
+             config.sys.assocSensorCon[i].zoneRange = config.sys.assocSensorCon[i+1].zoneRange;
+             config.sys.assocSensorCon[i + 1].zoneRange = 0;
+             for (j = 0; j < sizeof(config.sys.assocSensorCon[i + 1].channelZone); j++)
+             {
+                 config.sys.assocSensorCon[i].channelZone[j] = config.sys.assocSensorCon[i+1].channelZone[j];
+                 config.sys.assocSensorCon[i + 1].channelZone[j] = 0;
+             }
 
-        case RADIO_ACK_RC_GETLCD:
-            RemoteControlGetLcdAck((char *)pMsg->data, pMsg->dataLen);
-            break;
+             // update snsConInfo array
+             snsConInfo[i].battVoltage = snsConInfo[i + 1].battVoltage;
+             snsConInfo[i + 1].battVoltage = 0;
+             snsConInfo[i].chargeRate = snsConInfo[i + 1].chargeRate;
+             snsConInfo[i + 1].chargeRate = 0;
+             snsConInfo[i].solenoidState = snsConInfo[i + 1].solenoidState;
+             snsConInfo[i + 1].solenoidState = 0;
 
-        case RADIO_ACK_GET_FW_VER:
-            GetFwVerAck((char *)pMsg->data, pMsg->dataLen);
-            break;
+             // scan zones for any zones referencing the old index.  Update that
+             // zone to point to index x - 1 where x is the previous index.
+             for (j = 0; j < MAX_NUM_SC; j++)
+             {
+                 if (config.zone[j].snsConTableIndex == (i + 1))
+                 {
+                     config.zone[j].snsConTableIndex = i;
+                 }
+             }
+         }
+    }
 
-        case RADIO_ACK_CFG_PUT_START:
-            CloneStartAck();
-            break;
+   return assocSensorConIndex;
+}
 
-        case RADIO_ACK_CFG_PUT_APPLY:
-            CloneApplyAck(pMsg->data[10], U8TOU16(pMsg->data[11], pMsg->data[12]));
-            break;
 
-        case RADIO_ACK_CFG_GET_SNAP:
-            CloneUpStartAck();
-            break;
+/******************************************************************************
+ *
+ *  RADIO EXPANSION BUS FUNCTIONS
+ *
+ *****************************************************************************/
+ 
+ 
+/******************************************************************************
+ *
+ * expansionBusForwardCmd
+ *
+ * PURPOSE
+ *      This routine forwards on a WOIS command message to the expansion
+ *      units for them to respond to. This is also used for the master to send
+ *      a command to all of the expansion units at the same time.
+ *
+ * PARAMETERS
+ *      pPacket   the packet that was received and needs to be forwarded on
+ *
+ * RETURN VALUE
+ *      void
+ *
+ *****************************************************************************/
+static void expansionBusForwardCmd(const radioRxDataPacket_t *pPacket)
+{
+    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
+    uint16_t destN= U8TOU16(pPacket->netAddr[0], pPacket->netAddr[1]);
+    uint8_t length = RADIO_CMD_HEADER_SIZE + pMsg->dataLen;
+    uint8_t pkt;
+    
+    if (length > RADIO_MAXPAYLOAD)
+    {
+        return;
+    }
+    
+    /* copy the message once, each expansion unit shares the packet buffer */
+    pkt = radioPktAlloc();
+    if (pkt == RADIO_PKT_NONE)
+    {
+        return;
+    }
+    memcpy(radioPktData(pkt), pMsg, length);
+    expansionBusForwardPkt(pkt, destN, length);
+    radioPktRelease(pkt);
+}
 
-        case RADIO_ACK_EVENT_LOG:
-            CloneEvtStartAck((char *)pMsg->data, pMsg->dataLen);
-            break;
 
-        case RADIO_ACK_GET_MOIST:
-            GetMoistAck((char *)pMsg->data, pMsg->dataLen);
-            break;
+/******************************************************************************
+ *
+ * expansionBusForwardPkt
+ *
+ * PURPOSE
+ *      This routine sends a WOIS command message held in a packet buffer to
+ *      each of the expansion units.  The units share the one packet buffer.
+ *
+ * PARAMETERS
+ *      pkt       packet buffer holding the command message
+ *      destN     destination network address
+ *      length    length of the command message
+ *
+ * RETURN VALUE
+ *      void
+ *
+ *****************************************************************************/
+static void expansionBusForwardPkt(uint8_t pkt, uint16_t destN, uint8_t length)
+{
+    uint32_t destH;
+    uint32_t destL;
+    
+    switch(config.sys.numUnits)
+    {
+      case 3:
+          if(config.sys.expMac3 != 0x0013A20000000000)
+          {
+            radioExp3RespTime = dtTickCount;  /* set time counter for timeout response */
+            radioSentExpan3Msg = TRUE;
+            destH = (uint32_t)(config.sys.expMac3 >>32);
+            destL = (uint32_t)(config.sys.expMac3 & 0xFFFFFFFF); 
+            radioPktSend(radioDataFrameId(),
+                        destN,
+                        destH,
+                        destL,
+                        pkt,
+                        length);
+          }
+      case 2:
+          if(config.sys.expMac2 != 0x0013A20000000000)
+          {
+            radioExp2RespTime = dtTickCount;  /* set time counter for timeout response */
+            radioSentExpan2Msg = TRUE;
+            destH = (uint32_t)(config.sys.expMac2 >>32);
+            destL = (uint32_t)(config.sys.expMac2 & 0xFFFFFFFF); 
+            radioPktSend(radioDataFrameId(),
+                        destN,
+                        destH,
+                        destL,
+                        pkt,
+                        length);
+          }
 
-        case RADIO_ACK_GET_EXSTAT:
-            GetExStatAck((char *)pMsg->data, pMsg->dataLen);
-            break;
+      case 1:
+          if(config.sys.expMac1 != 0x0013A20000000000)
+          {
+            radioExp1RespTime = dtTickCount;  /* set time counter for timeout response */
+            radioSentExpan1Msg = TRUE;
+            destH = (uint32_t)(config.sys.expMac1 >>32);
+            destL = (uint32_t)(config.sys.expMac1 & 0xFFFFFFFF); 
+            radioPktSend(radioDataFrameId(),
+                        destN,
+                        destH,
+                        destL,
+                        pkt,
+                        length);
+          }
+      default:
+          break;
+    }
 
-        case RADIO_ACK_GET_MB_VALUES:
-            GetMbValuesAck((char *)pMsg->data, pMsg->dataLen);
-            break;
+}
 
-        case RADIO_ACK_SET_MB_VALUES:
-            SetMbValuesAck((char *)pMsg->data, pMsg->dataLen);
-            break;
+/******************************************************************************
+ *
+ * expansionBusSendCmd
+ *
+ * PURPOSE
+ *      This routine sends a WOIS command message from the master to each of the 
+ *      expansion units associated with the master.
+ *
+ * PARAMETERS
+ *      command   Value of the command that is to be sent
+ *      macId     mac ID of the unit that the command is to be sent to.
+ *                if sending it to all units then sent the value to 0
+ *
+ * RETURN VALUE
+ *      void
+ *
+ *****************************************************************************/
+void expansionBusSendCmd(uint8_t command, uint64_t macId)
+{
+    uint8_t pkt;
+    radioMsgCmd_t *pMsg;
+    radioMsgHeader_t *pHdr;
+    uint8_t length=RADIO_CMD_HEADER_SIZE;
+    uint8_t i;
+    
+    /* build the command directly in a packet buffer */
+    pkt = radioPktAlloc();
+    if (pkt == RADIO_PKT_NONE)
+    {
+        return;
+    }
+    pMsg = (radioMsgCmd_t *)radioPktData(pkt);
+    pHdr = (radioMsgHeader_t *)pMsg;
+    
+    /*if(macId == radioMacId)
+    {
+        if(macId == config.sys.expMac1)
+        {
+            config.sys.expMac1 = 0x0013A20000000000;
+        }
+        else if(macId == config.sys.expMac2)
+        {
+            config.sys.expMac2 = 0x0013A20000000000;
+        }
+        else if(macId == config.sys.expMac3)
+        {
+            config.sys.expMac3 = 0x0013A20000000000;
+        }
+        return;
+    }    */
+    
+    switch(command)
+    {
+      case RADIO_CMD_NO_OP:
+          pMsg->cmd= RADIO_CMD_NO_OP;
+          pMsg->dataLen=0;
+          break;
+      case RADIO_CMD_GET_MOIST:
+          pMsg->cmd= RADIO_CMD_GET_MOIST;
+          pMsg->dataLen=0;
+          break;
+      case RADIO_CMD_GET_EXSTAT:
+          pMsg->cmd= RADIO_CMD_GET_EXSTAT;
+          pMsg->dataLen=0;
+          break;
+      case RADIO_CMD_EXPAN_DIGEST:
+          pMsg->cmd= RADIO_CMD_EXPAN_DIGEST;
+          pMsg->dataLen=1;
+          
+          /* tell the unit which digest we have, zero asks for all zones */
+          i = expansionUnitIndex(macId);
+          pMsg->data[0]= (i < (SYS_N_UNITS - 1)) ? radioExpDigest[i].seq : 0;
+          length +=1;
+          break;
+      case RADIO_CMD_CFG_PUT_START:
+          pMsg->cmd= RADIO_CMD_CFG_PUT_START;
+          pMsg->dataLen=0;
+          break;
+      case RADIO_CMD_CFG_PUT_APPLY:
+          pMsg->cmd= RADIO_CMD_CFG_PUT_APPLY;
+          pMsg->dataLen=0;
+          break;
+      case RADIO_CMD_CFG_DELTA_START:
+          pMsg->cmd= RADIO_CMD_CFG_DELTA_START;
+          pMsg->dataLen=RADIO_CFG_DELTA_START_SIZE;
+          
+          pMsg->data[0]= radioCfgDistVersion;
+          pMsg->data[1]= (uint8_t)(radioCfgDistSegs >> 24);
+          pMsg->data[2]= (uint8_t)(radioCfgDistSegs >> 16);
+          pMsg->data[3]= (uint8_t)(radioCfgDistSegs >> 8);
+          pMsg->data[4]= (uint8_t)(radioCfgDistSegs & 0xFF);
+          for(i = 0; i < (SYS_N_UNITS - 1); i++)
+          {
+              pMsg->data[5 + (i * 2)]= (uint8_t)(radioCfgUnitCrc[i] >> 8);
+              pMsg->data[6 + (i * 2)]= (uint8_t)(radioCfgUnitCrc[i] & 0xFF);
+              pMsg->data[11 + (i * 2)]= (uint8_t)(radioCfgUnitBase[i] >> 8);
+              pMsg->data[12 + (i * 2)]= (uint8_t)(radioCfgUnitBase[i] & 0xFF);
+          }
+          length +=RADIO_CFG_DELTA_START_SIZE;
+          break;
+      case RADIO_CMD_CFG_DELTA_APPLY:
+          pMsg->cmd= RADIO_CMD_CFG_DELTA_APPLY;
+          pMsg->dataLen=1;
+          pMsg->data[0]= radioCfgDistVersion;
+          length +=1;
+          break;
+      case RADIO_CMD_GET_MB_VALUES:          
+          /* each expansion unit controls valves 1-12 on its 
+           *own system, but take up different zone numbers in the
+           *greater scheme of things.  */
+          pMsg->cmd= RADIO_CMD_GET_MB_VALUES;
+          pMsg->dataLen=1;
+          
+          /*set the first moisture balance zone to be 1.
+           *each expansion controls on its own unit from 1 to 12
+           *want the data for all configured zones from each of the expansions */
+          pMsg->data[0]= 1;
+          length +=1;
+          break;
+      case RADIO_CMD_INIT_DATETIME:
+          pMsg->cmd= RADIO_CMD_INIT_DATETIME;
+          pMsg->dataLen=6;
+          pMsg->data[0]= (uint8_t)(dtYear - 2000);
+          pMsg->data[1]= dtMon+1;
+          pMsg->data[2]= dtMday;
+          pMsg->data[3]= dtHour;
+          pMsg->data[4]= dtMin;
+          pMsg->data[5]= dtSec;          
+          length +=6;
+          break;
+      case RADIO_CMD_SEND_FLOW:
+          pMsg->cmd= RADIO_CMD_SEND_FLOW;
+          pMsg->dataLen=4;
+          pMsg->data[0]= GPM;
+          pMsg->data[1]= (flowDelay >> 8);
+          pMsg->data[2]= (flowDelay & 0x00FF);
+          pMsg->data[3]= findFlow;        
+          length +=4;  
+          break;
+      case RADIO_CMD_IRR_START:
+          pMsg->cmd= RADIO_CMD_IRR_START;
+          pMsg->dataLen=4;
+          pMsg->data[0]=irrExpRunningProg;
+          pMsg->data[1]=sysState;
+          pMsg->data[2]=irrOpMode;
+          pMsg->data[3]=irrPulseMode;
+          length +=4;
+          
+          radioCheckExpanStatusTime = dtTickCount;
+          break; 
+      case RADIO_CMD_IRR_COMPLETE:
+          pMsg->cmd= RADIO_CMD_IRR_COMPLETE;
+          pMsg->dataLen=1;
+          pMsg->data[0]=irrProgram;
+          length +=1;
+          break;
+      case RADIO_CMD_EXPANSION_STATUS:
+          pMsg->cmd= RADIO_CMD_EXPANSION_STATUS;
+          pMsg->dataLen=35;
+          length +=35;
+          /*irrigation state */
+          pMsg->data[0]=sysState;
+          pMsg->data[1]=irrState;
+          if(config.sys.unitType == UNIT_TYPE_EXPANSION_1)
+          {
+              pMsg->data[2]=irrCurZone+12;
+          }
+          else if(config.sys.unitType == UNIT_TYPE_EXPANSION_2)
+          {
+              pMsg->data[2]=irrCurZone+24;
+          } 
+          else if(config.sys.unitType == UNIT_TYPE_EXPANSION_3)
+          {
+              pMsg->data[2]=irrCurZone+36;
+          } 
+          /* System Error Flags */
+          pMsg->data[3]=(uint8_t)(sysErrorFlags >> 8);
+          pMsg->data[4]=(uint8_t)(sysErrorFlags & 0xFF);
+          /* System Fault Flags */
+          pMsg->data[5]=(uint8_t)(sysFaultFlags >> 24);
+          pMsg->data[6]=(uint8_t)((sysFaultFlags & 0x00FF0000) >> 16); 
+          pMsg->data[7]=(uint8_t)((sysFaultFlags & 0x0000FF00) >> 8);
+          pMsg->data[8]=(uint8_t)(sysFaultFlags & 0x000000FF);
+          /* moisture sensor zone failures */
+          pMsg->data[9]=(uint8_t)((moistFailedSensors & 0x0000000000000F00) >> 8);
+          pMsg->data[10]=(uint8_t)((moistFailedSensors & 0x00000000000000FF));
+          
+          /*send zone runtimes to master */
+          for(i=0; i<SYS_N_UNIT_ZONES; i++)
+          {
+                pMsg->data[2*i+11]=(irrDailyRuntimePerZone[i] >> 8);
+                pMsg->data[2*i+12]=(irrDailyRuntimePerZone[i] & 0xFF);    
+          }         
+          break;
+       case RADIO_CMD_IRR_STOP:
+          pMsg->cmd= RADIO_CMD_IRR_STOP;
+          pMsg->dataLen=0;
+          /* release control variable */
+          irrExpRunningProg = IRR_PGM_NONE;
+          sysState = SYS_STATE_IDLE;
+          expansionIrrState =IRR_STATE_IDLE;
+          expansionIrrCurZone = 0;
+          break;
+       case RADIO_CMD_IRR_RESUME:
+          pMsg->cmd= RADIO_CMD_IRR_RESUME;
+          pMsg->dataLen=0;
+          break;
+       case RADIO_CMD_IRR_SKIP:
+          pMsg->cmd= RADIO_CMD_IRR_SKIP;
+          pMsg->dataLen=0;
+          break;
+       case RADIO_CMD_IRR_OFF:
+          pMsg->cmd= RADIO_CMD_IRR_OFF;
+          pMsg->dataLen=0;
+          break; 
+       case RADIO_CMD_IRR_AUTO:
+          pMsg->cmd= RADIO_CMD_IRR_AUTO;
+          pMsg->dataLen=0;
+          break;
+       case RADIO_CMD_IRR_STOP_OFF:
+           pMsg->cmd= RADIO_CMD_IRR_STOP_OFF;
+           pMsg->dataLen=0;
+           break; 
+       case RADIO_CMD_DELETE_SC:
+           pMsg->cmd= RADIO_CMD_DELETE_SC;
+           pMsg->dataLen=1;           
+           /* index of SC to delete */
+           pMsg->data[0]=scDeleteIndex;
+           length +=1;
+           break;
+        case RADIO_CMD_SC_IS_REMOVED:
+           pMsg->cmd= RADIO_CMD_SC_IS_REMOVED;
+           pMsg->dataLen=1;           
+           /* index of SC to delete */
+           pMsg->data[0]=scDeleteIndex;
+           length +=1;
+           break;
+         case RADIO_CMD_EXPAN_GET_CONFIG:
+           pMsg->cmd= RADIO_CMD_EXPAN_GET_CONFIG;
+           pMsg->dataLen=0;
+           break; 
+      default:
+          /* not a supported command */
+          radioPktRelease(pkt);
+          return;
+    }
+    
+    pHdr->version = RADIO_PROTOCOL_VER;
+    pHdr->msgType = RADIO_TYPE_CMD;
+    radioMsgInsertCrc(pMsg, length);
+    
+    if(macId == RADIO_EXP_SEND_ALL )
+    {      
+        /* send command to each expansion unit */
+        expansionBusForwardPkt(pkt, RADIO_NET_ADDR_DFLT, length);
 
-        case RADIO_ACK_WEATHER_DATA:
-            WeatherUpdateAck((char *)pMsg->data, pMsg->dataLen);
-            break;
+    }
+    else 
+    {
+        /* set time counter for timeout response */
+        if(macId == config.sys.masterMac)
+        {
+            radioMasterRespTime = dtTickCount;
+            radioSentMasterMsg = TRUE;
+        }
+        else if(macId == config.sys.expMac1)
+        {
+            radioExp1RespTime = dtTickCount;
+            radioSentExpan1Msg = TRUE;
+        }
+        else if(macId == config.sys.expMac2)
+        {
+            radioExp2RespTime = dtTickCount;
+            radioSentExpan2Msg = TRUE;
+        } 
+        else if(macId == config.sys.expMac3){          
+            radioExp3RespTime = dtTickCount;
+            radioSentExpan3Msg = TRUE;
+        }
+        /*send command to only 1 expansion unit */
+        if(macId != 0x0013A20000000000)
+        {
+            radioPktSend(radioDataFrameId(),
+                         RADIO_NET_ADDR_DFLT,
+                         (uint32_t)(macId >> 32),
+                         (uint32_t)(macId & 0xFFFFFFFF),
+                         pkt,
+                         length);
+        }
+    }
+    radioPktRelease(pkt);
+}
 
-        case RADIO_ACK_INIT_DATETIME:
-            InitDateTimeAck((char *)pMsg->data, pMsg->dataLen);
-            break;
-#endif
 
-        default:
-            /* Unknown command. */
-            break;  /* not reached */
+/******************************************************************************
+ *
+ * expansionBusCmdHandler
+ *
+ * PURPOSE
+ *      This routine handles responses to commands that were issued from this unit
+ *      to expansion units. It determines what unit sent the response back and the
+ *      command it it responding to. It then acts accordingly to the command.
+ *
+ * PARAMETERS
+ *      pPacket     a pointer to the received radio packet 
+ *
+ * RETURN VALUE
+ *      void
+ *
+ *****************************************************************************/
+void expansionBusCmdHandler(const radioRxDataPacket_t *pPacket)
+{
+    radioMsgAck_t *pMsg = (radioMsgAck_t *)&pPacket->data[0]; 
+    uint8_t moistStart=0;
+    uint8_t moistEnd=0;
+    uint8_t i;
+    
+    /* rebuild the MAC of the source of the packet */
+    uint64_t expUnitMacID = U8TOU64(pPacket->phyAddr[0],
+                             pPacket->phyAddr[1],
+                             pPacket->phyAddr[2],
+                             pPacket->phyAddr[3],
+                             pPacket->phyAddr[4],
+                             pPacket->phyAddr[5],
+                             pPacket->phyAddr[6],
+                             pPacket->phyAddr[7]);
+    
+    /* inform the system that communication was received from the proper expansion */
+    if(expUnitMacID ==config.sys.expMac1)
+    {
+        radioStatusExpansion1 = EXPANSION_CONNECTED;
+        radioSentExpan1Msg = FALSE;
+        sysFaultClear(SYS_FAULT_EXPAN_1);
+    }
+    else if(expUnitMacID ==config.sys.expMac2)
+    {
+        radioStatusExpansion2 = EXPANSION_CONNECTED;
+        radioSentExpan2Msg = FALSE;
+        sysFaultClear(SYS_FAULT_EXPAN_2);
+    }
+    else if(expUnitMacID ==config.sys.expMac3)
+    {
+        radioStatusExpansion3 = EXPANSION_CONNECTED;
+        radioSentExpan3Msg = FALSE;
+        sysFaultClear(SYS_FAULT_EXPAN_3);
+    }
+    else if(expUnitMacID ==config.sys.masterMac)
+    {
+        radioSentMasterMsg = FALSE;
+        sysFaultClear(SYS_FAULT_EXPAN_MASTER);
+    }
+    
+    
+    /* handle each response */                         
+    switch(pMsg->cmd)
+    {
+      case RADIO_CMD_NO_OP:
+          radioMessageLog("Expan: No Op ACK");
+          break;
+      case RADIO_CMD_INHIBIT_ON:
+          radioMessageLog("Expan: Inhibit On ACK");
+          break;
+      case RADIO_CMD_INHIBIT_OFF:
+          radioMessageLog("Expan: Inhibit Off ACK");
+          break;
+      case RADIO_CMD_FORCE_ON:
+          radioMessageLog("Expan: Force On ACK");
+          break;
+      case RADIO_CMD_WEATHER_DATA:
+          radioMessageLog("Expan: Weather Data ACK");
+          break;
+      case RADIO_CMD_INIT_DATETIME:
+          radioMessageLog("Expan: Init DateTime ACK");
+          break;
+      case RADIO_CMD_GET_MOIST:
+          radioMessageLog("Expan: Get Moist ACK");
+          
+          /* determine which unit responded and load
+           * the data into the correct zones */
+          if(expUnitMacID ==config.sys.expMac1)
+          {   
+                moistStart = 13;
+                moistEnd = 24;
+          }
+          else if(expUnitMacID ==config.sys.expMac2)
+          {
+                moistStart = 25;
+                moistEnd = 36;
+          }
+          else if(expUnitMacID ==config.sys.expMac3)
+          {
+                moistStart = 37;
+                moistEnd = 48;
+          }
+          
+          /* load moisture data from expansion unit into moisture array */
+          for(i= moistStart; i < moistEnd;i++)
+          {
+             //drvMoistValueSet(i,pMsg->data[i-moistStart+10]);
+             expMoistValue[i-13] =  pMsg->data[i-moistStart+10];
+          }
+          break;
+      case RADIO_CMD_GET_EXSTAT:
+          radioMessageLog("Expan: Get Ext Stat ACK");
+          
+          
+          break;
+      case RADIO_CMD_EXPAN_DIGEST:
+          radioMessageLog("Expan: Digest ACK");
+          
+          i = expansionUnitIndex(expUnitMacID);
+          if((i < (SYS_N_UNITS - 1)) && (pMsg->dataLen > RADIO_ACK_MIN_DATA_SIZE))
+          {
+              expansionDigestApply(i, &pMsg->data[RADIO_ACK_MIN_DATA_SIZE],
+                                   pMsg->dataLen - RADIO_ACK_MIN_DATA_SIZE);
+              
+              /* ask for the rest of the changed zones */
+              if((pMsg->data[RADIO_ACK_MIN_DATA_SIZE + 1] & RADIO_DIGEST_FLAG_MORE) != 0)
+              {
+                  expansionBusSendCmd(RADIO_CMD_EXPAN_DIGEST, expUnitMacID);
+              }
+          }
+          break;
+      case RADIO_CMD_CFG_PUT_START:
+          radioMessageLog("Expan: Put Cfg Start ACK");
+          
+          /* update the configuration snapshot buffer before reading from it
+           * this puts the latest version of the configuration image into the
+           * snapshot buffer which is what is sent to the expansion units. */
+          configSnapshotSave();
+          
+          /* start the bulk transfer of the config file 
+           * by sending segment 0 of the configuration file */
+          expansionSendCfgSeg0(pPacket);
+          break;
+      case RADIO_CMD_CFG_PUT_APPLY:
+          radioMessageLog("Expan: Cfg Apply ACK");
+          
+          /*check to see if the configuration update of expansion unit 
+           *was successful */
+          if(pMsg->data[0] == RADIO_RESULT_FAILURE)
+          {
+              /* resend the configuration from the beginning*/
+              expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, expUnitMacID);
+          } 
+          else
+          {
+              expansionBusSendCmd(RADIO_CMD_INIT_DATETIME, expUnitMacID);
+          }
+          break;
+      case RADIO_CMD_CFG_DELTA_START:
+          radioMessageLog("Expan: Cfg Delta Start ACK");
+          
+          i = expansionUnitIndex(expUnitMacID);
+          if((i < (SYS_N_UNITS - 1)) && radioCfgDistActive &&
+             (pMsg->dataLen > RADIO_ACK_MIN_DATA_SIZE))
+          {
+              if(pMsg->data[RADIO_ACK_MIN_DATA_SIZE] == RADIO_RESULT_SUCCESS)
+              {
+                  radioCfgDistUnits |= (1 << i);
+              }
+              else
+              {
+                  /* unit does not hold the base image, send all of it */
+                  radioCfgDistFull |= (1 << i);
+                  expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, expUnitMacID);
+              }
+          }
+          break;
+      case RADIO_CMD_CFG_DELTA_APPLY:
+          radioMessageLog("Expan: Cfg Delta Apply ACK");
+          
+          i = expansionUnitIndex(expUnitMacID);
+          if((i >= (SYS_N_UNITS - 1)) || (pMsg->dataLen <= RADIO_ACK_MIN_DATA_SIZE))
+          {
+              break;
+          }
+          if(pMsg->data[RADIO_ACK_MIN_DATA_SIZE] == RADIO_RESULT_SUCCESS)
+          {
+              expansionBusSendCmd(RADIO_CMD_INIT_DATETIME, expUnitMacID);
+          }
+          else if((pMsg->data[RADIO_ACK_MIN_DATA_SIZE] == RADIO_RESULT_MISSING) &&
+                  (pMsg->dataLen >= (RADIO_ACK_MIN_DATA_SIZE + 5)) &&
+                  (radioCfgDistRetries[i] < RADIO_CFG_DELTA_RETRIES))
+          {
+              /* resend only the segments the unit missed */
+              radioCfgDistRetries[i]++;
+              radioCfgRepairMask[i] = radioCfgDistSegs &
+                  U8TOU32(pMsg->data[RADIO_ACK_MIN_DATA_SIZE + 1],
+                          pMsg->data[RADIO_ACK_MIN_DATA_SIZE + 2],
+                          pMsg->data[RADIO_ACK_MIN_DATA_SIZE + 3],
+                          pMsg->data[RADIO_ACK_MIN_DATA_SIZE + 4]);
+              if(radioCfgRepairMask[i] == 0)
+              {
+                  expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, expUnitMacID);
+              }
+          }
+          else
+          {
+              /* resend the configuration from the beginning*/
+              radioCfgRepairMask[i] = 0;
+              expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, expUnitMacID);
+          }
+          break;
+      case RADIO_CMD_GET_MB_VALUES:
+          radioMessageLog("Expan: Get MB Val ACK");
+         
+          /*account for which unit data came from so it is placed in the
+          *master zone list in the proper zone */
+          if(expUnitMacID ==config.sys.expMac1)
+          {
+              pMsg->data[0] += 12;
+          }
+          else if(expUnitMacID ==config.sys.expMac2)
+          {
+              pMsg->data[0] += 24;
+          }
+          else if(expUnitMacID ==config.sys.expMac3)
+          {
+              pMsg->data[0] += 36;
+          }
+         
+          /* Set Moisture Balance Values from command data. */ 
+          if(radioProtoCmdSetMbValues(pMsg->data, pMsg->dataLen)==FALSE) 
+          {
+              /* failure since zone or values are out of bounds */
+          }
+            
+          break;
+      default:
+          /* not a supported command */
+          return;
     }
+    
+    /* Yield control back to the system polling loop. */
+    radioYield = TRUE;
+        
 }
 
 
 /******************************************************************************
  *
- * radioCheckSumIsValid
- *
- * PURPOSE
- *      This routine is called to verify the CRC-16 checksum of a block of
- *      data matches the high and low CRC bytes provided.
- *
- * PARAMETERS
- *      pData   IN  pointer to start of data
- *      lenData IN  length of data
- *      sumH    IN  high byte of CRC checksum
- *      sumL    IN  low byte of CRC checksum
- *
- * RETURN VALUE
- *      This routine returns TRUE if the CRC-16 checksum of the provided data
- *      matches the high and low CRC bytes provided; otherwise FALSE is
- *      returned.
- *
- * NOTES
- *      This routine is used by the remote control LCD screen get command.
- *
- *****************************************************************************/
-static bool_t radioCheckSumIsValid(const void *pData,
-                                   uint8_t lenData,
-                                   uint8_t sumH,
-                                   uint8_t sumL)
-{
-    uint16_t sum = crc16(pData, lenData);
-
-    return ((sumH == (sum >> 8)) && (sumL == (sum & 0x00FF)));
-}
-
-
-/******************************************************************************
- *
- * radioExtAckSend
+ * expansionSendCfgSeg0
  *
  * PURPOSE
- *      This routine provides the same interface as the radioProtocolAckSend
- *      function but sends command acknowledgement messages without the 10-byte
- *      standard response data (serial number and current status).  The only
- *      data sent in the command acknowledgement is the data provided by the
- *      caller.  This routine allows smaller, more efficient response packets
- *      and is intended for use with debug and remote control commands.
- *
+ *      When an expansion unit responds to the command to start the configuration
+ *      download it will then send the first segment (segment 0) of the configuration
+ *      data image to kick off the complete data transfer. When the expansion unit
+ *      responds to this packet the bulkDataTransferHandler will take control of 
+ *      sending the remaining packets of the data image.
  * PARAMETERS
- *      pPacket     IN  pointer to start of received command packet
- *      cmdAck      IN  application command acknowledgement response code
- *      pData       IN  pointer to start of command response data
- *      lenData     IN  length of the command response data
+ *      pPacket     a pointer to the received radio packet 
  *
  * RETURN VALUE
- *      None.
+ *      void
  *
  *****************************************************************************/
-static void radioExtAckSend(const radioRxDataPacket_t *pPacket,
-                            uint8_t cmdAck,
-                            const uint8_t *pData,
-                            uint8_t lenData)
+void expansionSendCfgSeg0(const radioRxDataPacket_t *pPacket)
 {
-    radioMsgAck_t msg;
-    radioMsgCmd_t *cmdMsg = (radioMsgCmd_t *)&pPacket->data[0];
-
-    msg.msgId = cmdMsg->msgId;
-    msg.cmd = cmdAck;
-    msg.dataLen = lenData;
-
-    memcpy(msg.data, pData, lenData);
-
-    radioProtocolRespSend(pPacket,
-                          &msg,
-                          RADIO_TYPE_ACK,
-                          RADIO_CMD_HEADER_SIZE + msg.dataLen);
-}
-
-
-
-/******************************************************************************
- *
- *  RADIO SENSOR CONCENTRATOR FUNCTIONS
- *
- *****************************************************************************/
+   uint8_t pkt;
+   radioMsgXfer_t *pResp;
+   configSys_t  * pExpanConfigSys;
+   configImage_t expanConfig;
+   
+   /* rebuild the MAC of the source of the packet */
+    uint64_t expUnitMacID = U8TOU64(pPacket->phyAddr[0],
+                             pPacket->phyAddr[1],
+                             pPacket->phyAddr[2],
+                             pPacket->phyAddr[3],
+                             pPacket->phyAddr[4],
+                             pPacket->phyAddr[5],
+                             pPacket->phyAddr[6],
+                             pPacket->phyAddr[7]);
+                             
+   /* Build the segment directly in a packet buffer. */
+   pkt = radioPktAlloc();
+   if (pkt == RADIO_PKT_NONE)
+   {
+      return;
+   }
+   pResp = (radioMsgXfer_t *)radioPktData(pkt);
+   pExpanConfigSys = (configSys_t  *)pResp->data;
 
-/******************************************************************************
- *
- * radioCheckSensorAssocList
- *
- * PURPOSE
- *      This routine provides the same interface as the radioProtocolAckSend
- *      function but sends command acknowledgement messages without the 10-byte
- *      standard response data (serial number and current status).  The only
- *      data sent in the command acknowledgement is the data provided by the
- *      caller.  This routine allows smaller, more efficient response packets
- *      and is intended for use with debug and remote control commands.
- *
- * PARAMETERS
- *      sensorMAC     IN  MAC ID of sensor concentrator that sent message
- *
- * RETURN VALUE
- *      uint8_t    returns the index in the list at which MAC was found.
- *                 returns MAX_NUM_SC if not found.
- *
- *****************************************************************************/
-static uint8_t radioCheckSensorAssocList(uint64_t sensorMAC)
-{
-   uint8_t  i;
-   uint8_t retIndex = MAX_NUM_SC;
+   pResp->xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_REQ;
    
-   for(i=0; i<MAX_NUM_SC; i++)
+   /* Set segment index in response header. */
+   pResp->segHigh = 0x00;
+   pResp->segLow = 0x00;
+   configSnapshotRead(0, pResp->data, RADIO_MAXSEGMENT);
+   pResp->dataLen = (uint8_t)RADIO_MAXSEGMENT;
+   
+   
+   configSnapshotRead(0, &expanConfig, sizeof(configImage_t));
+   /*set the master mac id */
+   expanConfig.sys.masterMac = radioMacId;
+   pExpanConfigSys->masterMac = radioMacId;
+    
+   if(expUnitMacID ==config.sys.expMac1)
    {
-      if(config.sys.assocSensorCon[i].macId == sensorMAC)
-      {
-          retIndex =i;
-          break;
-      }
+      expanConfig.sys.unitType = UNIT_TYPE_EXPANSION_1;
+      pExpanConfigSys->unitType = UNIT_TYPE_EXPANSION_1; 
+   }
+   else if(expUnitMacID ==config.sys.expMac2)
+   {
+      expanConfig.sys.unitType = UNIT_TYPE_EXPANSION_2;
+      pExpanConfigSys->unitType = UNIT_TYPE_EXPANSION_2;
+   }
+   else if(expUnitMacID ==config.sys.expMac3)
+   {
+      expanConfig.sys.unitType = UNIT_TYPE_EXPANSION_3;
+      pExpanConfigSys->unitType = UNIT_TYPE_EXPANSION_3;
    }
    
-   return retIndex;      
+   
+    /* recompute the CRC checksum */                                        
+    pExpanConfigSys->checkSum=configMemorySnapShotChecksumCalc((uint8_t *)&expanConfig);
+   
+    /* Send segment 0 of config to expansion unit */
+    radioProtocolPktRespSend(pPacket,
+                             pkt,
+                             RADIO_TYPE_XFER,
+                             RADIO_XFER_HEADER_SIZE + pResp->dataLen);
+    radioPktRelease(pkt);
 }
 
-
 /******************************************************************************
  *
- * radioAddSensorAssocList
+ * expansionUnitIndex
  *
  * PURPOSE
- *      This routine provides the same interface as the radioProtocolAckSend
- *      function but sends command acknowledgement messages without the 10-byte
- *      standard response data (serial number and current status).  The only
- *      data sent in the command acknowledgement is the data provided by the
- *      caller.  This routine allows smaller, more efficient response packets
- *      and is intended for use with debug and remote control commands.
+ *      This routine maps an expansion unit MAC ID to its index in the
+ *      expansion unit tables (0=expansion 1, .. 2=expansion 3).
  *
  * PARAMETERS
- *      sensorMAC     IN  MAC ID of sensor concentrator that sent message
+ *      macId       IN  MAC ID of the expansion unit
  *
  * RETURN VALUE
- *      uint_8    index in associated sensor list where it was added.
+ *      This routine returns the expansion unit index, or SYS_N_UNITS - 1 if
+ *      the MAC ID is not a configured expansion unit.
  *
  *****************************************************************************/
-uint8_t radioAddSensorAssocList(uint64_t sensorMAC)
+static uint8_t expansionUnitIndex(uint64_t macId)
 {
-   uint8_t  i;
-   bool_t retIndex = MAX_NUM_SC;
-   
-   for(i=0; i<MAX_NUM_SC; i++)
-   {
-      if(config.sys.assocSensorCon[i].macId == 0)
-      {
-          retIndex=i;
-          config.sys.assocSensorCon[i].macId = sensorMAC;
-          config.sys.numSensorCon += 1;
-          break;
-      }
-   }
-   
-   return retIndex;      
+    if(macId == 0x0013A20000000000)
+    {
+        return SYS_N_UNITS - 1;
+    }
+    if(macId == config.sys.expMac1)
+    {
+        return 0;
+    }
+    if(macId == config.sys.expMac2)
+    {
+        return 1;
+    }
+    if(macId == config.sys.expMac3)
+    {
+        return 2;
+    }
+    return SYS_N_UNITS - 1;
 }
 
+
 /******************************************************************************
  *
- * radioRemoveSensorAssocList
+ * expansionDigestApply
  *
  * PURPOSE
- *      This routine removes a sensor concentrator MAC ID from the associated
- *      list.  It does this by setting that list index to 0. This returns the 
- *      that it was removed from.
+ *      This routine updates the master's expansion status digest cache from
+ *      a status digest received from an expansion unit.
  *
  * PARAMETERS
- *      sensorMAC     IN  MAC ID of sensor concentrator that sent message
+ *      unit        IN  expansion unit index (0-2)
+ *      pData       IN  digest data, following the ACK serial number/status
+ *      lenData     IN  length of digest data
  *
  * RETURN VALUE
- *      uint_8    index in associated sensor list where it was removed from.
+ *      void
+ *
+ * NOTES
+ *      Zone values are stored in the same master tables that the individual
+ *      Get Moisture, Get MB Values and Expansion Status commands update, so
+ *      NOC status queries are answered from RAM.  A truncated digest clears
+ *      the cached sequence number so the next request fetches all zones.
  *
  *****************************************************************************/
-uint8_t radioRemoveSensorAssocList(uint64_t sensorMAC)
+static void expansionDigestApply(uint8_t unit, const uint8_t *pData, uint8_t lenData)
 {
-    uint8_t  i, j;
-    bool_t retIndex = MAX_NUM_SC;
-    uint8_t chanZone;
-    int8_t assocSensorConIndex;
-
-    // find the index in config.sys.assocSensorCon of the provided sensorMAC
-    assocSensorConIndex = -1;
-    for(i = 0; i < MAX_NUM_SC; i++)
+    radioExpDigest_t *pDigest = &radioExpDigest[unit];
+    uint8_t firstZone = ((unit + 1) * SYS_N_UNIT_ZONES) + 1;
+    uint16_t zoneMask;
+    uint8_t di = RADIO_DIGEST_HDR_SIZE;
+    uint8_t zone;
+    uint8_t i;
+    
+    if(lenData < RADIO_DIGEST_HDR_SIZE)
     {
-        if(config.sys.assocSensorCon[i].macId == sensorMAC)
-        {
-            assocSensorConIndex = i;
-            break;
-        }
+        return;
     }
-
-    // clear out measurement storage as well
-    snsConInfo[assocSensorConIndex].chargeRate = 0;
-    snsConInfo[assocSensorConIndex].battVoltage = 0;
-    snsConInfo[assocSensorConIndex].solenoidState = 0;
-    config.sys.assocSensorCon[assocSensorConIndex].macId = 0;
-    scDeleteList[assocSensorConIndex] = FALSE;
     
-    //Look to see if any other SCs after this one are marked for deleteion
-            
-    for(i= assocSensorConIndex; i<MAX_NUM_SC; i++)
+    pDigest->seq = pData[0];
+    pDigest->rxTime = dtTickCount;
+    
+    zoneMask = U8TOU16(pData[2], pData[3]);
+    for(i = 0; i < SYS_N_UNIT_ZONES; i++)
     {
-      if(scDeleteList[i] == TRUE)
-      {
-        //Move remaining SCs up one in the list to keep the position correct
-        while( i< MAX_NUM_SC)
+        if((zoneMask & ((uint16_t)1 << i)) == 0)
         {
-          scDeleteList[i-1] = scDeleteList[i]; 
-          i++;
+            continue;
         }
-        break;
-      }
+        if((di + RADIO_DIGEST_ZONE_SIZE) > lenData)
+        {
+            /* truncated digest, start over with a full one */
+            pDigest->seq = 0;
+            break;
+        }
+        
+        zone = firstZone + i;
+        
+        /* moisture value and sensor failure */
+        expMoistValue[zone - 13] = pData[di];
+        if(pData[di] == RADIO_SENSOR_FAILURE)
+        {
+            moistFailureSet(zone);
+        }
+        else
+        {
+            moistFailureClear(zone);
+        }
+        
+        /* moisture balance and daily runtime */
+        irrMbSet(zone, (int16_t)U8TOU16(pData[di + 1], pData[di + 2]));
+        irrDailyRuntimePerZone[zone - 1] = U8TOU16(pData[di + 3], pData[di + 4]);
+        
+        di += RADIO_DIGEST_ZONE_SIZE;
     }
+}
+
 
+/******************************************************************************
+ *
+ * expansionDigestRequest
+ *
+ * PURPOSE
+ *      This routine requests a status digest from each configured expansion
+ *      unit whose cached digest is missing or older than
+ *      RADIO_DIGEST_MAX_AGE_SECS.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      void
+ *
+ * NOTES
+ *      Only the master unit requests digests.  A unit is not asked again
+ *      while a request is outstanding (RADIO_CMD_RETRY_SECS), so this routine
+ *      may be called from screen refreshes and NOC query handlers.
+ *
+ *****************************************************************************/
+void expansionDigestRequest(void)
+{
+    uint8_t unit;
+    uint64_t macId;
+    radioExpDigest_t *pDigest;
     
-    if(config.sys.numSensorCon != 0)
+    if(config.sys.unitType != UNIT_TYPE_MASTER)
     {
-        config.sys.numSensorCon -= 1;
+        return;
     }
-
-    // change the zone settings back to defaults and no sensor for each zone
-    // associated with this sensor concentrator
-    for(i = 0; i < SC_NUM_CHAN_UNIT; i++)
+    
+    for(unit = 0; (unit < config.sys.numUnits) && (unit < (SYS_N_UNITS - 1)); unit++)
     {
-        chanZone = config.sys.assocSensorCon[assocSensorConIndex].channelZone[i];
-        if(chanZone != SC_CHAN_NOT_ASSIGNED)
+        macId = expansionUnitMacGet(unit);
+        if(macId == 0x0013A20000000000)
         {
-            config.zone[chanZone].snsConChan = SC_NONE_SELECTED;
-            config.zone[chanZone].snsConTableIndex = ZONE_SC_INDEX_NONE;
-            config.zone[chanZone].sensorType = SNS_NONE;
-            config.zone[chanZone].group = CONFIG_GROUP_NONE;
+            continue;
         }
-        config.sys.assocSensorCon[assocSensorConIndex].channelZone[i] = SC_CHAN_NOT_ASSIGNED;
-    }
-
-    // Clean up items from config.zone where the snsConTableIndex to be
-    // removed is referenced (but not a part of channelZone).
-    for(i = 0; i < SYS_N_ZONES; i++)
-    {
-        if (config.zone[i].snsConTableIndex == assocSensorConIndex)
+        
+        pDigest = &radioExpDigest[unit];
+        if((pDigest->seq != 0) &&
+           (dtElapsedSeconds(pDigest->rxTime) <= RADIO_DIGEST_MAX_AGE_SECS))
         {
-            config.zone[i].snsConChan = SC_NONE_SELECTED;
-            config.zone[i].snsConTableIndex = ZONE_SC_INDEX_NONE;
-            config.zone[i].sensorType = SNS_NONE;
-            config.zone[i].group = CONFIG_GROUP_NONE;
+            /* cached digest is fresh */
+            continue;
         }
+        if((pDigest->reqTime != 0) &&
+           (dtElapsedSeconds(pDigest->reqTime) <= RADIO_CMD_RETRY_SECS))
+        {
+            /* request already outstanding */
+            continue;
+        }
+        
+        pDigest->reqTime = dtTickCount;
+        expansionBusSendCmd(RADIO_CMD_EXPAN_DIGEST, macId);
     }
-
-    // Move the remaining SCs down one.  This allows us to maintain the
-    // invariant that is always the lowest indices of assocSensorCon that
-    // are filled.  For each sensor concentrator shifted, we must also change
-    // the index pointers (for now, just zones)
-    for(i = assocSensorConIndex; i < MAX_NUM_SC; i++)
-    {
-         if(config.sys.assocSensorCon[i+1].macId != 0)
-         {
-             // update assocSensorCon
-             config.sys.assocSensorCon[i].macId = config.sys.assocSensorCon[i+1].macId;
-             config.sys.assocSensorCon[i + 1].macId = 0;
-             config.sys.assocSensorCon[i].zoneRange = config.sys.assocSensorCon[i+1].zoneRange;
-             config.sys.assocSensorCon[i + 1].zoneRange = 0;
-             for (j = 0; j < sizeof(config.sys.assocSensorCon[i + 1].channelZone); j++)
-             {
-                 config.sys.assocSensorCon[i].channelZone[j] = config.sys.assocSensorCon[i+1].channelZone[j];
-                 config.sys.assocSensorCon[i + 1].channelZone[j] = 0;
-             }
-
-             // update snsConInfo array
-             snsConInfo[i].battVoltage = snsConInfo[i + 1].battVoltage;
-             snsConInfo[i + 1].battVoltage = 0;
-             snsConInfo[i].chargeRate = snsConInfo[i + 1].chargeRate;
-             snsConInfo[i + 1].chargeRate = 0;
-             snsConInfo[i].solenoidState = snsConInfo[i + 1].solenoidState;
-             snsConInfo[i + 1].solenoidState = 0;
-
-             // scan zones for any zones referencing the old index.  Update that
-             // zone to point to index x - 1 where x is the previous index.
-             for (j = 0; j < MAX_NUM_SC; j++)
-             {
-                 if (config.zone[j].snsConTableIndex == (i + 1))
-                 {
-                     config.zone[j].snsConTableIndex = i;
-                 }
-             }
-         }
-    }
-
-   return assocSensorConIndex;
 }
 
 
+
 /******************************************************************************
  *
- *  RADIO EXPANSION BUS FUNCTIONS
+ * expansionUnitMacGet
+ *
+ * PURPOSE
+ *      This routine maps an expansion unit index to its MAC ID.
+ *
+ * PARAMETERS
+ *      unit        IN  expansion unit index (0-2)
+ *
+ * RETURN VALUE
+ *      This routine returns the MAC ID of the expansion unit, which is
+ *      0x0013A20000000000 if the unit is not configured.
  *
  *****************************************************************************/
- 
- 
+static uint64_t expansionUnitMacGet(uint8_t unit)
+{
+    switch(unit)
+    {
+        case 0:
+            return config.sys.expMac1;
+        case 1:
+            return config.sys.expMac2;
+        default:
+            return config.sys.expMac3;
+    }
+}
+
+
 /******************************************************************************
  *
- * expansionBusForwardCmd
+ * expansionCfgCrcCalc
  *
  * PURPOSE
- *      This routine forwards on a WOIS command message to the expansion
- *      units for them to respond to. This is also used for the master to send
- *      a command to all of the expansion units at the same time.
+ *      This routine computes the CRC of each segment of the configuration
+ *      snapshot, and the image checksum each expansion unit will hold once
+ *      the snapshot has been sent to it.
  *
  * PARAMETERS
- *      pPacket   the packet that was received and needs to be forwarded on
+ *      pSegCrc     OUT segment CRCs (RADIO_CFG_SEGS entries)
+ *      pUnitCrc    OUT expansion unit image checksums (SYS_N_UNITS - 1 entries)
  *
  * RETURN VALUE
  *      void
  *
+ * NOTES
+ *      The 4-byte image header is not covered by the segment CRCs since each
+ *      expansion unit rewrites the checksum itself.  The unit checksums are
+ *      computed with the unit type and master MAC ID patched into segment 0,
+ *      exactly as expansionSendCfgSeg0() does for a full download.
+ *
  *****************************************************************************/
-static void expansionBusForwardCmd(const radioRxDataPacket_t *pPacket)
+static void expansionCfgCrcCalc(uint16_t *pSegCrc, uint16_t *pUnitCrc)
 {
-    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
-    uint16_t destN= U8TOU16(pPacket->netAddr[0], pPacket->netAddr[1]);
-    uint32_t destH;
-    uint32_t destL;
+    uint8_t data[RADIO_MAXSEGMENT];
+    configSys_t *pSys = (configSys_t *)data;
+    uint32_t offset;
+    uint32_t nBytes;
+    uint32_t i;
+    uint32_t first;
+    uint16_t seg;
+    uint8_t unit;
     
-    switch(config.sys.numUnits)
+    for(unit = 0; unit < (SYS_N_UNITS - 1); unit++)
     {
-      case 3:
-          if(config.sys.expMac3 != 0x0013A20000000000)
-          {
-            radioExp3RespTime = dtTickCount;  /* set time counter for timeout response */
-            radioSentExpan3Msg = TRUE;
-            destH = (uint32_t)(config.sys.expMac3 >>32);
-            destL = (uint32_t)(config.sys.expMac3 & 0xFFFFFFFF); 
-            radioDataSend(radioDataFrameId(),
-                        destN,
-                        destH,
-                        destL,
-                        (uint8_t *)pMsg,
-                        RADIO_CMD_HEADER_SIZE + pMsg->dataLen);
-          }
-      case 2:
-          if(config.sys.expMac2 != 0x0013A20000000000)
-          {
-            radioExp2RespTime = dtTickCount;  /* set time counter for timeout response */
-            radioSentExpan2Msg = TRUE;
-            destH = (uint32_t)(config.sys.expMac2 >>32);
-            destL = (uint32_t)(config.sys.expMac2 & 0xFFFFFFFF); 
-            radioDataSend(radioDataFrameId(),
-                        destN,
-                        destH,
-                        destL,
-                        (uint8_t *)pMsg,
-                        RADIO_CMD_HEADER_SIZE + pMsg->dataLen);
-          }
-
-      case 1:
-          if(config.sys.expMac1 != 0x0013A20000000000)
-          {
-            radioExp1RespTime = dtTickCount;  /* set time counter for timeout response */
-            radioSentExpan1Msg = TRUE;
-            destH = (uint32_t)(config.sys.expMac1 >>32);
-            destL = (uint32_t)(config.sys.expMac1 & 0xFFFFFFFF); 
-            radioDataSend(radioDataFrameId(),
-                        destN,
-                        destH,
-                        destL,
-                        (uint8_t *)pMsg,
-                        RADIO_CMD_HEADER_SIZE + pMsg->dataLen);
-          }
-      default:
-          break;
+        pUnitCrc[unit] = CRC_INIT_VALUE;
+    }
+    
+    for(seg = 0; seg < RADIO_CFG_SEGS; seg++)
+    {
+        offset = seg * RADIO_MAXSEGMENT;
+        nBytes = CONFIG_IMAGE_SIZE - offset;
+        if (nBytes > RADIO_MAXSEGMENT)
+        {
+            nBytes = RADIO_MAXSEGMENT;
+        }
+        configSnapshotRead(offset, data, nBytes);
+        
+        /* skip the version and checksum header */
+        first = (seg == 0) ? 4 : 0;
+        
+        pSegCrc[seg] = CRC_INIT_VALUE;
+        for(i = first; i < nBytes; i++)
+        {
+            crcByte(data[i], &pSegCrc[seg]);
+        }
+        
+        for(unit = 0; unit < (SYS_N_UNITS - 1); unit++)
+        {
+            if(seg == 0)
+            {
+                pSys->unitType = unit + UNIT_TYPE_EXPANSION_1;
+                pSys->masterMac = radioMacId;
+            }
+            for(i = first; i < nBytes; i++)
+            {
+                crcByte(data[i], &pUnitCrc[unit]);
+            }
+        }
+        
+        /* Make sure watchdog doesn't timeout during this long operation. */
+        sysExecutionExtend();
     }
-
 }
 
+
 /******************************************************************************
  *
- * expansionBusSingleCmd
+ * expansionCfgSegSend
  *
  * PURPOSE
- *      This routine forwards on a WOIS command message to the expansion
- *      units for them to respond to
+ *      This routine sends one segment of the configuration snapshot as part
+ *      of a delta config distribution.
  *
  * PARAMETERS
- *      pPacket   the packet that needs to be sent to a single expansion unit
- *      macId     the MAC ID of the unit to receive the command
+ *      seg         IN  segment index
+ *      macId       IN  MAC ID of the expansion unit, or RADIO_EXP_BROADCAST
  *
  * RETURN VALUE
  *      void
  *
+ * NOTES
+ *      Delta segments are not acknowledged; missing segments are reported
+ *      by the expansion unit in its reply to RADIO_CMD_CFG_DELTA_APPLY.
+ *
  *****************************************************************************/
-static void expansionBusSingleCmd(const radioRxDataPacket_t *pPacket, uint64_t macId)
+static void expansionCfgSegSend(uint8_t seg, uint64_t macId)
 {
-    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket->data[0];
-    uint16_t destN= U8TOU16(pPacket->netAddr[0], pPacket->netAddr[1]);
-    uint32_t destH;
-    uint32_t destL;
+    radioMsgXfer_t msg;
+    uint32_t offset;
+    uint32_t len;
     
-     destH = (uint32_t)(macId >>32);
-     destL = (uint32_t)(macId & 0xFFFFFFFF); 
-     
-     if(macId != 0x0013A20000000000)
-     {
-        radioDataSend(radioDataFrameId(),
-                        destN,
-                        destH,
-                        destL,
-                        (uint8_t *)pMsg,
-                        RADIO_CMD_HEADER_SIZE + pMsg->dataLen);
-     }
+    offset = seg * RADIO_MAXSEGMENT;
+    len = CONFIG_IMAGE_SIZE - offset;
+    if (len > RADIO_MAXSEGMENT)
+    {
+        len = RADIO_MAXSEGMENT;
+    }
+    
+    msg.xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_DELTA_PUT;
+    msg.segHigh = radioCfgDistVersion;
+    msg.segLow = seg;
+    msg.dataLen = (uint8_t)len;
+    configSnapshotRead(offset, msg.data, len);
+    
+    msg.hdr.version = RADIO_PROTOCOL_VER;
+    msg.hdr.msgType = RADIO_TYPE_XFER;
+    radioMsgInsertCrc(&msg, RADIO_XFER_HEADER_SIZE + msg.dataLen);
+    radioDataSend(radioDataFrameId(),
+                  0xFFFE,
+                  (uint32_t)(macId >> 32),
+                  (uint32_t)(macId & 0xFFFFFFFF),
+                  (uint8_t *)&msg,
+                  RADIO_XFER_HEADER_SIZE + msg.dataLen);
 }
 
 
 /******************************************************************************
  *
- * expansionBusSendCmd
+ * expansionCfgDistribute
  *
  * PURPOSE
- *      This routine sends a WOIS command message from the master to each of the 
- *      expansion units associated with the master.
+ *      This routine sends the master's current configuration to the
+ *      expansion units.  Only the segments that changed since the last
+ *      distribution are sent, and they are broadcast once to all units.
  *
  * PARAMETERS
- *      command   Value of the command that is to be sent
- *      macId     mac ID of the unit that the command is to be sent to.
- *                if sending it to all units then sent the value to 0
+ *      None.
  *
  * RETURN VALUE
  *      void
  *
+ * NOTES
+ *      The full download (RADIO_CMD_CFG_PUT_START) is used when there is no
+ *      previous distribution to compare against, or when a distribution is
+ *      already in progress.  The segments are sent by expansionCfgDistPoll().
+ *
  *****************************************************************************/
-void expansionBusSendCmd(uint8_t command, uint64_t macId)
+void expansionCfgDistribute(void)
 {
-    radioRxDataPacket_t pPacket;
-    radioMsgCmd_t *pMsg = (radioMsgCmd_t *)&pPacket.data[0];
-    radioMsgHeader_t *pHdr = (radioMsgHeader_t *)pMsg;
-    uint8_t length=RADIO_CMD_HEADER_SIZE;
-    uint8_t i;
+    uint16_t segCrc[RADIO_CFG_SEGS];
+    uint16_t unitCrc[SYS_N_UNITS - 1];
+    uint32_t mask = 0;
+    uint16_t seg;
+    uint8_t unit;
+    bool_t full;
     
-    /*if(macId == radioMacId)
+    /* save the image to be distributed and compute what changed */
+    configSnapshotSave();
+    expansionCfgCrcCalc(segCrc, unitCrc);
+    
+    full = (radioCfgSegCrcValid == FALSE) ||
+           (radioCfgDistActive == TRUE) ||
+           (RADIO_CFG_SEGS > RADIO_CFG_DELTA_MAX_SEGS);
+    
+    for(seg = 0; (seg < RADIO_CFG_SEGS) && (seg < RADIO_CFG_DELTA_MAX_SEGS); seg++)
     {
-        if(macId == config.sys.expMac1)
-        {
-            config.sys.expMac1 = 0x0013A20000000000;
-        }
-        else if(macId == config.sys.expMac2)
-        {
-            config.sys.expMac2 = 0x0013A20000000000;
-        }
-        else if(macId == config.sys.expMac3)
+        if(segCrc[seg] != radioCfgSegCrc[seg])
         {
-            config.sys.expMac3 = 0x0013A20000000000;
+            mask |= (1UL << seg);
         }
-        return;
-    }    */
+        radioCfgSegCrc[seg] = segCrc[seg];
+    }
+    radioCfgSegCrcValid = TRUE;
     
-    switch(command)
+    for(unit = 0; unit < (SYS_N_UNITS - 1); unit++)
     {
-      case RADIO_CMD_NO_OP:
-          pMsg->cmd= RADIO_CMD_NO_OP;
-          pMsg->dataLen=0;
-          break;
-      case RADIO_CMD_GET_MOIST:
-          pMsg->cmd= RADIO_CMD_GET_MOIST;
-          pMsg->dataLen=0;
-          break;
-      case RADIO_CMD_GET_EXSTAT:
-          pMsg->cmd= RADIO_CMD_GET_EXSTAT;
-          pMsg->dataLen=0;
-          break;
-      case RADIO_CMD_CFG_PUT_START:
-          pMsg->cmd= RADIO_CMD_CFG_PUT_START;
-          pMsg->dataLen=0;
-          break;
-      case RADIO_CMD_CFG_PUT_APPLY:
-          pMsg->cmd= RADIO_CMD_CFG_PUT_APPLY;
-          pMsg->dataLen=0;
-          break;
-      case RADIO_CMD_GET_MB_VALUES:          
-          /* each expansion unit controls valves 1-12 on its 
-           *own system, but take up different zone numbers in the
-           *greater scheme of things.  */
-          pMsg->cmd= RADIO_CMD_GET_MB_VALUES;
-          pMsg->dataLen=1;
-          
-          /*set the first moisture balance zone to be 1.
-           *each expansion controls on its own unit from 1 to 12
-           *want the data for all configured zones from each of the expansions */
-          pMsg->data[0]= 1;
-          length +=1;
-          break;
-      case RADIO_CMD_INIT_DATETIME:
-          pMsg->cmd= RADIO_CMD_INIT_DATETIME;
-          pMsg->dataLen=6;
-          pMsg->data[0]= (uint8_t)(dtYear - 2000);
-          pMsg->data[1]= dtMon+1;
-          pMsg->data[2]= dtMday;
-          pMsg->data[3]= dtHour;
-          pMsg->data[4]= dtMin;
-          pMsg->data[5]= dtSec;          
-          length +=6;
-          break;
-      case RADIO_CMD_SEND_FLOW:
-          pMsg->cmd= RADIO_CMD_SEND_FLOW;
-          pMsg->dataLen=4;
-          pMsg->data[0]= GPM;
-          pMsg->data[1]= (flowDelay >> 8);
-          pMsg->data[2]= (flowDelay & 0x00FF);
-          pMsg->data[3]= findFlow;        
-          length +=4;  
-          break;
-      case RADIO_CMD_IRR_START:
-          pMsg->cmd= RADIO_CMD_IRR_START;
-          pMsg->dataLen=4;
-          pMsg->data[0]=irrExpRunningProg;
-          pMsg->data[1]=sysState;
-          pMsg->data[2]=irrOpMode;
-          pMsg->data[3]=irrPulseMode;
-          length +=4;
-          
-          radioCheckExpanStatusTime = dtTickCount;
-          break; 
-      case RADIO_CMD_IRR_COMPLETE:
-          pMsg->cmd= RADIO_CMD_IRR_COMPLETE;
-          pMsg->dataLen=1;
-          pMsg->data[0]=irrProgram;
-          length +=1;
-          break;
-      case RADIO_CMD_EXPANSION_STATUS:
-          pMsg->cmd= RADIO_CMD_EXPANSION_STATUS;
-          pMsg->dataLen=35;
-          length +=35;
-          /*irrigation state */
-          pMsg->data[0]=sysState;
-          pMsg->data[1]=irrState;
-          if(config.sys.unitType == UNIT_TYPE_EXPANSION_1)
-          {
-              pMsg->data[2]=irrCurZone+12;
-          }
-          else if(config.sys.unitType == UNIT_TYPE_EXPANSION_2)
-          {
-              pMsg->data[2]=irrCurZone+24;
-          } 
-          else if(config.sys.unitType == UNIT_TYPE_EXPANSION_3)
-          {
-              pMsg->data[2]=irrCurZone+36;
-          } 
-          /* System Error Flags */
-          pMsg->data[3]=(uint8_t)(sysErrorFlags >> 8);
-          pMsg->data[4]=(uint8_t)(sysErrorFlags & 0xFF);
-          /* System Fault Flags */
-          pMsg->data[5]=(uint8_t)(sysFaultFlags >> 24);
-          pMsg->data[6]=(uint8_t)((sysFaultFlags & 0x00FF0000) >> 16); 
-          pMsg->data[7]=(uint8_t)((sysFaultFlags & 0x0000FF00) >> 8);
-          pMsg->data[8]=(uint8_t)(sysFaultFlags & 0x000000FF);
-          /* moisture sensor zone failures */
-          pMsg->data[9]=(uint8_t)((moistFailedSensors & 0x0000000000000F00) >> 8);
-          pMsg->data[10]=(uint8_t)((moistFailedSensors & 0x00000000000000FF));
-          
-          /*send zone runtimes to master */
-          for(i=0; i<SYS_N_UNIT_ZONES; i++)
-          {
-                pMsg->data[2*i+11]=(irrDailyRuntimePerZone[i] >> 8);
-                pMsg->data[2*i+12]=(irrDailyRuntimePerZone[i] & 0xFF);    
-          }         
-          break;
-       case RADIO_CMD_IRR_STOP:
-          pMsg->cmd= RADIO_CMD_IRR_STOP;
-          pMsg->dataLen=0;
-          /* release control variable */
-          irrExpRunningProg = IRR_PGM_NONE;
-          sysState = SYS_STATE_IDLE;
-          expansionIrrState =IRR_STATE_IDLE;
-          expansionIrrCurZone = 0;
-          break;
-       case RADIO_CMD_IRR_RESUME:
-          pMsg->cmd= RADIO_CMD_IRR_RESUME;
-          pMsg->dataLen=0;
-          break;
-       case RADIO_CMD_IRR_SKIP:
-          pMsg->cmd= RADIO_CMD_IRR_SKIP;
-          pMsg->dataLen=0;
-          break;
-       case RADIO_CMD_IRR_OFF:
-          pMsg->cmd= RADIO_CMD_IRR_OFF;
-          pMsg->dataLen=0;
-          break; 
-       case RADIO_CMD_IRR_AUTO:
-          pMsg->cmd= RADIO_CMD_IRR_AUTO;
-          pMsg->dataLen=0;
-          break;
-       case RADIO_CMD_IRR_STOP_OFF:
-           pMsg->cmd= RADIO_CMD_IRR_STOP_OFF;
-           pMsg->dataLen=0;
-           break; 
-       case RADIO_CMD_DELETE_SC:
-           pMsg->cmd= RADIO_CMD_DELETE_SC;
-           pMsg->dataLen=1;           
-           /* index of SC to delete */
-           pMsg->data[0]=scDeleteIndex;
-           length +=1;
-           break;
-        case RADIO_CMD_SC_IS_REMOVED:
-           pMsg->cmd= RADIO_CMD_SC_IS_REMOVED;
-           pMsg->dataLen=1;           
-           /* index of SC to delete */
-           pMsg->data[0]=scDeleteIndex;
-           length +=1;
-           break;
-         case RADIO_CMD_EXPAN_GET_CONFIG:
-           pMsg->cmd= RADIO_CMD_EXPAN_GET_CONFIG;
-           pMsg->dataLen=0;
-           break; 
-      default:
-          /* not a supported command */
-          return;
+        radioCfgUnitBase[unit] = radioCfgUnitCrc[unit];
+        radioCfgUnitCrc[unit] = unitCrc[unit];
+        radioCfgRepairMask[unit] = 0;
+        radioCfgDistRetries[unit] = 0;
     }
     
-    pHdr->version = RADIO_PROTOCOL_VER;
-    pHdr->msgType = RADIO_TYPE_CMD;
-    radioMsgInsertCrc(pMsg, length);
+    if(full)
+    {
+        radioCfgDistActive = FALSE;
+        radioCfgDistMask = 0;
+        expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, RADIO_EXP_SEND_ALL);
+        return;
+    }
+    if(mask == 0)
+    {
+        /* nothing the expansion units use has changed */
+        return;
+    }
     
-    if(macId == RADIO_EXP_SEND_ALL )
-    {      
-        /* send command to each expansion unit */
-        expansionBusForwardCmd(&pPacket);
+    radioCfgDistVersion++;
+    if(radioCfgDistVersion == 0)
+    {
+        radioCfgDistVersion = 1;
+    }
+    radioCfgDistSegs = mask;
+    radioCfgDistMask = mask;
+    radioCfgDistUnits = 0;
+    radioCfgDistFull = 0;
+    radioCfgDistActive = TRUE;
+    radioCfgDistTime = drvMSGet();
+    radioCfgDistWait = RADIO_CFG_DELTA_START_MS;
+    
+    expansionBusSendCmd(RADIO_CMD_CFG_DELTA_START, RADIO_EXP_SEND_ALL);
+}
+
 
+/******************************************************************************
+ *
+ * expansionCfgDistPoll
+ *
+ * PURPOSE
+ *      This routine is called from the master's radio polling loop to send
+ *      the next segment of a delta config distribution.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      void
+ *
+ * NOTES
+ *      At most one segment is sent every RADIO_CFG_DELTA_GAP_MS so that the
+ *      broadcasts do not flood the network.  Once all changed segments have
+ *      been broadcast, the units that accepted the delta are asked to apply
+ *      it and the rest are given the full download.  Segments reported
+ *      missing by a unit are then resent to that unit only.
+ *
+ *****************************************************************************/
+static void expansionCfgDistPoll(void)
+{
+    uint64_t macId;
+    uint32_t *pMask;
+    uint8_t seg;
+    uint8_t unit;
+    
+    if((drvMSGet() - radioCfgDistTime) < radioCfgDistWait)
+    {
+        return;
     }
-    else 
+    
+    pMask = NULL;
+    macId = RADIO_EXP_BROADCAST;
+    if(radioCfgDistActive)
     {
-        /* set time counter for timeout response */
-        if(macId == config.sys.masterMac)
+        if(radioCfgDistMask == 0)
         {
-            radioMasterRespTime = dtTickCount;
-            radioSentMasterMsg = TRUE;
+            /* all changed segments have been broadcast */
+            radioCfgDistActive = FALSE;
+            for(unit = 0; unit < (SYS_N_UNITS - 1); unit++)
+            {
+                macId = expansionUnitMacGet(unit);
+                if(macId == 0x0013A20000000000)
+                {
+                    continue;
+                }
+                if((radioCfgDistUnits & (1 << unit)) != 0)
+                {
+                    expansionBusSendCmd(RADIO_CMD_CFG_DELTA_APPLY, macId);
+                }
+                else if((radioCfgDistFull & (1 << unit)) == 0)
+                {
+                    /* unit never answered the delta start */
+                    expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, macId);
+                }
+            }
+            return;
         }
-        else if(macId == config.sys.expMac1)
+        pMask = &radioCfgDistMask;
+    }
+    else
+    {
+        for(unit = 0; unit < (SYS_N_UNITS - 1); unit++)
         {
-            radioExp1RespTime = dtTickCount;
-            radioSentExpan1Msg = TRUE;
+            if(radioCfgRepairMask[unit] != 0)
+            {
+                pMask = &radioCfgRepairMask[unit];
+                macId = expansionUnitMacGet(unit);
+                break;
+            }
         }
-        else if(macId == config.sys.expMac2)
-        {
-            radioExp2RespTime = dtTickCount;
-            radioSentExpan2Msg = TRUE;
-        } 
-        else if(macId == config.sys.expMac3){          
-            radioExp3RespTime = dtTickCount;
-            radioSentExpan3Msg = TRUE;
+        if(pMask == NULL)
+        {
+            return;
         }
-        /*send command to only 1 expansion unit */
-        expansionBusSingleCmd(&pPacket, macId);
     }
+    
+    /* send the lowest numbered segment still pending */
+    for(seg = 0; (*pMask & (1UL << seg)) == 0; seg++)
+    {
+    }
+    *pMask &= ~(1UL << seg);
+    expansionCfgSegSend(seg, macId);
+    
+    if((macId != RADIO_EXP_BROADCAST) && (*pMask == 0))
+    {
+        /* missing segments resent, try the apply again */
+        expansionBusSendCmd(RADIO_CMD_CFG_DELTA_APPLY, macId);
+    }
+    
+    radioCfgDistTime = drvMSGet();
+    radioCfgDistWait = RADIO_CFG_DELTA_GAP_MS;
 }
 
 
 /******************************************************************************
  *
- * expansionBusCmdHandler
+ * radioCfgDeltaStart
  *
  * PURPOSE
- *      This routine handles responses to commands that were issued from this unit
- *      to expansion units. It determines what unit sent the response back and the
- *      command it it responding to. It then acts accordingly to the command.
+ *      This routine handles the start of a delta config distribution on an
+ *      expansion unit.
  *
  * PARAMETERS
- *      pPacket     a pointer to the received radio packet 
+ *      pData       IN  delta start command data
+ *      lenData     IN  length of command data
+ *      srcMac      IN  MAC ID of the unit that sent the command
  *
  * RETURN VALUE
- *      void
+ *      This routine returns RADIO_RESULT_SUCCESS if the delta can be applied
+ *      on top of the image in the download buffer, RADIO_RESULT_FAILURE if
+ *      the full configuration download is needed.
  *
  *****************************************************************************/
-void expansionBusCmdHandler(const radioRxDataPacket_t *pPacket)
+static uint8_t radioCfgDeltaStart(const uint8_t *pData, uint8_t lenData, uint64_t srcMac)
 {
-    radioMsgAck_t *pMsg = (radioMsgAck_t *)&pPacket->data[0]; 
-    uint8_t moistStart=0;
-    uint8_t moistEnd=0;
+    uint16_t base;
     uint8_t i;
     
-    /* rebuild the MAC of the source of the packet */
-    uint64_t expUnitMacID = U8TOU64(pPacket->phyAddr[0],
-                             pPacket->phyAddr[1],
-                             pPacket->phyAddr[2],
-                             pPacket->phyAddr[3],
-                             pPacket->phyAddr[4],
-                             pPacket->phyAddr[5],
-                             pPacket->phyAddr[6],
-                             pPacket->phyAddr[7]);
+    radioCfgDeltaVersion = 0;
     
-    /* inform the system that communication was received from the proper expansion */
-    if(expUnitMacID ==config.sys.expMac1)
+    if((lenData != RADIO_CFG_DELTA_START_SIZE) ||
+       (pData[0] == 0) ||
+       (srcMac != config.sys.masterMac) ||
+       (config.sys.unitType < UNIT_TYPE_EXPANSION_1) ||
+       (config.sys.unitType > UNIT_TYPE_EXPANSION_3))
     {
-        radioStatusExpansion1 = EXPANSION_CONNECTED;
-        radioSentExpan1Msg = FALSE;
-        sysFaultClear(SYS_FAULT_EXPAN_1);
+        return RADIO_RESULT_FAILURE;
     }
-    else if(expUnitMacID ==config.sys.expMac2)
+    i = (config.sys.unitType - UNIT_TYPE_EXPANSION_1) * 2;
+    
+    /* the download buffer must hold the image the delta is based on */
+    configBufferRead(2, &base, sizeof(base));
+    if(ntohs(base) != U8TOU16(pData[11 + i], pData[12 + i]))
     {
-        radioStatusExpansion2 = EXPANSION_CONNECTED;
-        radioSentExpan2Msg = FALSE;
-        sysFaultClear(SYS_FAULT_EXPAN_2);
+        return RADIO_RESULT_FAILURE;
     }
-    else if(expUnitMacID ==config.sys.expMac3)
+    
+    radioCfgDeltaVersion = pData[0];
+    radioCfgDeltaMask = U8TOU32(pData[1], pData[2], pData[3], pData[4]);
+    radioCfgDeltaCrc = U8TOU16(pData[5 + i], pData[6 + i]);
+    return RADIO_RESULT_SUCCESS;
+}
+
+
+/******************************************************************************
+ *
+ * radioCfgDeltaSegment
+ *
+ * PURPOSE
+ *      This routine writes a received delta config segment into the
+ *      download buffer of an expansion unit.
+ *
+ * PARAMETERS
+ *      pMsg        IN  delta segment transfer message
+ *      srcMac      IN  MAC ID of the unit that sent the segment
+ *
+ * RETURN VALUE
+ *      void
+ *
+ * NOTES
+ *      Segments that are not part of the current delta are ignored, which
+ *      includes broadcasts received by units that did not accept the delta.
+ *
+ *****************************************************************************/
+static void radioCfgDeltaSegment(const radioMsgXfer_t *pMsg, uint64_t srcMac)
+{
+    uint8_t data[RADIO_MAXSEGMENT];
+    configSys_t *pSys = (configSys_t *)data;
+    uint32_t offset;
+    uint32_t len;
+    uint8_t seg = pMsg->segLow;
+    
+    if((radioCfgDeltaVersion == 0) ||
+       (pMsg->segHigh != radioCfgDeltaVersion) ||
+       (srcMac != config.sys.masterMac) ||
+       (seg >= RADIO_CFG_DELTA_MAX_SEGS) ||
+       ((radioCfgDeltaMask & (1UL << seg)) == 0))
     {
-        radioStatusExpansion3 = EXPANSION_CONNECTED;
-        radioSentExpan3Msg = FALSE;
-        sysFaultClear(SYS_FAULT_EXPAN_3);
+        return;
     }
-    else if(expUnitMacID ==config.sys.masterMac)
+    
+    offset = seg * RADIO_MAXSEGMENT;
+    len = CONFIG_IMAGE_SIZE - offset;
+    if (len > RADIO_MAXSEGMENT)
     {
-        radioSentMasterMsg = FALSE;
-        sysFaultClear(SYS_FAULT_EXPAN_MASTER);
+        len = RADIO_MAXSEGMENT;
     }
-    
-    
-    /* handle each response */                         
-    switch(pMsg->cmd)
+    if(pMsg->dataLen != len)
     {
-      case RADIO_CMD_NO_OP:
-          radioMessageLog("Expan: No Op ACK");
-          break;
-      case RADIO_CMD_INHIBIT_ON:
-          radioMessageLog("Expan: Inhibit On ACK");
-          break;
-      case RADIO_CMD_INHIBIT_OFF:
-          radioMessageLog("Expan: Inhibit Off ACK");
-          break;
-      case RADIO_CMD_FORCE_ON:
-          radioMessageLog("Expan: Force On ACK");
-          break;
-      case RADIO_CMD_WEATHER_DATA:
-          radioMessageLog("Expan: Weather Data ACK");
-          break;
-      case RADIO_CMD_INIT_DATETIME:
-          radioMessageLog("Expan: Init DateTime ACK");
-          break;
-      case RADIO_CMD_GET_MOIST:
-          radioMessageLog("Expan: Get Moist ACK");
-          
-          /* determine which unit responded and load
-           * the data into the correct zones */
-          if(expUnitMacID ==config.sys.expMac1)
-          {   
-                moistStart = 13;
-                moistEnd = 24;
-          }
-          else if(expUnitMacID ==config.sys.expMac2)
-          {
-                moistStart = 25;
-                moistEnd = 36;
-          }
-          else if(expUnitMacID ==config.sys.expMac3)
-          {
-                moistStart = 37;
-                moistEnd = 48;
-          }
-          
-          /* load moisture data from expansion unit into moisture array */
-          for(i= moistStart; i < moistEnd;i++)
-          {
-             //drvMoistValueSet(i,pMsg->data[i-moistStart+10]);
-             expMoistValue[i-13] =  pMsg->data[i-moistStart+10];
-          }
-          break;
-      case RADIO_CMD_GET_EXSTAT:
-          radioMessageLog("Expan: Get Ext Stat ACK");
-          
-          
-          break;
-      case RADIO_CMD_CFG_PUT_START:
-          radioMessageLog("Expan: Put Cfg Start ACK");
-          
-          /* update the configuration snapshot buffer before reading from it
-           * this puts the latest version of the configuration image into the
-           * snapshot buffer which is what is sent to the expansion units. */
-          configSnapshotSave();
-          
-          /* start the bulk transfer of the config file 
-           * by sending segment 0 of the configuration file */
-          expansionSendCfgSeg0(pPacket);
-          break;
-      case RADIO_CMD_CFG_PUT_APPLY:
-          radioMessageLog("Expan: Cfg Apply ACK");
-          
-          /*check to see if the configuration update of expansion unit 
-           *was successful */
-          if(pMsg->data[0] == RADIO_RESULT_FAILURE)
-          {
-              /* resend the configuration from the beginning*/
-              expansionBusSendCmd(RADIO_CMD_CFG_PUT_START, expUnitMacID);
-          } 
-          else
-          {
-              expansionBusSendCmd(RADIO_CMD_INIT_DATETIME, expUnitMacID);
-          }
-          break;
-      case RADIO_CMD_GET_MB_VALUES:
-          radioMessageLog("Expan: Get MB Val ACK");
-         
-          /*account for which unit data came from so it is placed in the
-          *master zone list in the proper zone */
-          if(expUnitMacID ==config.sys.expMac1)
-          {
-              pMsg->data[0] += 12;
-          }
-          else if(expUnitMacID ==config.sys.expMac2)
-          {
-              pMsg->data[0] += 24;
-          }
-          else if(expUnitMacID ==config.sys.expMac3)
-          {
-              pMsg->data[0] += 36;
-          }
-         
-          /* Set Moisture Balance Values from command data. */ 
-          if(radioProtoCmdSetMbValues(pMsg->data, pMsg->dataLen)==FALSE) 
-          {
-              /* failure since zone or values are out of bounds */
-          }
-            
-          break;
-      default:
-          /* not a supported command */
-          return;
+        return;
     }
     
-    /* Yield control back to the system polling loop. */
-    radioYield = TRUE;
-        
+    memcpy(data, pMsg->data, len);
+    if(seg == 0)
+    {
+        /* segment 0 is sent as the master's own system config */
+        pSys->unitType = config.sys.unitType;
+        pSys->masterMac = srcMac;
+    }
+    configBufferWrite(data, offset, len);
+    radioCfgDeltaMask &= ~(1UL << seg);
 }
 
 
 /******************************************************************************
  *
- * expansionSendCfgSeg0
+ * radioCfgDeltaApply
  *
  * PURPOSE
- *      When an expansion unit responds to the command to start the configuration
- *      download it will then send the first segment (segment 0) of the configuration
- *      data image to kick off the complete data transfer. When the expansion unit
- *      responds to this packet the bulkDataTransferHandler will take control of 
- *      sending the remaining packets of the data image.
+ *      This routine applies a completed delta config distribution on an
+ *      expansion unit.
+ *
  * PARAMETERS
- *      pPacket     a pointer to the received radio packet 
+ *      pData       IN  delta apply command data
+ *      lenData     IN  length of command data
+ *      pAck        OUT acknowledgement data
  *
  * RETURN VALUE
- *      void
+ *      This routine returns the length of the acknowledgement data.
+ *
+ * NOTES
+ *      The result is RADIO_RESULT_MISSING followed by the mask of segments
+ *      still expected when some of the broadcasts were lost.  The image
+ *      checksum from the delta start is written to the download buffer, so
+ *      configBufferLoad() verifies the whole image before it is used.
  *
  *****************************************************************************/
-void expansionSendCfgSeg0(const radioRxDataPacket_t *pPacket)
+static uint8_t radioCfgDeltaApply(const uint8_t *pData, uint8_t lenData, uint8_t *pAck)
 {
-   radioMsgXfer_t resp;   
-   configSys_t  * pExpanConfigSys = (configSys_t  *)resp.data;
-   configImage_t expanConfig;
-   
-   /* rebuild the MAC of the source of the packet */
-    uint64_t expUnitMacID = U8TOU64(pPacket->phyAddr[0],
-                             pPacket->phyAddr[1],
-                             pPacket->phyAddr[2],
-                             pPacket->phyAddr[3],
-                             pPacket->phyAddr[4],
-                             pPacket->phyAddr[5],
-                             pPacket->phyAddr[6],
-                             pPacket->phyAddr[7]);
-                             
-   resp.xferMode = RADIO_XMODE_CONFIG | RADIO_XMODE_PUT_REQ;
-   
-   /* Set segment index in response header. */
-   resp.segHigh = 0x00;
-   resp.segLow = 0x00;
-   configSnapshotRead(0, resp.data, RADIO_MAXSEGMENT);
-   resp.dataLen = (uint8_t)RADIO_MAXSEGMENT;
-   
-   
-   configSnapshotRead(0, &expanConfig, sizeof(configImage_t));
-   /*set the master mac id */
-   expanConfig.sys.masterMac = radioMacId;
-   pExpanConfigSys->masterMac = radioMacId;
+    uint16_t crc;
+    int16_t result;
     
-   if(expUnitMacID ==config.sys.expMac1)
-   {
-      expanConfig.sys.unitType = UNIT_TYPE_EXPANSION_1;
-      pExpanConfigSys->unitType = UNIT_TYPE_EXPANSION_1; 
-   }
-   else if(expUnitMacID ==config.sys.expMac2)
-   {
-      expanConfig.sys.unitType = UNIT_TYPE_EXPANSION_2;
-      pExpanConfigSys->unitType = UNIT_TYPE_EXPANSION_2;
-   }
-   else if(expUnitMacID ==config.sys.expMac3)
-   {
-      expanConfig.sys.unitType = UNIT_TYPE_EXPANSION_3;
-      pExpanConfigSys->unitType = UNIT_TYPE_EXPANSION_3;
-   }
-   
-   
-    /* recompute the CRC checksum */                                        
-    pExpanConfigSys->checkSum=configMemorySnapShotChecksumCalc((uint8_t *)&expanConfig);
-   
-    /* Send segment 0 of config to expansion unit */
-    radioProtocolRespSend(pPacket,
-                          &resp,
-                          RADIO_TYPE_XFER,
-                          RADIO_XFER_HEADER_SIZE + resp.dataLen);   
+    if((lenData != 1) ||
+       (radioCfgDeltaVersion == 0) ||
+       (pData[0] != radioCfgDeltaVersion))
+    {
+        pAck[0] = RADIO_RESULT_FAILURE;
+        pAck[1] = 0;
+        pAck[2] = 0;
+        return 3;
+    }
+    
+    if(radioCfgDeltaMask != 0)
+    {
+        pAck[0] = RADIO_RESULT_MISSING;
+        pAck[1] = (uint8_t)(radioCfgDeltaMask >> 24);
+        pAck[2] = (uint8_t)(radioCfgDeltaMask >> 16);
+        pAck[3] = (uint8_t)(radioCfgDeltaMask >> 8);
+        pAck[4] = (uint8_t)(radioCfgDeltaMask & 0xFF);
+        return 5;
+    }
+    
+    radioCfgDeltaVersion = 0;
+    crc = htons(radioCfgDeltaCrc);
+    configBufferWrite(&crc, 2, sizeof(crc));
+    
+    result = configBufferLoad();
+    if(result == -1)
+    {
+        pAck[0] = RADIO_RESULT_SUCCESS;
+        pAck[1] = 0;
+        pAck[2] = 0;
+        debugWrite("Configuration delta applied.\n");
+        
+        sysFaultClear(SYS_FAULT_EXPAN_MASTER);
+    }
+    else
+    {
+        pAck[0] = RADIO_RESULT_FAILURE;
+        pAck[1] = result >> 8;
+        pAck[2] = result & 0x00FF;
+        debugWrite("Configuration delta not applied - invalid image.\n");
+    }
+    return 3;
 }
-
-
-
-
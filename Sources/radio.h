@@ -62,6 +62,12 @@
 /* Number of segments needed to transfer a configuration image */
 #define RADIO_CFG_SEGS ((CONFIG_IMAGE_SIZE + RADIO_MAXSEGMENT - 1) / RADIO_MAXSEGMENT)
 
+/* Max config block CRCs per RADIO_CMD_CFG_MANIFEST ack (8-byte data header) */
+#define RADIO_CFG_MANIFEST_CRCS 23
+
+/* RADIO_CMD_GET_PROTOSTAT flags (command data byte 1) */
+#define RADIO_PROTOSTAT_RESET   0x01    /* clear statistics after this read */
+
 /* Number of segements needed to transfer a max flash firmware version */
 #define RADIO_FW_SEGS  ((MAX_FW_IMAGE_SIZE + RADIO_MAXSEGMENT - 1) / RADIO_MAXSEGMENT)
 
@@ -78,6 +84,8 @@
 #define RADIO_INIT_FAIL_SECS          15        /* Init response time-out fail secs */
 #define RADIO_EXPAN_FAIL_SECS         15        /* Expansion Bus time-out fail secs */
 #define RADIO_EXPAN_STATUS_INTERVAL   45        /* number of seconds between checking radio comm with unit irrigating */
+#define RADIO_DIGEST_MAX_AGE_SECS     30        /* age at which cached expansion status digest is refreshed */
+#define RADIO_DIGEST_REFRESH_SECS     300       /* background expansion status digest refresh interval */
 
 #ifdef DEBUG_TIMINGS_ENABLED
     #pragma message("DEBUG!!! RADIO_SNSCON_FAIL_SECS @ 120s")
@@ -90,6 +98,15 @@
 #define RADIO_TXD_N_RETRIES     2       /* Number of Tx Data retries */
 #define RADIO_TXD_RETRY_SECS    5       /* Seconds between Tx data retries */
 
+/*
+**  Tx Data Priority Classes (0 = highest)
+*/
+#define RADIO_TXP_VALVE         0       /* Sensor Concentrator Valve Control */
+#define RADIO_TXP_IRR           1       /* Expansion Bus Irrigation Control */
+#define RADIO_TXP_NOC           2       /* NOC Command Responses */
+#define RADIO_TXP_BULK          3       /* Bulk Data Transfer */
+#define RADIO_TXP_N             4       /* Number of Tx Data Priority Classes */
+
 /* Radio Status */
 #define RADIO_STATUS_NOTPOP     0       /* Assume radio module not populated */
 #define RADIO_STATUS_ONLINE     1       /* Radio is associated with a PAN */
@@ -157,7 +174,7 @@
 
 #define RADIO_CMD_INIT_DATETIME 0x0D    /* Init Date/Time (DEBUG) */
 
-#define RADIO_CMD_GET_RADIOSTAT 0x0E    /* Get Radio Status (FUTURE) */
+#define RADIO_CMD_GET_RADIOSTAT 0x0E    /* Get Radio Status (Tx queue statistics) */
 #define RADIO_CMD_DIAGNOSE      0x0F    /* Diagnostic Command (FUTURE) */
 
 #define RADIO_CMD_WEATHER_DATA  0x10    /* Weather Update */
@@ -179,13 +196,21 @@
 #define RADIO_CMD_DELETE_SC       0x20    /* tell expansion unit to delete SC */
 #define RADIO_CMD_SC_IS_REMOVED   0x21    /* expansion telling master SC has been deleted */
 #define RADIO_CMD_EXPAN_GET_CONFIG 0x22     /* expansion requesting configuration from the master unit */
-#define RADIO_CMD_SEND_FLOW        0x26     /* Master telling expansion the flow meter value.
+#define RADIO_CMD_EXPAN_DIGEST     0x24     /* master requesting status digest from expansion unit */
+#define RADIO_CMD_SEND_FLOW        0x26     /* Master telling expansion the flow meter value. */
+#define RADIO_CMD_CFG_DELTA_START  0x27     /* master starting a delta config distribution */
+#define RADIO_CMD_CFG_DELTA_APPLY  0x28     /* master asking expansion to apply the delta config */
+#define RADIO_CMD_CFG_MANIFEST     0x29     /* Get Config Snapshot Block CRC Manifest */
+#define RADIO_CMD_GET_PROTOSTAT    0x2A     /* Get (and optionally reset) Protocol Statistics */
+
+#define RADIO_PROTO_CMD_N          (RADIO_CMD_GET_PROTOSTAT + 1) /* size of WOIS command dispatch table */
 
 
 /* Engineering Debug/Experimental Commands */
 #define RADIO_CMD_RC_TEST       0x90    /* Remote Control Test */
 #define RADIO_CMD_RC_EVENT      0x91    /* Remote Control Event */
 #define RADIO_CMD_RC_GETLCD     0x92    /* Remote Control Get LCD Data */
+#define RADIO_CMD_RC_SUBLCD     0x93    /* Remote Control Subscribe LCD Updates */
 #define RADIO_CMD_EVENT_LOG     0x9E    /* Save Event Log */
 #define RADIO_CMD_GET_FW_VER    0x9F    /* Get Firmware Version */
 
@@ -207,7 +232,7 @@
 #define RADIO_ACK_GET_MANUFDATA 0x0B    /* Get Manufacture Data Ack (FUTURE) */
 #define RADIO_ACK_SET_ACTION    0x0C    /* Set Controller Action Ack (FUTURE) */
 #define RADIO_ACK_INIT_DATETIME 0x0D    /* Init Date/Time Ack (DEBUG) */
-#define RADIO_ACK_GET_RADIOSTAT 0x0E    /* Get Radio Status Ack (FUTURE) */
+#define RADIO_ACK_GET_RADIOSTAT 0x0E    /* Get Radio Status Ack */
 #define RADIO_ACK_DIAGNOSE      0x0F    /* Diagnostic Command Ack  (FUTURE)*/
 #define RADIO_ACK_WEATHER_DATA  0x10    /* Weather Update Ack */
 #define RADIO_ACK_GET_MB_VALUES 0x11    /* Get Moisture Balance Values Ack */
@@ -229,11 +254,18 @@
 #define RADIO_ACK_DELETE_SC       0x21    /* tell expansion unit to delete SC */
 #define RADIO_ACK_SC_IS_REMOVED   0x22    /* expansion telling master SC has been deleted */
 #define RADIO_ACK_EXPAN_GET_CONFIG 0x23     /* expansion requesting configuration from the master unit */
+#define RADIO_ACK_EXPAN_DIGEST    0x24    /* expansion status digest */
 #define RADIO_ACK_SEND_FLOW       0x26
+#define RADIO_ACK_CFG_DELTA_START 0x27    /* start delta config distribution */
+#define RADIO_ACK_CFG_DELTA_APPLY 0x28    /* apply delta config */
+#define RADIO_ACK_CFG_MANIFEST    0x29    /* config snapshot block CRC manifest */
+#define RADIO_ACK_GET_PROTOSTAT   0x2A    /* protocol statistics */
 /* Engineering Debug/Experimental Command Acknowledgements */
 #define RADIO_ACK_RC_TEST       0xA0    /* Radio Control Test Ack */
 #define RADIO_ACK_RC_EVENT      0xA1    /* Radio Control Event Ack */
 #define RADIO_ACK_RC_GETLCD     0xA2    /* Radio Control Get LCD Data Ack */
+#define RADIO_ACK_RC_SUBLCD     0xA3    /* Radio Control Subscribe LCD Ack */
+#define RADIO_ACK_RC_LCDDELTA   0xA4    /* Radio Control LCD Changes (pushed) */
 #define RADIO_ACK_EVENT_LOG     0xAE    /* Save Event Log Ack */
 #define RADIO_ACK_GET_FW_VER    0xAF    /* Get Firmware Version */
 
@@ -246,6 +278,9 @@
 #define RADIO_XMODE_LEVEL       0x40    /* 24hrs Level Sensor Readings */
 #define RADIO_XMODE_EXP_FW      0x50    /* RFU: WOIS Expansion Unit Firmware */
 #define RADIO_XMODE_RAD_FW      0x60    /* RFU: WOIS Radio Firmware */  
+#define RADIO_XMODE_JOURNAL     0x70    /* System Event Journal (by seq #) */
+#define RADIO_XMODE_JQUERY      0x80    /* System Event Journal Query */
+#define RADIO_XMODE_CONFIG_RLE  0x90    /* WOIS Config Image, RLE encoded */
 #define RADIO_XMODE_EEPROM      0xE0    /* EEPROM debug */
 
 /*
@@ -257,6 +292,7 @@
 #define RADIO_XMODE_GET_NACK    0x04    /* Get Data Nack (from WOIS) */
 #define RADIO_XMODE_PUT_ACK     0x05    /* Put Data Ack (from WOIS) */
 #define RADIO_XMODE_PUT_NACK    0x06    /* Put Data Nack (from WOIS) */
+#define RADIO_XMODE_DELTA_PUT   0x07    /* Delta Put Data, no ack (from master) */
 
 /*
 **  WOIS Exception Flags
@@ -288,6 +324,7 @@
 /* Command Result Indication */
 #define RADIO_RESULT_SUCCESS    1       /* Success */
 #define RADIO_RESULT_FAILURE    0       /* Failure */
+#define RADIO_RESULT_MISSING    2       /* Failure - data segments missing */
 
 /* Weather Update Result Indication */
 #define RADIO_WEATHER_MODE_ON   1       /* Weather Mode Enabled */
@@ -470,6 +507,7 @@
 #define RADIO_CMD_ND        0x97    /* Node Discover. returned 9 seperate  
                                      * AT_CMD respone packets  for each node*/
 #define RADIO_CMD_RC        0x98    /* Read the RSSI value of specified channel 0-11  */
+#define RADIO_CMD_AUTO_LAST RADIO_CMD_RC    /* last automated cmd identifier */
 //#define RADIO_CMD_NH_S      0x99    /* Set the number of hops for the radio */
 //#define RADIO_CMD_CE_S      0xA0    /* Set CE */
 //#define RADIO_CMD_CE        0xA1    /* get CE value */ 
@@ -493,7 +531,54 @@
  *  EXPANSION BUS
  *
  *****************************************************************************/
-#define RADIO_EXP_SEND_ALL    0x0   /* send expansion bus message to all units
+#define RADIO_EXP_SEND_ALL    0x0   /* send expansion bus message to all units */
+#define RADIO_EXP_BROADCAST   0x000000000000FFFF  /* ZigBee broadcast address */
+
+/*
+**  Delta Config Distribution
+**
+**  When the master's configuration changes only the 64-byte config segments
+**  that differ from the last distributed image are broadcast, once, to all
+**  expansion units.  The start command data is:
+**
+**      [0]     distribution version (1-255)
+**      [1-4]   changed segment mask (bit 0 = segment 0)
+**      [5-10]  new image checksum for expansion 1, 2, 3
+**      [11-16] base image checksum for expansion 1, 2, 3
+**
+**  A unit accepts the delta only if its download buffer holds the base image.
+**  Segments are sent with the RADIO_XMODE_DELTA_PUT transfer mode carrying
+**  the version in segHigh and the segment index in segLow.  The apply
+**  command data is the version; a unit that is missing segments answers
+**  RADIO_RESULT_MISSING followed by the 4-byte mask of missing segments,
+**  which the master resends to that unit only.  Units that refuse or fail
+**  the delta get the full configuration download.
+*/
+#define RADIO_CFG_DELTA_START_SIZE  17      /* delta start command data size */
+#define RADIO_CFG_DELTA_MAX_SEGS    32      /* segments covered by the mask */
+#define RADIO_CFG_DELTA_START_MS    1000    /* ms from start to first segment */
+#define RADIO_CFG_DELTA_GAP_MS      250     /* ms between delta segments */
+#define RADIO_CFG_DELTA_RETRIES     2       /* missing segment resends per unit */
+
+/*
+**  Expansion Status Digest
+**
+**  The digest ACK data (after the 10-byte serial number/status prefix) is a
+**  fixed header followed by one entry for each zone set in the zone mask.
+**  Only zones whose values changed since the digest sequence number sent in
+**  the request are included; a request with a stale or zero sequence number
+**  returns all zones.
+**
+**      [0]     digest sequence number (1-255)
+**      [1]     digest flags
+**      [2-3]   zone mask (bit 0 = unit zone 1)
+**      [4-..]  zone entries: moisture (1), MB value (2), daily runtime (2)
+*/
+#define RADIO_DIGEST_HDR_SIZE   4       /* digest fixed header size */
+#define RADIO_DIGEST_ZONE_SIZE  5       /* digest zone entry size */
+#define RADIO_DIGEST_MAX_ZONES  10      /* zone entries that fit in one ACK */
+#define RADIO_DIGEST_FLAG_MORE  0x01    /* more changed zones remain */
+#define RADIO_DIGEST_FLAG_FULL  0x02    /* digest started from a full refresh */
 
 /******************************************************************************
  *
@@ -737,6 +822,79 @@ typedef struct
    uint8_t solenoidState;               /* only using the 4 LS bits. 1 means ON and 0 means OFF */
 }packetSCAckData_t;
 
+/*
+**  Expansion Status Digest Cache (master only)
+*/
+typedef struct
+{
+    uint32_t rxTime;                    /* tick count of last digest received */
+    uint32_t reqTime;                   /* tick count of last digest request */
+    uint8_t seq;                        /* last digest sequence (0=none) */
+} radioExpDigest_t;
+
+/*
+**  Tx Data Queue Statistics (per priority class)
+*/
+typedef struct
+{
+    uint16_t sent;                      /* frames sent */
+    uint16_t dropped;                   /* frames dropped, queue full */
+    uint16_t maxMs;                     /* longest time queued, in ms */
+    uint32_t totalMs;                   /* total time queued, in ms */
+} radioTxqStat_t;
+
+/*
+**  Protocol Statistics (per WOIS command and per transfer data type)
+**  An entry is assigned to a command code or transfer data type when it is
+**  first received, so only the messages actually in use take space; this
+**  includes the extended commands passed to radioExtCommandHandler.  Once
+**  all entries are taken, other messages are counted in the last entry.
+*/
+#define RADIO_PSTAT_N           24      /* number of entries */
+#define RADIO_PSTAT_NONE        0xFF    /* no entry */
+
+/* Protocol statistics entry types */
+#define RADIO_PSTAT_FREE        0       /* entry not in use */
+#define RADIO_PSTAT_CMD         1       /* command; code is the command code */
+#define RADIO_PSTAT_XFER        2       /* transfer; code is mode & 0xF0 */
+#define RADIO_PSTAT_OTHER       3       /* messages received once table full */
+
+typedef struct
+{
+    uint8_t type;                       /* entry type (RADIO_PSTAT_xxx) */
+    uint8_t code;                       /* command code or transfer type */
+    uint16_t rx;                        /* messages received with valid CRC */
+    uint16_t ack;                       /* acks or transfer responses sent */
+    uint16_t nack;                      /* commands rejected, transfer NACKs */
+    uint16_t dup;                       /* repeats of the previous message */
+    uint16_t txFail;                    /* responses failed after all retries */
+    uint16_t maxMs;                     /* longest processing time, in ms */
+    uint32_t totalMs;                   /* total processing time, in ms */
+} radioProtoStat_t;
+
+/*
+**  Radio Replay Benchmark Traffic Models
+*/
+#define RADIO_REPLAY_NOOP       0       /* No Op commands */
+#define RADIO_REPLAY_EXSTAT     1       /* Get Extended Status commands */
+#define RADIO_REPLAY_GETLCD     2       /* Remote Control Get LCD polls */
+#define RADIO_REPLAY_CFGGET     3       /* Config image segment gets */
+#define RADIO_REPLAY_TXSTAT     4       /* ZigBee Tx Status frames */
+#define RADIO_REPLAY_MIX        5       /* all of the above, in turn */
+#define RADIO_REPLAY_N          6       /* Number of traffic models */
+#define RADIO_REPLAY_STALL_MS   500     /* ms without a frame handled before replay gives up */
+
+/*
+**  Radio Replay Benchmark Result
+*/
+typedef struct
+{
+    uint16_t frames;                    /* frames injected */
+    uint16_t handled;                   /* frames read and handled */
+    uint16_t txFrames;                  /* response frames (discarded) */
+    uint32_t ms;                        /* elapsed time, in ms */
+} radioReplayResult_t;
+
 /******************************************************************************
  *
  *  Radio Node Information Stucture
@@ -827,13 +985,14 @@ extern uint16_t dtid;
 /* Global variable externs only for WIN32 platform */
 extern uint32_t radioEtAccumulator;         /* ET Data Accumulator */
 extern uint32_t radioRainAccumulator;       /* Rainfall Data Accumulator */
-extern uint8_t radioTxDataRetriesRemaining; /* numbr of Tx data retries left */
-extern radioTxDataPacket_t radioTxDataPkt;  /* last Tx data packet buffer */
-extern uint16_t radioTxDataPktLen;          /* last Tx data packet length */
 extern uint32_t radioTxDataTime;            /* last Tx data send tick count */
 #endif
 
 extern uint8_t expMoistValue[36];
+extern radioExpDigest_t radioExpDigest[SYS_N_UNITS - 1];
+extern radioTxqStat_t radioTxqStat[RADIO_TXP_N];
+extern radioProtoStat_t radioProtoStat[RADIO_PSTAT_N];
+extern const char * const radioReplayName[RADIO_REPLAY_N];
 
 /******************************************************************************
  *
@@ -854,8 +1013,14 @@ void radioLoopbackTestStart(void);
 void radioLoopbackTestCancel(void);
 void radioRemoveSensorAssocHandler(uint64_t sensorMAC);
 void expansionBusSendCmd(uint8_t command,uint64_t macId);
+void expansionDigestRequest(void);
+void expansionCfgDistribute(void);
 uint8_t radioAddSensorAssocList(uint64_t sensorMAC);
 uint8_t radioRemoveSensorAssocList(uint64_t sensorMAC);
+bool_t radioReplayRun(uint8_t model,
+                      uint16_t count,
+                      radioReplayResult_t *pResult);
+void radioProtoStatReset(void);
 /*
 **  RADIO FUNCTIONS MADE PUBLIC ONLY FOR WIN32 PLATFORM
 */
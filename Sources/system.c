@@ -33,6 +33,7 @@
 #include "drvSys.h"
 #include "drvRtc.h"
 #include "drvExtFlash.h"
+#include "extFlash.h"
 
 
 
@@ -49,6 +50,23 @@
 #define SYS_EVENT_PAUSE         SYS_EVENT_SYS + 10  /* Pause Command */
 #define SYS_EVENT_RESUME        SYS_EVENT_SYS + 11  /* Resume Command */
 #define SYS_EVENT_SHUTDOWN      SYS_EVENT_SYS + 12  /* Shutdown Start */
+#define SYS_EVENT_BOOT_CONFIG   SYS_EVENT_SYS + 13  /* configInit time, ms */
+#define SYS_EVENT_BOOT_DONE     SYS_EVENT_SYS + 14  /* Reset to 1st poll, ms */
+
+/* Event Journal */
+#define SYS_JOURNAL_OFF         0       /* journal not initialized */
+#define SYS_JOURNAL_READY       1       /* journal ready for writes */
+#define SYS_JOURNAL_ERASING     2       /* journal sector erase in progress */
+#define SYS_JOURNAL_ERASED      0xFFFFFFFF  /* sequence number of free slot */
+#define SYS_JOURNAL_INVALID     0           /* sequence number of bad slot */
+#define SYS_JOURNAL_SECTORS     2           /* flash sectors used by journal */
+#define SYS_JOURNAL_SLOT_ADDR(sector, slot) \
+    (sysJournalSectorAddr[sector] + (uint32_t)(slot) * sizeof(sysJournalEntry_t))
+
+/* Journal index subsystem bit for an event type (see sysJournalFilter_t). */
+#define SYS_JOURNAL_SUBSYS_BIT(type) \
+    ((((type) >> 12) >= 1 && ((type) >> 12) <= 7) ? \
+     (uint8_t)(1 << (((type) >> 12) - 1)) : 0x80)
  
 /******************************************************************************
  *
@@ -73,6 +91,37 @@ bool_t sysIsPaused = FALSE;             /* Paused Flag On=TRUE */
 bool_t sysResetRequest = FALSE;         /* Request a system reset if TRUE */
 sysEventLog_t sysEventLog;              /* System Event Log Data Store */
 bool_t sysInhibitStop = FALSE;          /* Inhibit off command recieved, wait for SC to checkin before clearing */
+uint16_t sysBootConfigMs = 0;           /* configInit duration in ms */
+uint16_t sysBootMs = 0;                 /* reset to first sysPoll in ms */
+
+/*
+** Event Journal State
+*/
+static const uint32_t sysJournalSectorAddr[SYS_JOURNAL_SECTORS] =
+{
+    EVENT_JOURNAL_SPI_ADDR,
+    EVENT_JOURNAL_B_SPI_ADDR
+};
+static uint32_t sysJournalBaseSeq;      /* sequence number in active slot 0 */
+static uint32_t sysJournalNextSeq;      /* sequence number for next entry */
+static uint32_t sysJournalOldBaseSeq;   /* sequence number in older slot 0 */
+static uint16_t sysJournalOldCount = 0; /* entries kept in older sector */
+static uint8_t sysJournalSector = 0;    /* active journal sector */
+static uint8_t sysJournalPending = 0;   /* event log index to journal next */
+static uint8_t sysJournalBacklog = 0;   /* event log entries not journaled */
+static uint8_t sysJournalState = SYS_JOURNAL_OFF;   /* journal state */
+static uint8_t sysJournalIndex[SYS_JOURNAL_SECTORS]
+                              [SYS_JOURNAL_LIMIT / SYS_JOURNAL_INDEX_BLOCK];
+                                        /* subsystems in each index block */
+static uint32_t sysJournalIndexSeq;     /* next sequence number to index */
+static uint32_t sysJournalIndexEnd;     /* end of entries journaled at init */
+static bool_t sysJournalIndexReady = FALSE; /* index covers all entries */
+
+static void sysJournalFlush(void);
+static uint16_t sysJournalScan(uint8_t sector, uint32_t *pBase);
+static void sysJournalInvalidate(uint8_t sector, uint16_t slot);
+static bool_t sysJournalLocate(uint32_t *pSeq, uint8_t *pSector, uint16_t *pSlot);
+static void sysJournalIndexBuild(void);
 
 /*
 ** Expansion Units State and Status Data
@@ -116,7 +165,7 @@ const char sysVersionDate[12] = "11-14-2014";
  *****************************************************************************/
 void sysInit(void)
 {
-    
+    uint32_t startMs;
     
     /*
     ** Initialize all application subsystems.
@@ -130,7 +179,10 @@ void sysInit(void)
 
     
     /* Initialize configuration subsystem. */
+    startMs = drvMSGet();
     configInit();
+    sysBootConfigMs = (uint16_t)(drvMSGet() - startMs);
+    sysEvent(SYS_EVENT_BOOT_CONFIG, sysBootConfigMs);
 
     /* Initialize user interface subsystem. */
     uiInit();
@@ -138,6 +190,9 @@ void sysInit(void)
     /* Initialize date/time subsystem. */
     dtInit();
 
+    /* Initialize the persistent event journal. */
+    sysJournalInit();
+
     /* Initialize moisture sensor subsystem. */
     moistInit();
 
@@ -199,6 +254,18 @@ void sysPoll(void)
     {
 #endif
 
+        /*
+        **  Record start-up time on the first iteration.  The millisecond
+        **  tick count starts from zero at reset, so this covers everything
+        **  from the reset vector on (less the few ms before the tick timer
+        **  is started by the driver layer).
+        */
+        if (sysBootMs == 0)
+        {
+            sysBootMs = (uint16_t)drvMSGet();
+            sysEvent(SYS_EVENT_BOOT_DONE, sysBootMs);
+        }
+
         /* Test for system reset request. */
         if (sysResetRequest)
         {
@@ -253,6 +320,12 @@ void sysPoll(void)
         /* Poll the configuration subsystem. */
         configPoll();
 
+        /* Write any deferred event journal entries. */
+        sysJournalPoll();
+
+        /* Output one deferred debug trace record if the UART is idle. */
+        debugTracePoll();
+
 #ifndef WIN32
     }
 #endif
@@ -304,6 +377,9 @@ void sysPollPowerCheck(void)
             irrPoll();
         }
 
+        /* Checkpoint irrigation progress in case power is not restored. */
+        irrCheckpointSave();
+
         /* Insure watchdog is tamed again before more debug writes. */
         drvSysWatchDogClear();
 
@@ -1028,6 +1104,9 @@ void sysExecutionExtend(void)
  *      This routine uses a high-resolution timestamp for each log entry.
  *      The timestamp value is stored in millisecond units; however precision
  *      is limited by the 2ms hardware timer update interval.
+ *      Each entry is also queued for the SPI flash event journal; it is
+ *      written by sysJournalPoll() from the main loop, so no flash program
+ *      is done here (this routine is called within the power fail check).
  *
  *****************************************************************************/
 void sysEvent(uint16_t eventType, uint16_t eventData)
@@ -1041,4 +1120,645 @@ void sysEvent(uint16_t eventType, uint16_t eventData)
         sysEventLog.mn.next = 0;
         sysEventLog.mn.wrapped = TRUE;
     }
+
+    /* Queue the entry for the persistent journal. */
+    if (sysJournalBacklog < SYS_EVENT_LIMIT)
+    {
+        sysJournalBacklog++;
+    }
+    else
+    {
+        /* Oldest unjournaled entry was just overwritten in RAM. */
+        if (++sysJournalPending >= SYS_EVENT_LIMIT)
+        {
+            sysJournalPending = 0;
+        }
+    }
+}
+
+
+/******************************************************************************
+ *
+ * sysJournalInit
+ *
+ * PURPOSE
+ *      This routine initializes the persistent system event journal.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      The journal uses two SPI flash sectors as an append-only log.
+ *      Entries are written in sequence order from the start of the active
+ *      sector, so the entry for sequence number N is always at slot
+ *      (N - sysJournalBaseSeq).  When the active sector is full the other
+ *      (older) sector is erased and becomes the active sector, so the
+ *      journal always keeps at least one full sector of history.
+ *      A slot that could not be programmed holds sequence number 0.
+ *      If the last write before a reset was cut short, the slots after
+ *      the last consistent entry are marked invalid and the journal
+ *      resumes after them.  The active sector is erased only if it does
+ *      not follow on from the older sector.
+ *      The in-RAM subsystem index used by sysJournalQuery() is rebuilt a
+ *      few entries at a time by sysJournalPoll(), so start-up does not
+ *      wait for the whole journal to be read.
+ *      Events logged before this routine runs are journaled by the first
+ *      call to sysJournalPoll().
+ *
+ *****************************************************************************/
+void sysJournalInit(void)
+{
+    uint32_t base[SYS_JOURNAL_SECTORS];
+    uint32_t nextBase = 1;
+    uint16_t used[SYS_JOURNAL_SECTORS];
+    uint8_t cur;
+    uint8_t old;
+
+    /* Wait for any flash operation in progress. */
+    while (drvExtFlashBusy())
+    {
+        drvSysWatchDogClear();
+    }
+
+    used[0] = sysJournalScan(0, &base[0]);
+    used[1] = sysJournalScan(1, &base[1]);
+
+    /* The active sector is the newer one; the older sector is full. */
+    if ((used[0] == SYS_JOURNAL_LIMIT) && (used[1] == SYS_JOURNAL_LIMIT))
+    {
+        cur = (base[1] > base[0]) ? 1 : 0;
+    }
+    else if (used[0] == SYS_JOURNAL_LIMIT)
+    {
+        cur = 1;
+    }
+    else if (used[1] == SYS_JOURNAL_LIMIT)
+    {
+        cur = 0;
+    }
+    else
+    {
+        /* Neither sector full - only one should be in use. */
+        cur = ((used[0] == 0) && (used[1] != 0)) ? 1 : 0;
+    }
+    old = cur ^ 1;
+
+    sysJournalSector = cur;
+    sysJournalOldCount = 0;
+    if ((used[old] == SYS_JOURNAL_LIMIT) && (base[old] != SYS_JOURNAL_ERASED))
+    {
+        sysJournalOldBaseSeq = base[old];
+        sysJournalOldCount = SYS_JOURNAL_LIMIT;
+        nextBase = base[old] + SYS_JOURNAL_LIMIT;
+    }
+    else if (base[cur] != SYS_JOURNAL_ERASED)
+    {
+        nextBase = base[cur];
+    }
+
+    if ((used[cur] != 0) && (base[cur] != nextBase))
+    {
+        /* Active sector does not follow the older sector - start it over. */
+        drvExtFlashErase(sysJournalSectorAddr[cur]);
+        used[cur] = 0;
+        sysJournalState = SYS_JOURNAL_ERASING;
+    }
+    else
+    {
+        sysJournalState = SYS_JOURNAL_READY;
+    }
+    sysJournalBaseSeq = nextBase;
+    sysJournalNextSeq = nextBase + used[cur];
+
+    /* Index the entries already journaled from the poll loop. */
+    sysJournalIndexSeq = 0;
+    sysJournalIndexEnd = sysJournalNextSeq;
+    sysJournalIndexReady = FALSE;
+}
+
+
+/******************************************************************************
+ *
+ * sysJournalPoll
+ *
+ * PURPOSE
+ *      This routine is called from the main polling loop to complete
+ *      journal sector erasure, write any event log entries not yet
+ *      journaled and continue rebuilding the subsystem index.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ *****************************************************************************/
+void sysJournalPoll(void)
+{
+    if (sysJournalState == SYS_JOURNAL_ERASING)
+    {
+        if (drvExtFlashBusy())
+        {
+            return;
+        }
+        sysJournalState = SYS_JOURNAL_READY;
+    }
+    if (sysJournalBacklog != 0)
+    {
+        sysJournalFlush();
+    }
+    if (!sysJournalIndexReady)
+    {
+        sysJournalIndexBuild();
+    }
+}
+
+
+/******************************************************************************
+ *
+ * sysJournalRead
+ *
+ * PURPOSE
+ *      This routine reads a range of entries from the event journal.
+ *
+ * PARAMETERS
+ *      firstSeq    IN      first sequence number wanted
+ *      pBuf        OUT     buffer for journal entries (network byte order)
+ *      maxEntries  IN      maximum number of entries to return
+ *
+ * RETURN VALUE
+ *      Number of entries returned; 0 if there are no entries at or after
+ *      firstSeq, or if the journal flash is busy.
+ *
+ * NOTES
+ *      If firstSeq is older than the oldest entry still in the journal, the
+ *      entries returned start at the oldest entry.  Callers can detect the
+ *      gap from the sequence numbers in the returned entries.
+ *
+ *****************************************************************************/
+uint8_t sysJournalRead(uint32_t firstSeq, sysJournalEntry_t *pBuf, uint8_t maxEntries)
+{
+    uint32_t end;
+    uint32_t n;
+    uint16_t slot;
+    uint8_t sector;
+    uint8_t first;
+    uint8_t i;
+    uint8_t count = 0;
+
+    if ((sysJournalState != SYS_JOURNAL_READY) || drvExtFlashBusy())
+    {
+        return 0;
+    }
+
+    while ((count < maxEntries) &&
+           sysJournalLocate(&firstSeq, &sector, &slot))
+    {
+        /* Read no further than the last entry in this sector. */
+        if (sector == sysJournalSector)
+        {
+            end = sysJournalNextSeq;
+        }
+        else
+        {
+            end = sysJournalOldBaseSeq + sysJournalOldCount;
+        }
+        n = end - firstSeq;
+        if (n > (uint32_t)(maxEntries - count))
+        {
+            n = maxEntries - count;
+        }
+
+        first = count;
+        drvExtFlashRead(SYS_JOURNAL_SLOT_ADDR(sector, slot),
+                        &pBuf[first],
+                        n * sizeof(sysJournalEntry_t));
+
+        /* Drop any slots marked invalid. */
+        for (i = 0; i < n; i++)
+        {
+            if (ntohl(pBuf[first + i].seq) == firstSeq + i)
+            {
+                pBuf[count++] = pBuf[first + i];
+            }
+        }
+        firstSeq += n;
+    }
+    return count;
+}
+
+
+/******************************************************************************
+ *
+ * sysJournalQuery
+ *
+ * PURPOSE
+ *      This routine finds event journal entries matching a filter.
+ *
+ * PARAMETERS
+ *      pFilter     IN      pointer to query filter
+ *      pSeq        IN/OUT  sequence number to start searching from; updated
+ *                          to the sequence number to resume from
+ *      pBuf        OUT     buffer for matching entries (network byte order)
+ *      maxEntries  IN      maximum number of entries to return
+ *
+ * RETURN VALUE
+ *      Number of matching entries returned.
+ *
+ * NOTES
+ *      Once the in-RAM subsystem index is rebuilt, blocks of the journal
+ *      that hold no events for the requested subsystems are skipped without
+ *      reading flash; until then every entry is read.  At most SYS_JOURNAL_QUERY_SCAN entries are read per
+ *      call; the search is complete when the returned resume sequence number
+ *      reaches sysJournalNextSeqGet().  If the flash is busy no entries are
+ *      returned and the resume sequence number is unchanged.
+ *
+ *****************************************************************************/
+uint8_t sysJournalQuery(const sysJournalFilter_t *pFilter,
+                        uint32_t *pSeq,
+                        sysJournalEntry_t *pBuf,
+                        uint8_t maxEntries)
+{
+    uint32_t seq = *pSeq;
+    uint32_t date;
+    uint16_t type;
+    uint16_t slot;
+    uint16_t scanned = 0;
+    uint8_t sector;
+    uint8_t count = 0;
+
+    if ((sysJournalState != SYS_JOURNAL_READY) || drvExtFlashBusy())
+    {
+        return 0;
+    }
+
+    while ((count < maxEntries) &&
+           (scanned < SYS_JOURNAL_QUERY_SCAN) &&
+           sysJournalLocate(&seq, &sector, &slot))
+    {
+        /* Skip whole index blocks with no events for these subsystems. */
+        if (sysJournalIndexReady &&
+            ((sysJournalIndex[sector][slot / SYS_JOURNAL_INDEX_BLOCK] &
+              pFilter->subsysMask) == 0))
+        {
+            seq += SYS_JOURNAL_INDEX_BLOCK - (slot % SYS_JOURNAL_INDEX_BLOCK);
+            continue;
+        }
+
+        drvExtFlashRead(SYS_JOURNAL_SLOT_ADDR(sector, slot),
+                        &pBuf[count],
+                        sizeof(sysJournalEntry_t));
+        scanned++;
+
+        type = ntohs(pBuf[count].type);
+        date = ntohl(pBuf[count].date);
+        if ((ntohl(pBuf[count].seq) == seq) &&
+            ((SYS_JOURNAL_SUBSYS_BIT(type) & pFilter->subsysMask) != 0) &&
+            (type >= pFilter->typeLow) &&
+            (type <= pFilter->typeHigh) &&
+            (date >= pFilter->dateFrom) &&
+            (date <= pFilter->dateTo))
+        {
+            count++;
+        }
+        seq++;
+    }
+
+    *pSeq = seq;
+    return count;
+}
+
+
+/******************************************************************************
+ *
+ * sysJournalNextSeqGet
+ *
+ * PURPOSE
+ *      This routine returns the sequence number the next journal entry will
+ *      be given.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      Next journal sequence number.
+ *
+ *****************************************************************************/
+uint32_t sysJournalNextSeqGet(void)
+{
+    return sysJournalNextSeq;
+}
+
+
+/******************************************************************************
+ *
+ * sysJournalFlush
+ *
+ * PURPOSE
+ *      This routine appends event log entries not yet journaled to the
+ *      event journal in SPI flash.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      Entries stay in the RAM event log while the flash is busy (sector
+ *      erase takes about one second) and are written on a later call.
+ *      The journal date is taken when the entry is written to flash; the
+ *      millisecond timestamp is the original event time.
+ *      When the active sector is full the older sector is erased and
+ *      becomes the active sector; the full sector is kept as history.
+ *
+ *****************************************************************************/
+static void sysJournalFlush(void)
+{
+    sysJournalEntry_t entry;
+    uint32_t slot;
+
+    while (sysJournalBacklog != 0)
+    {
+        if ((sysJournalState != SYS_JOURNAL_READY) || drvExtFlashBusy())
+        {
+            return;
+        }
+
+        slot = sysJournalNextSeq - sysJournalBaseSeq;
+        if (slot >= SYS_JOURNAL_LIMIT)
+        {
+            /* Active sector full - keep it and erase the older sector. */
+            sysJournalOldBaseSeq = sysJournalBaseSeq;
+            sysJournalOldCount = SYS_JOURNAL_LIMIT;
+            sysJournalSector ^= 1;
+            sysJournalBaseSeq = sysJournalNextSeq;
+            drvExtFlashErase(sysJournalSectorAddr[sysJournalSector]);
+            sysJournalState = SYS_JOURNAL_ERASING;
+            for (slot = 0; slot < sizeof(sysJournalIndex[0]); slot++)
+            {
+                sysJournalIndex[sysJournalSector][slot] = 0;
+            }
+            return;
+        }
+
+        /* Event log entry time, type and data are already in network order. */
+        entry.seq = htonl(sysJournalNextSeq);
+        entry.date = htonl(((uint32_t)(dtYear - 2000) << 26) |
+                           ((uint32_t)(dtMon + 1) << 22) |
+                           ((uint32_t)dtMday << 17) |
+                           ((uint32_t)dtHour << 12) |
+                           ((uint32_t)dtMin << 6) |
+                           dtSec);
+        entry.time = sysEventLog.ev[sysJournalPending].time;
+        entry.type = sysEventLog.ev[sysJournalPending].type;
+        entry.data = sysEventLog.ev[sysJournalPending].data;
+
+        sysJournalNextSeq++;
+        if (!drvExtFlashWrite(&entry,
+                              SYS_JOURNAL_SLOT_ADDR(sysJournalSector, slot),
+                              sizeof(entry)))
+        {
+            /* Mark the slot invalid and retry in the next slot later. */
+            sysJournalInvalidate(sysJournalSector, (uint16_t)slot);
+            return;
+        }
+        sysJournalIndex[sysJournalSector][slot / SYS_JOURNAL_INDEX_BLOCK] |=
+            SYS_JOURNAL_SUBSYS_BIT(ntohs(entry.type));
+        if (++sysJournalPending >= SYS_EVENT_LIMIT)
+        {
+            sysJournalPending = 0;
+        }
+        sysJournalBacklog--;
+    }
+}
+
+
+/******************************************************************************
+ *
+ * sysJournalScan
+ *
+ * PURPOSE
+ *      This routine finds the slots in use in one journal sector and marks
+ *      invalid any slots left inconsistent by an interrupted write.
+ *
+ * PARAMETERS
+ *      sector      IN      journal sector (0 or 1)
+ *      pBase       OUT     sequence number of slot 0, or SYS_JOURNAL_ERASED
+ *                          if the sector holds no valid entries
+ *
+ * RETURN VALUE
+ *      Number of slots in use (0 to SYS_JOURNAL_LIMIT).
+ *
+ * NOTES
+ *      Slots are programmed in order, so the slots in use are found with a
+ *      binary search for the first erased sequence number.  Only the last
+ *      write can have been cut short: a dirty slot with an erased sequence
+ *      number, or trailing slots whose sequence number does not match
+ *      their position, are given sequence number 0.
+ *
+ *****************************************************************************/
+static uint16_t sysJournalScan(uint8_t sector, uint32_t *pBase)
+{
+    sysJournalEntry_t entry;
+    uint32_t seq;
+    uint16_t lo = 0;
+    uint16_t hi = SYS_JOURNAL_LIMIT;
+    uint16_t mid;
+    uint16_t slot;
+    uint16_t last;
+    uint8_t i;
+
+    *pBase = SYS_JOURNAL_ERASED;
+
+    /* Find the first slot with an erased sequence number. */
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        drvExtFlashRead(SYS_JOURNAL_SLOT_ADDR(sector, mid), &seq, sizeof(seq));
+        if (ntohl(seq) == SYS_JOURNAL_ERASED)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+
+    /* A write cut short before the sequence number was programmed. */
+    if (lo < SYS_JOURNAL_LIMIT)
+    {
+        drvExtFlashRead(SYS_JOURNAL_SLOT_ADDR(sector, lo), &entry, sizeof(entry));
+        for (i = 0; i < sizeof(entry); i++)
+        {
+            if (((uint8_t *)&entry)[i] != 0xFF)
+            {
+                sysJournalInvalidate(sector, lo);
+                lo++;
+                break;
+            }
+        }
+    }
+
+    /* The first valid slot gives the sequence number of slot 0. */
+    for (slot = 0; slot < lo; slot++)
+    {
+        drvExtFlashRead(SYS_JOURNAL_SLOT_ADDR(sector, slot), &seq, sizeof(seq));
+        seq = ntohl(seq);
+        if (seq != SYS_JOURNAL_INVALID)
+        {
+            *pBase = seq - slot;
+            break;
+        }
+        drvSysWatchDogClear();
+    }
+
+    /* Walk back to the last slot consistent with the first. */
+    last = lo;
+    while (last > slot + 1)
+    {
+        last--;
+        drvExtFlashRead(SYS_JOURNAL_SLOT_ADDR(sector, last), &seq, sizeof(seq));
+        seq = ntohl(seq);
+        if ((seq == *pBase + last) || (seq == SYS_JOURNAL_INVALID))
+        {
+            break;
+        }
+        sysJournalInvalidate(sector, last);
+        drvSysWatchDogClear();
+    }
+    return lo;
+}
+
+
+/******************************************************************************
+ *
+ * sysJournalInvalidate
+ *
+ * PURPOSE
+ *      This routine marks a journal slot invalid.
+ *
+ * PARAMETERS
+ *      sector      IN      journal sector (0 or 1)
+ *      slot        IN      slot within the sector
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      The sequence number is programmed to 0, which is possible whatever
+ *      the slot holds, so the slot is never mistaken for a free slot.
+ *
+ *****************************************************************************/
+static void sysJournalInvalidate(uint8_t sector, uint16_t slot)
+{
+    uint32_t seq = htonl(SYS_JOURNAL_INVALID);
+
+    (void)drvExtFlashWrite(&seq, SYS_JOURNAL_SLOT_ADDR(sector, slot), sizeof(seq));
+}
+
+
+/******************************************************************************
+ *
+ * sysJournalLocate
+ *
+ * PURPOSE
+ *      This routine finds the journal slot holding a sequence number.
+ *
+ * PARAMETERS
+ *      pSeq        IN/OUT  sequence number wanted; advanced to the oldest
+ *                          sequence number still in the journal, if later
+ *      pSector     OUT     journal sector (0 or 1)
+ *      pSlot       OUT     slot within the sector
+ *
+ * RETURN VALUE
+ *      TRUE if the slot is in use; FALSE if the sequence number is not yet
+ *      journaled, in which case *pSeq is set to sysJournalNextSeq.
+ *
+ *****************************************************************************/
+static bool_t sysJournalLocate(uint32_t *pSeq, uint8_t *pSector, uint16_t *pSlot)
+{
+    uint32_t seq = *pSeq;
+
+    if ((sysJournalOldCount != 0) &&
+        (seq < sysJournalOldBaseSeq + sysJournalOldCount))
+    {
+        /* Entry is in the older sector. */
+        if (seq < sysJournalOldBaseSeq)
+        {
+            seq = sysJournalOldBaseSeq;
+        }
+        *pSector = sysJournalSector ^ 1;
+        *pSlot = (uint16_t)(seq - sysJournalOldBaseSeq);
+    }
+    else
+    {
+        if (seq < sysJournalBaseSeq)
+        {
+            seq = sysJournalBaseSeq;
+        }
+        if (seq >= sysJournalNextSeq)
+        {
+            *pSeq = sysJournalNextSeq;
+            return FALSE;
+        }
+        *pSector = sysJournalSector;
+        *pSlot = (uint16_t)(seq - sysJournalBaseSeq);
+    }
+    *pSeq = seq;
+    return TRUE;
+}
+
+
+/******************************************************************************
+ *
+ * sysJournalIndexBuild
+ *
+ * PURPOSE
+ *      This routine adds the next few journal entries written before
+ *      sysJournalInit() to the subsystem index.
+ *
+ * PARAMETERS
+ *      None.
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      One flash read of up to 4 entries is done per call.  Entries written
+ *      since sysJournalInit() are indexed by sysJournalFlush().
+ *
+ *****************************************************************************/
+static void sysJournalIndexBuild(void)
+{
+    sysJournalEntry_t entry[4];
+    uint16_t slot;
+    uint8_t sector;
+    uint8_t i;
+
+    if ((sysJournalState != SYS_JOURNAL_READY) || drvExtFlashBusy())
+    {
+        return;
+    }
+    if (!sysJournalLocate(&sysJournalIndexSeq, &sector, &slot) ||
+        (sysJournalIndexSeq >= sysJournalIndexEnd))
+    {
+        sysJournalIndexReady = TRUE;
+        return;
+    }
+
+    drvExtFlashRead(SYS_JOURNAL_SLOT_ADDR(sector, slot), entry, sizeof(entry));
+    for (i = 0;
+         (i < 4) && (slot + i < SYS_JOURNAL_LIMIT) &&
+         (sysJournalIndexSeq < sysJournalIndexEnd);
+         i++)
+    {
+        sysJournalIndex[sector][(slot + i) / SYS_JOURNAL_INDEX_BLOCK] |=
+            SYS_JOURNAL_SUBSYS_BIT(ntohs(entry[i].type));
+        sysJournalIndexSeq++;
+    }
 }
@@ -39,6 +39,9 @@
 #define SYS_TEST_RUNTIME_MAX    30      /* maximum per-zone test run-time */
 #define SYS_MOISTURE_MAX        60      /* maximum moisture percentage */
 #define SYS_EVENT_LIMIT         100     /* Number of Event Log Entries */
+#define SYS_JOURNAL_LIMIT       4096    /* Event Journal Entries per Sector */
+#define SYS_JOURNAL_INDEX_BLOCK 64      /* Journal Entries per Index Byte */
+#define SYS_JOURNAL_QUERY_SCAN  256     /* Max Entries Read per Query Call */
 
 
 /*
@@ -153,6 +156,42 @@ typedef struct
 /* Size of Data Storage used by the System Event Log */
 #define SYS_EVENT_LOG_SIZE  sizeof(sysEventLog_t)
 
+/*
+**  SYSTEM EVENT JOURNAL ENTRY STRUCT
+**
+**  Every event log entry is also appended to a persistent journal in SPI
+**  flash and given a 32-bit sequence number.  Journal entries are stored
+**  in network byte order.  The date field is packed as:
+**      bits 31..26  year - 2000        bits 16..12  hour (0..23)
+**      bits 25..22  month (1..12)      bits 11..6   minute (0..59)
+**      bits 21..17  day (1..31)        bits 5..0    second (0..59)
+*/
+typedef struct
+{
+    uint32_t seq;           /* journal sequence number */
+    uint32_t date;          /* packed date/time entry was journaled */
+    uint32_t time;          /* time in milliseconds since system init */
+    uint16_t type;          /* event type (subsystem event code) */
+    uint16_t data;          /* event data (additional event information) */
+} sysJournalEntry_t;
+
+/*
+**  SYSTEM EVENT JOURNAL QUERY FILTER STRUCT
+**
+**  An entry matches if its subsystem bit is set in subsysMask, its type is
+**  within typeLow..typeHigh and its packed date is within dateFrom..dateTo.
+**  Subsystem mask bit n is for subsystem identifier n + 1 (bit 0 is
+**  SYS_EVENT_SYS); bit 7 matches any other subsystem identifier.
+*/
+typedef struct
+{
+    uint8_t subsysMask;     /* subsystems to match */
+    uint16_t typeLow;       /* lowest event type to match */
+    uint16_t typeHigh;      /* highest event type to match */
+    uint32_t dateFrom;      /* earliest packed date/time to match */
+    uint32_t dateTo;        /* latest packed date/time to match */
+} sysJournalFilter_t;
+
 /*
 **  SYSTEM EVENT LOG ENTRY SUBSYSTEM IDENTIFIERS
 **
@@ -191,6 +230,8 @@ extern uint32_t sysInhibitOffTime;  /* Last Inhibit Off Time (in time-ticks) */
 extern uint16_t sysErrorFlags;      /* System Error Flags */
 extern uint32_t sysFaultFlags;      /* System Fault Flags */
 extern bool_t sysResetRequest;      /* Request a system reset if TRUE */
+extern uint16_t sysBootConfigMs;    /* configInit duration in ms */
+extern uint16_t sysBootMs;          /* reset to first sysPoll in ms */
 extern uint8_t sysMaxZones;         /* Max number of zones supported */
 extern sysEventLog_t sysEventLog;   /* System Event Log Data Store */
 extern uint8_t expansionIrrState;           /* Expansion unit Irrigation State */
@@ -229,6 +270,14 @@ bool_t sysFaultOn(uint8_t fault);
 char *sysFormatFirmwareVer(char *buf);
 void sysExecutionExtend(void);
 void sysEvent(uint16_t eventType, uint16_t eventData);
+void sysJournalInit(void);
+void sysJournalPoll(void);
+uint8_t sysJournalRead(uint32_t firstSeq, sysJournalEntry_t *pBuf, uint8_t maxEntries);
+uint8_t sysJournalQuery(const sysJournalFilter_t *pFilter,
+                        uint32_t *pSeq,
+                        sysJournalEntry_t *pBuf,
+                        uint8_t maxEntries);
+uint32_t sysJournalNextSeqGet(void);
 
 
 /* END system */
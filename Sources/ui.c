@@ -30,6 +30,7 @@
 #include "datetime.h"
 #include "irrigation.h"
 #include "moisture.h"
+#include "format.h"
 #include "ui.h"
 #include "drvKeypad.h"
 #include "drvLcd.h"
@@ -224,6 +225,7 @@ typedef struct
     uiNavDialAction_t pDialCw;          /* option-dial-CW event action */
     uiNavDialAction_t pDialCcw;         /* option-dial-CCW event action */
     uiSoftKey_t softKey[UI_N_SOFTKEYS]; /* softkey labels & actions */
+    uint8_t deps;                       /* state shown (UI_DEP_xxx mask) */
 } uiMenuDb_t;
 
 /*
@@ -281,6 +283,7 @@ static uint8_t pin[4];
 */
 char uiLcdBuf[160];                 /* LCD screen buffer */
 uint8_t uiLcdCursor;                /* current hardware cursor location */
+uint8_t uiLcdGen;                   /* incremented on each LCD update */
 
 
 /*
@@ -288,8 +291,9 @@ uint8_t uiLcdCursor;                /* current hardware cursor location */
 */
 static bool_t uiLcdRefreshReq = TRUE;   /* flag to force immediate LCD refresh */
 static bool_t uiLcdRefreshTick = FALSE; /* flag indicating time-tick LCD refresh */
-static uint8_t uiLcdLastUpdateSec;  /* seconds value on last LCD update */
-static uint8_t uiLcdLastUpdateMin;  /* minutes value on last LCD update */
+static uint8_t uiLcdRefreshDeps;    /* state changed since last tick (UI_DEP_xxx) */
+static uint8_t uiLcdLastUpdateSec;  /* seconds value on last tick */
+static uint8_t uiLcdLastUpdateMin;  /* minutes value on last tick */
 static uint32_t uiLastEventTime;    /* Time of last front panel switch event */
 static uint32_t uiScreenTimeout;    /* # secs inactivity before return to home */
 static int8_t uiStatusCycle = 0;    /* Current status cycle message */
@@ -310,7 +314,7 @@ bool_t timeChanged;          /* keep track if user change the time */
 **  Common Utility Routines
 */
 static void  uiEventFunction(uint8_t position, bool_t altFunc);
-static void  uiEventDial(uint8_t direction);
+static void  uiEventDial(uint8_t direction, uint8_t steps);
 static void  uiEventSoft(uint8_t eventType, uint8_t eventKey);
 static void  uiMenuSet(const uiMenuDb_t *menu);
 static char *uiFormatIrrMode(char *buf);
@@ -907,7 +911,8 @@ static const uiMenuDb_t uiMenuUnimplemented =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_NONE
 };
 
 
@@ -924,7 +929,8 @@ static const uiMenuDb_t uiMenuStatusIdle =
         {uiStatusTest,          "TEST"},
         {NULL,                    NULL},
         {NULL,                    NULL},
-    }
+    },
+    UI_DEP_SECONDS | UI_DEP_IRR | UI_DEP_RADIO | UI_DEP_CONFIG
 };
 
 
@@ -941,7 +947,8 @@ static const uiMenuDb_t uiMenuStatusActive =
         {uiStatusStop,          "STOP"},
         {NULL,                    NULL},
         {uiStatusSkip,          "SKIP"},
-    }
+    },
+    UI_DEP_SECONDS | UI_DEP_IRR | UI_DEP_RADIO | UI_DEP_CONFIG
 };
 
 
@@ -958,7 +965,8 @@ static const uiMenuDb_t uiMenuStatusPaused =
         {uiStatusStop,           "STOP"},
         {uiStatusResume,       "RESUME"},
         {uiStatusTestSkip,       "NEXT"},
-    }
+    },
+    UI_DEP_SECONDS | UI_DEP_IRR | UI_DEP_RADIO | UI_DEP_CONFIG
 };
 
 
@@ -975,7 +983,8 @@ static const uiMenuDb_t uiMenuStatusTest =
         {NULL,                  NULL},
         {uiStatusTestStart,     "START"},
         {uiStatusCancel,        "CANCEL"},
-    }
+    },
+    UI_DEP_IRR | UI_DEP_CONFIG
 };
 
 
@@ -992,7 +1001,8 @@ static const uiMenuDb_t uiMenuStatusManual =
         {NULL,                  NULL},
         {uiStatusManualStart,   "START"},
         {uiStatusCancel,        "CANCEL"},
-    }
+    },
+    UI_DEP_IRR | UI_DEP_CONFIG
 };
 
 
@@ -1009,7 +1019,8 @@ static const uiMenuDb_t uiMenuStatusResume =
         {uiStatusResumeCancel,  "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_NONE
 };
 
 
@@ -1026,7 +1037,8 @@ static const uiMenuDb_t uiMenuStatusResumeTest =
         {uiStatusResumeCancel,  "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_NONE
 };
 
 
@@ -1043,7 +1055,8 @@ static const uiMenuDb_t uiMenuStatusResumeMan =
         {uiStatusResumeCancel,  "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_NONE
 };
 
 
@@ -1060,7 +1073,8 @@ static const uiMenuDb_t uiMenuSetup =
         {uiSetupEx2,            "25-36"},
         {uiSetupEx3,            "37-48"},
         {uiSetupSnsCon,         "SnsCon"},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1077,7 +1091,8 @@ static const uiMenuDb_t uiMenuSetupExpan1 =
         {uiSetupExpanMAC,       "SET MAC ID"},
         {NULL,                  NULL},
         {uiSetupExpanBack,      "Back"},
-    }
+    },
+    UI_DEP_RADIO | UI_DEP_CONFIG
 };
 
 /* Controller Expansion 2 Setup Function Menu */
@@ -1093,7 +1108,8 @@ static const uiMenuDb_t uiMenuSetupExpan2 =
         {uiSetupExpanMAC,       "SET MAC ID"},
         {NULL,                  NULL},
         {uiSetupExpanBack,      "Back"},
-    }
+    },
+    UI_DEP_RADIO | UI_DEP_CONFIG
 };
 
 /* Controller Expansion 3 Setup Function Menu */
@@ -1109,7 +1125,8 @@ static const uiMenuDb_t uiMenuSetupExpan3 =
         {uiSetupExpanMAC,       "SET MAC ID"},
         {NULL,                  NULL},
         {uiSetupExpanBack,      "Back"},
-    }
+    },
+    UI_DEP_RADIO | UI_DEP_CONFIG
 };
 
 /* Controller Expansion MAC ID Setup Function Menu */
@@ -1125,7 +1142,8 @@ static const uiMenuDb_t uiMenuSetupExpanMACMenu =
         {uiSetupExpanMacClear,      "Clear"},
         {uiSetupExpanMacAccept,     "Accept"},
         {uiSetupExpanMacCancel,     "Cancel"},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1142,7 +1160,8 @@ static const uiMenuDb_t uiMenuSetupSensorConMenu =
         {uiSetupSensorConAccept,    "Accept"},
         {uiSetupSensorConDeny,      "Cancel"},
         {uiSetupExpanBack,          "Back"},
-    }
+    },
+    UI_DEP_IRR | UI_DEP_RADIO | UI_DEP_CONFIG
 };
 
 
@@ -1159,7 +1178,8 @@ static const uiMenuDb_t uiMenuDt =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_SECONDS | UI_DEP_CONFIG
 };
 
 
@@ -1176,7 +1196,8 @@ static const uiMenuDb_t uiMenuOpMode =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1193,7 +1214,8 @@ static const uiMenuDb_t uiMenuIrrDaysSummary =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1210,7 +1232,8 @@ static const uiMenuDb_t uiMenuIrrDays =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1239,7 +1262,8 @@ static const uiMenuDb_t uiMenuRunTimeSummary =
 #endif
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1257,7 +1281,8 @@ static const uiMenuDb_t uiMenuRunTime =
           {uiRunTimeGroup3,       "25-36"},
           {uiRunTimeGroup4,       "37-48"},
           {uiRunTimeCopy,         "COPY"},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1274,7 +1299,8 @@ static const uiMenuDb_t uiMenuRunTimeCopy =
         {uiRunTimeCopyNo,       "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1291,7 +1317,8 @@ static const uiMenuDb_t uiMenuAppRateSummary =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1309,7 +1336,8 @@ static const uiMenuDb_t uiMenuAppRate =
           {NULL,                  NULL},
           {NULL,                  NULL},
           {uiAppRateCopy,         "COPY"},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1326,7 +1354,8 @@ static const uiMenuDb_t uiMenuAppRateCopy =
         {uiAppRateCopyNo,       "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1343,7 +1372,8 @@ static const uiMenuDb_t uiMenuAppEffSummary =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1361,7 +1391,8 @@ static const uiMenuDb_t uiMenuAppEff =
           {NULL,                  NULL},
           {NULL,                  NULL},
           {uiAppEffCopy,          "COPY"},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1378,7 +1409,8 @@ static const uiMenuDb_t uiMenuAppEffCopy =
         {uiAppEffCopyNo,        "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1397,7 +1429,8 @@ static const uiMenuDb_t uiMenuSoilType =
           {uiSoilTypeGroup4,      "37-48"},
           {uiSoilTypeCopy,        "COPY"},
 
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1414,7 +1447,8 @@ static const uiMenuDb_t uiMenuSoilTypeCopy =
         {uiSoilTypeCopyNo,      "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1431,7 +1465,8 @@ static const uiMenuDb_t uiMenuSlope =
           {uiSlopeGroup3,         "25-36"},
           {uiSlopeGroup4,         "37-48"},
           {uiSlopeCopy,           "COPY"},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1448,7 +1483,8 @@ static const uiMenuDb_t uiMenuSlopeCopy =
         {uiSlopeCopyNo,         "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1466,7 +1502,8 @@ static const uiMenuDb_t uiMenuMoist =
           {uiMoistGroup4,         "37-48"}, 
           //{NULL,                     NULL},         
           {uiFlowSetting,          "FLOW"},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1483,7 +1520,8 @@ static const uiMenuDb_t uiMenuMoistCopy =
         {uiMoistCopyNo,         "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1500,7 +1538,8 @@ static const uiMenuDb_t uiMenuMoistVal =
         {uiMoistValGroup4,      "37-48"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_SECONDS | UI_DEP_CONFIG
 };
 ///////////////flow settings menu////////////
 static const uiMenuDb_t uiMenuFlow =
@@ -1516,7 +1555,8 @@ static const uiMenuDb_t uiMenuFlow =
           {uiFlowGroup3,       "25-36"},
           {uiFlowGroup4,       "37-48"},
           {uiFlowCopy,         "COPY"},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1532,7 +1572,8 @@ static const uiMenuDb_t uiMenuFlowCopy =
         {uiFlowCopyNo,          "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1550,7 +1591,8 @@ static const uiMenuDb_t uiMenuGroupsSummary =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1567,7 +1609,8 @@ static const uiMenuDb_t uiMenuGroups =
           {uiGroupsGroup3,        "25-36"},
           {uiGroupsGroup4,        "37-48"},
           {NULL,                  NULL},
-    }
+    },
+    UI_DEP_IRR | UI_DEP_CONFIG
 };
 
 
@@ -1584,7 +1627,8 @@ static const uiMenuDb_t uiMenuGroupsUngroup =
         {uiGroupsUngroupNo,     "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1602,7 +1646,8 @@ static const uiMenuDb_t uiMenuGroupsCopy =
         {uiGroupsCopyNo,        "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 #endif
 
@@ -1620,7 +1665,8 @@ static const uiMenuDb_t uiMenuClimate =
           {uiClimateGroup3,       "25-36"},
           {uiClimateGroup4,       "37-48"},
           {uiClimateCopy,         "COPY"},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1637,7 +1683,8 @@ static const uiMenuDb_t uiMenuClimateCopy =
         {uiClimateCopyNo,       "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1656,7 +1703,8 @@ static const uiMenuDb_t uiMenuMbVal =
           {uiMbValSetZero,        "ZERO"},
           {uiMbValCopy,           "COPY"},
 
-    }
+    },
+    UI_DEP_IRR | UI_DEP_CONFIG
 };
 
 
@@ -1673,7 +1721,8 @@ static const uiMenuDb_t uiMenuMbValCopy =
         {uiMbValCopyNo,         "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_IRR | UI_DEP_CONFIG
 };
 
 
@@ -1690,7 +1739,8 @@ static const uiMenuDb_t uiMenuPlantType =
           {uiPlantTypeGroup3,     "25-36"},
           {uiPlantTypeGroup4,     "37-48"},
           {uiPlantTypeCopy,       "COPY"},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1707,7 +1757,8 @@ static const uiMenuDb_t uiMenuPlantTypeCopy =
         {uiPlantTypeCopyNo,     "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1724,7 +1775,8 @@ static const uiMenuDb_t uiMenuRzwws =
         {uiRzwwsGroup4,         "37-48"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_CONFIG
 };
 
 
@@ -1741,7 +1793,8 @@ static const uiMenuDb_t uiMenuAdvSummary =
         {uiAdvSummaryHidden0,   NULL},
         {uiAdvSummaryHidden0,   NULL},
         {uiAdvSummaryHidden1,   NULL},
-    }
+    },
+    UI_DEP_NONE
 };
 
 
@@ -1758,7 +1811,8 @@ static const uiMenuDb_t uiMenuAdvDefaults =
         {uiAdvDefaultsNo,       "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_NONE
 };
 
 
@@ -1776,7 +1830,8 @@ static const uiMenuDb_t uiMenuAdvProduct1 =
         {uiAdvProductDbg0,      NULL},
         {uiAdvProductDbg1,      NULL},
         {uiAdvProductDbg0,      NULL},
-    }
+    },
+    UI_DEP_SECONDS
 };
 
 
@@ -1793,7 +1848,8 @@ static const uiMenuDb_t uiMenuAdvProductDbg =
         {uiAdvProductDbgEvSave, "ESAVE"},
         {uiAdvProductDbgEvLog,  "EVIEW"},
         {uiAdvProductDbgReset,  "RESET"},
-    }
+    },
+    UI_DEP_SECONDS | UI_DEP_IRR | UI_DEP_CONFIG
 };
 
 
@@ -1810,7 +1866,8 @@ static const uiMenuDb_t uiMenuAdvEventLog =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_SECONDS
 };
 
 
@@ -1827,7 +1884,8 @@ static const uiMenuDb_t uiMenuAdvReset =
         {uiAdvResetNo,          "NO"},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_NONE
 };
 
 
@@ -1844,7 +1902,8 @@ static const uiMenuDb_t uiMenuAdvProduct2 =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {NULL,                  NULL},
-    }
+    },
+    UI_DEP_RADIO
 };
 
 
@@ -1861,7 +1920,8 @@ static const uiMenuDb_t uiMenuAdvRadio =
         {uiAdvRadioEdit,        "SET PAN"},
         {NULL,                  NULL},
         {uiAdvRadioReset,       "RESET"},
-    }
+    },
+    UI_DEP_SECONDS | UI_DEP_RADIO | UI_DEP_CONFIG
 };
 
 
@@ -1878,7 +1938,8 @@ static const uiMenuDb_t uiMenuAdvRadioEdit =
         {uiAdvRadioEditOp,      "=OP"},
         {uiAdvRadioEditAccept,  "ACCEPT"},
         {uiAdvRadioEditCancel,  "CANCEL"},
-    }
+    },
+    UI_DEP_RADIO | UI_DEP_CONFIG
 };
 
 
@@ -1895,7 +1956,8 @@ static const uiMenuDb_t uiMenuAdvRadio2 =
         {NULL,                  NULL},
         {NULL,                  NULL},
         {uiAdvRadio2Test,     "TEST"},
-    }
+    },
+    UI_DEP_SECONDS | UI_DEP_RADIO
 };
 
 /////// LOCK ////////////
@@ -1912,7 +1974,8 @@ static const uiMenuDb_t uiMenuLock =
         {NULL,                    NULL},
         {NULL,                    NULL},
         {uiLockOK,              "LOCK"},
-    }
+    },
+    UI_DEP_NONE
 };
 
 static const uiMenuDb_t uiMenuLockOK =
@@ -1927,7 +1990,8 @@ static const uiMenuDb_t uiMenuLockOK =
         {NULL,              NULL},
         {NULL,              NULL},
         {NULL,              NULL},
-    }
+    },
+    UI_DEP_NONE
 };
 
 //////////// UNLOCK //////////
@@ -1943,7 +2007,8 @@ static const uiMenuDb_t uiMenuUnlock =
         {NULL,                      NULL},
         {NULL,                      NULL},
         {uiUnlockOK,            "UNLOCK"},
-    }
+    },
+    UI_DEP_NONE
 };
 
 static const uiMenuDb_t uiMenuUnlockOK =
@@ -1958,7 +2023,8 @@ static const uiMenuDb_t uiMenuUnlockOK =
         {NULL,            NULL},
         {NULL,            NULL},
         {NULL,            NULL},
-    }
+    },
+    UI_DEP_NONE
 };
 
 
@@ -2015,10 +2081,16 @@ void uiInit(void)
 
 void uiPoll(void)
 {
+    drvKeypadEvent_t event;
     uint8_t newEvent;
 
-    while ((newEvent = drvKeypadGet()) != 0)
+    /*
+    **  Dispatch all queued events; the LCD is rendered once afterward.
+    **  Fast dial spins arrive coalesced into a single multi-step event.
+    */
+    while (drvKeypadGetEvent(&event))
     {
+        newEvent = event.key;
         uiLastEventTime = dtTickCount;
         switch (newEvent & DRV_KEYPAD_TYPE_MASK)
         {
@@ -2035,7 +2107,7 @@ void uiPoll(void)
                             newEvent & DRV_KEYPAD_KEY_MASK);
                 break;
             case DRV_KEYPAD_TYPE_NAV:
-                uiEventDial(newEvent & DRV_KEYPAD_KEY_MASK);
+                uiEventDial(newEvent & DRV_KEYPAD_KEY_MASK, event.count);
                 break;
             default:
                 /* unknown event type - discard and ignore */
@@ -2045,14 +2117,19 @@ void uiPoll(void)
 
     /*
     **  Perform the following actions every second:
-    **  - Refresh LCD screen display.
+    **  - Refresh LCD screen display if the state it shows has changed.
     **  - Check for UI inactivity timeout.
     */
     if ((uiLcdLastUpdateSec != dtSec) ||
         (uiLcdLastUpdateMin != dtMin))          /* for Win32 speed-up x60 */
     {
+        /* Store current second & minute values. */
+        uiLcdLastUpdateSec = dtSec;
+        uiLcdLastUpdateMin = dtMin;
+
         /* Set flag to generate LCD refresh at the top of each second. */
         uiLcdRefreshTick = TRUE;
+        uiLcdRefreshDeps |= UI_DEP_SECONDS;
 
         /* Check for UI timeout. */
         if (dtElapsedSeconds(uiLastEventTime) > uiScreenTimeout)
@@ -2064,12 +2141,21 @@ void uiPoll(void)
         }
     }
 
-    /* Update LCD if either LCD refresh flag is set. */
-    if (uiLcdRefreshReq || uiLcdRefreshTick)
+    /* Update LCD if requested, or on the tick if the menu's state changed. */
+    if (uiLcdRefreshReq ||
+        (uiLcdRefreshTick && (uiCurMenu != NULL) &&
+         ((uiCurMenu->deps & uiLcdRefreshDeps) != 0)))
     {
         /* Update the LCD screen display. */
         uiLcdUpdate();
     }
+
+    if (uiLcdRefreshTick)
+    {
+        /* Clear tick; changes not shown by the current menu are discarded. */
+        uiLcdRefreshDeps = 0;
+        uiLcdRefreshTick = FALSE;
+    }
 }
 
 
@@ -2266,31 +2352,39 @@ static void uiEventFunction(uint8_t position, bool_t altFunc)
  *
  * PARAMETERS
  *      direction   IN  direction of dial rotation (0=cw, 1=ccw)
+ *      steps       IN  number of dial steps (coalesced and accelerated)
  *
  * RETURN VALUE
  *      None.
  *
+ * NOTES
+ *      The action routine is looked up for each step since a dial action
+ *      may change the current menu.
+ *
  *****************************************************************************/
-static void uiEventDial(uint8_t direction)
+static void uiEventDial(uint8_t direction, uint8_t steps)
 {
-    /* Execute the appropriate Navigation Dial Menu Action routine. */
-    switch (direction)
+    while (steps-- > 0)
     {
-        case 0:                         /* Clockwise Dial Rotation */
-            if (uiCurMenu->pDialCw != NULL)
-            {
-                uiCurMenu->pDialCw();
-            }
-            break;
-        case 1:                         /* Counter-Clockwise Dial Rotation */
-            if (uiCurMenu->pDialCcw != NULL)
-            {
-                uiCurMenu->pDialCcw();
-            }
-            break;
-        default:
-            /* should never reach */
-            break;
+        /* Execute the appropriate Navigation Dial Menu Action routine. */
+        switch (direction)
+        {
+            case 0:                     /* Clockwise Dial Rotation */
+                if (uiCurMenu->pDialCw != NULL)
+                {
+                    uiCurMenu->pDialCw();
+                }
+                break;
+            case 1:                     /* Counter-Clockwise Dial Rotation */
+                if (uiCurMenu->pDialCcw != NULL)
+                {
+                    uiCurMenu->pDialCcw();
+                }
+                break;
+            default:
+                /* should never reach */
+                break;
+        }
     }
 
     /* Request LCD screen refresh. */
@@ -2348,6 +2442,12 @@ static void uiEventSoft(uint8_t eventType, uint8_t eventKey)
  *****************************************************************************/
 static void uiMenuSet(const uiMenuDb_t *menu)
 {
+    /* A new menu must be drawn, whatever state it shows. */
+    if (menu != uiCurMenu)
+    {
+        uiLcdRefreshReq = TRUE;
+    }
+
     /* Set the current menu. */
     uiCurMenu = menu;
 }
@@ -2375,6 +2475,31 @@ void uiLcdRefresh(void)
 }
 
 
+/******************************************************************************
+ *
+ * uiNotify
+ *
+ * PURPOSE
+ *      This routine is called by subsystems to report a change to state
+ *      that may be shown on the LCD display.
+ *
+ * PARAMETERS
+ *      deps    IN  state changed (UI_DEP_xxx mask)
+ *
+ * RETURN VALUE
+ *      None.
+ *
+ * NOTES
+ *      Changes are collected until the next 1-second tick, when the LCD is
+ *      refreshed only if the current menu shows any of the changed state.
+ *
+ *****************************************************************************/
+void uiNotify(uint8_t deps)
+{
+    uiLcdRefreshDeps |= deps;
+}
+
+
 /******************************************************************************
  *
  * uiLcdUpdate
@@ -2412,10 +2537,6 @@ static void uiLcdUpdate(void)
         return;
     }
 
-    /* Store current second & minute values. */
-    uiLcdLastUpdateSec = dtSec;
-    uiLcdLastUpdateMin = dtMin;
-
     /* Clear LCD display buffer to all space characters. */
     memset(uiLcdBuf, ' ', sizeof(uiLcdBuf));
 
@@ -2508,10 +2629,10 @@ static void uiLcdUpdate(void)
 
     /* Write LCD buffer to hardware device driver. */
     drvLcdWrite(uiLcdBuf, uiLcdCursor);
+    uiLcdGen++;
 
-    /* Clear LCD refresh flags. */
+    /* Clear LCD refresh request flag (tick flag is cleared by uiPoll). */
     uiLcdRefreshReq = FALSE;
-    uiLcdRefreshTick = FALSE;
 
 #ifdef WIN32
     /* Write soft key availability mask (for win32 prototype). */
@@ -2602,6 +2723,7 @@ static char *uiFormatIrrMode(char *buf)
 {
     char *opMode;
     uint8_t program;
+    char *p;
 
     switch (irrOpMode)
     {
@@ -2630,10 +2752,16 @@ static char *uiFormatIrrMode(char *buf)
         program = irrProgram;
     }
     
-    sprintf(buf, "Program %c, %s%s",
-        program + 'A',
-        opMode,
-        irrPulseMode == CONFIG_PULSEMODE_ON ? "/Pulse" : "");
+    p = fmtStr(buf, "Program ", 0);
+    *p++ = (char)(program + 'A');
+    *p++ = ',';
+    *p++ = ' ';
+    p = fmtStr(p, opMode, 0);
+    if (irrPulseMode == CONFIG_PULSEMODE_ON)
+    {
+        p = fmtStr(p, "/Pulse", 0);
+    }
+    *p = '\0';
 
     return buf;
 }
@@ -2668,49 +2796,50 @@ static char *uiFormatIrrMode(char *buf)
 char *uiFormatSystemMode(char *buf)
 {
     char tmpbuf[41];
+    char *p = buf;
 
     switch (sysState)
     {
         case SYS_STATE_IDLE:
             if (!sysIsAuto)
             {
-                sprintf(buf, "Irrigation is turned OFF");
+                p = fmtStr(p, "Irrigation is turned OFF", 0);
             }
             else
             {
-                sprintf(buf, "Irrigation is ON/AUTOMATIC");
+                p = fmtStr(p, "Irrigation is ON/AUTOMATIC", 0);
             }
             break;
 
         case SYS_STATE_AUTORUN:
-            sprintf(buf,
-                    "AUTO STARTED  (%s)",
-                    uiFormatIrrMode(tmpbuf));
+            p = fmtStr(p, "AUTO STARTED  (", 0);
+            p = fmtStr(p, uiFormatIrrMode(tmpbuf), 0);
+            *p++ = ')';
             break;
 
         case SYS_STATE_MANUAL:
-            sprintf(buf,
-                    "MANUAL START  (%s)",
-                    uiFormatIrrMode(tmpbuf));
+            p = fmtStr(p, "MANUAL START  (", 0);
+            p = fmtStr(p, uiFormatIrrMode(tmpbuf), 0);
+            *p++ = ')';
             break;
 
         case SYS_STATE_FORCE:
-            sprintf(buf,
-                    "FORCE ON  (%s)",
-                    uiFormatIrrMode(tmpbuf));
+            p = fmtStr(p, "FORCE ON  (", 0);
+            p = fmtStr(p, uiFormatIrrMode(tmpbuf), 0);
+            *p++ = ')';
             break;
 
         case SYS_STATE_TEST:
-            sprintf(buf,
-                    "TEST MODE  (%d minute%s/zone)",
-                    sysTestRunTime,
-                    sysTestRunTime > 1 ? "s" : "");
+            p = fmtStr(p, "TEST MODE  (", 0);
+            p = fmtUint(p, sysTestRunTime, 0, ' ');
+            p = fmtStr(p, sysTestRunTime > 1 ? " minutes/zone)" : " minute/zone)", 0);
             break;
         default:
             /* should never reach */
-            sprintf(buf, "?");
+            *p++ = '?';
             break;
     }
+    *p = '\0';
 
     return buf;
 }
@@ -2756,6 +2885,8 @@ static char *uiFormatSystemStatus(char *buf)
     uint16_t remainingPulses;
     int8_t moisture = 0;
     uint8_t failedMoistZone = 0;
+    uint8_t flowZone;
+    char *p;
 
     /*
     **  Build a list of all active status messsages to determine the
@@ -2917,23 +3048,27 @@ static char *uiFormatSystemStatus(char *buf)
     /* Generate the status message to display for the current message cycle. */
     if (count == 0)
     {
-        sprintf(buf, "");
+        buf[0] = '\0';
     }
     else if (messageId[uiStatusCycle] < UI_SMSG_ERROR_LIMIT)
     {
-        sprintf(buf, "%.40s", uiSystemErrorMsg[messageId[uiStatusCycle] - UI_SMSG_ERROR]);
+        p = fmtStr(buf, uiSystemErrorMsg[messageId[uiStatusCycle] - UI_SMSG_ERROR], 40);
+        *p = '\0';
     }
     else if (messageId[uiStatusCycle] < UI_SMSG_FAULT_LIMIT)
     {
         if((messageId[uiStatusCycle] - UI_SMSG_FAULT) == SYS_FAULT_SNSCON)
         {
-            sprintf(buf, "%.24s %08X%08X", uiSystemFaultMsg[messageId[uiStatusCycle] - UI_SMSG_FAULT],
-                    (uint32_t)(config.sys.assocSensorCon[irrSnsConSolUnitIndex].macId >> 32),
-                    (uint32_t)(config.sys.assocSensorCon[irrSnsConSolUnitIndex].macId & 0xFFFFFFFF));
+            p = fmtStr(buf, uiSystemFaultMsg[messageId[uiStatusCycle] - UI_SMSG_FAULT], 24);
+            *p++ = ' ';
+            p = fmtHex(p, (uint32_t)(config.sys.assocSensorCon[irrSnsConSolUnitIndex].macId >> 32), 8);
+            p = fmtHex(p, (uint32_t)(config.sys.assocSensorCon[irrSnsConSolUnitIndex].macId & 0xFFFFFFFF), 8);
+            *p = '\0';
         }
         else
         {
-            sprintf(buf, "%.40s", uiSystemFaultMsg[messageId[uiStatusCycle] - UI_SMSG_FAULT]);
+            p = fmtStr(buf, uiSystemFaultMsg[messageId[uiStatusCycle] - UI_SMSG_FAULT], 40);
+            *p = '\0';
         }
     }
     else
@@ -2948,32 +3083,43 @@ static char *uiFormatSystemStatus(char *buf)
                 moisture = irrZoneMoisture(irrCurZone);
                 if (moisture >= 0)
                 {
-                    sprintf(buf, "Moisture is %d%%, target of %d%%.",
-                        moisture,
-                        irrZone[irrCurZone - 1].maxMoist);
+                    p = fmtStr(buf, "Moisture is ", 0);
+                    p = fmtInt(p, moisture, 0, ' ');
+                    p = fmtStr(p, "%, target of ", 0);
+                    p = fmtUint(p, irrZone[irrCurZone - 1].maxMoist, 0, ' ');
+                    p = fmtStr(p, "%.", 0);
                 }
                 else
                 {
-                    sprintf(buf, "Moisture reading is not available.");
+                    p = fmtStr(buf, "Moisture reading is not available.", 0);
                 }
+                *p = '\0';
                 break;
 
             case UI_SMSG_SENSORFAIL:
-                    sprintf(buf, "Moisture sensor failure in zone %d.",
-                        failedMoistZone);
+                p = fmtStr(buf, "Moisture sensor failure in zone ", 0);
+                p = fmtUint(p, failedMoistZone, 0, ' ');
+                *p++ = '.';
+                *p = '\0';
                 break;
 
             case UI_SMSG_PULSE:
-                printf(buf, "Pulse ends in %s, %d remaining.",
-                dtFormatRunTimeSecs(tmpbuf, remainingSecs),
-                remainingPulses);
+                p = fmtStr(buf, "Pulse ends in ", 0);
+                p = fmtStr(p, dtFormatRunTimeSecs(tmpbuf, remainingSecs), 0);
+                *p++ = ',';
+                *p++ = ' ';
+                p = fmtUint(p, remainingPulses, 0, ' ');
+                p = fmtStr(p, " remaining.", 0);
+                *p = '\0';
                 break;
 
             case UI_SMSG_TOT_WATER:
  
                 remainingSecs = irrRemainingProgramSecs();
-                sprintf(buf, "Total watering remaining %s.",
-                dtFormatRunTimeSecs(tmpbuf, remainingSecs));
+                p = fmtStr(buf, "Total watering remaining ", 0);
+                p = fmtStr(p, dtFormatRunTimeSecs(tmpbuf, remainingSecs), 0);
+                *p++ = '.';
+                *p = '\0';
                 break;
                 
             case UI_SMSG_FLOW:
@@ -2981,32 +3127,34 @@ static char *uiFormatSystemStatus(char *buf)
                 if ( findFlow == 1 ) {
                     
                 if ( expansionIrrState == IRR_STATE_WATERING )
-                    sprintf(buf,
-                            "Flow is %d GPM, Target of %d-%d GPM",
-                            GPM,
-                            config.zone[expansionIrrCurZone-1].minGPM,
-                            config.zone[expansionIrrCurZone-1].maxGPM
-                            ); 
-                 else
-                    sprintf(buf,
-                            "Flow is %d GPM, Target of %d-%d GPM",
-                            GPM,
-                            config.zone[irrCurZone-1].minGPM,
-                            config.zone[irrCurZone-1].maxGPM
-                            ); 
+                    flowZone = expansionIrrCurZone;
+                else
+                    flowZone = irrCurZone;
+
+                p = fmtStr(buf, "Flow is ", 0);
+                p = fmtUint(p, GPM, 0, ' ');
+                p = fmtStr(p, " GPM, Target of ", 0);
+                p = fmtUint(p, config.zone[flowZone-1].minGPM, 0, ' ');
+                *p++ = '-';
+                p = fmtUint(p, config.zone[flowZone-1].maxGPM, 0, ' ');
+                p = fmtStr(p, " GPM", 0);
+                *p = '\0';
                 }
                 break;    
 
             case UI_SMSG_AUTO_OFF:
-                sprintf(buf, "Automatic irrigation is set to 'OFF'.");
+                p = fmtStr(buf, "Automatic irrigation is set to 'OFF'.", 0);
+                *p = '\0';
                 break;
 
             case UI_SMSG_RADIO_OFFLINE:
-                sprintf(buf, "Radio is offline.");
+                p = fmtStr(buf, "Radio is offline.", 0);
+                *p = '\0';
                 break;
 
             default:
-                sprintf(buf, "???");
+                p = fmtStr(buf, "???", 0);
+                *p = '\0';
                 break;
         }
     }
@@ -3106,6 +3254,7 @@ static void uiUnimplementedDisplay(void)
 static void uiStatusDisplay(void)
 {
     char buf[41];
+    char *pBuf;
     //char buf11[41];
     uint8_t zoneNumber;
     
@@ -3122,8 +3271,7 @@ static void uiStatusDisplay(void)
     }
 
     /* Write LCD line 1 (system mode) */
-    sprintf(&uiLcdBuf[LCD_RC(0, 0)],
-        uiFormatSystemMode(buf));
+    fmtStr(&uiLcdBuf[LCD_RC(0, 0)], uiFormatSystemMode(buf), 0);
     //sprintf(&uiLcdBuf[LCD_RC(0, 0)],
     //     "T:%3d,CT:%3d,CI:%d,SKIP:%d",
     //     dtTickCount,radioSnsConCheckinTime,scCheckedIn,TestSkipFlag);    
@@ -3136,8 +3284,7 @@ static void uiStatusDisplay(void)
             uiKeyMask = UI_KM_KEY5 | UI_KM_KEY6;
             if (sysIsInhibited)
             {
-                sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                        "(Inhibited)");
+                fmtStr(&uiLcdBuf[LCD_RC(1, 0)], "(Inhibited)", 0);
             }
             break;
 
@@ -3158,8 +3305,8 @@ static void uiStatusDisplay(void)
             if (sysIsInhibited)
             {
                 uiMenuSet(&uiMenuStatusPaused);
-                sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                        "WATERING INTERRUPTED  (Inhibited)");
+                fmtStr(&uiLcdBuf[LCD_RC(1, 0)],
+                       "WATERING INTERRUPTED  (Inhibited)", 0);
             }
             else if (sysIsPaused)
             {
@@ -3171,36 +3318,35 @@ static void uiStatusDisplay(void)
                          (config.zone[irrCurZone-1].sensorType != SNS_WIRELESS_MOIST))) 
                     {
                         //KAV
-                        sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                            "WATERING ZONE %d PAUSED FOR SC %04X",irrCurZone,(uint16_t)(config.sys.assocSensorCon[config.zone[irrCurZone-1].snsConTableIndex].macId & 0xFFFF) );
+                        pBuf = fmtStr(&uiLcdBuf[LCD_RC(1, 0)], "WATERING ZONE ", 0);
+                        pBuf = fmtUint(pBuf, irrCurZone, 0, ' ');
+                        pBuf = fmtStr(pBuf, " PAUSED FOR SC ", 0);
+                        fmtHex(pBuf, (uint16_t)(config.sys.assocSensorCon[config.zone[irrCurZone-1].snsConTableIndex].macId & 0xFFFF), 4);
                         break;
                     }
                 }
 
-                sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                        "WATERING INTERRUPTED  (Paused)");
+                fmtStr(&uiLcdBuf[LCD_RC(1, 0)],
+                       "WATERING INTERRUPTED  (Paused)", 0);
 
             }
             else if ((irrState == IRR_STATE_SOAKING)|(expansionIrrState == IRR_STATE_SOAKING))
             {
                 if(expansionIrrState == IRR_STATE_SOAKING)
                 {
-                    sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                        "SOAKING");
+                    fmtStr(&uiLcdBuf[LCD_RC(1, 0)], "SOAKING", 0);
                 }
                 else
                 {
-                    sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                        "SOAKING  (%s remaining)",
-                        dtFormatRunTimeSecs(buf, irrRemainingSoakSecs())
-                        );
+                    pBuf = fmtStr(&uiLcdBuf[LCD_RC(1, 0)], "SOAKING  (", 0);
+                    pBuf = fmtStr(pBuf, dtFormatRunTimeSecs(buf, irrRemainingSoakSecs()), 0);
+                    fmtStr(pBuf, " remaining)", 0);
                 }
             }
             else if ((irrState == IRR_STATE_SENSING)|(expansionIrrState == IRR_STATE_SENSING))
             {
                 uiKeyMask = UI_KM_ALL;
-                sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                        "SENSING . . .");
+                fmtStr(&uiLcdBuf[LCD_RC(1, 0)], "SENSING . . .", 0);
             }
             else
             {
@@ -3225,8 +3371,8 @@ static void uiStatusDisplay(void)
                 {                    
                     if(expansionIrrCurZone == 0)
                     {                    
-                        sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                            "WAITING FOR ZONE TO START");
+                        fmtStr(&uiLcdBuf[LCD_RC(1, 0)],
+                               "WAITING FOR ZONE TO START", 0);
                     }
                     else 
                     {   
@@ -3238,9 +3384,9 @@ static void uiStatusDisplay(void)
                         }
                         
                         
-                        sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                            "WATERING EXP ZONE %d  ",
-                             expansionIrrCurZone);                        
+                        pBuf = fmtStr(&uiLcdBuf[LCD_RC(1, 0)],
+                                      "WATERING EXP ZONE ", 0);
+                        fmtUint(pBuf, expansionIrrCurZone, 0, ' ');
                                                    
                         
                         /*                         
@@ -3260,17 +3406,17 @@ static void uiStatusDisplay(void)
                   
                     if(zoneNumber == 0)
                     {
-                        sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                            "WAITING FOR ZONE TO START");
+                        fmtStr(&uiLcdBuf[LCD_RC(1, 0)],
+                               "WAITING FOR ZONE TO START", 0);
                     }
                     else 
                     {   
                         
-                        sprintf(&uiLcdBuf[LCD_RC(1, 0)],
-                            "WATERING ZONE %d  (%s remaining)",
-                            zoneNumber,
-                            dtFormatRunTimeSecs(buf, irrRemainingZoneSecs(irrCurZone))
-                            );
+                        pBuf = fmtStr(&uiLcdBuf[LCD_RC(1, 0)], "WATERING ZONE ", 0);
+                        pBuf = fmtUint(pBuf, zoneNumber, 0, ' ');
+                        pBuf = fmtStr(pBuf, "  (", 0);
+                        pBuf = fmtStr(pBuf, dtFormatRunTimeSecs(buf, irrRemainingZoneSecs(irrCurZone)), 0);
+                        fmtStr(pBuf, " remaining)", 0);
                              
                         /*    
                         sprintf(&uiLcdBuf[LCD_RC(1, 0)],
@@ -3308,8 +3454,7 @@ static void uiStatusDisplay(void)
     }
     
     /* Write LCD line 3 (Date/Time or System Error/Fault Status). */
-    sprintf(&uiLcdBuf[LCD_RC(2, 0)], "%s",
-           uiFormatSystemStatus(buf));
+    fmtStr(&uiLcdBuf[LCD_RC(2, 0)], uiFormatSystemStatus(buf), 0);
 }
 
 
@@ -5359,7 +5504,6 @@ static void uiIrrDaysOff(uint8_t /*eventType*/, uint8_t /*eventKey*/)
 static void uiRunTimeSummaryDisplay(void)
 {
     uint16_t totalRT[SYS_N_PROGRAMS];
-    char buf[41];
 
     
     /* compute run-time totals for each program */
@@ -5397,9 +5541,13 @@ static void uiRunTimeSummaryDisplay(void)
 
         for (int p = i * 2; p < (i * 2) + 2 && p < SYS_N_PROGRAMS; p++)
         {
-            pBuf += sprintf(pBuf, "PGM %c: %6.6s       ",
-                            p + 'A',
-                            dtFormatRunTime(buf, totalRT[p]));
+            pBuf = fmtStr(pBuf, "PGM ", 0);
+            *pBuf++ = (char)(p + 'A');
+            pBuf = fmtStr(pBuf, ": ", 0);
+            pBuf = fmtUint(pBuf, totalRT[p] / 60, 3, ' ');
+            *pBuf++ = ':';
+            pBuf = fmtUint(pBuf, totalRT[p] % 60, 2, '0');
+            pBuf = fmtStr(pBuf, "       ", 0);
         }
     }
 }
@@ -5535,16 +5683,21 @@ static void uiRunTimeDisplay(void)
 
         if (config.zone[z].runTime[uiField2] != 0)
         {
-            pBuf += sprintf(pBuf, "%2d%c: %3.2d  ",
-                            displayZoneNum + z + 1,
-                            uiField2 + 'A',
-                            config.zone[z].runTime[uiField2]);
+            pBuf = fmtUint(pBuf, displayZoneNum + z + 1, 2, ' ');
+            *pBuf++ = (char)(uiField2 + 'A');
+            pBuf = fmtStr(pBuf, ": ", 0);
+            if (config.zone[z].runTime[uiField2] < 100)
+            {
+                *pBuf++ = ' ';
+            }
+            pBuf = fmtUint(pBuf, config.zone[z].runTime[uiField2], 2, '0');
+            pBuf = fmtStr(pBuf, "  ", 0);
         }
         else
         {
-            pBuf += sprintf(pBuf, "%2d%c: Off  ",
-                            displayZoneNum + z + 1,
-                            uiField2 + 'A');
+            pBuf = fmtUint(pBuf, displayZoneNum + z + 1, 2, ' ');
+            *pBuf++ = (char)(uiField2 + 'A');
+            pBuf = fmtStr(pBuf, ": Off  ", 0);
         }
     }
 
@@ -5788,10 +5941,10 @@ static void uiAppRateDisplay(void)
     {
         char *pBuf = &uiLcdBuf[LCD_RC(0, 0) + (i * 10)];
 
-        sprintf(pBuf, "%2d: %1d.%02d  ",
-                z + 1,
-                ntohs(config.zone[z].appRate) / 100,
-                ntohs(config.zone[z].appRate) % 100);
+        pBuf = fmtUint(pBuf, z + 1, 2, ' ');
+        pBuf = fmtStr(pBuf, ": ", 0);
+        pBuf = fmtFixed(pBuf, ntohs(config.zone[z].appRate), 2, 0);
+        pBuf = fmtStr(pBuf, "  ", 0);
     }
 
     if ((appRate <= CONFIG_APPRATE_MIN))
@@ -5914,10 +6067,10 @@ static void uiAppRateDisplay(void)
     {
         char *pBuf = &uiLcdBuf[LCD_RC(0, 0) + (i * 10)];
 
-        pBuf += sprintf(pBuf, "%2d: %1d.%02d  ",
-                        displayZoneNum+z + 1,
-                        ntohs(config.zone[z].appRate) / 100,
-                        ntohs(config.zone[z].appRate) % 100);
+        pBuf = fmtUint(pBuf, displayZoneNum + z + 1, 2, ' ');
+        pBuf = fmtStr(pBuf, ": ", 0);
+        pBuf = fmtFixed(pBuf, ntohs(config.zone[z].appRate), 2, 0);
+        pBuf = fmtStr(pBuf, "  ", 0);
     }
 
     uint8_t row = (uiField - uiFirstField) / 4;
@@ -6965,7 +7118,8 @@ static void uiMoistValDisplay(void)
     
     if(config.sys.unitType == UNIT_TYPE_MASTER)
     {
-        expansionBusSendCmd(RADIO_CMD_GET_MOIST, RADIO_EXP_SEND_ALL); 
+        /* expansion moisture values come from the status digest cache */
+        expansionDigestRequest();
     }
     
     switch(config.sys.unitType){
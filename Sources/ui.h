@@ -25,6 +25,25 @@
 
 
 
+/******************************************************************************
+ *
+ *  UI REFRESH DEPENDENCIES
+ *
+ *****************************************************************************/
+
+/*
+**  State shown on LCD screens.  Each menu declares the state it shows, and
+**  its screen is only re-drawn on the 1-second tick when that state has
+**  changed (see uiNotify).
+*/
+#define UI_DEP_NONE         0x00    /* static screen, redrawn on events only */
+#define UI_DEP_SECONDS      0x01    /* clock, countdowns, cycling messages */
+#define UI_DEP_IRR          0x02    /* irrigation & system state, MB values */
+#define UI_DEP_RADIO        0x04    /* radio & expansion unit status */
+#define UI_DEP_CONFIG       0x08    /* configuration settings */
+
+
+
 /******************************************************************************
  *
  *  UI GLOBAL VARIABLES
@@ -33,6 +52,7 @@
 
 extern char uiLcdBuf[160];              /* LCD screen buffer */
 extern uint8_t uiLcdCursor;             /* current hardware cursor location */
+extern uint8_t uiLcdGen;                /* incremented on each LCD update */
 extern uint8_t uiPosition;              /* current function switch position */
 extern uint8_t navEndZone;               /* control variable to set how many zones can navigate through */
 extern bool_t TestSkipFlag;
@@ -47,6 +67,7 @@ void uiInit(void);
 void uiPoll(void);
 void uiStatusShow(void);
 void uiLcdRefresh(void);
+void uiNotify(uint8_t deps);
 char *uiFormatSystemMode(char *buf);
 
 /* END ui */